@@ -47,7 +47,8 @@ public:
 
     void Configure(const vkex::ArgParser& args, vkex::Configuration& configuration);
     void Setup();
-    void Update(double frame_elapsed_time) {}
+    void Destroy();
+    void Update(double frame_elapsed_time);
     void Render(vkex::RenderData* p_data);
     void Present(vkex::PresentData* p_data);
 
@@ -62,6 +63,9 @@ private:
     vkex::Buffer              m_vertex_buffer         = nullptr;
     vkex::Texture             m_texture               = nullptr;
     vkex::Sampler             m_sampler               = nullptr;
+
+    // Written by Update on the simulation thread, read by Present
+    vkex::FrameStateT<vkex::ViewConstantsData> m_view_state;
 };
 
 void VkexInfoApp::Configure(const vkex::ArgParser& args, vkex::Configuration& configuration)
@@ -76,6 +80,7 @@ void VkexInfoApp::Configure(const vkex::ArgParser& args, vkex::Configuration& co
     configuration.graphics_debug.message_severity.warning = true;
     configuration.graphics_debug.message_severity.error   = true;
     configuration.graphics_debug.message_type.validation  = true;
+    configuration.pipelined_update.enable                 = true;
 }
 
 void VkexInfoApp::Setup()
@@ -100,7 +105,7 @@ void VkexInfoApp::Setup()
     {
         const vkex::ShaderInterface&        shader_interface = m_color_shader->GetInterface();
         vkex::DescriptorSetLayoutCreateInfo create_info      = ToVkexCreateInfo(shader_interface.GetSet(0));
-        VKEX_CALL(GetDevice()->CreateDescriptorSetLayout(create_info, &m_descriptor_set_layout));
+        VKEX_CALL(GetDevice()->AcquireDescriptorSetLayout(create_info, &m_descriptor_set_layout));
     }
 
     // Descriptor pool
@@ -118,7 +123,7 @@ void VkexInfoApp::Setup()
         vkex::PipelineLayoutCreateInfo create_info = {};
         create_info.descriptor_set_layouts.push_back(vkex::ToVulkan(m_descriptor_set_layout));
         vkex::Result vkex_result = vkex::Result::Undefined;
-        VKEX_CALL(GetDevice()->CreatePipelineLayout(create_info, &m_color_pipeline_layout));
+        VKEX_CALL(GetDevice()->AcquirePipelineLayout(create_info, &m_color_pipeline_layout));
     }
 
     // Pipeline
@@ -208,6 +213,40 @@ void VkexInfoApp::Setup()
             }
         }
     }
+
+    RegisterFrameState(&m_view_state);
+}
+
+void VkexInfoApp::Destroy()
+{
+    UnregisterFrameState(&m_view_state);
+
+    // Interned layouts are destroyed by the last release
+    VKEX_CALL(GetDevice()->ReleasePipelineLayout(m_color_pipeline_layout));
+    VKEX_CALL(GetDevice()->ReleaseDescriptorSetLayout(m_descriptor_set_layout));
+}
+
+void VkexInfoApp::Update(double frame_elapsed_time)
+{
+    // Runs on the simulation thread, frame values come from the snapshot
+    float3            eye    = float3(0, 1, 2);
+    float3            center = float3(0, 0, 0);
+    float3            up     = float3(0, 1, 0);
+    float             aspect = GetWindowAspect();
+    vkex::PerspCamera camera(eye, center, up, 60.0f, aspect);
+
+    float    t = static_cast<float>(GetUpdateFrameInfo().frame_start_time);
+    float4x4 M = glm::rotate(t, float3(0, 1, 0)) * glm::rotate(t / 2.0f, float3(0, 0, 1));
+    float4x4 V = camera.GetViewMatrix();
+    float4x4 P = camera.GetProjectionMatrix();
+
+    vkex::ViewConstantsData& view = m_view_state.GetUpdateState();
+    view.M                        = M;
+    view.V                        = V;
+    view.P                        = P;
+    view.MVP                      = P * V * M;
+    view.N                        = glm::inverseTranspose(float3x3(M));
+    view.LP                       = float3(0, 3, 5);
 }
 
 void VkexInfoApp::Render(vkex::RenderData* p_data)
@@ -220,26 +259,9 @@ void VkexInfoApp::Present(vkex::PresentData* p_present_data)
     uint32_t      frame_index = p_present_data->GetFrameIndex();
     PerFrameData& frame_data  = m_per_frame_data[frame_index];
 
-    // Update constant buffer
+    // Update constant buffer from the state Update published for this frame
     {
-        float3            eye    = float3(0, 1, 2);
-        float3            center = float3(0, 0, 0);
-        float3            up     = float3(0, 1, 0);
-        float             aspect = GetWindowAspect();
-        vkex::PerspCamera camera(eye, center, up, 60.0f, aspect);
-
-        float    t = GetFrameStartTime();
-        float4x4 M = glm::rotate(t, float3(0, 1, 0)) * glm::rotate(t / 2.0f, float3(0, 0, 1));
-        float4x4 V = camera.GetViewMatrix();
-        float4x4 P = camera.GetProjectionMatrix();
-
-        m_view_constants.data.M   = M;
-        m_view_constants.data.V   = V;
-        m_view_constants.data.P   = P;
-        m_view_constants.data.MVP = P * V * M;
-        m_view_constants.data.N   = glm::inverseTranspose(float3x3(M));
-        m_view_constants.data.LP  = float3(0, 3, 5);
-
+        m_view_constants.data = m_view_state.GetRenderState();
         VKEX_CALL(frame_data.constant_buffer->Copy(m_view_constants.size, &m_view_constants.data));
     }
 
@@ -58,6 +58,7 @@ public:
 
     void Configure(const vkex::ArgParser& args, vkex::Configuration& configuration);
     void Setup();
+    void Destroy();
     void Update(double frame_elapsed_time)
     {
     }
@@ -94,6 +95,7 @@ void VkexInfoApp::Configure(const vkex::ArgParser& args, vkex::Configuration& co
     configuration.graphics_debug.message_severity.error   = true;
     configuration.graphics_debug.message_type.validation  = true;
     configuration.enable_imgui                            = true;
+    configuration.gpu_profiler.enable                     = true;
 }
 
 void VkexInfoApp::SetupPerFrameObjects()
@@ -222,7 +224,7 @@ void VkexInfoApp::Setup()
     {
         const vkex::ShaderInterface&        shader_interface = m_color_shader->GetInterface();
         vkex::DescriptorSetLayoutCreateInfo create_info      = ToVkexCreateInfo(shader_interface.GetSet(0));
-        VKEX_CALL(GetDevice()->CreateDescriptorSetLayout(create_info, &m_descriptor_set_layout));
+        VKEX_CALL(GetDevice()->AcquireDescriptorSetLayout(create_info, &m_descriptor_set_layout));
     }
 
     // Descriptor pool
@@ -240,7 +242,7 @@ void VkexInfoApp::Setup()
         vkex::PipelineLayoutCreateInfo create_info = {};
         create_info.descriptor_set_layouts.push_back(vkex::ToVulkan(m_descriptor_set_layout));
         vkex::Result vkex_result = vkex::Result::Undefined;
-        VKEX_CALL(GetDevice()->CreatePipelineLayout(create_info, &m_color_pipeline_layout));
+        VKEX_CALL(GetDevice()->AcquirePipelineLayout(create_info, &m_color_pipeline_layout));
     }
 
     // Pipeline
@@ -302,6 +304,13 @@ void VkexInfoApp::Setup()
     SetupPerFrameObjects();
 }
 
+void VkexInfoApp::Destroy()
+{
+    // Interned layouts are destroyed by the last release
+    VKEX_CALL(GetDevice()->ReleasePipelineLayout(m_color_pipeline_layout));
+    VKEX_CALL(GetDevice()->ReleaseDescriptorSetLayout(m_descriptor_set_layout));
+}
+
 void VkexInfoApp::Render(vkex::RenderData* p_current_render_data, vkex::PresentData* p_current_present_data)
 {
     const uint32_t frame_index         = GetCurrentFrameIndex();
@@ -335,9 +344,15 @@ void VkexInfoApp::Render(vkex::RenderData* p_current_render_data, vkex::PresentD
     }
 
     // Build render work command buffer
-    vkex::CommandBuffer& cmd = per_frame_data.command_buffer;
+    vkex::CommandBuffer& cmd          = per_frame_data.command_buffer;
+    vkex::GpuProfiler    gpu_profiler = GetGpuProfiler();
     cmd->Begin();
+    if (gpu_profiler != nullptr) {
+        gpu_profiler->CmdBeginFrame(cmd);
+    }
     {
+        VKEX_GPU_ZONE(gpu_profiler, cmd, "Draw");
+
         auto& descriptor_set = per_frame_data.descriptor_set;
 
         auto rendering_info = vkex::RenderingInfo::LoadOpClear(
@@ -356,6 +371,9 @@ void VkexInfoApp::Render(vkex::RenderData* p_current_render_data, vkex::PresentD
         }
         cmd->CmdEndRendering();
     }
+    if (gpu_profiler != nullptr) {
+        gpu_profiler->CmdEndFrame(cmd);
+    }
     cmd->End();
 
     // Submit render work
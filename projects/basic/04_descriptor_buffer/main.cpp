@@ -30,8 +30,7 @@ using ViewConstants = vkex::ConstantBufferData<vkex::ViewConstantsData>;
 
 struct PerFrameData
 {
-    vkex::Buffer descriptor_buffer = nullptr;
-    vkex::Buffer constant_buffer   = nullptr;
+    vkex::Buffer constant_buffer = nullptr;
 };
 
 class VkexInfoApp : public vkex::Application
@@ -47,20 +46,22 @@ public:
 
     void Configure(const vkex::ArgParser& args, vkex::Configuration& configuration);
     void Setup();
+    void Destroy();
     void Update(double frame_elapsed_time) {}
     void Render(vkex::RenderData* p_data);
     void Present(vkex::PresentData* p_data);
 
 private:
-    std::vector<PerFrameData> m_per_frame_data        = {};
-    vkex::ShaderProgram       m_color_shader          = nullptr;
-    vkex::DescriptorSetLayout m_descriptor_set_layout = nullptr;
-    vkex::PipelineLayout      m_color_pipeline_layout = nullptr;
-    vkex::GraphicsPipeline    m_color_pipeline        = nullptr;
-    ViewConstants             m_view_constants        = {};
-    vkex::Buffer              m_vertex_buffer         = nullptr;
-    vkex::Texture             m_texture               = nullptr;
-    vkex::Sampler             m_sampler               = nullptr;
+    std::vector<PerFrameData>  m_per_frame_data        = {};
+    vkex::ShaderProgram        m_color_shader          = nullptr;
+    vkex::DescriptorSetLayout  m_descriptor_set_layout = nullptr;
+    vkex::DescriptorBufferHeap m_descriptor_heap       = nullptr;
+    vkex::PipelineLayout       m_color_pipeline_layout = nullptr;
+    vkex::GraphicsPipeline     m_color_pipeline        = nullptr;
+    ViewConstants              m_view_constants        = {};
+    vkex::Buffer               m_vertex_buffer         = nullptr;
+    vkex::Texture              m_texture               = nullptr;
+    vkex::Sampler              m_sampler               = nullptr;
 };
 
 void VkexInfoApp::Configure(const vkex::ArgParser& args, vkex::Configuration& configuration)
@@ -102,7 +103,7 @@ void VkexInfoApp::Setup()
         vkex::DescriptorSetLayoutCreateInfo create_info      = ToVkexCreateInfo(shader_interface.GetSet(0));
         create_info.flags.bits.descriptor_buffer             = true;
 
-        VKEX_CALL(GetDevice()->CreateDescriptorSetLayout(create_info, &m_descriptor_set_layout));
+        VKEX_CALL(GetDevice()->AcquireDescriptorSetLayout(create_info, &m_descriptor_set_layout));
     }
 
     // Pipeline layout
@@ -110,7 +111,7 @@ void VkexInfoApp::Setup()
         vkex::PipelineLayoutCreateInfo create_info = {};
         create_info.descriptor_set_layouts.push_back(vkex::ToVulkan(m_descriptor_set_layout));
         vkex::Result vkex_result = vkex::Result::Undefined;
-        VKEX_CALL(GetDevice()->CreatePipelineLayout(create_info, &m_color_pipeline_layout));
+        VKEX_CALL(GetDevice()->AcquirePipelineLayout(create_info, &m_color_pipeline_layout));
     }
 
     // Pipeline
@@ -168,6 +169,17 @@ void VkexInfoApp::Setup()
         VKEX_CALL(GetDevice()->CreateSampler(create_info, &m_sampler));
     }
 
+    // Descriptor heap
+    {
+        VkDeviceSize layout_size = 0;
+        vkex::GetDescriptorSetLayoutSizeEXT(*GetDevice(), *m_descriptor_set_layout, &layout_size);
+
+        vkex::DescriptorBufferHeapCreateInfo create_info = {};
+        create_info.frame_count                          = GetFrameCount();
+        create_info.resource_size                        = layout_size;
+        VKEX_CALL(GetDevice()->CreateDescriptorBufferHeap(create_info, &m_descriptor_heap));
+    }
+
     // Per frame data
     {
         const uint32_t frame_count = GetFrameCount();
@@ -176,21 +188,6 @@ void VkexInfoApp::Setup()
         for (uint32_t frame_index = 0; frame_index < frame_count; ++frame_index) {
             PerFrameData& per_frame_data = m_per_frame_data[frame_index];
 
-            // Descriptor buffer
-            {
-                VkDeviceSize layoutSize = 0;
-                vkex::GetDescriptorSetLayoutSizeEXT(*GetDevice(), *m_descriptor_set_layout, &layoutSize);
-
-                vkex::BufferCreateInfo create_info                              = {};
-                create_info.size                                                = layoutSize;
-                create_info.usage_flags.bits.shader_device_address              = true;
-                create_info.usage_flags.bits.resource_descriptor_buffer         = true;
-                create_info.usage_flags.bits.sampler_descriptor_buffer          = true;
-                create_info.committed                                           = true;
-                create_info.memory_usage                                        = VMA_MEMORY_USAGE_CPU_ONLY;
-                VKEX_CALL(GetDevice()->CreateBuffer(create_info, &per_frame_data.descriptor_buffer));
-            }
-
             // Constant buffer
             {
                 uint32_t val = (m_view_constants.size % 16);
@@ -201,71 +198,17 @@ void VkexInfoApp::Setup()
                 create_info.memory_usage                           = VMA_MEMORY_USAGE_CPU_ONLY;
                 VKEX_CALL(GetDevice()->CreateConstantBuffer(create_info, &per_frame_data.constant_buffer));
             }
-
-            // Update descriptors
-            {
-                char*    p_descriptor_buffer_addr = nullptr;
-                VkResult vkres                    = per_frame_data.descriptor_buffer->MapMemory(reinterpret_cast<void**>(&p_descriptor_buffer_addr));
-                VKEX_ASSERT_MSG((vkres == VK_SUCCESS), "map memory failed");
-
-                size_t descriptorBufferOffsetAlignment = GetDevice()->GetDescriptorBufferProperties().descriptorBufferOffsetAlignment;
-                size_t uniformBufferDescriptorSize     = GetDevice()->GetDescriptorBufferProperties().uniformBufferDescriptorSize;
-                size_t sampledImageDescriptorSize      = GetDevice()->GetDescriptorBufferProperties().sampledImageDescriptorSize;
-                size_t samplerDescriptorSize           = GetDevice()->GetDescriptorBufferProperties().samplerDescriptorSize;
-
-                const vkex::ShaderInterface& shader_interface     = m_color_shader->GetInterface();
-                vkex::ShaderInterface::Set   shader_interface_set = shader_interface.GetSet(0);
-
-                // Uniform buffer
-                {
-                    VkDescriptorAddressInfoEXT buffer_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT};
-                    buffer_info.pNext                      = nullptr;
-                    buffer_info.address                    = per_frame_data.constant_buffer->GetDeviceAddress();
-                    buffer_info.range                      = per_frame_data.constant_buffer->GetSize();
-                    buffer_info.format                     = VK_FORMAT_UNDEFINED;
-
-                    VkDescriptorGetInfoEXT descriptor_get_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT};
-                    descriptor_get_info.type                   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                    descriptor_get_info.data.pUniformBuffer    = &buffer_info;
-
-                    VkDeviceSize offset;
-                    vkex::GetDescriptorSetLayoutBindingOffsetEXT(*GetDevice(), *m_descriptor_set_layout, shader_interface_set.bindings[0].binding_number, &offset),
-                    vkex::GetDescriptorEXT(*GetDevice(), &descriptor_get_info, uniformBufferDescriptorSize, p_descriptor_buffer_addr + offset);
-                }
-
-                // Sampled image
-                {
-                    VkDescriptorImageInfo image_info = {};
-                    image_info.imageView             = *m_texture->GetImageView();
-                    image_info.imageLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-                    VkDescriptorGetInfoEXT descriptor_get_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT};
-                    descriptor_get_info.type                   = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-                    descriptor_get_info.data.pSampledImage     = &image_info;
-
-                    VkDeviceSize offset;
-                    vkex::GetDescriptorSetLayoutBindingOffsetEXT(*GetDevice(), *m_descriptor_set_layout, shader_interface_set.bindings[1].binding_number, &offset),
-                    vkex::GetDescriptorEXT(*GetDevice(), &descriptor_get_info, sampledImageDescriptorSize, p_descriptor_buffer_addr + offset);
-                }
-
-                // Sampler
-                {
-                    VkSampler              sampler             = *m_sampler;
-                    VkDescriptorGetInfoEXT descriptor_get_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT};
-                    descriptor_get_info.type                   = VK_DESCRIPTOR_TYPE_SAMPLER;
-                    descriptor_get_info.data.pSampler          = &sampler;
-                    
-                    VkDeviceSize offset;
-                    vkex::GetDescriptorSetLayoutBindingOffsetEXT(*GetDevice(), *m_descriptor_set_layout, shader_interface_set.bindings[2].binding_number, &offset),
-                    vkex::GetDescriptorEXT(*GetDevice(), &descriptor_get_info, samplerDescriptorSize, p_descriptor_buffer_addr + offset);
-                }
-
-                per_frame_data.descriptor_buffer->UnmapMemory();
-            }
         }
     }
 }
 
+void VkexInfoApp::Destroy()
+{
+    // Interned layouts are destroyed by the last release
+    VKEX_CALL(GetDevice()->ReleasePipelineLayout(m_color_pipeline_layout));
+    VKEX_CALL(GetDevice()->ReleaseDescriptorSetLayout(m_descriptor_set_layout));
+}
+
 void VkexInfoApp::Render(vkex::RenderData* p_data)
 {
 }
@@ -299,6 +242,21 @@ void VkexInfoApp::Present(vkex::PresentData* p_present_data)
         VKEX_CALL(frame_data.constant_buffer->Copy(m_view_constants.size, &m_view_constants.data));
     }
 
+    // Write descriptors for this frame
+    vkex::DescriptorBufferAllocation descriptor_set = {};
+    {
+        const vkex::ShaderInterface& shader_interface     = m_color_shader->GetInterface();
+        vkex::ShaderInterface::Set   shader_interface_set = shader_interface.GetSet(0);
+
+        vkex::DescriptorSetBindings bindings;
+        bindings.Bind(shader_interface_set.bindings[0].binding_number, frame_data.constant_buffer);
+        bindings.Bind(shader_interface_set.bindings[1].binding_number, m_texture);
+        bindings.Bind(shader_interface_set.bindings[2].binding_number, m_sampler);
+
+        m_descriptor_heap->NewFrame(frame_index);
+        VKEX_CALL(m_descriptor_heap->AllocateSet(m_descriptor_set_layout, bindings, &descriptor_set));
+    }
+
     // Build command buffer
     auto cmd = p_present_data->GetCommandBuffer();
     cmd->Begin();
@@ -314,26 +272,12 @@ void VkexInfoApp::Present(vkex::PresentData* p_present_data)
             cmd->CmdSetScissor(rendering_info.render_area);
             cmd->CmdBindPipeline(m_color_pipeline);
 
-            VkDescriptorBufferBindingInfoEXT bindingInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT};
-            bindingInfo.pNext                            = nullptr;
-            bindingInfo.address                          = frame_data.descriptor_buffer->GetDeviceAddress();
-            bindingInfo.usage =
-                VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
-                VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT;
-            cmd->CmdBindDescriptorBuffersEXT(1, &bindingInfo);
-
-            size_t descriptorBufferOffsetAlignment = GetDevice()->GetDescriptorBufferProperties().descriptorBufferOffsetAlignment;
-            VKEX_ASSERT((bindingInfo.address % descriptorBufferOffsetAlignment) == 0);
-
-            uint32_t     bufferIndices[1] = {0};
-            VkDeviceSize offsets[1]       = {0};
-            cmd->CmdSetDescriptorBufferOffsetsEXT(
+            cmd->CmdBindDescriptorBuffers(m_descriptor_heap);
+            cmd->CmdSetDescriptorBufferOffsets(
                 VK_PIPELINE_BIND_POINT_GRAPHICS,
                 *m_color_pipeline_layout,
                 0,
-                1,
-                bufferIndices,
-                offsets);
+                {descriptor_set});
 
             cmd->CmdBindVertexBuffers(m_vertex_buffer);
             cmd->CmdDraw(36, 1, 0, 0);
@@ -808,16 +808,41 @@ vkex::Result Application::InitializeVkexDevice()
         device_create_info.physical_device        = physical_device;
         device_create_info.safe_values            = true;
         device_create_info.enabled_features       = m_configuration.graphics.enable_features;
+        device_create_info.host_allocator         = m_host_allocator.get();
         device_create_info.queue_create_infos.push_back(queue_create_info);
+        const VkAllocationCallbacks* p_allocator = m_host_allocator ? m_host_allocator->GetCallbacks(VK_OBJECT_TYPE_DEVICE) : nullptr;
+        vkex::Result                 vkex_result = vkex::Result::Undefined;
+        VKEX_RESULT_CALL(
+            vkex_result,
+            m_instance->CreateDevice(device_create_info, &m_device, p_allocator););
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    // Pipeline cache
+    if (!m_configuration.pipeline_cache.disable) {
         vkex::Result vkex_result = vkex::Result::Undefined;
         VKEX_RESULT_CALL(
             vkex_result,
-            m_instance->CreateDevice(device_create_info, &m_device););
+            m_device->LoadPipelineCache(m_configuration.pipeline_cache.path));
         if (!vkex_result) {
             return vkex_result;
         }
     }
 
+    // Shader reflection cache
+    if (m_configuration.shader_reflection_cache.enable_disk_cache) {
+        const fs::path path = m_configuration.shader_reflection_cache.path;
+        if (fs::exists(path)) {
+            vkex::Result vkex_result = m_device->GetShaderReflectionCache().Load(path);
+            if (!vkex_result) {
+                // Not fatal, shaders are reflected as they are loaded
+                VKEX_LOG_WARN("Ignoring malformed shader reflection cache: " << path);
+            }
+        }
+    }
+
     // Queues
     {
         vkex::Result vkex_result = vkex::Result::Undefined;
@@ -1273,7 +1298,11 @@ vkex::Result Application::InitializeVkexSwapchain()
 
 vkex::Result Application::InitializeFakeSwapchain()
 {
-    uint32_t image_count = m_swapchain->GetImageCount();
+    // In window mode the fake images only stand in while the swapchain
+    // is being recreated, in headless mode they are rendered to every
+    // frame and need the full size.
+    uint32_t   image_count = IsApplicationModeWindow() ? m_swapchain->GetImageCount() : m_configuration.swapchain.image_count;
+    VkExtent3D extent      = IsApplicationModeWindow() ? VkExtent3D{1, 1, 1} : VkExtent3D{m_configuration.window.width, m_configuration.window.height, 1};
 
     // Fake swapchain color images
     {
@@ -1291,7 +1320,7 @@ vkex::Result Application::InitializeFakeSwapchain()
             image_create_info.create_flags          = 0;
             image_create_info.image_type            = VK_IMAGE_TYPE_2D;
             image_create_info.format                = {m_configuration.swapchain.color_format};
-            image_create_info.extent                = {1, 1, 1};
+            image_create_info.extent                = extent;
             image_create_info.mip_levels            = 1;
             image_create_info.array_layers          = 1;
             image_create_info.samples               = VK_SAMPLE_COUNT_1_BIT;
@@ -1332,7 +1361,7 @@ vkex::Result Application::InitializeFakeSwapchain()
             image_create_info.create_flags          = 0;
             image_create_info.image_type            = VK_IMAGE_TYPE_2D;
             image_create_info.format                = {m_configuration.swapchain.depth_stencil_format};
-            image_create_info.extent                = {1, 1, 1};
+            image_create_info.extent                = extent;
             image_create_info.mip_levels            = 1;
             image_create_info.array_layers          = 1;
             image_create_info.samples               = VK_SAMPLE_COUNT_1_BIT;
@@ -1523,7 +1552,6 @@ vkex::Result Application::InitializeFakeSwapchain()
     // Transition swapchain color images to VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
     // Transition swapchain depth/stencil images to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
     {
-        uint32_t image_count = m_swapchain->GetImageCount();
         for (uint32_t image_index = 0; image_index < image_count; ++image_index) {
             // Color image
             vkex::Image image = m_fake_swapchain_color_images[image_index];
@@ -1543,11 +1571,11 @@ vkex::Result Application::InitializeFakeSwapchain()
     {
         // clang-format off
         VKEX_LOG_INFO("");
-        VKEX_LOG_INFO("Fake Swapchain created : " << vkex::ToHexString(m_swapchain->GetVkObject()));
-        VKEX_LOG_INFO("   " << "Image Count      : " << m_configuration.swapchain.image_count);
+        VKEX_LOG_INFO("Fake Swapchain created : " << (IsApplicationModeWindow() ? vkex::ToHexString(m_swapchain->GetVkObject()) : std::string("<HEADLESS>")));
+        VKEX_LOG_INFO("   " << "Image Count      : " << image_count);
         VKEX_LOG_INFO("   " << "Format           : " << vkex::ToString(m_configuration.swapchain.color_format));
         VKEX_LOG_INFO("   " << "Color Space      : " << vkex::ToString(m_configuration.swapchain.color_space));
-        VKEX_LOG_INFO("   " << "Size             : " << 1 << "x" << 1);
+        VKEX_LOG_INFO("   " << "Size             : " << extent.width << "x" << extent.height);
         VKEX_LOG_INFO("   " << "Present Mode     : " << "<DON'T CARE>");
         VKEX_LOG_INFO("   " << "Paced Frame Rate : " << m_configuration.swapchain.paced_frame_rate);
         VKEX_LOG_INFO("");
@@ -1675,6 +1703,11 @@ vkex::Result Application::InitializeVkexPerFramePresentData()
 
 vkex::Result Application::InitializeVkex()
 {
+    // Host allocator
+    if (m_configuration.host_allocator.enable) {
+        m_host_allocator = std::make_unique<vkex::HostAllocator>();
+    }
+
     // Instance
     {
         vkex::InstanceCreateInfo instance_create_info          = {};
@@ -1684,10 +1717,11 @@ vkex::Result Application::InitializeVkex()
         instance_create_info.debug_utils.message_type          = m_configuration.graphics_debug.message_type;
         instance_create_info.enable_swapchain                  = (m_configuration.mode == APPLICATION_MODE_WINDOW) ? true : false;
 
-        vkex::Result vkex_result = vkex::Result::Undefined;
+        const VkAllocationCallbacks* p_allocator = m_host_allocator ? m_host_allocator->GetCallbacks(VK_OBJECT_TYPE_INSTANCE) : nullptr;
+        vkex::Result                 vkex_result = vkex::Result::Undefined;
         VKEX_RESULT_CALL(
             vkex_result,
-            vkex::CreateInstanceVKEX(instance_create_info, &m_instance));
+            vkex::CreateInstanceVKEX(instance_create_info, &m_instance, p_allocator));
         if (!vkex_result) {
             return vkex_result;
         }
@@ -1702,7 +1736,7 @@ vkex::Result Application::InitializeVkex()
     }
 
     // Swapchain memory pool (interesting comments inside implementation)
-    if (IsApplicationModeWindow()) {
+    {
         vkex::Result vkex_result = InitializeVkexSwapchainImageMemoryPool();
         if (!vkex_result) {
             return vkex_result;
@@ -1717,8 +1751,8 @@ vkex::Result Application::InitializeVkex()
         }
     }
 
-    // Fake swapchain
-    if (IsApplicationModeWindow()) {
+    // Fake swapchain, stands in for the swapchain in headless mode
+    {
         vkex::Result vkex_result = InitializeFakeSwapchain();
         if (!vkex_result) {
             return vkex_result;
@@ -1734,13 +1768,27 @@ vkex::Result Application::InitializeVkex()
     }
 
     // Per frame present data
-    if (IsApplicationModeWindow()) {
+    {
         vkex::Result vkex_result = InitializeVkexPerFramePresentData();
         if (!vkex_result) {
             return vkex_result;
         }
     }
 
+    // GPU profiler
+    if (m_configuration.gpu_profiler.enable) {
+        vkex::GpuProfilerCreateInfo create_info = {};
+        create_info.frame_count                 = m_configuration.frame_count;
+        create_info.queue_family_index          = m_graphics_queue->GetVkQueueFamilyIndex();
+        vkex::Result vkex_result                = m_device->CreateGpuProfiler(create_info, &m_gpu_profiler);
+        if (vkex_result == vkex::Result::ErrorTimestampsNotSupported) {
+            VKEX_LOG_WARN("Graphics queue does not support timestamps, GPU profiler disabled");
+        }
+        else if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
     return vkex::Result::Success;
 }
 
@@ -1778,7 +1826,7 @@ vkex::Result Application::InitializeImGui()
         init_info.Device                    = *m_device;
         init_info.QueueFamily               = m_graphics_queue->GetVkQueueFamilyIndex();
         init_info.Queue                     = *m_graphics_queue;
-        init_info.PipelineCache             = VK_NULL_HANDLE;
+        init_info.PipelineCache             = (m_device->GetDefaultPipelineCache() != nullptr) ? *(m_device->GetDefaultPipelineCache()) : VK_NULL_HANDLE;
         init_info.DescriptorPool            = *m_imgui_descriptor_pool;
         init_info.MinImageCount             = m_configuration.swapchain.image_count;
         init_info.ImageCount                = m_configuration.swapchain.image_count;
@@ -2057,7 +2105,7 @@ vkex::Result Application::InternalDestroy()
     }
 
     // Fake swapchain
-    if (IsApplicationModeWindow()) {
+    {
         vkex::Result vkex_result = DestroyFakeSwapchain();
         if (!vkex_result) {
             return vkex_result;
@@ -2065,13 +2113,22 @@ vkex::Result Application::InternalDestroy()
     }
 
     // Swapchain memory pool
-    if (IsApplicationModeWindow()) {
+    {
         vkex::Result vkex_result = DestroyVkexSwapchainImageMemoryPool();
         if (!vkex_result) {
             return vkex_result;
         }
     }
 
+    // GPU profiler
+    if (m_gpu_profiler != nullptr) {
+        vkex::Result vkex_result = m_device->DestroyGpuProfiler(m_gpu_profiler);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        m_gpu_profiler = nullptr;
+    }
+
     // Command pools
     {
         vkex::Result vkex_result = m_device->DestroyCommandPool(m_render_command_pool);
@@ -2097,7 +2154,7 @@ vkex::Result Application::InternalDestroy()
     }
 
     // Present data
-    if (IsApplicationModeWindow()) {
+    {
         for (auto& data : m_per_frame_present_data) {
             vkex::Result vkex_result = data->InternalDestroy();
             if (!vkex_result) {
@@ -2107,9 +2164,30 @@ vkex::Result Application::InternalDestroy()
         m_per_frame_present_data.clear();
     }
 
+    // Pipeline cache
+    if ((m_device != nullptr) && (m_device->GetDefaultPipelineCache() != nullptr)) {
+        // Include pipelines that are still compiling
+        m_device->WaitPipelineCompiles();
+
+        vkex::Result vkex_result = m_device->SavePipelineCache(m_configuration.pipeline_cache.path);
+        if (!vkex_result) {
+            // Not fatal, next run starts with a cold cache
+            VKEX_LOG_WARN("Unable to save pipeline cache: " << m_configuration.pipeline_cache.path);
+        }
+    }
+
+    // Shader reflection cache
+    if ((m_device != nullptr) && m_configuration.shader_reflection_cache.enable_disk_cache) {
+        vkex::Result vkex_result = m_device->GetShaderReflectionCache().Save(m_configuration.shader_reflection_cache.path);
+        if (!vkex_result) {
+            VKEX_LOG_WARN("Unable to save shader reflection cache: " << m_configuration.shader_reflection_cache.path);
+        }
+    }
+
     // Device
     if (m_device != nullptr) {
-        vkex::Result vkex_result = m_instance->DestroyDevice(m_device);
+        const VkAllocationCallbacks* p_allocator = m_host_allocator ? m_host_allocator->GetCallbacks(VK_OBJECT_TYPE_DEVICE) : nullptr;
+        vkex::Result                 vkex_result = m_instance->DestroyDevice(m_device, p_allocator);
         if (!vkex_result) {
             return vkex_result;
         }
@@ -2118,13 +2196,20 @@ vkex::Result Application::InternalDestroy()
 
     // Instance
     if (m_instance != nullptr) {
-        vkex::Result vkex_result = vkex::DestroyInstanceVKEX(m_instance);
+        const VkAllocationCallbacks* p_allocator = m_host_allocator ? m_host_allocator->GetCallbacks(VK_OBJECT_TYPE_INSTANCE) : nullptr;
+        vkex::Result                 vkex_result = vkex::DestroyInstanceVKEX(m_instance, p_allocator);
         if (!vkex_result) {
             return vkex_result;
         }
         m_instance = nullptr;
     }
 
+    // Host allocator, bytes still in use after the instance is gone are leaks
+    if (m_host_allocator) {
+        m_host_allocator->LogStats();
+        m_host_allocator.reset();
+    }
+
     if (m_window != nullptr) {
         glfwDestroyWindow(m_window);
         m_window = nullptr;
@@ -2237,78 +2322,193 @@ void Application::KeyDownCallback(KeyboardInput key)
     }
 }
 
+void Application::AddBenchmarkArgs()
+{
+    m_args.AddOptionInt("bf", "benchmark-frames", "Run headless and record a report for this many frames");
+    m_args.AddOptionInt("bw", "benchmark-warmup-frames", "Frames to run before the benchmark starts recording");
+    m_args.AddOptionString("br", "benchmark-report", "Benchmark report path, CSV if it ends in .csv and JSON otherwise");
+}
+
+void Application::ConfigureBenchmark()
+{
+    int frame_count = 0;
+    if (m_args.GetInt("bf", "benchmark-frames", &frame_count)) {
+        m_configuration.benchmark.frame_count = static_cast<uint32_t>(std::max(frame_count, 0));
+    }
+
+    int warmup_frame_count = 0;
+    if (m_args.GetInt("bw", "benchmark-warmup-frames", &warmup_frame_count)) {
+        m_configuration.benchmark.warmup_frame_count = static_cast<uint32_t>(std::max(warmup_frame_count, 0));
+    }
+
+    m_args.GetString("br", "benchmark-report", &m_configuration.benchmark.report_path);
+
+    if (!IsBenchmarkMode()) {
+        return;
+    }
+
+    // Fixed workload: fake swapchain, no pacing
+    m_configuration.mode                       = APPLICATION_MODE_HEADLESS;
+    m_configuration.swapchain.paced_frame_rate = 0;
+    m_configuration.host_allocator.enable      = true;
+    m_configuration.gpu_profiler.enable        = true;
+
+    if (m_configuration.benchmark.report_path.empty()) {
+        m_configuration.benchmark.report_path = GetDefaultOutputPath("_benchmark.json").string();
+    }
+
+    m_benchmark_report.SetName(m_configuration.name);
+    m_benchmark_report.SetWarmupFrameCount(m_configuration.benchmark.warmup_frame_count);
+    m_benchmark_report.Reserve(m_configuration.benchmark.frame_count);
+
+    VKEX_LOG_INFO("Benchmark: " << m_configuration.benchmark.warmup_frame_count << " warm-up frames, " << m_configuration.benchmark.frame_count << " recorded frames");
+}
+
+void Application::RecordBenchmarkFrame()
+{
+    if (m_elapsed_frame_count < m_configuration.benchmark.warmup_frame_count) {
+        return;
+    }
+
+    vkex::BenchmarkFrame frame   = {};
+    frame.frame_number           = m_elapsed_frame_count;
+    frame.frame_time             = GetElapsedTime() - m_frame_start_time;
+    frame.update_time            = m_update_fn_time;
+    frame.render_time            = m_render_fn_time;
+    frame.present_time           = m_present_fn_time;
+    frame.render_fence_wait_time = m_render_fence_wait_time;
+    frame.frame_fence_wait_time  = m_frame_fence_wait_time;
+    if (m_host_allocator) {
+        frame.host_allocation_count = m_host_allocator->GetFrameAllocationCount();
+        frame.host_bytes_allocated  = m_host_allocator->GetFrameBytesAllocated();
+    }
+    m_benchmark_report.AddFrame(frame);
+
+    if (m_benchmark_report.GetFrames().size() >= m_configuration.benchmark.frame_count) {
+        Quit();
+    }
+}
+
+void Application::CollectBenchmarkGpuTimes()
+{
+    std::vector<vkex::GpuFrameTime> frame_times;
+    m_gpu_profiler->TakeResolvedFrameTimes(&frame_times);
+    for (auto& frame_time : frame_times) {
+        m_benchmark_report.SetGpuTime(frame_time.frame_number, frame_time.time);
+    }
+}
+
+vkex::Result Application::SaveBenchmarkReport()
+{
+    m_benchmark_report.SetDeviceName(m_device->GetDeviceName());
+
+    vkex::Result vkex_result = m_benchmark_report.Save(m_configuration.benchmark.report_path);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    VKEX_LOG_INFO("Benchmark report written to " << m_configuration.benchmark.report_path);
+
+    return vkex::Result::Success;
+}
+
+void Application::AddCpuProfilerArgs()
+{
+    m_args.AddOptionString("ct", "cpu-trace", "Record CPU zones and write a Chrome trace to this path on exit");
+}
+
+void Application::ConfigureCpuProfiler()
+{
+    if (m_args.GetString("ct", "cpu-trace", &m_configuration.cpu_profiler.trace_path)) {
+        m_configuration.cpu_profiler.enable = true;
+    }
+
+    if (!m_configuration.cpu_profiler.enable) {
+        return;
+    }
+
+    if (m_configuration.cpu_profiler.trace_path.empty()) {
+        m_configuration.cpu_profiler.trace_path = GetDefaultOutputPath("_trace.json").string();
+    }
+
+    vkex::CpuProfiler::SetThreadName("Main");
+    vkex::CpuProfiler::SetEnabled(true);
+}
+
+vkex::Result Application::SaveCpuTrace()
+{
+    vkex::CpuProfiler::SetEnabled(false);
+
+    vkex::Result vkex_result = vkex::CpuProfiler::SaveChromeTrace(m_configuration.cpu_profiler.trace_path);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    VKEX_LOG_INFO("CPU trace written to " << m_configuration.cpu_profiler.trace_path << " (" << vkex::CpuProfiler::GetTraceZoneCount() << " zones, " << vkex::CpuProfiler::GetDroppedZoneCount() << " dropped)");
+
+    return vkex::Result::Success;
+}
+
 vkex::Result Application::CheckConfiguration()
 {
     if (m_configuration.frame_count == 0) {
         m_configuration.frame_count = kDefaultInFlightFrameCount;
     }
 
+    if (m_configuration.pipeline_cache.path.empty()) {
+        m_configuration.pipeline_cache.path = GetDefaultOutputPath("_pipeline_cache.bin").string();
+    }
+
+    if (m_configuration.shader_reflection_cache.path.empty()) {
+        m_configuration.shader_reflection_cache.path = GetDefaultOutputPath("_reflection_cache.bin").string();
+    }
+
     return vkex::Result::Success;
 }
 
-vkex::Result Application::UpdateCurrentPerFrameData()
+// Per frame data is used round robin, so each frame's previous frame is
+// the slot before it. The oldest frame in flight, which is the slot after
+// the current one, has no previous frame.
+template <typename PerFrameDataT>
+PerFrameDataT* Application::AdvancePerFrameData(
+    const std::vector<std::unique_ptr<PerFrameDataT>>& per_frame_data,
+    uint32_t                                           frame_index,
+    uint64_t                                           elapsed_frame_count)
 {
-    // NOTE: This is really gross - find a better way to do this.
+    const size_t count = per_frame_data.size();
+    VKEX_ASSERT(frame_index < count);
 
-    // Render data
-    {
-        // Stack size should always be less than or equal to total frames
-        VKEX_ASSERT(m_render_data_stack.size() <= m_per_frame_render_data.size());
-        // Update current render data and shuffle stack
-        m_current_render_data = m_per_frame_render_data[m_frame_index].get();
-        if (m_render_data_stack.size() == m_per_frame_render_data.size()) {
-            const size_t last_index = m_render_data_stack.size() - 1;
-            for (size_t i = 0; i < last_index; ++i) {
-                m_render_data_stack[i] = m_render_data_stack[i + 1];
-            }
-            m_render_data_stack[last_index] = m_current_render_data;
-        }
-        else {
-            m_render_data_stack.push_back(m_current_render_data);
-        }
-        // Update the previous frame pointers
-        m_render_data_stack[0]->SetPrevious(nullptr);
-        for (size_t i = 0; i < (m_render_data_stack.size() - 1); ++i) {
-            m_render_data_stack[i + 1]->SetPrevious(m_render_data_stack[i]);
-        }
+    if ((elapsed_frame_count + 1) >= count) {
+        per_frame_data[(frame_index + 1) % count]->SetPrevious(nullptr);
     }
 
-    // Present data
-    {
-        // Stack size should always be less than or equal to total frames
-        VKEX_ASSERT(m_present_data_stack.size() <= m_per_frame_present_data.size());
-        // Update current present data and shuffle stack
-        m_current_present_data = m_per_frame_present_data[m_frame_index].get();
-        if (m_present_data_stack.size() == m_per_frame_present_data.size()) {
-            const size_t last_index = m_present_data_stack.size() - 1;
-            for (size_t i = 0; i < last_index; ++i) {
-                m_present_data_stack[i] = m_present_data_stack[i + 1];
-            }
-            m_present_data_stack[last_index] = m_current_present_data;
-        }
-        else {
-            m_present_data_stack.push_back(m_current_present_data);
-        }
-        // Update the previous frame pointers
-        m_present_data_stack[0]->SetPrevious(nullptr);
-        for (size_t i = 0; i < (m_present_data_stack.size() - 1); ++i) {
-            m_present_data_stack[i + 1]->SetPrevious(m_present_data_stack[i]);
-        }
+    PerFrameDataT* p_current  = per_frame_data[frame_index].get();
+    PerFrameDataT* p_previous = nullptr;
+    if ((elapsed_frame_count > 0) && (count > 1)) {
+        p_previous = per_frame_data[(frame_index + count - 1) % count].get();
     }
+    p_current->SetPrevious(p_previous);
 
-    // m_current_render_data = m_per_frame_render_data[m_frame_index].get();
-    // if (IsApplicationModeWindow()) {
-    //   if (m_current_present_data != nullptr) {
-    //       m_previous_present_data = m_current_present_data;
-    //   }
-    //   m_current_present_data = m_per_frame_present_data[m_frame_index].get();
-    // }
+    return p_current;
+}
+
+vkex::Result Application::UpdateCurrentPerFrameData()
+{
+    // Render data
+    m_current_render_data = AdvancePerFrameData(m_per_frame_render_data, m_frame_index, m_elapsed_frame_count);
+
+    // Present data
+    if (!m_per_frame_present_data.empty()) {
+        m_current_present_data = AdvancePerFrameData(m_per_frame_present_data, m_frame_index, m_elapsed_frame_count);
+    }
 
     return vkex::Result::Success;
 }
 
 vkex::Result vkex::Application::ProcessRenderFence(RenderData* p_data)
 {
+    VKEX_CPU_ZONE("Wait Render Fence");
+
     VkResult vk_result = InvalidValue<VkResult>::Value;
     VKEX_VULKAN_RESULT_CALL(
         vk_result,
@@ -2330,9 +2530,7 @@ vkex::Result vkex::Application::ProcessRenderFence(RenderData* p_data)
 
 vkex::Result Application::ProcessFrameFence(PresentData* p_data)
 {
-    if (!IsApplicationModeWindow()) {
-        return vkex::Result::ErrorInvalidApplicationMode;
-    }
+    VKEX_CPU_ZONE("Wait Frame Fence");
 
     VkResult vk_result = InvalidValue<VkResult>::Value;
     VKEX_VULKAN_RESULT_CALL(
@@ -2355,9 +2553,7 @@ vkex::Result Application::ProcessFrameFence(PresentData* p_data)
 
 vkex::Result Application::AcquireNextImage(PresentData* p_present_data, uint32_t* p_swapchain_image_index)
 {
-    if (!IsApplicationModeWindow()) {
-        return vkex::Result::ErrorInvalidApplicationMode;
-    }
+    VKEX_CPU_ZONE("Acquire Next Image");
 
     // Flag to indicate if fence needs resetting
     bool reset_fence = false;
@@ -2370,7 +2566,8 @@ vkex::Result Application::AcquireNextImage(PresentData* p_present_data, uint32_t
     VkFence     vk_image_acquired_fence     = *vkex_image_acquired_fence;
 
     // Use next images from *fake* swapchain if m_recreate_swapchain is set
-    if (m_recreate_swapchain) {
+    // or if there is no swapchain
+    if (m_recreate_swapchain || IsApplicationModeHeadless()) {
         *p_swapchain_image_index = m_elapsed_frame_count % m_configuration.swapchain.image_count;
 
         // Still need to signal the image acquire semaphore so doesn't break the loop
@@ -2508,6 +2705,14 @@ fs::path Application::GetApplicationPath() const
     return path;
 }
 
+fs::path Application::GetDefaultOutputPath(const std::string& suffix) const
+{
+    fs::path app_path = GetApplicationPath();
+    fs::path path     = app_path.parent_path() / app_path.stem();
+    path += suffix;
+    return path;
+}
+
 const std::vector<fs::path>& Application::GetAssetDirs() const
 {
     return m_asset_dirs;
@@ -2595,19 +2800,91 @@ void Application::DispatchCallKeyDown(KeyboardInput key)
     KeyDown(key);
 }
 
+void Application::RegisterFrameState(vkex::IFrameState* p_frame_state)
+{
+    VKEX_ASSERT_MSG(!m_pipelined_update_pending, "Frame states must not be registered while an update is in flight");
+
+    auto it = std::find(std::begin(m_frame_states), std::end(m_frame_states), p_frame_state);
+    if (it == std::end(m_frame_states)) {
+        m_frame_states.push_back(p_frame_state);
+    }
+}
+
+void Application::UnregisterFrameState(vkex::IFrameState* p_frame_state)
+{
+    VKEX_ASSERT_MSG(!m_pipelined_update_pending, "Frame states must not be unregistered while an update is in flight");
+
+    m_frame_states.erase(
+        std::remove(std::begin(m_frame_states), std::end(m_frame_states), p_frame_state),
+        std::end(m_frame_states));
+}
+
+void Application::PublishFrameStates()
+{
+    for (auto p_frame_state : m_frame_states) {
+        p_frame_state->Publish();
+    }
+}
+
+void Application::CaptureUpdateFrameInfo()
+{
+    VKEX_ASSERT_MSG(!m_pipelined_update_pending, "Frame info must not change while an update is in flight");
+
+    m_update_frame_info.elapsed_frames     = m_elapsed_frame_count;
+    m_update_frame_info.frame_start_time   = m_frame_start_time;
+    m_update_frame_info.frame_elapsed_time = m_frame_elapsed_time;
+    m_update_frame_info.average_frame_time = m_average_frame_time;
+    m_update_frame_info.frames_per_second  = m_frames_per_second;
+}
+
+void Application::StartPipelinedUpdate(double frame_elapsed_time)
+{
+    VKEX_ASSERT_MSG(!m_pipelined_update_pending, "Pipelined update already in flight");
+
+    // The worker only reads the snapshot, Submit() orders the writes
+    CaptureUpdateFrameInfo();
+
+    m_pipelined_update_pending = true;
+    m_update_worker->Submit([this, frame_elapsed_time]() {
+        double start_time = GetElapsedTime();
+        DispatchCallUpdate(frame_elapsed_time);
+        double end_time            = GetElapsedTime();
+        m_pipelined_update_fn_time = end_time - start_time;
+    });
+}
+
+void Application::WaitPipelinedUpdate()
+{
+    if (!m_pipelined_update_pending) {
+        return;
+    }
+
+    {
+        VKEX_CPU_ZONE("Wait Pipelined Update");
+        m_update_worker->WaitIdle();
+    }
+    m_pipelined_update_pending = false;
+
+    m_update_fn_time = m_pipelined_update_fn_time;
+    m_update_time_stats.Push(m_update_fn_time);
+}
+
 void Application::DispatchCallUpdate(double frame_elapsed_time)
 {
+    VKEX_CPU_ZONE("Update");
     Update(frame_elapsed_time);
 }
 
 void Application::DispatchCallRender(RenderData* p_render_data, PresentData* p_present_data)
 {
+    VKEX_CPU_ZONE("Render");
     Render(p_render_data, p_present_data);
     SubmitRender(p_render_data, p_present_data);
 }
 
 void Application::DispatchCallPresent(PresentData* p_present_data)
 {
+    VKEX_CPU_ZONE("Present");
     Present(p_present_data);
     SubmitPresent(p_present_data);
 }
@@ -2644,6 +2921,11 @@ void Application::SetCursorMode(vkex::CursorMode cursor_mode)
 
 void Application::DrawImGui(vkex::CommandBuffer cmd)
 {
+    // No ImGui frame was started
+    if (!IsApplicationModeWindow() || !m_configuration.enable_imgui) {
+        return;
+    }
+
     ImGui::Render();
     ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), *cmd);
 }
@@ -2693,13 +2975,16 @@ vkex::Result Application::SubmitRender(RenderData* p_current_render_data, Presen
 
     // Queue submit
     VkResult vk_result = InvalidValue<VkResult>::Value;
-    VKEX_VULKAN_RESULT_CALL(
-        vk_result,
-        vkQueueSubmit(
-            *m_graphics_queue,
-            1,
-            &vk_submit_info,
-            vk_work_complete_fence));
+    {
+        VKEX_CPU_ZONE("vkQueueSubmit");
+        VKEX_VULKAN_RESULT_CALL(
+            vk_result,
+            vkQueueSubmit(
+                *m_graphics_queue,
+                1,
+                &vk_submit_info,
+                vk_work_complete_fence));
+    }
     if (vk_result != VK_SUCCESS) {
         return vkex::Result(vk_result);
     }
@@ -2711,10 +2996,6 @@ vkex::Result Application::SubmitRender(RenderData* p_current_render_data, Presen
 
 vkex::Result Application::SubmitPresent(vkex::PresentData* p_present_data)
 {
-    if (IsApplicationModeHeadless()) {
-        return vkex::Result::ErrorInvalidApplicationMode;
-    }
-
     // Vulkan objects
     VkSemaphore          vk_image_acquired_semaphore            = *(p_present_data->GetImageAcquiredSemaphore());
     VkCommandBuffer      vk_command_buffer                      = *(p_present_data->GetCommandBuffer());
@@ -2722,7 +3003,6 @@ vkex::Result Application::SubmitPresent(vkex::PresentData* p_present_data)
     VkSemaphore          vk_work_complete_for_render_semaphore  = *(p_present_data->GetWorkCompleteForRenderSemaphore());
     VkSemaphore          vk_work_complete_for_present_semaphore = *(p_present_data->GetWorkCompleteForPresentSemaphore());
     VkFence              vk_work_complete_fence                 = *(p_present_data->GetWorkCompleteFence());
-    VkSwapchainKHR       vk_swapchain                           = *m_swapchain;
     uint32_t             vk_swapchain_image_index               = m_current_swapchain_image_index;
 
     // Submit present work
@@ -2752,23 +3032,26 @@ vkex::Result Application::SubmitPresent(vkex::PresentData* p_present_data)
         vk_submit_info.pSignalSemaphores    = DataPtr(vk_signal_semaphores);
         // Queue submit
         VkResult vk_result = InvalidValue<VkResult>::Value;
-        VKEX_VULKAN_RESULT_CALL(
-            vk_result,
-            vkQueueSubmit(
-                *m_graphics_queue,
-                1,
-                &vk_submit_info,
-                vk_work_complete_fence));
+        {
+            VKEX_CPU_ZONE("vkQueueSubmit");
+            VKEX_VULKAN_RESULT_CALL(
+                vk_result,
+                vkQueueSubmit(
+                    *m_graphics_queue,
+                    1,
+                    &vk_submit_info,
+                    vk_work_complete_fence));
+        }
         if (vk_result != VK_SUCCESS) {
             return vkex::Result(vk_result);
         }
     }
 
-    // Submit present request
-    if (!m_recreate_swapchain) {
+    // Submit present request, the fake swapchain has nothing to present
+    if (IsApplicationModeWindow() && !m_recreate_swapchain) {
         // Containers
         std::vector<VkSemaphore>    vk_wait_semaphores         = {vk_work_complete_for_present_semaphore};
-        std::vector<VkSwapchainKHR> vk_swapchains              = {vk_swapchain};
+        std::vector<VkSwapchainKHR> vk_swapchains              = {*m_swapchain};
         std::vector<uint32_t>       vk_swapchain_image_indices = {vk_swapchain_image_index};
 
         // Present info
@@ -2785,9 +3068,13 @@ vkex::Result Application::SubmitPresent(vkex::PresentData* p_present_data)
         time_range.start     = static_cast<float>(GetElapsedTime());
 
         // Queue present
-        VkResult vk_result = vkQueuePresentKHR(
-            *m_present_queue,
-            &vk_present_info);
+        VkResult vk_result = InvalidValue<VkResult>::Value;
+        {
+            VKEX_CPU_ZONE("vkQueuePresentKHR");
+            vk_result = vkQueuePresentKHR(
+                *m_present_queue,
+                &vk_present_info);
+        }
         if (vk_result != VK_SUCCESS) {
             //
             // NOTE: In testing on Windows 10, I found that only NVIDIA returns OUT_OF_DATE
@@ -2807,16 +3094,15 @@ vkex::Result Application::SubmitPresent(vkex::PresentData* p_present_data)
         // Queue present time end
         time_range.end  = static_cast<float>(GetElapsedTime());
         time_range.diff = time_range.end - time_range.start;
-        m_vk_queue_present_times.push_back(time_range);
-        // Average queue present time
-        {
-            m_average_vk_queue_present_time = 0;
-            const size_t n                  = m_vk_queue_present_times.size();
-            for (size_t i = 0; i < n; ++i) {
-                m_average_vk_queue_present_time += m_vk_queue_present_times[i].diff;
-            }
-            m_average_vk_queue_present_time *= 1.0f / static_cast<float>(n);
+        m_vk_queue_present_time_stats.Push(time_range.diff);
+
+        // The average stays over the last 100 presents, kept as a running sum
+        if (m_vk_queue_present_times.size() == m_vk_queue_present_times.capacity()) {
+            m_vk_queue_present_time_sum -= m_vk_queue_present_times[0].diff;
         }
+        m_vk_queue_present_times.push_back(time_range);
+        m_vk_queue_present_time_sum += time_range.diff;
+        m_average_vk_queue_present_time = static_cast<float>(m_vk_queue_present_time_sum / static_cast<double>(m_vk_queue_present_times.size()));
     }
     // Still need consume the wait semaphore so the queue doesn't stall and break the loop
     else {
@@ -2974,6 +3260,8 @@ bool Application::IsRunning() const
 vkex::Result Application::Run(int argn, const char* const* argv)
 {
     // Add args
+    AddBenchmarkArgs();
+    AddCpuProfilerArgs();
     DispatchCallAddArgs(m_args);
 
     // Parse args
@@ -2987,6 +3275,10 @@ vkex::Result Application::Run(int argn, const char* const* argv)
     // Call app configure
     DispatchCallConfigure(m_args, m_configuration);
 
+    // Benchmark and profiler args override the app's configuration
+    ConfigureBenchmark();
+    ConfigureCpuProfiler();
+
     // Check configuration
     vkex::Result vkex_result = CheckConfiguration();
     if (!vkex_result) {
@@ -3005,12 +3297,33 @@ vkex::Result Application::Run(int argn, const char* const* argv)
     if (IsApplicationModeWindow()) {
         glfwSetTime(0);
     }
+    m_start_timestamp = vkex::Timer::Timestamp();
+
+    // Simulation thread for pipelined updates
+    if (m_configuration.pipelined_update.enable) {
+        m_update_worker = std::make_unique<vkex::WorkerPool>(1, "Update");
+    }
+
+    // Never leave Run() with an update in flight, including on errors
+    struct PipelinedUpdateGuard
+    {
+        Application* p_application;
+        ~PipelinedUpdateGuard()
+        {
+            p_application->WaitPipelinedUpdate();
+        }
+    } pipelined_update_guard = {this};
 
     // -----------------------------------------------------------------------------------------------
     // Main loop [BEGIN]
     // -----------------------------------------------------------------------------------------------
     m_running = true;
     while (IsRunning()) {
+        VKEX_CPU_ZONE("Frame");
+
+        // Wait for this frame's pipelined update before touching anything it might read
+        WaitPipelinedUpdate();
+
         // Poll GLFW events
         if (IsApplicationModeWindow()) {
             glfwPollEvents();
@@ -3024,6 +3337,7 @@ vkex::Result Application::Run(int argn, const char* const* argv)
             // Update time stats
             if (m_elapsed_frame_count > 0) {
                 m_frame_start_time_delta = (current_time - m_frame_start_time);
+                m_frame_time_stats.Push(m_frame_start_time_delta);
                 m_total_frame_time += m_frame_start_time_delta;
                 m_average_frame_time = (m_total_frame_time / static_cast<double>(m_elapsed_frame_count));
                 m_frames_per_second  = static_cast<double>(m_elapsed_frame_count) / current_time;
@@ -3056,6 +3370,9 @@ vkex::Result Application::Run(int argn, const char* const* argv)
             }
         }
 
+        // Objects deferred from here on may be used by this frame
+        m_device->BeginDeferredDestroyFrame(m_elapsed_frame_count);
+
         // Start the Dear ImGui frame
         if (IsApplicationModeWindow() && m_configuration.enable_imgui) {
             ImGui_ImplVulkan_NewFrame();
@@ -3063,12 +3380,24 @@ vkex::Result Application::Run(int argn, const char* const* argv)
             ImGui::NewFrame();
         }
 
-        // Call app update
-        {
+        // Call app update, with pipelined updates only the first frame
+        // has no update in flight
+        if (!IsPipelinedUpdate() || (m_elapsed_frame_count == 0)) {
+            CaptureUpdateFrameInfo();
+
             double start_time = GetElapsedTime();
             DispatchCallUpdate(m_frame_elapsed_time);
             double end_time  = GetElapsedTime();
             m_update_fn_time = end_time - start_time;
+            m_update_time_stats.Push(m_update_fn_time);
+        }
+
+        // Hand this frame's state to render
+        PublishFrameStates();
+
+        // Update the next frame while this one renders
+        if (IsPipelinedUpdate()) {
+            StartPipelinedUpdate(m_frame_elapsed_time);
         }
 
         if (m_window_frame_count >= kWindowFrames) {
@@ -3085,27 +3414,52 @@ vkex::Result Application::Run(int argn, const char* const* argv)
         // Call app render
         {
             {
+                double       start_time  = GetElapsedTime();
                 vkex::Result vkex_result = ProcessRenderFence(m_current_render_data);
+                m_render_fence_wait_time = GetElapsedTime() - start_time;
                 if (!vkex_result) {
                     return vkex_result;
                 }
             }
 
+            // This frame slot's previous GPU work has completed
+            if (m_gpu_profiler != nullptr) {
+                m_gpu_profiler->NewFrame(m_frame_index, m_elapsed_frame_count);
+                if (IsBenchmarkMode()) {
+                    CollectBenchmarkGpuTimes();
+                }
+            }
+
             double start_time = GetElapsedTime();
             DispatchCallRender(m_current_render_data, m_current_present_data);
             double end_time  = GetElapsedTime();
             m_render_fn_time = end_time - start_time;
+            m_render_time_stats.Push(m_render_fn_time);
         }
 
         // Present data
-        if (IsApplicationModeWindow()) {
+        {
+            double       start_time  = GetElapsedTime();
             vkex::Result vkex_result = ProcessFrameFence(m_current_present_data);
+            m_frame_fence_wait_time  = GetElapsedTime() - start_time;
             if (!vkex_result) {
                 return vkex_result;
             }
         }
 
-        if (IsApplicationModeWindow()) {
+        // The fences of this frame slot have signaled, so every frame up
+        // to and including the slot's previous use has completed.
+        {
+            uint64_t     frame_count           = m_configuration.frame_count;
+            uint64_t     completed_frame_count = (m_elapsed_frame_count >= frame_count) ? (m_elapsed_frame_count - frame_count + 1) : 0;
+            vkex::Result vkex_result           = m_device->CollectDeferredDestroys(completed_frame_count);
+            if (!vkex_result) {
+                return vkex_result;
+            }
+        }
+
+        // Headless mode acquires from and presents to the fake swapchain
+        {
             // Acquire next image
             m_current_swapchain_image_index = UINT32_MAX;
             vkex::Result vkex_result        = vkex::Result::Undefined;
@@ -3121,25 +3475,28 @@ vkex::Result Application::Run(int argn, const char* const* argv)
             DispatchCallPresent(m_current_present_data);
             double end_time   = GetElapsedTime();
             m_present_fn_time = end_time - start_time;
+            m_present_time_stats.Push(m_present_fn_time);
         }
 
-        // Pace fames - if needed
-        if (m_configuration.swapchain.paced_frame_rate > 0) {
-            if (m_elapsed_frame_count > 0) {
-                double current_time  = GetElapsedTime();
-                double paced_fps     = 1.0 / static_cast<double>(m_configuration.swapchain.paced_frame_rate);
-                double expected_time = m_frame_0_time + (m_elapsed_frame_count * paced_fps);
-                double diff          = expected_time - current_time;
-                if (diff > 0) {
-                    // std::stringstream ss;
-                    // ss << diff << "\n";
-                    // OutputDebugStringA(ss.str().c_str());
-                    vkex::Timer::SleepSeconds(diff);
-                }
-            }
-            else {
-                m_frame_0_time = GetElapsedTime();
-            }
+        // Close this frame's host allocation counters
+        if (m_host_allocator) {
+            m_host_allocator->NewFrame();
+        }
+
+        if (IsBenchmarkMode()) {
+            RecordBenchmarkFrame();
+        }
+
+        // Pace frames - if needed
+        {
+            VKEX_CPU_ZONE("Frame Pacing");
+            m_frame_pacer.SetFrameRate(m_configuration.swapchain.paced_frame_rate);
+            m_frame_pacer.WaitForNextFrame();
+        }
+
+        // Keep the per-thread zone buffers from filling up
+        if (vkex::CpuProfiler::IsEnabled()) {
+            vkex::CpuProfiler::Collect();
         }
 
         // Increment present count
@@ -3151,6 +3508,10 @@ vkex::Result Application::Run(int argn, const char* const* argv)
     // Main loop [END]
     // -----------------------------------------------------------------------------------------------
 
+    // The last pipelined update's results are discarded
+    WaitPipelinedUpdate();
+    m_update_worker.reset();
+
     // Wait for all queues to become idle
     vkex_result = WaitAllQueuesIdle();
     if (!vkex_result) {
@@ -3166,6 +3527,29 @@ vkex::Result Application::Run(int argn, const char* const* argv)
         }
     }
 
+    // Pick up the GPU times of the frames still in flight at exit
+    if (m_gpu_profiler != nullptr) {
+        m_gpu_profiler->ResolvePendingFrames();
+        if (IsBenchmarkMode()) {
+            CollectBenchmarkGpuTimes();
+        }
+    }
+
+    // Write the report while the device is still around to name it
+    if (IsBenchmarkMode()) {
+        vkex_result = SaveBenchmarkReport();
+        if (!vkex_result) {
+            VKEX_LOG_ERROR("Unable to save benchmark report: " << m_configuration.benchmark.report_path);
+        }
+    }
+
+    if (m_configuration.cpu_profiler.enable) {
+        vkex_result = SaveCpuTrace();
+        if (!vkex_result) {
+            VKEX_LOG_ERROR("Unable to save CPU trace: " << m_configuration.cpu_profiler.trace_path);
+        }
+    }
+
     // Call app destroy
     DispatchCallDestroy();
 
@@ -3199,6 +3583,11 @@ uint32_t Application::GetCurrentFrameIndex() const
 
 float Application::GetElapsedTime() const
 {
+    if (!IsApplicationModeWindow()) {
+        double elapsed_seconds = vkex::Timer::TimestampToSeconds(vkex::Timer::Timestamp() - m_start_timestamp);
+        return static_cast<float>(elapsed_seconds);
+    }
+
     double elapsed_seconds = glfwGetTime();
     return static_cast<float>(elapsed_seconds);
 }
@@ -3244,7 +3633,7 @@ vkex::PresentData* Application::GetCurrentPresentData() const
 
 void Application::DrawDebugApplicationInfo()
 {
-    if (!m_configuration.enable_imgui) {
+    if (!IsApplicationModeWindow() || !m_configuration.enable_imgui) {
         return;
     }
 
@@ -3351,6 +3740,18 @@ void Application::DrawDebugApplicationInfo()
                 ImGui::Text("%f seconds", GetElapsedTime());
                 ImGui::NextColumn();
             }
+            // Pacing
+            if (m_frame_pacer.GetFrameRate() > 0) {
+                vkex::FramePacerStats stats = m_frame_pacer.GetStats();
+                ImGui::Text("Pacing Error (Mean / Max)");
+                ImGui::NextColumn();
+                ImGui::Text("%.1f / %.1f us", stats.mean_error_micros, stats.max_error_micros);
+                ImGui::NextColumn();
+                ImGui::Text("Missed Pacing Deadlines");
+                ImGui::NextColumn();
+                ImGui::Text("%llu frames", static_cast<unsigned long long>(stats.missed_frame_count));
+                ImGui::NextColumn();
+            }
             ImGui::Columns(1);
         }
 
@@ -3385,6 +3786,52 @@ void Application::DrawDebugApplicationInfo()
 
         ImGui::Separator();
 
+        // Timing percentiles
+        {
+            const std::pair<const char*, const vkex::RunningStats*> timings[] = {
+                {"Frame Time", &m_frame_time_stats},
+                {"Update Call Time", &m_update_time_stats},
+                {"Render Call Time", &m_render_time_stats},
+                {"Present Call Time", &m_present_time_stats},
+            };
+
+            ImGui::Columns(2);
+            ImGui::Text("Last %zu Frames", kTimingStatsFrames);
+            ImGui::NextColumn();
+            ImGui::Text("p50 / p95 / p99");
+            ImGui::NextColumn();
+            for (auto& timing : timings) {
+                vkex::Percentiles percentiles = timing.second->GetPercentiles();
+                ImGui::Text("%s", timing.first);
+                ImGui::NextColumn();
+                ImGui::Text("%.3f / %.3f / %.3f ms", percentiles.p50 * 1000.0, percentiles.p95 * 1000.0, percentiles.p99 * 1000.0);
+                ImGui::NextColumn();
+            }
+            ImGui::Columns(1);
+        }
+
+        // GPU zones
+        if (m_gpu_profiler != nullptr) {
+            ImGui::Separator();
+
+            ImGui::Columns(2);
+            ImGui::Text("GPU Zones");
+            ImGui::NextColumn();
+            ImGui::Text("last / p50 / p95");
+            ImGui::NextColumn();
+            for (auto& zone : m_gpu_profiler->GetZoneResults()) {
+                const vkex::RunningStats* p_stats     = m_gpu_profiler->GetZoneStats(zone.path);
+                vkex::Percentiles         percentiles = (p_stats != nullptr) ? p_stats->GetPercentiles() : vkex::Percentiles{};
+                ImGui::Text("%*s%s", static_cast<int>(2 * zone.depth), "", zone.name);
+                ImGui::NextColumn();
+                ImGui::Text("%.3f / %.3f / %.3f ms", zone.time * 1000.0, percentiles.p50 * 1000.0, percentiles.p95 * 1000.0);
+                ImGui::NextColumn();
+            }
+            ImGui::Columns(1);
+        }
+
+        ImGui::Separator();
+
         // Swapchain
         {
             ImGui::Columns(2);
@@ -3442,7 +3889,7 @@ void Application::DrawDebugApplicationInfo()
 
             // ImGui::PlotLines(
             //   "0 to 100us",
-            //   (float*)m_queue_present_times.data() + 2,
+            //   (float*)m_queue_present_times.storage() + 2,
             //   m_queue_present_times.size(),
             //   0,
             //   nullptr,
@@ -18,12 +18,17 @@
 #define __VKEX_APPLICATION_H__
 
 #include "vkex/ArgParser.h"
+#include "vkex/BenchmarkReport.h"
 #include "vkex/Bitmap.h"
 #include "vkex/Camera.h"
 #include "vkex/Cast.h"
+#include "vkex/CpuProfiler.h"
 #include "vkex/FileSystem.h"
+#include "vkex/FramePacer.h"
+#include "vkex/FrameState.h"
 #include "vkex/Geometry.h"
 #include "vkex/Instance.h"
+#include "vkex/RunningStats.h"
 #include "vkex/Timer.h"
 #include "vkex/ToString.h"
 #include "vkex/Transform.h"
@@ -223,6 +228,9 @@ class Application;
 
 /** @class HistoryT
  *
+ * Ring buffer of the last SizeValue values. Element 0 is the oldest.
+ * storage() is the unordered ring storage, which starts at offset() once
+ * the history is full, e.g. for ImGui::PlotLines' values_offset.
  */
 template <typename T, size_t SizeValue>
 class HistoryT
@@ -233,27 +241,35 @@ public:
 
     const T& operator[](size_t n) const
     {
-        return m_data[n];
+        return m_data[(m_first + n) % m_data.size()];
     }
 
-    const T* data() const
+    const T* storage() const
     {
         const T* ptr = m_data.data();
         return ptr;
     }
 
+    size_t offset() const
+    {
+        return m_first;
+    }
+
     size_t size() const
     {
         return m_data.size();
     }
 
+    static constexpr size_t capacity()
+    {
+        return SizeValue;
+    }
+
     void push_back(const T& value)
     {
         if (m_data.size() == SizeValue) {
-            for (size_t i = 0; i < (SizeValue - 1); ++i) {
-                m_data[i] = m_data[i + 1];
-            }
-            m_data[SizeValue - 1] = value;
+            m_data[m_first] = value;
+            m_first         = (m_first + 1) % SizeValue;
         }
         else {
             m_data.push_back(value);
@@ -262,6 +278,7 @@ public:
 
 private:
     std::vector<T> m_data;
+    size_t         m_first = 0;
 };
 
 /** @struct TimeRange
@@ -274,6 +291,20 @@ struct TimeRange
     float diff;
 };
 
+/** @struct UpdateFrameInfo
+ *
+ * Frame values captured on the main thread right before Update() is
+ * dispatched, see Application::GetUpdateFrameInfo().
+ */
+struct UpdateFrameInfo
+{
+    uint64_t elapsed_frames     = 0;
+    double   frame_start_time   = 0;
+    double   frame_elapsed_time = 0;
+    double   average_frame_time = 0;
+    double   frames_per_second  = 0;
+};
+
 /** @struct Configuration
  *
  */
@@ -381,6 +412,132 @@ struct Configuration
         DebugUtilsMessageType     message_type;
     } graphics_debug;
 
+    // Pipeline cache
+    //
+    // The device pipeline cache is loaded from 'path' when the device is
+    // created and written back on shutdown.
+    //
+    struct
+    {
+        // Default: false
+        bool disable;
+
+        // Default: <executable name>_pipeline_cache.bin next to the executable
+        std::string path;
+    } pipeline_cache;
+
+    // Shader reflection cache
+    //
+    // Reflection results are always cached in memory. If enabled, the
+    // cache is also loaded from 'path' when the device is created and
+    // written back on shutdown.
+    //
+    struct
+    {
+        // Default: false
+        bool enable_disk_cache;
+
+        // Default: <executable name>_reflection_cache.bin next to the executable
+        std::string path;
+    } shader_reflection_cache;
+
+    // Host allocator
+    //
+    // If enabled, the instance, the device and every object created
+    // through the device without explicit allocation callbacks use a
+    // vkex::HostAllocator, which pools the driver's host allocations and
+    // counts them per scope, per object type and per frame. The stats are
+    // logged on shutdown.
+    //
+    struct
+    {
+        // Default: false
+        bool enable;
+    } host_allocator;
+
+    // Pipelined update
+    //
+    // If enabled, Update() for frame N+1 runs on a simulation thread
+    // while Render() and Present() for frame N run on the main thread.
+    // Update() receives frame N's elapsed time and must not call ImGui
+    // or record commands. Input callbacks are never called while
+    // Update() is running. State is handed from Update() to Render()
+    // through FrameStateT.
+    //
+    // The main thread advances the frame values while Update() runs, so
+    // Update() must read them from GetUpdateFrameInfo() and not from
+    // GetElapsedFrames(), GetFrameStartTime(), GetFrameElapsedTime(),
+    // GetAverageFrameTime(), GetFramesPerSecond(), the window frame time
+    // getters, GetCurrentFrameIndex(), GetCurrentRenderData(),
+    // GetCurrentPresentData() or the timing stats.
+    //
+    struct
+    {
+        // Default: false
+        bool enable;
+    } pipelined_update;
+
+    // GPU profiler
+    //
+    // If enabled, a vkex::GpuProfiler for the graphics queue is created
+    // and resolved every frame once the frame's render fence has
+    // signaled. Record zones into it from Render() with CmdBeginFrame(),
+    // VKEX_GPU_ZONE and CmdEndFrame(). Zone times are shown in the ImGui
+    // window and the root zone is reported as the benchmark's GPU time.
+    //
+    struct
+    {
+        // Default: false
+        bool enable;
+    } gpu_profiler;
+
+    // CPU profiler
+    //
+    // If enabled, vkex::CpuProfiler records the zones of vkex and of the
+    // application (VKEX_CPU_ZONE), collects them once per frame and
+    // writes a Chrome trace to trace_path on shutdown.
+    //
+    // Set from the command line with --cpu-trace <path>, which enables
+    // the profiler.
+    //
+    struct
+    {
+        // Default: false
+        bool enable;
+
+        // Default: <executable name>_trace.json next to the executable
+        std::string trace_path;
+    } cpu_profiler;
+
+    // Benchmark
+    //
+    // If frame_count is non-zero the application runs headless, without
+    // a window or swapchain. Render() and Present() are still called
+    // every frame: Present() records into window sized fake swapchain
+    // images, and SubmitPresent() submits the work but skips
+    // vkQueuePresentKHR. ImGui is not available. The application renders
+    // warmup_frame_count frames followed by frame_count recorded frames,
+    // writes a per-frame report to report_path and quits. The host
+    // allocator and the GPU profiler are enabled so that allocations and
+    // GPU times can be reported. The report is CSV if report_path ends in
+    // .csv and JSON otherwise.
+    //
+    // Set from the command line with --benchmark-frames,
+    // --benchmark-warmup-frames and --benchmark-report, which override
+    // the values set in Configure().
+    //
+    struct
+    {
+        // Default: 0 (no benchmark)
+        uint32_t frame_count;
+
+        // Default: 0
+        uint32_t warmup_frame_count;
+
+        // Default: <executable name>_benchmark.json next to the executable
+        std::string report_path;
+    } benchmark;
+
     // ImGui
     bool enable_imgui;
 
@@ -523,6 +680,10 @@ public:
     //! @fn GetApplicationPath
     fs::path GetApplicationPath() const;
 
+    //! @fn GetDefaultOutputPath
+    //! Returns <executable name><suffix> next to the executable
+    fs::path GetDefaultOutputPath(const std::string& suffix) const;
+
     //! @fn GetAssetDirs
     const std::vector<fs::path>& GetAssetDirs() const;
 
@@ -599,6 +760,48 @@ public:
         return m_device;
     }
 
+    //! @fn RegisterFrameState - Published from Update to Render every frame, see FrameStateT
+    void RegisterFrameState(vkex::IFrameState* p_frame_state);
+
+    //! @fn UnregisterFrameState
+    void UnregisterFrameState(vkex::IFrameState* p_frame_state);
+
+    //! @fn IsPipelinedUpdate - Returns true if Update runs on the simulation thread
+    bool IsPipelinedUpdate() const
+    {
+        return m_update_worker != nullptr;
+    }
+
+    //! @fn GetUpdateFrameInfo - Frame values for Update(), safe to call from the simulation thread
+    const vkex::UpdateFrameInfo& GetUpdateFrameInfo() const
+    {
+        return m_update_frame_info;
+    }
+
+    //! @fn IsBenchmarkMode - Returns true if the application is running a benchmark
+    bool IsBenchmarkMode() const
+    {
+        return m_configuration.benchmark.frame_count > 0;
+    }
+
+    //! @fn GetFramePacerStats
+    vkex::FramePacerStats GetFramePacerStats() const
+    {
+        return m_frame_pacer.GetStats();
+    }
+
+    //! @fn GetGpuProfiler - Returns nullptr unless the GPU profiler is enabled
+    vkex::GpuProfiler GetGpuProfiler() const
+    {
+        return m_gpu_profiler;
+    }
+
+    //! @fn GetHostAllocator
+    vkex::HostAllocator* GetHostAllocator() const
+    {
+        return m_host_allocator.get();
+    }
+
     //! @fn GetWindowWidth
     uint32_t GetWindowWidth() const
     {
@@ -686,6 +889,36 @@ public:
         return m_average_vk_queue_present_time;
     }
 
+    //! @fn GetFrameTimeStats - Frame to frame times in seconds over the last kTimingStatsFrames frames
+    const vkex::RunningStats& GetFrameTimeStats() const
+    {
+        return m_frame_time_stats;
+    }
+
+    //! @fn GetUpdateTimeStats - Update call times in seconds
+    const vkex::RunningStats& GetUpdateTimeStats() const
+    {
+        return m_update_time_stats;
+    }
+
+    //! @fn GetRenderTimeStats - Render call times in seconds
+    const vkex::RunningStats& GetRenderTimeStats() const
+    {
+        return m_render_time_stats;
+    }
+
+    //! @fn GetPresentTimeStats - Present call times in seconds
+    const vkex::RunningStats& GetPresentTimeStats() const
+    {
+        return m_present_time_stats;
+    }
+
+    //! @fn GetVkQueuePresentTimeStats - vkQueuePresentKHR times in seconds
+    const vkex::RunningStats& GetVkQueuePresentTimeStats() const
+    {
+        return m_vk_queue_present_time_stats;
+    }
+
     //! @fn DrawDebugApplicationInfo
     void DrawDebugApplicationInfo();
 
@@ -761,9 +994,52 @@ private:
     //! @fn CheckConfiguration
     vkex::Result CheckConfiguration();
 
+    //! @fn AdvancePerFrameData
+    template <typename PerFrameDataT>
+    static PerFrameDataT* AdvancePerFrameData(
+        const std::vector<std::unique_ptr<PerFrameDataT>>& per_frame_data,
+        uint32_t                                           frame_index,
+        uint64_t                                           elapsed_frame_count);
+
     //! @fn UpdateCurrentPerFrameData
     vkex::Result UpdateCurrentPerFrameData();
 
+    //! @fn PublishFrameStates
+    void PublishFrameStates();
+
+    //! @fn CaptureUpdateFrameInfo
+    void CaptureUpdateFrameInfo();
+
+    //! @fn StartPipelinedUpdate
+    void StartPipelinedUpdate(double frame_elapsed_time);
+
+    //! @fn WaitPipelinedUpdate
+    void WaitPipelinedUpdate();
+
+    //! @fn AddBenchmarkArgs
+    void AddBenchmarkArgs();
+
+    //! @fn ConfigureBenchmark
+    void ConfigureBenchmark();
+
+    //! @fn RecordBenchmarkFrame
+    void RecordBenchmarkFrame();
+
+    //! @fn CollectBenchmarkGpuTimes
+    void CollectBenchmarkGpuTimes();
+
+    //! @fn SaveBenchmarkReport
+    vkex::Result SaveBenchmarkReport();
+
+    //! @fn AddCpuProfilerArgs
+    void AddCpuProfilerArgs();
+
+    //! @fn ConfigureCpuProfiler
+    void ConfigureCpuProfiler();
+
+    //! @fn SaveCpuTrace
+    vkex::Result SaveCpuTrace();
+
     //! @fn ProcessRenderFence
     vkex::Result ProcessRenderFence(vkex::RenderData* p_data);
 
@@ -799,11 +1075,26 @@ protected:
     double m_render_fn_time  = 0;
     double m_present_fn_time = 0;
 
+    double m_render_fence_wait_time = 0;
+    double m_frame_fence_wait_time  = 0;
+
+    // Time base for headless mode, where GLFW is not initialized
+    uint64_t m_start_timestamp = vkex::Timer::Timestamp();
+
+    static constexpr size_t kTimingStatsFrames = 1000;
+    vkex::RunningStats      m_frame_time_stats{kTimingStatsFrames};
+    vkex::RunningStats      m_update_time_stats{kTimingStatsFrames};
+    vkex::RunningStats      m_render_time_stats{kTimingStatsFrames};
+    vkex::RunningStats      m_present_time_stats{kTimingStatsFrames};
+    vkex::RunningStats      m_vk_queue_present_time_stats{kTimingStatsFrames};
+
     const uint32_t kWindowFrames           = 100;
     uint32_t       m_window_frame_count    = kWindowFrames;
     double         m_max_window_frame_time = 0;
     double         m_min_window_frame_time = std::numeric_limits<double>::max();
 
+    std::unique_ptr<vkex::HostAllocator> m_host_allocator;
+
     vkex::Instance               m_instance                      = nullptr;
     vkex::Device                 m_device                        = nullptr;
     vkex::Queue                  m_graphics_queue                = nullptr;
@@ -825,18 +1116,25 @@ protected:
     bool                         m_recreate_swapchain     = false;
     bool                         m_window_surface_invalid = false;
 
-    double m_frame_0_time = 0;
+    vkex::FramePacer m_frame_pacer;
+
+    vkex::BenchmarkReport m_benchmark_report;
+    vkex::GpuProfiler     m_gpu_profiler = nullptr;
+
+    std::vector<vkex::IFrameState*>   m_frame_states;
+    std::unique_ptr<vkex::WorkerPool> m_update_worker;
+    bool                              m_pipelined_update_pending = false;
+    double                            m_pipelined_update_fn_time = 0;
+    vkex::UpdateFrameInfo             m_update_frame_info        = {};
 
     using RenderDataPtr = std::unique_ptr<RenderData>;
     std::vector<RenderDataPtr> m_per_frame_render_data;
-    std::vector<RenderData*>   m_render_data_stack;
     vkex::CommandPool          m_render_command_pool = nullptr;
     bool                       m_render_submitted    = false;
     RenderData*                m_current_render_data = nullptr;
 
     using PresentDataPtr = std::unique_ptr<PresentData>;
     std::vector<PresentDataPtr> m_per_frame_present_data;
-    std::vector<PresentData*>   m_present_data_stack;
     vkex::CommandPool           m_present_command_pool = nullptr;
     PresentData*                m_current_present_data = nullptr;
     // PresentData*                  m_previous_present_data = nullptr;
@@ -849,6 +1147,7 @@ protected:
     vkex::Buffer m_screenshot_buffer = nullptr;
 
     HistoryT<TimeRange, 100> m_vk_queue_present_times;
+    double                   m_vk_queue_present_time_sum     = 0;
     float                    m_average_vk_queue_present_time = 0;
 };
 
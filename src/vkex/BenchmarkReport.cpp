@@ -0,0 +1,214 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#include "vkex/BenchmarkReport.h"
+#include "vkex/FileSystem.h"
+#include "vkex/Util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace vkex {
+
+namespace {
+
+struct TimeField
+{
+    const char* name;
+    double BenchmarkFrame::*p_member;
+};
+
+const TimeField k_time_fields[] = {
+    {"frame_ms", &BenchmarkFrame::frame_time},
+    {"update_ms", &BenchmarkFrame::update_time},
+    {"render_ms", &BenchmarkFrame::render_time},
+    {"present_ms", &BenchmarkFrame::present_time},
+    {"render_fence_wait_ms", &BenchmarkFrame::render_fence_wait_time},
+    {"frame_fence_wait_ms", &BenchmarkFrame::frame_fence_wait_time},
+    {"gpu_ms", &BenchmarkFrame::gpu_time},
+};
+
+// Negative times are unavailable and written as null
+void WriteJsonMillis(std::ostream& os, double seconds)
+{
+    if (seconds < 0) {
+        os << "null";
+    }
+    else {
+        os << (seconds * 1000.0);
+    }
+}
+
+// Nearest rank percentile of sorted values
+double Percentile(const std::vector<double>& sorted_values, double percentile)
+{
+    size_t rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(sorted_values.size())));
+    rank        = std::max<size_t>(rank, 1);
+    return sorted_values[std::min(rank, sorted_values.size()) - 1];
+}
+
+} // namespace
+
+BenchmarkReport::BenchmarkReport()
+{
+}
+
+BenchmarkReport::~BenchmarkReport()
+{
+}
+
+void BenchmarkReport::SetGpuTime(uint64_t frame_number, double gpu_time)
+{
+    // Frames are recorded in frame order
+    auto it = std::lower_bound(
+        std::begin(m_frames),
+        std::end(m_frames),
+        frame_number,
+        [](const BenchmarkFrame& frame, uint64_t value) -> bool { return frame.frame_number < value; });
+    if ((it == std::end(m_frames)) || (it->frame_number != frame_number)) {
+        return;
+    }
+
+    it->gpu_time = gpu_time;
+}
+
+void BenchmarkReport::WriteJson(std::ostream& os) const
+{
+    os << std::setprecision(6) << std::fixed;
+
+    os << "{\n";
+    os << "  \"name\": " << JsonString(m_name) << ",\n";
+    os << "  \"device\": " << JsonString(m_device_name) << ",\n";
+    os << "  \"warmup_frames\": " << m_warmup_frame_count << ",\n";
+    os << "  \"frames_recorded\": " << m_frames.size() << ",\n";
+
+    // Summary
+    os << "  \"summary\": {\n";
+    for (auto& field : k_time_fields) {
+        std::vector<double> values;
+        values.reserve(m_frames.size());
+        for (auto& frame : m_frames) {
+            double value = frame.*field.p_member;
+            if (value >= 0) {
+                values.push_back(value);
+            }
+        }
+
+        os << "    \"" << field.name << "\": ";
+        if (values.empty()) {
+            os << "null";
+        }
+        else {
+            std::sort(std::begin(values), std::end(values));
+            double sum = 0;
+            for (double value : values) {
+                sum += value;
+            }
+            double mean = sum / static_cast<double>(values.size());
+
+            os << "{ \"mean\": ";
+            WriteJsonMillis(os, mean);
+            os << ", \"min\": ";
+            WriteJsonMillis(os, values.front());
+            os << ", \"max\": ";
+            WriteJsonMillis(os, values.back());
+            os << ", \"p50\": ";
+            WriteJsonMillis(os, Percentile(values, 0.50));
+            os << ", \"p95\": ";
+            WriteJsonMillis(os, Percentile(values, 0.95));
+            os << ", \"p99\": ";
+            WriteJsonMillis(os, Percentile(values, 0.99));
+            os << " }";
+        }
+        os << ",\n";
+    }
+    {
+        uint64_t allocation_count = 0;
+        uint64_t bytes_allocated  = 0;
+        for (auto& frame : m_frames) {
+            allocation_count += frame.host_allocation_count;
+            bytes_allocated += frame.host_bytes_allocated;
+        }
+        os << "    \"host_allocation_count\": " << allocation_count << ",\n";
+        os << "    \"host_bytes_allocated\": " << bytes_allocated << "\n";
+    }
+    os << "  },\n";
+
+    // Frames
+    os << "  \"frames\": [";
+    for (size_t n = 0; n < m_frames.size(); ++n) {
+        const BenchmarkFrame& frame = m_frames[n];
+        os << ((n > 0) ? ",\n" : "\n");
+        os << "    { \"frame\": " << frame.frame_number;
+        for (auto& field : k_time_fields) {
+            os << ", \"" << field.name << "\": ";
+            WriteJsonMillis(os, frame.*field.p_member);
+        }
+        os << ", \"host_allocation_count\": " << frame.host_allocation_count;
+        os << ", \"host_bytes_allocated\": " << frame.host_bytes_allocated;
+        os << " }";
+    }
+    os << "\n  ]\n";
+    os << "}\n";
+}
+
+void BenchmarkReport::WriteCsv(std::ostream& os) const
+{
+    os << std::setprecision(6) << std::fixed;
+
+    os << "frame";
+    for (auto& field : k_time_fields) {
+        os << "," << field.name;
+    }
+    os << ",host_allocation_count,host_bytes_allocated\n";
+
+    // Unavailable times are left empty
+    for (auto& frame : m_frames) {
+        os << frame.frame_number;
+        for (auto& field : k_time_fields) {
+            os << ",";
+            double value = frame.*field.p_member;
+            if (value >= 0) {
+                os << (value * 1000.0);
+            }
+        }
+        os << "," << frame.host_allocation_count;
+        os << "," << frame.host_bytes_allocated;
+        os << "\n";
+    }
+}
+
+vkex::Result BenchmarkReport::Save(const std::string& path) const
+{
+    std::stringstream ss;
+    if (fs::path(path).extension() == ".csv") {
+        WriteCsv(ss);
+    }
+    else {
+        WriteJson(ss);
+    }
+
+    std::string data = ss.str();
+    if (!fs::save_file_atomic(path, data.data(), data.size())) {
+        return vkex::Result::ErrorFailed;
+    }
+
+    return vkex::Result::Success;
+}
+
+} // namespace vkex
\ No newline at end of file
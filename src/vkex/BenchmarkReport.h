@@ -0,0 +1,138 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#ifndef __VKEX_BENCHMARK_REPORT_H__
+#define __VKEX_BENCHMARK_REPORT_H__
+
+#include "vkex/Config.h"
+
+#include <ostream>
+
+namespace vkex {
+
+/** @struct BenchmarkFrame
+ *
+ * Times are in seconds. gpu_time is negative if no GPU time is available
+ * for the frame.
+ */
+struct BenchmarkFrame
+{
+    uint64_t frame_number           = 0;
+    double   frame_time             = 0;
+    double   update_time            = 0;
+    double   render_time            = 0;
+    double   present_time           = 0;
+    double   render_fence_wait_time = 0;
+    double   frame_fence_wait_time  = 0;
+    double   gpu_time               = -1;
+    uint64_t host_allocation_count  = 0;
+    uint64_t host_bytes_allocated   = 0;
+};
+
+/** @class BenchmarkReport
+ *
+ * Per-frame results of a benchmark run. The JSON report holds the run's
+ * parameters, a summary with the mean, min, max and p50/p95/p99 of every
+ * time, and every frame. The CSV report holds one row per frame. Times
+ * are written in milliseconds.
+ */
+class BenchmarkReport
+{
+public:
+    BenchmarkReport();
+    ~BenchmarkReport();
+
+    /** @fn SetName
+     *
+     */
+    void SetName(const std::string& name)
+    {
+        m_name = name;
+    }
+
+    /** @fn SetDeviceName
+     *
+     */
+    void SetDeviceName(const std::string& device_name)
+    {
+        m_device_name = device_name;
+    }
+
+    /** @fn SetWarmupFrameCount
+     *
+     */
+    void SetWarmupFrameCount(uint32_t warmup_frame_count)
+    {
+        m_warmup_frame_count = warmup_frame_count;
+    }
+
+    /** @fn Reserve
+     *
+     */
+    void Reserve(size_t frame_count)
+    {
+        m_frames.reserve(frame_count);
+    }
+
+    /** @fn AddFrame
+     *
+     */
+    void AddFrame(const vkex::BenchmarkFrame& frame)
+    {
+        m_frames.push_back(frame);
+    }
+
+    /** @fn SetGpuTime
+     *
+     * Sets gpu_time of the recorded frame with frame_number, if there
+     * is one. GPU times arrive after the frame has been recorded.
+     */
+    void SetGpuTime(uint64_t frame_number, double gpu_time);
+
+    /** @fn GetFrames
+     *
+     */
+    const std::vector<vkex::BenchmarkFrame>& GetFrames() const
+    {
+        return m_frames;
+    }
+
+    /** @fn WriteJson
+     *
+     */
+    void WriteJson(std::ostream& os) const;
+
+    /** @fn WriteCsv
+     *
+     */
+    void WriteCsv(std::ostream& os) const;
+
+    /** @fn Save
+     *
+     * Writes CSV if path has a .csv extension and JSON otherwise.
+     */
+    vkex::Result Save(const std::string& path) const;
+
+private:
+    std::string                       m_name;
+    std::string                       m_device_name;
+    uint32_t                          m_warmup_frame_count = 0;
+    std::vector<vkex::BenchmarkFrame> m_frames;
+};
+
+} // namespace vkex
+
+#endif // __VKEX_BENCHMARK_REPORT_H__
\ No newline at end of file
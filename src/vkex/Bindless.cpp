@@ -0,0 +1,282 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#include "vkex/Bindless.h"
+#include "vkex/Device.h"
+#include "vkex/ToString.h"
+
+namespace vkex {
+
+// =================================================================================================
+// BindlessTable
+// =================================================================================================
+CBindlessTable::CBindlessTable()
+{
+}
+
+CBindlessTable::~CBindlessTable()
+{
+}
+
+vkex::Result CBindlessTable::InternalCreate(
+    const vkex::BindlessTableCreateInfo& create_info,
+    const VkAllocationCallbacks*         p_allocator)
+{
+    // Copy create info
+    m_create_info = create_info;
+
+    if (m_create_info.frame_count == 0) {
+        return vkex::Result::ErrorOutOfRange;
+    }
+
+    // Check features
+    {
+        const VkPhysicalDeviceDescriptorIndexingFeatures& features = GetDevice()->GetEnabledFeatures().descriptorIndexing;
+        if (!features.runtimeDescriptorArray) {
+            VKEX_LOG_ERROR("Bindless table requires runtimeDescriptorArray for its unsized shader arrays");
+            return vkex::Result::ErrorRequiredFeatureNotEnabled;
+        }
+        if (!features.descriptorBindingPartiallyBound ||
+            !features.descriptorBindingSampledImageUpdateAfterBind ||
+            !features.descriptorBindingStorageBufferUpdateAfterBind) {
+            VKEX_LOG_ERROR("Bindless table requires descriptorBindingPartiallyBound and update-after-bind for sampled images and storage buffers");
+            return vkex::Result::ErrorRequiredFeatureNotEnabled;
+        }
+    }
+
+    // Check limits
+    {
+        const VkPhysicalDeviceDescriptorIndexingProperties& properties = GetDevice()->GetDescriptorIndexingProperties();
+        if ((m_create_info.max_sampled_images > properties.maxDescriptorSetUpdateAfterBindSampledImages) ||
+            (m_create_info.max_samplers > properties.maxDescriptorSetUpdateAfterBindSamplers) ||
+            (m_create_info.max_storage_buffers > properties.maxDescriptorSetUpdateAfterBindStorageBuffers)) {
+            return vkex::Result::ErrorOutOfRange;
+        }
+    }
+
+    // Slot allocators
+    m_slots[kSampledImageBinding].capacity  = m_create_info.max_sampled_images;
+    m_slots[kSamplerBinding].capacity       = m_create_info.max_samplers;
+    m_slots[kStorageBufferBinding].capacity = m_create_info.max_storage_buffers;
+    for (auto& slots : m_slots) {
+        slots.pending_frees.resize(m_create_info.frame_count);
+    }
+
+    // Descriptor set layout
+    {
+        const VkDescriptorType k_vk_descriptor_types[kBindingCount] = {
+            VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            VK_DESCRIPTOR_TYPE_SAMPLER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        };
+
+        vkex::DescriptorSetLayoutCreateInfo create_info = {};
+        create_info.flags.bits.update_after_bind_pool   = true;
+        for (uint32_t binding = 0; binding < kBindingCount; ++binding) {
+            VkDescriptorSetLayoutBinding vk_binding = {};
+            vk_binding.binding                      = binding;
+            vk_binding.descriptorType               = k_vk_descriptor_types[binding];
+            vk_binding.descriptorCount              = m_slots[binding].capacity;
+            vk_binding.stageFlags                   = m_create_info.shader_stages;
+            vk_binding.pImmutableSamplers           = nullptr;
+            create_info.bindings.push_back(vk_binding);
+            create_info.binding_flags.push_back(VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT);
+        }
+
+        vkex::Result vkex_result = GetDevice()->CreateDescriptorSetLayout(create_info, &m_descriptor_set_layout, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    // Descriptor pool
+    {
+        vkex::DescriptorPoolCreateInfo create_info = {};
+        create_info.flags.bits.update_after_bind   = true;
+        create_info.max_sets                       = 1;
+        create_info.pool_sizes.sampled_image       = m_create_info.max_sampled_images;
+        create_info.pool_sizes.sampler             = m_create_info.max_samplers;
+        create_info.pool_sizes.storage_buffer      = m_create_info.max_storage_buffers;
+        vkex::Result vkex_result                   = GetDevice()->CreateDescriptorPool(create_info, &m_descriptor_pool, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    // Descriptor set
+    {
+        vkex::DescriptorSetAllocateInfo allocate_info = {};
+        allocate_info.layouts.push_back(m_descriptor_set_layout);
+        vkex::Result vkex_result = m_descriptor_pool->AllocateDescriptorSet(allocate_info, &m_descriptor_set);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CBindlessTable::InternalDestroy(const VkAllocationCallbacks* p_allocator)
+{
+    // Destroying the pool frees the set
+    if (m_descriptor_pool != nullptr) {
+        vkex::Result vkex_result = GetDevice()->DestroyDescriptorPool(m_descriptor_pool, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        m_descriptor_pool = nullptr;
+        m_descriptor_set  = nullptr;
+    }
+
+    if (m_descriptor_set_layout != nullptr) {
+        vkex::Result vkex_result = GetDevice()->DestroyDescriptorSetLayout(m_descriptor_set_layout, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        m_descriptor_set_layout = nullptr;
+    }
+
+    for (auto& slots : m_slots) {
+        slots = {};
+    }
+
+    return vkex::Result::Success;
+}
+
+void CBindlessTable::NewFrame(uint32_t frame_index)
+{
+    VKEX_ASSERT_MSG((frame_index < m_create_info.frame_count), "Frame index exceeds bindless table frame count");
+
+    m_frame_index = frame_index;
+    for (auto& slots : m_slots) {
+        std::vector<uint32_t>& pending = slots.pending_frees[m_frame_index];
+        slots.free_slots.insert(std::end(slots.free_slots), std::begin(pending), std::end(pending));
+        pending.clear();
+    }
+}
+
+vkex::Result CBindlessTable::AllocateSlot(uint32_t binding, uint32_t* p_index)
+{
+    SlotAllocator& slots = m_slots[binding];
+    if (!slots.free_slots.empty()) {
+        *p_index = slots.free_slots.back();
+        slots.free_slots.pop_back();
+        return vkex::Result::Success;
+    }
+
+    if (slots.high_water >= slots.capacity) {
+        return vkex::Result::ErrorOutOfRange;
+    }
+
+    *p_index = slots.high_water;
+    ++slots.high_water;
+
+    return vkex::Result::Success;
+}
+
+void CBindlessTable::ReleaseSlot(uint32_t binding, uint32_t index)
+{
+    SlotAllocator& slots = m_slots[binding];
+    VKEX_ASSERT_MSG((index < slots.high_water), "Bindless table slot was never allocated");
+
+    // The descriptor is left as is, shaders must not reference the
+    // slot after it is released.
+    slots.pending_frees[m_frame_index].push_back(index);
+}
+
+vkex::Result CBindlessTable::RegisterTexture(const vkex::Texture texture, uint32_t* p_index)
+{
+    uint32_t     index       = UINT32_MAX;
+    vkex::Result vkex_result = AllocateSlot(kSampledImageBinding, &index);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    vkex_result = m_descriptor_set->UpdateDescriptor(kSampledImageBinding, texture, index);
+    if (!vkex_result) {
+        m_slots[kSampledImageBinding].free_slots.push_back(index);
+        return vkex_result;
+    }
+
+    *p_index = index;
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CBindlessTable::RegisterSampler(const vkex::Sampler sampler, uint32_t* p_index)
+{
+    uint32_t     index       = UINT32_MAX;
+    vkex::Result vkex_result = AllocateSlot(kSamplerBinding, &index);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    vkex_result = m_descriptor_set->UpdateDescriptor(kSamplerBinding, sampler, index);
+    if (!vkex_result) {
+        m_slots[kSamplerBinding].free_slots.push_back(index);
+        return vkex_result;
+    }
+
+    *p_index = index;
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CBindlessTable::RegisterStorageBuffer(const vkex::Buffer buffer, uint32_t* p_index)
+{
+    uint32_t     index       = UINT32_MAX;
+    vkex::Result vkex_result = AllocateSlot(kStorageBufferBinding, &index);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    vkex_result = m_descriptor_set->UpdateDescriptor(kStorageBufferBinding, buffer, index);
+    if (!vkex_result) {
+        m_slots[kStorageBufferBinding].free_slots.push_back(index);
+        return vkex_result;
+    }
+
+    *p_index = index;
+
+    return vkex::Result::Success;
+}
+
+void CBindlessTable::ReleaseTexture(uint32_t index)
+{
+    ReleaseSlot(kSampledImageBinding, index);
+}
+
+void CBindlessTable::ReleaseSampler(uint32_t index)
+{
+    ReleaseSlot(kSamplerBinding, index);
+}
+
+void CBindlessTable::ReleaseStorageBuffer(uint32_t index)
+{
+    ReleaseSlot(kStorageBufferBinding, index);
+}
+
+uint32_t CBindlessTable::GetUsedCount(uint32_t binding) const
+{
+    if (binding >= kBindingCount) {
+        return 0;
+    }
+
+    const SlotAllocator& slots = m_slots[binding];
+    return slots.high_water - CountU32(slots.free_slots);
+}
+
+} // namespace vkex
\ No newline at end of file
@@ -0,0 +1,182 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#ifndef __VKEX_BINDLESS_H__
+#define __VKEX_BINDLESS_H__
+
+#include "vkex/Config.h"
+#include "vkex/Descriptor.h"
+#include "vkex/Traits.h"
+#include "vkex/VulkanUtil.h"
+
+namespace vkex {
+
+// =================================================================================================
+// BindlessTable
+// =================================================================================================
+
+/** @struct BindlessTableCreateInfo
+ *
+ * frame_count is the number of frames in flight. Released slots are not
+ * handed out again until NewFrame() has been called with the same frame
+ * index, i.e. once the frame that released them has completed.
+ */
+struct BindlessTableCreateInfo
+{
+    uint32_t           frame_count;
+    uint32_t           max_sampled_images;
+    uint32_t           max_samplers;
+    uint32_t           max_storage_buffers;
+    VkShaderStageFlags shader_stages = VK_SHADER_STAGE_ALL;
+};
+
+/** @class IBindlessTable
+ *
+ * Single descriptor set holding large arrays of sampled images, samplers
+ * and storage buffers. The bindings are created partially bound and
+ * update-after-bind, so the set can be bound once per command buffer and
+ * resources can be registered while it is bound. Shaders declare the
+ * arrays at the binding numbers below and select elements with indices
+ * passed in through push constants:
+ *
+ *   layout(set = N, binding = 0) uniform texture2D Textures[];
+ *   layout(set = N, binding = 1) uniform sampler   Samplers[];
+ *   layout(set = N, binding = 2) buffer Buffers { uint data[]; } StorageBuffers[];
+ *
+ * Requires runtimeDescriptorArray, descriptorBindingPartiallyBound and
+ * the update-after-bind features for sampled images and storage buffers
+ * to be enabled in VkPhysicalDeviceDescriptorIndexingFeatures.
+ */
+class CBindlessTable : public IDeviceObject
+{
+public:
+    enum
+    {
+        kSampledImageBinding  = 0,
+        kSamplerBinding       = 1,
+        kStorageBufferBinding = 2,
+        kBindingCount         = 3,
+    };
+
+    CBindlessTable();
+    ~CBindlessTable();
+
+    /** @fn GetDescriptorSetLayout
+     *
+     */
+    vkex::DescriptorSetLayout GetDescriptorSetLayout() const
+    {
+        return m_descriptor_set_layout;
+    }
+
+    /** @fn GetDescriptorSet
+     *
+     */
+    vkex::DescriptorSet GetDescriptorSet() const
+    {
+        return m_descriptor_set;
+    }
+
+    /** @fn NewFrame
+     *
+     * Returns the slots released during the previous use of frame_index
+     * to the free lists.
+     */
+    void NewFrame(uint32_t frame_index);
+
+    /** @fn RegisterTexture
+     *
+     */
+    vkex::Result RegisterTexture(const vkex::Texture texture, uint32_t* p_index);
+
+    /** @fn RegisterSampler
+     *
+     */
+    vkex::Result RegisterSampler(const vkex::Sampler sampler, uint32_t* p_index);
+
+    /** @fn RegisterStorageBuffer
+     *
+     */
+    vkex::Result RegisterStorageBuffer(const vkex::Buffer buffer, uint32_t* p_index);
+
+    /** @fn ReleaseTexture
+     *
+     */
+    void ReleaseTexture(uint32_t index);
+
+    /** @fn ReleaseSampler
+     *
+     */
+    void ReleaseSampler(uint32_t index);
+
+    /** @fn ReleaseStorageBuffer
+     *
+     */
+    void ReleaseStorageBuffer(uint32_t index);
+
+    /** @fn GetUsedCount
+     *
+     * Number of slots in binding that are registered or waiting to be
+     * recycled.
+     */
+    uint32_t GetUsedCount(uint32_t binding) const;
+
+private:
+    friend class CDevice;
+    friend class IObjectStorageFunctions;
+
+    struct SlotAllocator
+    {
+        uint32_t                           capacity   = 0;
+        uint32_t                           high_water = 0;
+        std::vector<uint32_t>              free_slots;
+        std::vector<std::vector<uint32_t>> pending_frees; // Indexed by frame index
+    };
+
+    /** @fn InternalCreate
+     *
+     */
+    vkex::Result InternalCreate(
+        const vkex::BindlessTableCreateInfo& create_info,
+        const VkAllocationCallbacks*         p_allocator);
+
+    /** @fn InternalDestroy
+     *
+     */
+    vkex::Result InternalDestroy(const VkAllocationCallbacks* p_allocator);
+
+    /** @fn AllocateSlot
+     *
+     */
+    vkex::Result AllocateSlot(uint32_t binding, uint32_t* p_index);
+
+    /** @fn ReleaseSlot
+     *
+     */
+    void ReleaseSlot(uint32_t binding, uint32_t index);
+
+private:
+    vkex::BindlessTableCreateInfo m_create_info           = {};
+    vkex::DescriptorSetLayout     m_descriptor_set_layout = nullptr;
+    vkex::DescriptorPool          m_descriptor_pool       = nullptr;
+    vkex::DescriptorSet           m_descriptor_set        = nullptr;
+    uint32_t                      m_frame_index           = 0;
+    SlotAllocator                 m_slots[kBindingCount];
+};
+
+} // namespace vkex
+
+#endif // __VKEX_BINDLESS_H__
\ No newline at end of file
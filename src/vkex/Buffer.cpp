@@ -15,6 +15,7 @@
 */
 
 #include "vkex/Buffer.h"
+#include "vkex/CpuProfiler.h"
 #include "vkex/Device.h"
 #include "vkex/Instance.h"
 #include "vkex/ToString.h"
@@ -266,6 +267,8 @@ VkDeviceAddress CBuffer::GetDeviceAddress() const
 
 vkex::Result CBuffer::Copy(size_t size, const void* p_src)
 {
+    VKEX_CPU_ZONE("CBuffer::Copy");
+
     bool is_host_visible = IsMemoryHostVisible(m_create_info.memory_usage);
     VKEX_ASSERT_MSG(is_host_visible, "Buffer resource must be host visible for direct copy!");
     if (!is_host_visible) {
@@ -117,10 +117,10 @@ std::vector<vkex::DescriptorSetLayoutCreateInfo> ToVkexCreateInfo(const std::vec
     return create_infos;
 }
 
-vkex::DescriptorSetLayoutCreateInfo ToVkexCreateInfo(const ShaderInterface::Set& set)
+vkex::DescriptorSetLayoutCreateInfo ToVkexCreateInfo(const ShaderInterface::Set& set, vkex::DescriptorLayoutCreateFlags flags)
 {
     vkex::DescriptorSetLayoutCreateInfo create_info = {};
-    create_info.flags                               = 0;
+    create_info.flags                               = flags;
     create_info.bindings                            = ToVulkan(set.bindings);
     return create_info;
 }
@@ -50,7 +50,7 @@ std::vector<VkDescriptorSetLayout>        ToVulkan(const std::vector<vkex::Descr
 vkex::ImageType     ToVkex(VkImageType value);
 vkex::ImageViewType ToVkex(VkImageViewType value);
 
-vkex::DescriptorSetLayoutCreateInfo              ToVkexCreateInfo(const vkex::ShaderInterface::Set& set);
+vkex::DescriptorSetLayoutCreateInfo              ToVkexCreateInfo(const vkex::ShaderInterface::Set& set, vkex::DescriptorLayoutCreateFlags flags = 0);
 std::vector<vkex::DescriptorSetLayoutCreateInfo> ToVkexCreateInfo(const std::vector<vkex::ShaderInterface::Set>& sets);
 
 // =================================================================================================
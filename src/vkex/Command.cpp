@@ -23,6 +23,34 @@ namespace vkex {
 // =================================================================================================
 // CommandBuffer
 // =================================================================================================
+template <typename T>
+static bool UpdateCachedAttachmentState(
+    uint32_t  first_attachment,
+    uint32_t  attachment_count,
+    const T*  p_values,
+    T*        p_cached_values,
+    uint32_t  max_cached_attachments,
+    uint32_t* p_valid_mask)
+{
+    bool changed = false;
+    for (uint32_t i = 0; i < attachment_count; ++i) {
+        uint32_t attachment = first_attachment + i;
+        if (attachment >= max_cached_attachments) {
+            changed = true;
+            continue;
+        }
+
+        uint32_t bit   = (1u << attachment);
+        bool     valid = ((*p_valid_mask & bit) != 0);
+        if (!valid || (memcmp(&p_cached_values[attachment], &p_values[i], sizeof(T)) != 0)) {
+            p_cached_values[attachment] = p_values[i];
+            *p_valid_mask              |= bit;
+            changed                     = true;
+        }
+    }
+    return changed;
+}
+
 vkex::RenderingInfo RenderingInfo::LoadOp(
     const std::vector<vkex::ImageView>&    color_views,
     const std::vector<VkAttachmentLoadOp>& color_load_ops,
@@ -131,6 +159,9 @@ vkex::Result CCommandBuffer::Begin(VkCommandBufferUsageFlags flags)
     vk_begin_info.flags                    = flags;
     vk_begin_info.pInheritanceInfo         = nullptr;
 
+    // Dynamic state is undefined at the start of a command buffer
+    InvalidateDynamicStateCache();
+
     VkResult vk_result = InvalidValue<VkResult>::Value;
     VKEX_VULKAN_RESULT_CALL(
         vk_result,
@@ -161,6 +192,23 @@ vkex::Result CCommandBuffer::End()
 // -------------------------------------------------------------------------------------------------
 // Command functions that mirror the vkCmd* interface
 // -------------------------------------------------------------------------------------------------
+void CCommandBuffer::InvalidateDynamicStateCache()
+{
+    InvalidateDynamicState(true, true);
+}
+
+void CCommandBuffer::InvalidateDynamicState(bool raster_state, bool blend_state)
+{
+    if (raster_state) {
+        m_dynamic_state_cache.valid_bits = 0;
+    }
+    if (blend_state) {
+        m_dynamic_state_cache.blend_enable_valid_mask   = 0;
+        m_dynamic_state_cache.blend_equation_valid_mask = 0;
+        m_dynamic_state_cache.write_mask_valid_mask     = 0;
+    }
+}
+
 void CCommandBuffer::CmdBindPipeline(VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
 {
     VkCommandBuffer vk_command_buffer = GetVkObject();
@@ -168,6 +216,11 @@ void CCommandBuffer::CmdBindPipeline(VkPipelineBindPoint pipelineBindPoint, VkPi
         vk_command_buffer,
         pipelineBindPoint,
         pipeline);
+
+    // Nothing is known about which states the pipeline has baked in
+    if (pipelineBindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS) {
+        InvalidateDynamicState(true, true);
+    }
 }
 
 void CCommandBuffer::CmdSetViewport(uint32_t firstViewport, uint32_t viewportCount, const VkViewport* pViewports)
@@ -252,6 +305,81 @@ void CCommandBuffer::CmdSetStencilReference(VkStencilFaceFlags faceMask, uint32_
         reference);
 }
 
+void CCommandBuffer::CmdSetCullMode(VkCullModeFlags cullMode)
+{
+    DynamicStateCache& cache = m_dynamic_state_cache;
+    if ((cache.valid_bits & DynamicStateCache::kCullModeBit) && (cache.cull_mode == cullMode)) {
+        return;
+    }
+    cache.cull_mode   = cullMode;
+    cache.valid_bits |= DynamicStateCache::kCullModeBit;
+
+    VkCommandBuffer vk_command_buffer = GetVkObject();
+    vkCmdSetCullMode(
+        vk_command_buffer,
+        cullMode);
+}
+
+void CCommandBuffer::CmdSetFrontFace(VkFrontFace frontFace)
+{
+    DynamicStateCache& cache = m_dynamic_state_cache;
+    if ((cache.valid_bits & DynamicStateCache::kFrontFaceBit) && (cache.front_face == frontFace)) {
+        return;
+    }
+    cache.front_face  = frontFace;
+    cache.valid_bits |= DynamicStateCache::kFrontFaceBit;
+
+    VkCommandBuffer vk_command_buffer = GetVkObject();
+    vkCmdSetFrontFace(
+        vk_command_buffer,
+        frontFace);
+}
+
+void CCommandBuffer::CmdSetPrimitiveTopology(VkPrimitiveTopology primitiveTopology)
+{
+    DynamicStateCache& cache = m_dynamic_state_cache;
+    if ((cache.valid_bits & DynamicStateCache::kTopologyBit) && (cache.topology == primitiveTopology)) {
+        return;
+    }
+    cache.topology    = primitiveTopology;
+    cache.valid_bits |= DynamicStateCache::kTopologyBit;
+
+    VkCommandBuffer vk_command_buffer = GetVkObject();
+    vkCmdSetPrimitiveTopology(
+        vk_command_buffer,
+        primitiveTopology);
+}
+
+void CCommandBuffer::CmdSetDepthTestEnable(VkBool32 depthTestEnable)
+{
+    DynamicStateCache& cache = m_dynamic_state_cache;
+    if ((cache.valid_bits & DynamicStateCache::kDepthTestEnableBit) && (cache.depth_test_enable == depthTestEnable)) {
+        return;
+    }
+    cache.depth_test_enable = depthTestEnable;
+    cache.valid_bits       |= DynamicStateCache::kDepthTestEnableBit;
+
+    VkCommandBuffer vk_command_buffer = GetVkObject();
+    vkCmdSetDepthTestEnable(
+        vk_command_buffer,
+        depthTestEnable);
+}
+
+void CCommandBuffer::CmdSetDepthWriteEnable(VkBool32 depthWriteEnable)
+{
+    DynamicStateCache& cache = m_dynamic_state_cache;
+    if ((cache.valid_bits & DynamicStateCache::kDepthWriteEnableBit) && (cache.depth_write_enable == depthWriteEnable)) {
+        return;
+    }
+    cache.depth_write_enable = depthWriteEnable;
+    cache.valid_bits        |= DynamicStateCache::kDepthWriteEnableBit;
+
+    VkCommandBuffer vk_command_buffer = GetVkObject();
+    vkCmdSetDepthWriteEnable(
+        vk_command_buffer,
+        depthWriteEnable);
+}
+
 void CCommandBuffer::CmdBindDescriptorSets(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t* pDynamicOffsets)
 {
     VkCommandBuffer vk_command_buffer = GetVkObject();
@@ -680,6 +808,72 @@ void CCommandBuffer::CmdSetDescriptorBufferOffsetsEXT(VkPipelineBindPoint pipeli
         pOffsets);
 }
 
+void CCommandBuffer::CmdSetColorBlendEnableEXT(uint32_t firstAttachment, uint32_t attachmentCount, const VkBool32* pColorBlendEnables)
+{
+    DynamicStateCache& cache   = m_dynamic_state_cache;
+    bool               changed = UpdateCachedAttachmentState(
+        firstAttachment,
+        attachmentCount,
+        pColorBlendEnables,
+        cache.blend_enables,
+        DynamicStateCache::kMaxCachedAttachments,
+        &cache.blend_enable_valid_mask);
+    if (!changed) {
+        return;
+    }
+
+    VkCommandBuffer vk_command_buffer = GetVkObject();
+    vkex::CmdSetColorBlendEnableEXT(
+        vk_command_buffer,
+        firstAttachment,
+        attachmentCount,
+        pColorBlendEnables);
+}
+
+void CCommandBuffer::CmdSetColorBlendEquationEXT(uint32_t firstAttachment, uint32_t attachmentCount, const VkColorBlendEquationEXT* pColorBlendEquations)
+{
+    DynamicStateCache& cache   = m_dynamic_state_cache;
+    bool               changed = UpdateCachedAttachmentState(
+        firstAttachment,
+        attachmentCount,
+        pColorBlendEquations,
+        cache.blend_equations,
+        DynamicStateCache::kMaxCachedAttachments,
+        &cache.blend_equation_valid_mask);
+    if (!changed) {
+        return;
+    }
+
+    VkCommandBuffer vk_command_buffer = GetVkObject();
+    vkex::CmdSetColorBlendEquationEXT(
+        vk_command_buffer,
+        firstAttachment,
+        attachmentCount,
+        pColorBlendEquations);
+}
+
+void CCommandBuffer::CmdSetColorWriteMaskEXT(uint32_t firstAttachment, uint32_t attachmentCount, const VkColorComponentFlags* pColorWriteMasks)
+{
+    DynamicStateCache& cache   = m_dynamic_state_cache;
+    bool               changed = UpdateCachedAttachmentState(
+        firstAttachment,
+        attachmentCount,
+        pColorWriteMasks,
+        cache.write_masks,
+        DynamicStateCache::kMaxCachedAttachments,
+        &cache.write_mask_valid_mask);
+    if (!changed) {
+        return;
+    }
+
+    VkCommandBuffer vk_command_buffer = GetVkObject();
+    vkex::CmdSetColorWriteMaskEXT(
+        vk_command_buffer,
+        firstAttachment,
+        attachmentCount,
+        pColorWriteMasks);
+}
+
 // -----------------------------------------------------------------------------------------------
 // Command functions with convenience parameters
 // -----------------------------------------------------------------------------------------------
@@ -690,7 +884,14 @@ void CCommandBuffer::CmdBindPipeline(vkex::ComputePipeline pipeline)
 
 void CCommandBuffer::CmdBindPipeline(vkex::GraphicsPipeline pipeline)
 {
-    this->CmdBindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, *pipeline);
+    VkCommandBuffer vk_command_buffer = GetVkObject();
+    vkCmdBindPipeline(
+        vk_command_buffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        *pipeline);
+
+    // States the pipeline leaves dynamic keep their values
+    InvalidateDynamicState(!pipeline->HasDynamicRasterState(), !pipeline->HasDynamicBlendState());
 }
 
 void CCommandBuffer::CmdSetViewport(uint32_t firstViewport, const std::vector<VkViewport>* pViewports)
@@ -729,6 +930,33 @@ void CCommandBuffer::CmdSetBlendConstants(float bc0, float bc1, float bc2, float
 {
 }
 
+void CCommandBuffer::CmdSetColorBlendEnable(uint32_t attachment, VkBool32 colorBlendEnable)
+{
+    this->CmdSetColorBlendEnableEXT(attachment, 1, &colorBlendEnable);
+}
+
+void CCommandBuffer::CmdSetColorBlendEquation(uint32_t attachment, const VkColorBlendEquationEXT& colorBlendEquation)
+{
+    this->CmdSetColorBlendEquationEXT(attachment, 1, &colorBlendEquation);
+}
+
+void CCommandBuffer::CmdSetColorBlendEquation(uint32_t attachment, const VkPipelineColorBlendAttachmentState& state)
+{
+    VkColorBlendEquationEXT equation = {};
+    equation.srcColorBlendFactor     = state.srcColorBlendFactor;
+    equation.dstColorBlendFactor     = state.dstColorBlendFactor;
+    equation.colorBlendOp            = state.colorBlendOp;
+    equation.srcAlphaBlendFactor     = state.srcAlphaBlendFactor;
+    equation.dstAlphaBlendFactor     = state.dstAlphaBlendFactor;
+    equation.alphaBlendOp            = state.alphaBlendOp;
+    this->CmdSetColorBlendEquationEXT(attachment, 1, &equation);
+}
+
+void CCommandBuffer::CmdSetColorWriteMask(uint32_t attachment, VkColorComponentFlags colorWriteMask)
+{
+    this->CmdSetColorWriteMaskEXT(attachment, 1, &colorWriteMask);
+}
+
 void CCommandBuffer::CmdBindDescriptorSets(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, const std::vector<VkDescriptorSet>& descriptorSets, const std::vector<uint32_t>* pDynamicOffsets)
 {
     this->CmdBindDescriptorSets(
@@ -741,6 +969,87 @@ void CCommandBuffer::CmdBindDescriptorSets(VkPipelineBindPoint pipelineBindPoint
         (pDynamicOffsets != nullptr ? DataPtr(*pDynamicOffsets) : nullptr));
 }
 
+void CCommandBuffer::CmdBindShaderArguments(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, const vkex::ShaderArguments& arguments)
+{
+    // Bind allocated sets in runs of consecutive set numbers
+    const std::vector<vkex::AssignedDescriptorSet>& assigned_sets = arguments.GetAssignedSets();
+    size_t                                          first         = 0;
+    while (first < assigned_sets.size()) {
+        std::vector<VkDescriptorSet> vk_descriptor_sets = {*(assigned_sets[first].descriptor_set)};
+        size_t                       last               = first + 1;
+        while ((last < assigned_sets.size()) && (assigned_sets[last].set_number == (assigned_sets[last - 1].set_number + 1))) {
+            vk_descriptor_sets.push_back(*(assigned_sets[last].descriptor_set));
+            ++last;
+        }
+
+        this->CmdBindDescriptorSets(
+            pipelineBindPoint,
+            layout,
+            assigned_sets[first].set_number,
+            vk_descriptor_sets);
+
+        first = last;
+    }
+
+    // Push the recorded descriptors, one call per push set
+    std::vector<VkWriteDescriptorSet> vk_writes;
+    for (auto& push_set : arguments.GetAssignedPushSets()) {
+        vk_writes.clear();
+        arguments.GetPushDescriptorWrites(push_set.set_number, &vk_writes);
+        if (vk_writes.empty()) {
+            continue;
+        }
+
+        this->CmdPushDescriptorSetKHR(
+            pipelineBindPoint,
+            layout,
+            push_set.set_number,
+            CountU32(vk_writes),
+            DataPtr(vk_writes));
+    }
+}
+
+void CCommandBuffer::CmdBindBindlessTable(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t set, const vkex::BindlessTable table)
+{
+    VkDescriptorSet vk_descriptor_set = *(table->GetDescriptorSet());
+    this->CmdBindDescriptorSets(
+        pipelineBindPoint,
+        layout,
+        set,
+        1,
+        &vk_descriptor_set,
+        0,
+        nullptr);
+}
+
+void CCommandBuffer::CmdBindDescriptorBuffers(const vkex::DescriptorBufferHeap heap)
+{
+    const std::vector<VkDescriptorBufferBindingInfoEXT>& binding_infos = heap->GetBindingInfos();
+    this->CmdBindDescriptorBuffersEXT(
+        CountU32(binding_infos),
+        DataPtr(binding_infos));
+}
+
+void CCommandBuffer::CmdSetDescriptorBufferOffsets(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, const std::vector<vkex::DescriptorBufferAllocation>& allocations)
+{
+    std::vector<uint32_t>     buffer_indices;
+    std::vector<VkDeviceSize> offsets;
+    buffer_indices.reserve(allocations.size());
+    offsets.reserve(allocations.size());
+    for (auto& allocation : allocations) {
+        buffer_indices.push_back(allocation.buffer_index);
+        offsets.push_back(allocation.offset);
+    }
+
+    this->CmdSetDescriptorBufferOffsetsEXT(
+        pipelineBindPoint,
+        layout,
+        firstSet,
+        CountU32(allocations),
+        DataPtr(buffer_indices),
+        DataPtr(offsets));
+}
+
 void CCommandBuffer::CmdBindIndexBuffer(vkex::Buffer buffer, VkDeviceSize offset, VkIndexType indexType)
 {
     VkBuffer vk_buffer = *buffer;
@@ -893,6 +1202,20 @@ void CCommandBuffer::CmdCopyQueryPoolResults(vkex::QueryPool queryPool, uint32_t
         flags);
 }
 
+void CCommandBuffer::CmdBeginGpuZone(vkex::GpuProfiler profiler, const char* name)
+{
+    if (profiler != nullptr) {
+        profiler->CmdBeginZone(this, name);
+    }
+}
+
+void CCommandBuffer::CmdEndGpuZone(vkex::GpuProfiler profiler)
+{
+    if (profiler != nullptr) {
+        profiler->CmdEndZone(this);
+    }
+}
+
 void CCommandBuffer::CmdPushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, const std::vector<uint8_t>* pValues)
 {
 }
@@ -1222,8 +1545,8 @@ vkex::Result CCommandPool::InternalDestroy(const VkAllocationCallbacks* p_alloca
 {
     // Collect command buffers
     std::vector<vkex::CommandBuffer> command_buffers;
-    for (auto& obj : m_stored_command_buffers) {
-        command_buffers.push_back(obj.get());
+    for (auto obj : m_stored_command_buffers) {
+        command_buffers.push_back(obj);
     }
     // Free command buffers
     FreeCommandBuffers(&command_buffers);
@@ -109,6 +109,14 @@ public:
     vkex::Result Begin(VkCommandBufferUsageFlags flags = 0);
     vkex::Result End();
 
+    /** @fn InvalidateDynamicStateCache
+     *
+     * The cull mode, front face, topology, depth test/write and color blend
+     * setters skip calls that would not change the current state. Call this
+     * after recording any of those states through GetVkObject() directly.
+     */
+    void InvalidateDynamicStateCache();
+
     // -----------------------------------------------------------------------------------------------
     // Command functions that mirror the vkCmd* interface
     // -----------------------------------------------------------------------------------------------
@@ -122,6 +130,11 @@ public:
     void CmdSetStencilCompareMask(VkStencilFaceFlags faceMask, uint32_t compareMask);
     void CmdSetStencilWriteMask(VkStencilFaceFlags faceMask, uint32_t writeMask);
     void CmdSetStencilReference(VkStencilFaceFlags faceMask, uint32_t reference);
+    void CmdSetCullMode(VkCullModeFlags cullMode);
+    void CmdSetFrontFace(VkFrontFace frontFace);
+    void CmdSetPrimitiveTopology(VkPrimitiveTopology primitiveTopology);
+    void CmdSetDepthTestEnable(VkBool32 depthTestEnable);
+    void CmdSetDepthWriteEnable(VkBool32 depthWriteEnable);
     void CmdBindDescriptorSets(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t* pDynamicOffsets);
     void CmdBindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
     void CmdBindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize* pOffsets);
@@ -165,6 +178,10 @@ public:
     void CmdBindDescriptorBuffersEXT(uint32_t bufferCount, const VkDescriptorBufferBindingInfoEXT* pBindingInfos);
     void CmdSetDescriptorBufferOffsetsEXT(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t setCount, const uint32_t* pBufferIndices, const VkDeviceSize* pOffsets);
 
+    void CmdSetColorBlendEnableEXT(uint32_t firstAttachment, uint32_t attachmentCount, const VkBool32* pColorBlendEnables);
+    void CmdSetColorBlendEquationEXT(uint32_t firstAttachment, uint32_t attachmentCount, const VkColorBlendEquationEXT* pColorBlendEquations);
+    void CmdSetColorWriteMaskEXT(uint32_t firstAttachment, uint32_t attachmentCount, const VkColorComponentFlags* pColorWriteMasks);
+
     // -----------------------------------------------------------------------------------------------
     // Command functions with convenience parameters
     // -----------------------------------------------------------------------------------------------
@@ -175,7 +192,15 @@ public:
     void CmdSetScissor(uint32_t firstScissor, const std::vector<VkRect2D>* pScissors);
     void CmdSetScissor(const VkRect2D& area);
     void CmdSetBlendConstants(float bc0, float bc1, float bc2, float bc3);
+    void CmdSetColorBlendEnable(uint32_t attachment, VkBool32 colorBlendEnable);
+    void CmdSetColorBlendEquation(uint32_t attachment, const VkColorBlendEquationEXT& colorBlendEquation);
+    void CmdSetColorBlendEquation(uint32_t attachment, const VkPipelineColorBlendAttachmentState& state);
+    void CmdSetColorWriteMask(uint32_t attachment, VkColorComponentFlags colorWriteMask);
     void CmdBindDescriptorSets(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, const std::vector<VkDescriptorSet>& descriptorSets, const std::vector<uint32_t>* pDynamicOffsets = nullptr);
+    void CmdBindShaderArguments(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, const vkex::ShaderArguments& arguments);
+    void CmdBindBindlessTable(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t set, const vkex::BindlessTable table);
+    void CmdBindDescriptorBuffers(const vkex::DescriptorBufferHeap heap);
+    void CmdSetDescriptorBufferOffsets(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, const std::vector<vkex::DescriptorBufferAllocation>& allocations);
     void CmdBindIndexBuffer(vkex::Buffer buffer, VkDeviceSize offset, VkIndexType indexType);
     void CmdBindVertexBuffers(uint32_t firstBinding, const std::vector<VkBuffer>* pBuffers, const VkDeviceSize* pOffsets);
     void CmdBindVertexBuffers(vkex::Buffer buffer, VkDeviceSize offset = 0);
@@ -197,6 +222,8 @@ public:
     void CmdResetQueryPool(vkex::QueryPool queryPool, uint32_t firstQuery, uint32_t queryCount);
     void CmdWriteTimestamp(VkPipelineStageFlagBits pipelineStage, vkex::QueryPool queryPool, uint32_t query);
     void CmdCopyQueryPoolResults(vkex::QueryPool queryPool, uint32_t firstQuery, uint32_t queryCount, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize stride, VkQueryResultFlags flags);
+    void CmdBeginGpuZone(vkex::GpuProfiler profiler, const char* name);
+    void CmdEndGpuZone(vkex::GpuProfiler profiler);
     void CmdPushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, const std::vector<uint8_t>* pValues);
     void CmdExecuteCommands(const std::vector<VkCommandBuffer>* pCommandBuffers);
 
@@ -209,6 +236,42 @@ private:
     friend class CCommandPool;
     friend class IObjectStorageFunctions;
 
+    /** @struct DynamicStateCache
+     *
+     * Last values recorded for the filtered dynamic states. A state is only
+     * trusted while its valid bit is set. Attachments past
+     * kMaxCachedAttachments are never filtered.
+     */
+    struct DynamicStateCache
+    {
+        enum
+        {
+            kMaxCachedAttachments = 8,
+        };
+
+        enum
+        {
+            kCullModeBit         = 0x00000001,
+            kFrontFaceBit        = 0x00000002,
+            kTopologyBit         = 0x00000004,
+            kDepthTestEnableBit  = 0x00000008,
+            kDepthWriteEnableBit = 0x00000010,
+        };
+
+        uint32_t                valid_bits                = 0;
+        VkCullModeFlags         cull_mode                 = VK_CULL_MODE_NONE;
+        VkFrontFace             front_face                = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        VkPrimitiveTopology     topology                  = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        VkBool32                depth_test_enable         = VK_FALSE;
+        VkBool32                depth_write_enable        = VK_FALSE;
+        uint32_t                blend_enable_valid_mask   = 0;
+        uint32_t                blend_equation_valid_mask = 0;
+        uint32_t                write_mask_valid_mask     = 0;
+        VkBool32                blend_enables[kMaxCachedAttachments];
+        VkColorBlendEquationEXT blend_equations[kMaxCachedAttachments];
+        VkColorComponentFlags   write_masks[kMaxCachedAttachments];
+    };
+
     /** @fn InternalCreate
      *
      */
@@ -229,9 +292,17 @@ private:
         m_pool = pool;
     }
 
+    /** @fn InvalidateDynamicState
+     *
+     * Binding a pipeline with a state baked in overwrites that state, so
+     * the cached value can't be trusted afterwards.
+     */
+    void InvalidateDynamicState(bool raster_state, bool blend_state);
+
 private:
-    vkex::CommandPool             m_pool        = nullptr;
-    vkex::CommandBufferCreateInfo m_create_info = {};
+    vkex::CommandPool             m_pool                = nullptr;
+    vkex::CommandBufferCreateInfo m_create_info         = {};
+    DynamicStateCache             m_dynamic_state_cache = {};
 };
 
 // =================================================================================================
@@ -337,10 +408,10 @@ private:
     vkex::Result InternalDestroy(const VkAllocationCallbacks* p_allocator);
 
 private:
-    vkex::CommandPoolCreateInfo                  m_create_info    = {};
-    VkCommandPoolCreateInfo                      m_vk_create_info = {};
-    VkCommandPool                                m_vk_object      = VK_NULL_HANDLE;
-    std::vector<std::unique_ptr<CCommandBuffer>> m_stored_command_buffers;
+    vkex::CommandPoolCreateInfo      m_create_info    = {};
+    VkCommandPoolCreateInfo          m_vk_create_info = {};
+    VkCommandPool                    m_vk_object      = VK_NULL_HANDLE;
+    vkex::ObjectPool<CCommandBuffer> m_stored_command_buffers;
 };
 
 } // namespace vkex
@@ -52,6 +52,7 @@
 #define VKEX_MINIMUM_REQUIRED_VULKAN_VERSION VK_MAKE_VERSION(1, 3, 0)
 #define VKEX_ALL_MIP_LEVELS                  0xFFFFFFFF
 #define VKEX_ALL_ARRAY_LAYERS                0xFFFFFFFF
+#define VKEX_ALL_QUERIES                     0xFFFFFFFF
 
 enum
 {
@@ -214,6 +215,13 @@ public:
         ErrorDescriptorSetNumberNotFound            = -1204,
         ErrorDuplicatetDescriptorBinding            = -1205,
         ErrorPipelineMissingRequiredShaderStage     = -1206,
+        ErrorRequiredFeatureNotEnabled              = -1207,
+        ErrorDescriptorSetLayoutNotPushDescriptor   = -1208,
+        ErrorSpecializationConstantNotFound         = -1209,
+        ErrorSpecializationConstantTypeMismatch     = -1210,
+        ErrorTimestampsNotSupported                 = -1211,
+        ErrorInvalidQueryType                       = -1212,
+        ErrorObjectIsShared                         = -1213,
 
         ErrorVulkanFunctionFailed  = -1300,
         ErrorSpirvReflectionError  = -1301,
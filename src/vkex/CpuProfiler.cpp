@@ -0,0 +1,292 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#include "vkex/CpuProfiler.h"
+#include "vkex/FileSystem.h"
+#include "vkex/Util.h"
+
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace vkex {
+
+namespace {
+
+struct ZoneRecord
+{
+    const char* name;
+    uint64_t    start_timestamp;
+    uint64_t    end_timestamp;
+};
+
+// Single producer (the owning thread), single consumer (Collect, which
+// holds ProfilerState::mutex).
+struct ThreadBuffer
+{
+    uint32_t              thread_id = 0;
+    ZoneRecord            zones[CpuProfiler::kThreadBufferCapacity];
+    std::atomic<uint64_t> write_index{0};
+    std::atomic<uint64_t> read_index{0};
+    std::atomic<uint64_t> dropped_count{0};
+};
+
+struct TraceZone
+{
+    const char* name;
+    uint64_t    start_timestamp;
+    uint64_t    end_timestamp;
+    uint32_t    thread_id;
+};
+
+struct ProfilerState
+{
+    std::mutex                                 mutex;
+    uint64_t                                   start_timestamp = vkex::Timer::Timestamp();
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;      // Buffers of running threads
+    std::vector<std::unique_ptr<ThreadBuffer>> free_threads; // Buffers of exited threads, for reuse
+    std::vector<std::string>                   thread_names; // Indexed by thread_id, kept after exit
+    std::vector<TraceZone>                     trace;
+    size_t                                     trace_oldest        = 0; // Next zone to overwrite once the trace is full
+    uint64_t                                   trace_dropped_count = 0;
+};
+
+static_assert((CpuProfiler::kThreadBufferCapacity & (CpuProfiler::kThreadBufferCapacity - 1)) == 0, "Thread buffer capacity must be a power of two");
+
+// Never destroyed, threads may still record zones during static destruction
+ProfilerState& GetState()
+{
+    static ProfilerState* s_state = new ProfilerState();
+    return *s_state;
+}
+
+// Caller must hold state.mutex
+void CollectLocked(ProfilerState& state);
+
+// Returns the thread's buffer to ProfilerState::free_threads when the
+// thread exits.
+struct ThreadBufferOwner
+{
+    ThreadBuffer* p_buffer = nullptr;
+
+    ~ThreadBufferOwner()
+    {
+        if (p_buffer == nullptr) {
+            return;
+        }
+
+        ProfilerState&              state = GetState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        // Take the thread's last zones before the buffer is reused
+        CollectLocked(state);
+        state.trace_dropped_count += p_buffer->dropped_count.load(std::memory_order_relaxed);
+
+        ThreadBuffer* p_exited = p_buffer;
+        auto          it       = FindIf(state.threads, [p_exited](const std::unique_ptr<ThreadBuffer>& elem) -> bool { return elem.get() == p_exited; });
+        if (it != state.threads.end()) {
+            state.free_threads.push_back(std::move(*it));
+            state.threads.erase(it);
+        }
+        p_buffer = nullptr;
+    }
+};
+
+thread_local ThreadBufferOwner t_thread_buffer;
+thread_local std::string       t_thread_name;
+
+ThreadBuffer* GetThreadBuffer()
+{
+    if (t_thread_buffer.p_buffer == nullptr) {
+        ProfilerState&              state = GetState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        std::unique_ptr<ThreadBuffer> buffer;
+        if (!state.free_threads.empty()) {
+            buffer = std::move(state.free_threads.back());
+            state.free_threads.pop_back();
+            buffer->write_index.store(0, std::memory_order_relaxed);
+            buffer->read_index.store(0, std::memory_order_relaxed);
+            buffer->dropped_count.store(0, std::memory_order_relaxed);
+        }
+        else {
+            buffer = std::make_unique<ThreadBuffer>();
+        }
+        buffer->thread_id        = CountU32(state.thread_names);
+        t_thread_buffer.p_buffer = buffer.get();
+        state.thread_names.push_back(t_thread_name);
+        state.threads.push_back(std::move(buffer));
+    }
+    return t_thread_buffer.p_buffer;
+}
+
+void CollectLocked(ProfilerState& state)
+{
+    const uint64_t mask = CpuProfiler::kThreadBufferCapacity - 1;
+    for (auto& thread : state.threads) {
+        uint64_t read  = thread->read_index.load(std::memory_order_relaxed);
+        uint64_t write = thread->write_index.load(std::memory_order_acquire);
+        for (; read < write; ++read) {
+            const ZoneRecord& zone       = thread->zones[read & mask];
+            TraceZone         trace_zone = {zone.name, zone.start_timestamp, zone.end_timestamp, thread->thread_id};
+            if (state.trace.size() < CpuProfiler::kMaxTraceZones) {
+                state.trace.push_back(trace_zone);
+            }
+            else {
+                // Keep the most recent zones, the oldest one is lost
+                state.trace[state.trace_oldest] = trace_zone;
+                state.trace_oldest              = (state.trace_oldest + 1) % CpuProfiler::kMaxTraceZones;
+                state.trace_dropped_count += 1;
+            }
+        }
+        thread->read_index.store(write, std::memory_order_release);
+    }
+}
+
+} // namespace
+
+// =================================================================================================
+// CpuProfiler
+// =================================================================================================
+std::atomic<bool> CpuProfiler::s_enabled{false};
+
+void CpuProfiler::SetEnabled(bool enabled)
+{
+    // Fixes the trace's time base before the first zone is recorded
+    GetState();
+
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void CpuProfiler::SetThreadName(const std::string& name)
+{
+    // Threads that never record a zone don't get a buffer
+    t_thread_name = name;
+    if (t_thread_buffer.p_buffer == nullptr) {
+        return;
+    }
+
+    ProfilerState&              state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.thread_names[t_thread_buffer.p_buffer->thread_id] = name;
+}
+
+void CpuProfiler::RecordZone(const char* name, uint64_t start_timestamp, uint64_t end_timestamp)
+{
+    ThreadBuffer* p_buffer = GetThreadBuffer();
+
+    uint64_t write = p_buffer->write_index.load(std::memory_order_relaxed);
+    uint64_t read  = p_buffer->read_index.load(std::memory_order_acquire);
+    if ((write - read) >= kThreadBufferCapacity) {
+        p_buffer->dropped_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ZoneRecord& zone     = p_buffer->zones[write & (kThreadBufferCapacity - 1)];
+    zone.name            = name;
+    zone.start_timestamp = start_timestamp;
+    zone.end_timestamp   = end_timestamp;
+    p_buffer->write_index.store(write + 1, std::memory_order_release);
+}
+
+void CpuProfiler::Collect()
+{
+    ProfilerState&              state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    CollectLocked(state);
+}
+
+void CpuProfiler::Clear()
+{
+    ProfilerState&              state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (auto& thread : state.threads) {
+        thread->read_index.store(thread->write_index.load(std::memory_order_acquire), std::memory_order_release);
+        thread->dropped_count.store(0, std::memory_order_relaxed);
+    }
+    state.trace.clear();
+    state.trace_oldest        = 0;
+    state.trace_dropped_count = 0;
+}
+
+size_t CpuProfiler::GetTraceZoneCount()
+{
+    ProfilerState&              state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.trace.size();
+}
+
+uint64_t CpuProfiler::GetDroppedZoneCount()
+{
+    ProfilerState&              state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    uint64_t                    count = state.trace_dropped_count;
+    for (auto& thread : state.threads) {
+        count += thread->dropped_count.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+vkex::Result CpuProfiler::SaveChromeTrace(const std::string& path)
+{
+    std::stringstream ss;
+    {
+        ProfilerState&              state = GetState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        CollectLocked(state);
+
+        ss << std::fixed << std::setprecision(3);
+        ss << "{\n";
+        ss << "  \"displayTimeUnit\": \"ms\",\n";
+        ss << "  \"traceEvents\": [";
+
+        bool first = true;
+        for (uint32_t thread_id = 0; thread_id < CountU32(state.thread_names); ++thread_id) {
+            const std::string& thread_name = state.thread_names[thread_id];
+            std::string        name        = thread_name.empty() ? ("Thread " + std::to_string(thread_id)) : thread_name;
+            ss << (first ? "\n" : ",\n");
+            ss << "    {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread_id;
+            ss << ", \"args\": {\"name\": " << JsonString(name) << "}}";
+            first = false;
+        }
+
+        // Oldest first
+        const size_t count = state.trace.size();
+        for (size_t i = 0; i < count; ++i) {
+            const TraceZone& zone     = state.trace[(state.trace_oldest + i) % count];
+            uint64_t         start    = (zone.start_timestamp > state.start_timestamp) ? (zone.start_timestamp - state.start_timestamp) : 0;
+            uint64_t         duration = (zone.end_timestamp > zone.start_timestamp) ? (zone.end_timestamp - zone.start_timestamp) : 0;
+            ss << (first ? "\n" : ",\n");
+            ss << "    {\"name\": " << JsonString(zone.name) << ", \"cat\": \"vkex\", \"ph\": \"X\", \"pid\": 1";
+            ss << ", \"tid\": " << zone.thread_id;
+            ss << ", \"ts\": " << vkex::Timer::TimestampToMicros(start);
+            ss << ", \"dur\": " << vkex::Timer::TimestampToMicros(duration) << "}";
+            first = false;
+        }
+
+        ss << "\n  ]\n";
+        ss << "}\n";
+    }
+
+    std::string data = ss.str();
+    if (!fs::save_file_atomic(path, data.data(), data.size())) {
+        return vkex::Result::ErrorFailed;
+    }
+
+    return vkex::Result::Success;
+}
+
+} // namespace vkex
\ No newline at end of file
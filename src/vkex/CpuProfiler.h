@@ -0,0 +1,171 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#ifndef __VKEX_CPU_PROFILER_H__
+#define __VKEX_CPU_PROFILER_H__
+
+#include "vkex/Config.h"
+#include "vkex/Timer.h"
+
+#include <atomic>
+
+#define VKEX_CPU_ZONE_CONCAT_INNER(a, b) a##b
+#define VKEX_CPU_ZONE_CONCAT(a, b)       VKEX_CPU_ZONE_CONCAT_INNER(a, b)
+
+// Use as follows: VKEX_CPU_ZONE("LoadScene"). The zone ends at the end of
+// the enclosing scope. name must be a string literal. Define
+// VKEX_CPU_PROFILER_DISABLE to compile zones out entirely.
+#if defined(VKEX_CPU_PROFILER_DISABLE)
+#    define VKEX_CPU_ZONE(name)
+#    define VKEX_CPU_ZONE_FUNCTION()
+#else
+#    define VKEX_CPU_ZONE(name) \
+        vkex::CpuZoneScope VKEX_CPU_ZONE_CONCAT(vkex_cpu_zone_, __LINE__)(name)
+#    define VKEX_CPU_ZONE_FUNCTION() \
+        vkex::CpuZoneScope VKEX_CPU_ZONE_CONCAT(vkex_cpu_zone_, __LINE__)(__FUNCTION__)
+#endif
+
+namespace vkex {
+
+// =================================================================================================
+// CpuProfiler
+// =================================================================================================
+
+/** @class CpuProfiler
+ *
+ * Process wide instrumentation profiler. Zones are timed with
+ * Timer::Timestamp() and written by the thread that ran them into its own
+ * fixed size ring buffer, without locks. Collect() moves the zones of
+ * every thread into the trace, it must be called often enough that the
+ * per-thread buffers do not fill up; zones that do not fit are dropped
+ * and counted. Application calls it once per frame.
+ *
+ * A thread's buffer is created the first time it records a zone. When
+ * the thread exits its zones are collected and the buffer is kept for
+ * reuse by the next new thread, so short lived threads don't grow memory
+ * use.
+ *
+ * Recording is off until SetEnabled(true) is called, disabled zones only
+ * cost a relaxed atomic load.
+ */
+class CpuProfiler
+{
+public:
+    enum
+    {
+        kThreadBufferCapacity = 16384,   // Zones, must be a power of two
+        kMaxTraceZones        = 1 << 21, // Most recent zones held by the trace
+    };
+
+    /** @fn IsEnabled
+     *
+     */
+    static bool IsEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /** @fn SetEnabled
+     *
+     */
+    static void SetEnabled(bool enabled);
+
+    /** @fn SetThreadName
+     *
+     * Names the calling thread in the trace.
+     */
+    static void SetThreadName(const std::string& name);
+
+    /** @fn RecordZone
+     *
+     * Use VKEX_CPU_ZONE instead. name must outlive the profiler.
+     */
+    static void RecordZone(const char* name, uint64_t start_timestamp, uint64_t end_timestamp);
+
+    /** @fn Collect
+     *
+     * Moves the zones recorded by every thread into the trace. May be
+     * called from any thread.
+     */
+    static void Collect();
+
+    /** @fn Clear
+     *
+     * Discards the trace, including zones not yet collected.
+     */
+    static void Clear();
+
+    /** @fn GetTraceZoneCount
+     *
+     */
+    static size_t GetTraceZoneCount();
+
+    /** @fn GetDroppedZoneCount
+     *
+     * Zones lost to full thread buffers, or overwritten by newer zones
+     * once the trace is full.
+     */
+    static uint64_t GetDroppedZoneCount();
+
+    /** @fn SaveChromeTrace
+     *
+     * Collects and writes the trace in the Chrome trace event format,
+     * which chrome://tracing and https://ui.perfetto.dev can open.
+     * Timestamps are in microseconds since the profiler was first used.
+     */
+    static vkex::Result SaveChromeTrace(const std::string& path);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// =================================================================================================
+// CpuZoneScope
+// =================================================================================================
+
+/** @class CpuZoneScope
+ *
+ * Use VKEX_CPU_ZONE.
+ */
+class CpuZoneScope
+{
+public:
+    CpuZoneScope(const char* name)
+        : m_name(name)
+    {
+        if (CpuProfiler::IsEnabled()) {
+            m_start_timestamp = vkex::Timer::Timestamp();
+        }
+    }
+
+    ~CpuZoneScope()
+    {
+        if (m_start_timestamp != 0) {
+            CpuProfiler::RecordZone(m_name, m_start_timestamp, vkex::Timer::Timestamp());
+        }
+    }
+
+    CpuZoneScope(const CpuZoneScope&)            = delete;
+    CpuZoneScope& operator=(const CpuZoneScope&) = delete;
+
+private:
+    const char* m_name            = nullptr;
+    uint64_t    m_start_timestamp = 0;
+};
+
+} // namespace vkex
+
+#endif // __VKEX_CPU_PROFILER_H__
\ No newline at end of file
@@ -38,8 +38,22 @@ vkex::Result CDescriptorSetLayout::InternalCreate(
     // Copy create info
     m_create_info = create_info;
 
+    // Binding flags
+    const void* p_next = nullptr;
+    if (!m_create_info.binding_flags.empty()) {
+        if (m_create_info.binding_flags.size() != m_create_info.bindings.size()) {
+            return vkex::Result::ErrorOutOfRange;
+        }
+
+        m_vk_binding_flags_create_info               = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO};
+        m_vk_binding_flags_create_info.bindingCount  = CountU32(m_create_info.binding_flags);
+        m_vk_binding_flags_create_info.pBindingFlags = DataPtr(m_create_info.binding_flags);
+        p_next                                       = &m_vk_binding_flags_create_info;
+    }
+
     // Create Vulkan object
     m_vk_create_info              = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    m_vk_create_info.pNext        = p_next;
     m_vk_create_info.flags        = m_create_info.flags.flags;
     m_vk_create_info.bindingCount = CountU32(m_create_info.bindings);
     m_vk_create_info.pBindings    = DataPtr(m_create_info.bindings);
@@ -51,6 +65,9 @@ vkex::Result CDescriptorSetLayout::InternalCreate(
             &m_vk_create_info,
             p_allocator,
             &m_vk_object));
+    if (vk_result != VK_SUCCESS) {
+        return vkex::Result(vk_result);
+    }
 
     return vkex::Result::Success;
 }
@@ -69,6 +86,145 @@ vkex::Result CDescriptorSetLayout::InternalDestroy(const VkAllocationCallbacks*
     return vkex::Result::Success;
 }
 
+// =================================================================================================
+// DescriptorUpdateTemplate
+// =================================================================================================
+CDescriptorUpdateTemplate::CDescriptorUpdateTemplate()
+{
+}
+
+CDescriptorUpdateTemplate::~CDescriptorUpdateTemplate()
+{
+}
+
+vkex::Result CDescriptorUpdateTemplate::InternalCreate(
+    const vkex::DescriptorUpdateTemplateCreateInfo& create_info,
+    const VkAllocationCallbacks*                    p_allocator)
+{
+    // Copy create info
+    m_create_info = create_info;
+
+    if (m_create_info.descriptor_set_layout == nullptr) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    // Pack entries in binding order
+    std::vector<vkex::ShaderInterface::Binding> bindings = m_create_info.set.bindings;
+    std::sort(
+        std::begin(bindings),
+        std::end(bindings),
+        [](const vkex::ShaderInterface::Binding& a, const vkex::ShaderInterface::Binding& b) -> bool { return a.binding_number < b.binding_number; });
+
+    // Every entry must match a binding of the layout
+    const std::vector<VkDescriptorSetLayoutBinding>& layout_bindings = m_create_info.descriptor_set_layout->GetBindings();
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        const vkex::ShaderInterface::Binding& binding = bindings[i];
+        if ((i > 0) && (binding.binding_number == bindings[i - 1].binding_number)) {
+            return vkex::Result::ErrorDuplicatetDescriptorBinding;
+        }
+
+        auto it = FindIf(
+            layout_bindings,
+            [&binding](const VkDescriptorSetLayoutBinding& elem) -> bool { return elem.binding == binding.binding_number; });
+        if (it == std::end(layout_bindings)) {
+            return vkex::Result::ErrorInvalidDescriptorBinding;
+        }
+        if (it->descriptorType != binding.descriptor_type) {
+            return vkex::Result::ErrorInvalidDescriptorType;
+        }
+        if (binding.descriptor_count > it->descriptorCount) {
+            return vkex::Result::ErrorOutOfRange;
+        }
+    }
+
+    m_data_size = 0;
+    for (auto& binding : bindings) {
+        size_t stride = 0;
+        switch (binding.descriptor_type) {
+            default: {
+                return vkex::Result::ErrorInvalidDescriptorType;
+            } break;
+
+            case VK_DESCRIPTOR_TYPE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT: {
+                stride = sizeof(VkDescriptorImageInfo);
+            } break;
+
+            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER: {
+                stride = sizeof(VkBufferView);
+            } break;
+
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: {
+                stride = sizeof(VkDescriptorBufferInfo);
+            } break;
+        }
+
+        VkDescriptorUpdateTemplateEntry vk_entry = {};
+        vk_entry.dstBinding                      = binding.binding_number;
+        vk_entry.dstArrayElement                 = 0;
+        vk_entry.descriptorCount                 = binding.descriptor_count;
+        vk_entry.descriptorType                  = binding.descriptor_type;
+        vk_entry.offset                          = m_data_size;
+        vk_entry.stride                          = stride;
+        m_vk_entries.push_back(vk_entry);
+
+        m_data_size += stride * binding.descriptor_count;
+    }
+
+    // Create Vulkan object
+    m_vk_create_info                            = {VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO};
+    m_vk_create_info.flags                      = 0;
+    m_vk_create_info.descriptorUpdateEntryCount = CountU32(m_vk_entries);
+    m_vk_create_info.pDescriptorUpdateEntries   = DataPtr(m_vk_entries);
+    m_vk_create_info.templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+    m_vk_create_info.descriptorSetLayout        = *(m_create_info.descriptor_set_layout);
+    VkResult vk_result                          = InvalidValue<VkResult>::Value;
+    VKEX_VULKAN_RESULT_CALL(
+        vk_result,
+        vkCreateDescriptorUpdateTemplate(
+            *m_device,
+            &m_vk_create_info,
+            p_allocator,
+            &m_vk_object));
+    if (vk_result != VK_SUCCESS) {
+        return vkex::Result(vk_result);
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorUpdateTemplate::InternalDestroy(const VkAllocationCallbacks* p_allocator)
+{
+    if (m_vk_object != VK_NULL_HANDLE) {
+        vkDestroyDescriptorUpdateTemplate(
+            *m_device,
+            m_vk_object,
+            p_allocator);
+
+        m_vk_object = VK_NULL_HANDLE;
+    }
+
+    return vkex::Result::Success;
+}
+
+uint32_t CDescriptorUpdateTemplate::GetEntryOffset(uint32_t binding_number) const
+{
+    auto it = FindIf(
+        m_vk_entries,
+        [binding_number](const VkDescriptorUpdateTemplateEntry& elem) -> bool { return elem.dstBinding == binding_number; });
+    if (it == std::end(m_vk_entries)) {
+        return UINT32_MAX;
+    }
+    return static_cast<uint32_t>(it->offset);
+}
+
 // =================================================================================================
 // DescriptorSet
 // =================================================================================================
@@ -87,6 +243,16 @@ vkex::Result CDescriptorSet::InternalCreate(
     // Copy create info
     m_create_info = create_info;
 
+    // Binding lookup table
+    uint32_t max_binding = 0;
+    for (auto& binding : m_create_info.bindings) {
+        max_binding = std::max(max_binding, binding.binding);
+    }
+    m_binding_indices.assign(m_create_info.bindings.empty() ? 0 : (max_binding + 1), UINT32_MAX);
+    for (uint32_t i = 0; i < CountU32(m_create_info.bindings); ++i) {
+        m_binding_indices[m_create_info.bindings[i].binding] = i;
+    }
+
     return vkex::Result::Success;
 }
 
@@ -104,18 +270,16 @@ void CDescriptorSet::SetPool(vkex::DescriptorPool pool)
 
 const VkDescriptorSetLayoutBinding* CDescriptorSet::FindDescriptorBinding(uint32_t binding) const
 {
-    const VkDescriptorSetLayoutBinding* p_descriptor_binding = nullptr;
-
-    auto it = std::find_if(
-        std::begin(m_create_info.bindings),
-        std::end(m_create_info.bindings),
-        [binding](const VkDescriptorSetLayoutBinding& elem) -> bool { return elem.binding == binding; });
+    if (binding >= CountU32(m_binding_indices)) {
+        return nullptr;
+    }
 
-    if (it != m_create_info.bindings.end()) {
-        p_descriptor_binding = &(*it);
+    uint32_t index = m_binding_indices[binding];
+    if (index == UINT32_MAX) {
+        return nullptr;
     }
 
-    return p_descriptor_binding;
+    return &m_create_info.bindings[index];
 }
 
 void CDescriptorSet::UpdateDescriptors(uint32_t binding, VkDescriptorType descriptor_type, uint32_t array_element, uint32_t count, const VkDescriptorBufferInfo* p_infos)
@@ -158,27 +322,145 @@ void CDescriptorSet::UpdateDescriptors(uint32_t binding, VkDescriptorType descri
         nullptr);
 }
 
-vkex::Result CDescriptorSet::UpdateDescriptor(uint32_t binding, const vkex::Buffer buffer, uint32_t array_element)
+vkex::Result CDescriptorSet::GetDescriptorInfo(const vkex::BoundDescriptor& descriptor, VkDescriptorType* p_descriptor_type, vkex::BoundDescriptor* p_info) const
 {
-    const VkDescriptorSetLayoutBinding* p_descriptor_binding = FindDescriptorBinding(binding);
+    const VkDescriptorSetLayoutBinding* p_descriptor_binding = FindDescriptorBinding(descriptor.binding_number);
     if (p_descriptor_binding == nullptr) {
         return vkex::Result::ErrorInvalidDescriptorBinding;
     }
+    if (descriptor.array_element >= p_descriptor_binding->descriptorCount) {
+        return vkex::Result::ErrorInvalidDescriptorBinding;
+    }
 
-    VkDescriptorType descriptor_type           = p_descriptor_binding->descriptorType;
-    bool             is_storage_buffer         = (descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-    bool             is_uniform_buffer         = (descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-    bool             is_uniform_buffer_dynamic = (descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
-    bool             is_uniform_texel_buffer   = (descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER);
+    // Resources the descriptor type is written from
+    VkDescriptorType descriptor_type = p_descriptor_binding->descriptorType;
+    bool             needs_buffer    = false;
+    bool             needs_view      = false;
+    bool             needs_sampler   = false;
+    bool             needs_texel     = false;
+    VkImageLayout    image_layout    = VK_IMAGE_LAYOUT_UNDEFINED;
+    switch (descriptor_type) {
+        default: {
+            return vkex::Result::ErrorInvalidDescriptorType;
+        } break;
+
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: {
+            needs_buffer = true;
+        } break;
+
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER: {
+            needs_texel = true;
+        } break;
+
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT: {
+            needs_view   = true;
+            image_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        } break;
+
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: {
+            needs_view   = true;
+            image_layout = VK_IMAGE_LAYOUT_GENERAL;
+        } break;
+
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: {
+            needs_view    = true;
+            needs_sampler = true;
+            image_layout  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        } break;
+
+        case VK_DESCRIPTOR_TYPE_SAMPLER: {
+            needs_sampler = true;
+        } break;
+    }
 
-    if (!(is_storage_buffer || is_uniform_buffer || is_uniform_buffer_dynamic || is_uniform_texel_buffer)) {
+    // The descriptor must hold exactly those resources
+    bool has_buffer  = (descriptor.buffer_info.buffer != VK_NULL_HANDLE);
+    bool has_view    = (descriptor.image_info.imageView != VK_NULL_HANDLE);
+    bool has_sampler = (descriptor.image_info.sampler != VK_NULL_HANDLE);
+    bool has_texel   = (descriptor.texel_buffer_view != VK_NULL_HANDLE);
+    if ((has_buffer != needs_buffer) || (has_view != needs_view) || (has_sampler != needs_sampler) || (has_texel != needs_texel)) {
         return vkex::Result::ErrorInvalidDescriptorType;
     }
 
-    VkDescriptorBufferInfo info{};
-    info.buffer = *buffer;
-    info.offset = 0;
-    info.range  = buffer->GetSize();
+    *p_descriptor_type = descriptor_type;
+    *p_info            = descriptor;
+    // Keep a layout the caller chose
+    if (needs_view && (p_info->image_info.imageLayout == VK_IMAGE_LAYOUT_UNDEFINED)) {
+        p_info->image_info.imageLayout = image_layout;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorSet::GetDescriptorInfo(uint32_t binding, uint32_t array_element, const vkex::Buffer buffer, VkDescriptorType* p_descriptor_type, VkDescriptorBufferInfo* p_info) const
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding;
+    descriptor.array_element         = array_element;
+    descriptor.buffer_info.buffer    = *buffer;
+    descriptor.buffer_info.offset    = 0;
+    descriptor.buffer_info.range     = buffer->GetSize();
+
+    vkex::BoundDescriptor info        = {};
+    vkex::Result          vkex_result = GetDescriptorInfo(descriptor, p_descriptor_type, &info);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    *p_info = info.buffer_info;
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorSet::GetDescriptorInfo(uint32_t binding, uint32_t array_element, const vkex::Texture texture, VkDescriptorType* p_descriptor_type, VkDescriptorImageInfo* p_info) const
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding;
+    descriptor.array_element         = array_element;
+    descriptor.image_info.imageView  = *(texture->GetImageView());
+
+    vkex::BoundDescriptor info        = {};
+    vkex::Result          vkex_result = GetDescriptorInfo(descriptor, p_descriptor_type, &info);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    *p_info = info.image_info;
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorSet::GetDescriptorInfo(uint32_t binding, uint32_t array_element, const vkex::Sampler sampler, VkDescriptorType* p_descriptor_type, VkDescriptorImageInfo* p_info) const
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding;
+    descriptor.array_element         = array_element;
+    descriptor.image_info.sampler    = *sampler;
+
+    vkex::BoundDescriptor info        = {};
+    vkex::Result          vkex_result = GetDescriptorInfo(descriptor, p_descriptor_type, &info);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    *p_info = info.image_info;
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorSet::UpdateDescriptor(uint32_t binding, const vkex::Buffer buffer, uint32_t array_element)
+{
+    VkDescriptorType       descriptor_type = InvalidValue<VkDescriptorType>::Value;
+    VkDescriptorBufferInfo info            = {};
+    vkex::Result           vkex_result     = GetDescriptorInfo(binding, array_element, buffer, &descriptor_type, &info);
+    if (!vkex_result) {
+        return vkex_result;
+    }
 
     const uint32_t count = 1;
     UpdateDescriptors(
@@ -193,28 +475,13 @@ vkex::Result CDescriptorSet::UpdateDescriptor(uint32_t binding, const vkex::Buff
 
 vkex::Result CDescriptorSet::UpdateDescriptor(uint32_t binding, const vkex::Texture texture, uint32_t array_element)
 {
-    const VkDescriptorSetLayoutBinding* p_descriptor_binding = FindDescriptorBinding(binding);
-    if (p_descriptor_binding == nullptr) {
-        return vkex::Result::ErrorInvalidDescriptorBinding;
-    }
-
-    VkDescriptorType descriptor_type  = p_descriptor_binding->descriptorType;
-    bool             is_sampled_image = (descriptor_type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
-    bool             is_storage_image = (descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
-    if (!(is_sampled_image || is_storage_image)) {
-        return vkex::Result::ErrorInvalidDescriptorType;
-    }
-
-    VkImageLayout image_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    if (is_storage_image) {
-        image_layout = VK_IMAGE_LAYOUT_GENERAL;
+    VkDescriptorType      descriptor_type = InvalidValue<VkDescriptorType>::Value;
+    VkDescriptorImageInfo info            = {};
+    vkex::Result          vkex_result     = GetDescriptorInfo(binding, array_element, texture, &descriptor_type, &info);
+    if (!vkex_result) {
+        return vkex_result;
     }
 
-    VkDescriptorImageInfo info{};
-    info.sampler     = VK_NULL_HANDLE;
-    info.imageView   = *(texture->GetImageView());
-    info.imageLayout = image_layout;
-
     const uint32_t count = 1;
     UpdateDescriptors(
         binding,
@@ -228,22 +495,13 @@ vkex::Result CDescriptorSet::UpdateDescriptor(uint32_t binding, const vkex::Text
 
 vkex::Result CDescriptorSet::UpdateDescriptor(uint32_t binding, const vkex::Sampler sampler, uint32_t array_element)
 {
-    const VkDescriptorSetLayoutBinding* p_descriptor_binding = FindDescriptorBinding(binding);
-    if (p_descriptor_binding == nullptr) {
-        return vkex::Result::ErrorInvalidDescriptorBinding;
-    }
-
-    VkDescriptorType descriptor_type = p_descriptor_binding->descriptorType;
-    bool             is_sampler      = (descriptor_type == VK_DESCRIPTOR_TYPE_SAMPLER);
-    if (!is_sampler) {
-        return vkex::Result::ErrorInvalidDescriptorType;
+    VkDescriptorType      descriptor_type = InvalidValue<VkDescriptorType>::Value;
+    VkDescriptorImageInfo info            = {};
+    vkex::Result          vkex_result     = GetDescriptorInfo(binding, array_element, sampler, &descriptor_type, &info);
+    if (!vkex_result) {
+        return vkex_result;
     }
 
-    VkDescriptorImageInfo info{};
-    info.sampler     = *sampler;
-    info.imageView   = VK_NULL_HANDLE;
-    info.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-
     const uint32_t count = 1;
     UpdateDescriptors(
         binding,
@@ -255,6 +513,15 @@ vkex::Result CDescriptorSet::UpdateDescriptor(uint32_t binding, const vkex::Samp
     return vkex::Result::Success;
 }
 
+void CDescriptorSet::UpdateDescriptors(const vkex::DescriptorUpdateTemplate update_template, const void* p_data)
+{
+    vkUpdateDescriptorSetWithTemplate(
+        *(m_pool->GetDevice()),
+        m_create_info.vk_object,
+        *update_template,
+        p_data);
+}
+
 // =================================================================================================
 // DescriptorPool
 // =================================================================================================
@@ -463,16 +730,27 @@ void CDescriptorPool::FreeDescriptorSets(
     uint32_t                   descriptor_set_count,
     const vkex::DescriptorSet* p_descriptor_sets)
 {
+    if (descriptor_set_count == 0) {
+        return;
+    }
+
     std::vector<VkDescriptorSet> vk_descriptor_sets;
+    vk_descriptor_sets.reserve(descriptor_set_count);
     for (uint32_t i = 0; i < descriptor_set_count; ++i) {
         vkex::DescriptorSet descriptor_set = p_descriptor_sets[i];
+        // Skip sets that were already freed
+        if (!m_stored_descriptor_sets.IsLive(descriptor_set)) {
+            continue;
+        }
         // Copy Vulkan object
         vk_descriptor_sets.push_back(descriptor_set->GetVkObject());
         // Destroy the stored object
-        DestroyObject<CDescriptorSet>(
-            m_stored_descriptor_sets,
-            descriptor_set,
-            nullptr);
+        descriptor_set->InternalDestroy(nullptr);
+        m_stored_descriptor_sets.Free(descriptor_set);
+    }
+
+    if (vk_descriptor_sets.empty()) {
+        return;
     }
 
     vkFreeDescriptorSets(
@@ -496,4 +774,727 @@ void CDescriptorPool::FreeDescriptorSet(const vkex::DescriptorSet descriptor_set
         &descriptor_set);
 }
 
+vkex::Result CDescriptorPool::Reset()
+{
+    VkResult vk_result = InvalidValue<VkResult>::Value;
+    VKEX_VULKAN_RESULT_CALL(
+        vk_result,
+        vkResetDescriptorPool(
+            *m_device,
+            m_vk_object,
+            0));
+    if (vk_result != VK_SUCCESS) {
+        return vkex::Result(vk_result);
+    }
+
+    vkex::Result vkex_result = DestroyAllObjects<CDescriptorSet>(
+        m_stored_descriptor_sets,
+        nullptr);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+// =================================================================================================
+// DescriptorPoolChain
+// =================================================================================================
+CDescriptorPoolChain::CDescriptorPoolChain()
+{
+}
+
+CDescriptorPoolChain::~CDescriptorPoolChain()
+{
+}
+
+vkex::Result CDescriptorPoolChain::InternalCreate(
+    const vkex::DescriptorPoolChainCreateInfo& create_info,
+    const VkAllocationCallbacks*               p_allocator)
+{
+    // Copy create info
+    m_create_info = create_info;
+
+    if ((m_create_info.frame_count == 0) || m_create_info.shader_interfaces.empty() || (m_create_info.instances_per_pool == 0)) {
+        return vkex::Result::ErrorOutOfRange;
+    }
+
+    // One size class per shader interface
+    m_size_classes.clear();
+    for (auto& shader_interface : m_create_info.shader_interfaces) {
+        uint32_t set_count = CountU32(shader_interface.GetSets());
+        if (set_count == 0) {
+            return vkex::Result::ErrorOutOfRange;
+        }
+
+        SizeClass size_class      = {};
+        size_class.instance_sizes = shader_interface.GetDescriptorPoolSizes();
+        size_class.pool_sizes     = m_create_info.instances_per_pool * size_class.instance_sizes;
+        size_class.max_sets       = m_create_info.instances_per_pool * set_count;
+        m_size_classes.push_back(size_class);
+    }
+
+    m_p_allocator = p_allocator;
+    m_frame_index = 0;
+    m_frames.resize(m_create_info.frame_count);
+    for (auto& frame : m_frames) {
+        frame.size_classes.resize(m_size_classes.size());
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorPoolChain::InternalDestroy(const VkAllocationCallbacks* p_allocator)
+{
+    for (auto& frame : m_frames) {
+        for (auto& list : frame.size_classes) {
+            for (auto& state : list.pools) {
+                vkex::Result vkex_result = GetDevice()->DestroyDescriptorPool(state.pool, p_allocator);
+                if (!vkex_result) {
+                    return vkex_result;
+                }
+            }
+        }
+    }
+    m_frames.clear();
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorPoolChain::AddPool(uint32_t size_class, PoolList* p_list)
+{
+    const SizeClass& sizes = m_size_classes[size_class];
+
+    vkex::DescriptorPoolCreateInfo create_info = {};
+    create_info.max_sets                       = sizes.max_sets;
+    create_info.pool_sizes                     = sizes.pool_sizes;
+
+    PoolState    state       = {};
+    vkex::Result vkex_result = GetDevice()->CreateDescriptorPool(create_info, &state.pool, m_p_allocator);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+    state.remaining      = sizes.pool_sizes;
+    state.remaining_sets = sizes.max_sets;
+
+    p_list->pools.push_back(state);
+
+    return vkex::Result::Success;
+}
+
+bool CDescriptorPoolChain::Covers(const vkex::DescriptorPoolSizes& sizes, const vkex::DescriptorPoolSizes& required)
+{
+    for (uint32_t i = 0; i < VKEX_DESCRIPTOR_TYPE_COUNT; ++i) {
+        if (required.sizes[i] > sizes.sizes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t CDescriptorPoolChain::FindSizeClass(const vkex::DescriptorPoolSizes& required) const
+{
+    uint32_t best_index = UINT32_MAX;
+    uint64_t best_total = UINT64_MAX;
+    for (uint32_t i = 0; i < CountU32(m_size_classes); ++i) {
+        const vkex::DescriptorPoolSizes& sizes = m_size_classes[i].instance_sizes;
+        if (!Covers(sizes, required)) {
+            continue;
+        }
+
+        uint64_t total = 0;
+        for (uint32_t j = 0; j < VKEX_DESCRIPTOR_TYPE_COUNT; ++j) {
+            total += sizes.sizes[j];
+        }
+        if (total < best_total) {
+            best_index = i;
+            best_total = total;
+        }
+    }
+    return best_index;
+}
+
+bool CDescriptorPoolChain::HasRoom(const PoolState& state, const vkex::DescriptorPoolSizes& required)
+{
+    if (state.remaining_sets == 0) {
+        return false;
+    }
+
+    return Covers(state.remaining, required);
+}
+
+vkex::Result CDescriptorPoolChain::NewFrame(uint32_t frame_index)
+{
+    VKEX_ASSERT_MSG((frame_index < m_create_info.frame_count), "Frame index exceeds descriptor pool chain frame count");
+
+    m_frame_index    = frame_index;
+    FrameData& frame = m_frames[m_frame_index];
+
+    for (uint32_t size_class = 0; size_class < CountU32(frame.size_classes); ++size_class) {
+        const SizeClass& sizes = m_size_classes[size_class];
+        PoolList&        list  = frame.size_classes[size_class];
+
+        // Pools past the current one haven't been touched since their last reset
+        uint32_t used_count = std::min(list.current_pool + 1, CountU32(list.pools));
+        for (uint32_t i = 0; i < used_count; ++i) {
+            PoolState&   state       = list.pools[i];
+            vkex::Result vkex_result = state.pool->Reset();
+            if (!vkex_result) {
+                return vkex_result;
+            }
+            state.remaining      = sizes.pool_sizes;
+            state.remaining_sets = sizes.max_sets;
+        }
+        list.current_pool = 0;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorPoolChain::AllocateDescriptorSet(
+    const vkex::DescriptorSetLayout layout,
+    vkex::DescriptorSet*            p_descriptor_set)
+{
+    // Descriptors required by the layout
+    vkex::DescriptorPoolSizes required = {};
+    for (auto& binding : layout->GetBindings()) {
+        if (static_cast<uint32_t>(binding.descriptorType) >= VKEX_DESCRIPTOR_TYPE_COUNT) {
+            return vkex::Result::ErrorInvalidDescriptorType;
+        }
+        required.sizes[binding.descriptorType] += binding.descriptorCount;
+    }
+
+    // Every size class covering the layout fits the set into an empty pool
+    uint32_t size_class = FindSizeClass(required);
+    if (size_class == UINT32_MAX) {
+        return vkex::Result::ErrorOutOfRange;
+    }
+
+    // Find a pool with enough room, adding one if needed. The
+    // capacity is tracked here since running a pool out of memory
+    // is treated as a fatal error by the Vulkan call wrapper.
+    PoolList& list = m_frames[m_frame_index].size_classes[size_class];
+    while (true) {
+        if (list.current_pool >= CountU32(list.pools)) {
+            vkex::Result vkex_result = AddPool(size_class, &list);
+            if (!vkex_result) {
+                return vkex_result;
+            }
+        }
+
+        if (HasRoom(list.pools[list.current_pool], required)) {
+            break;
+        }
+
+        ++list.current_pool;
+    }
+
+    PoolState& state = list.pools[list.current_pool];
+
+    vkex::DescriptorSetAllocateInfo allocate_info = {};
+    allocate_info.layouts.push_back(layout);
+    vkex::Result vkex_result = state.pool->AllocateDescriptorSet(allocate_info, p_descriptor_set);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    for (uint32_t i = 0; i < VKEX_DESCRIPTOR_TYPE_COUNT; ++i) {
+        state.remaining.sizes[i] -= required.sizes[i];
+    }
+    state.remaining_sets -= 1;
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorPoolChain::AllocateDescriptorSets(
+    const std::vector<vkex::DescriptorSetLayout>& layouts,
+    std::vector<vkex::DescriptorSet>*             p_descriptor_sets)
+{
+    for (auto& layout : layouts) {
+        vkex::DescriptorSet descriptor_set = nullptr;
+        vkex::Result        vkex_result    = AllocateDescriptorSet(layout, &descriptor_set);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        p_descriptor_sets->push_back(descriptor_set);
+    }
+
+    return vkex::Result::Success;
+}
+
+uint32_t CDescriptorPoolChain::GetPoolCount() const
+{
+    uint32_t count = 0;
+    for (auto& frame : m_frames) {
+        for (auto& list : frame.size_classes) {
+            count += CountU32(list.pools);
+        }
+    }
+    return count;
+}
+
+// =================================================================================================
+// DescriptorWriter
+// =================================================================================================
+DescriptorWriter::DescriptorWriter()
+{
+}
+
+DescriptorWriter::~DescriptorWriter()
+{
+}
+
+void DescriptorWriter::SetDevice(vkex::DescriptorSet descriptor_set)
+{
+    vkex::Device device = descriptor_set->m_pool->GetDevice();
+    if (m_device == nullptr) {
+        m_device = device;
+    }
+    VKEX_ASSERT_MSG((m_device == device), "All descriptor sets in a DescriptorWriter must belong to the same device");
+}
+
+vkex::Result DescriptorWriter::Write(vkex::DescriptorSet descriptor_set, uint32_t binding, const vkex::Buffer buffer, uint32_t array_element)
+{
+    VkDescriptorType       descriptor_type = InvalidValue<VkDescriptorType>::Value;
+    VkDescriptorBufferInfo info            = {};
+    vkex::Result           vkex_result     = descriptor_set->GetDescriptorInfo(binding, array_element, buffer, &descriptor_type, &info);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    Write(descriptor_set, binding, descriptor_type, array_element, 1, &info);
+
+    return vkex::Result::Success;
+}
+
+vkex::Result DescriptorWriter::Write(vkex::DescriptorSet descriptor_set, uint32_t binding, const vkex::Texture texture, uint32_t array_element)
+{
+    VkDescriptorType      descriptor_type = InvalidValue<VkDescriptorType>::Value;
+    VkDescriptorImageInfo info            = {};
+    vkex::Result          vkex_result     = descriptor_set->GetDescriptorInfo(binding, array_element, texture, &descriptor_type, &info);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    Write(descriptor_set, binding, descriptor_type, array_element, 1, &info);
+
+    return vkex::Result::Success;
+}
+
+vkex::Result DescriptorWriter::Write(vkex::DescriptorSet descriptor_set, uint32_t binding, const vkex::Sampler sampler, uint32_t array_element)
+{
+    VkDescriptorType      descriptor_type = InvalidValue<VkDescriptorType>::Value;
+    VkDescriptorImageInfo info            = {};
+    vkex::Result          vkex_result     = descriptor_set->GetDescriptorInfo(binding, array_element, sampler, &descriptor_type, &info);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    Write(descriptor_set, binding, descriptor_type, array_element, 1, &info);
+
+    return vkex::Result::Success;
+}
+
+void DescriptorWriter::Write(vkex::DescriptorSet descriptor_set, uint32_t binding, VkDescriptorType descriptor_type, uint32_t array_element, uint32_t count, const VkDescriptorBufferInfo* p_infos)
+{
+    SetDevice(descriptor_set);
+
+    VkWriteDescriptorSet vk_write_descriptor = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    vk_write_descriptor.dstSet               = *descriptor_set;
+    vk_write_descriptor.dstBinding           = binding;
+    vk_write_descriptor.dstArrayElement      = array_element;
+    vk_write_descriptor.descriptorCount      = count;
+    vk_write_descriptor.descriptorType       = descriptor_type;
+    m_vk_writes.push_back(vk_write_descriptor);
+
+    m_pending_infos.push_back(PendingInfo{kBufferInfo, m_buffer_infos.size()});
+    m_buffer_infos.insert(std::end(m_buffer_infos), p_infos, p_infos + count);
+}
+
+void DescriptorWriter::Write(vkex::DescriptorSet descriptor_set, uint32_t binding, VkDescriptorType descriptor_type, uint32_t array_element, uint32_t count, const VkDescriptorImageInfo* p_infos)
+{
+    SetDevice(descriptor_set);
+
+    VkWriteDescriptorSet vk_write_descriptor = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    vk_write_descriptor.dstSet               = *descriptor_set;
+    vk_write_descriptor.dstBinding           = binding;
+    vk_write_descriptor.dstArrayElement      = array_element;
+    vk_write_descriptor.descriptorCount      = count;
+    vk_write_descriptor.descriptorType       = descriptor_type;
+    m_vk_writes.push_back(vk_write_descriptor);
+
+    m_pending_infos.push_back(PendingInfo{kImageInfo, m_image_infos.size()});
+    m_image_infos.insert(std::end(m_image_infos), p_infos, p_infos + count);
+}
+
+void DescriptorWriter::Write(vkex::DescriptorSet descriptor_set, uint32_t binding, VkDescriptorType descriptor_type, uint32_t array_element, uint32_t count, const VkBufferView* p_texel_buffer_views)
+{
+    SetDevice(descriptor_set);
+
+    VkWriteDescriptorSet vk_write_descriptor = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    vk_write_descriptor.dstSet               = *descriptor_set;
+    vk_write_descriptor.dstBinding           = binding;
+    vk_write_descriptor.dstArrayElement      = array_element;
+    vk_write_descriptor.descriptorCount      = count;
+    vk_write_descriptor.descriptorType       = descriptor_type;
+    m_vk_writes.push_back(vk_write_descriptor);
+
+    m_pending_infos.push_back(PendingInfo{kTexelBufferView, m_texel_buffer_views.size()});
+    m_texel_buffer_views.insert(std::end(m_texel_buffer_views), p_texel_buffer_views, p_texel_buffer_views + count);
+}
+
+vkex::Result DescriptorWriter::Write(vkex::DescriptorSet descriptor_set, const vkex::BoundDescriptor& descriptor)
+{
+    VkDescriptorType      descriptor_type = InvalidValue<VkDescriptorType>::Value;
+    vkex::BoundDescriptor info            = {};
+    vkex::Result          vkex_result     = descriptor_set->GetDescriptorInfo(descriptor, &descriptor_type, &info);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    if (info.texel_buffer_view != VK_NULL_HANDLE) {
+        Write(descriptor_set, info.binding_number, descriptor_type, info.array_element, 1, &info.texel_buffer_view);
+    }
+    else if (info.buffer_info.buffer != VK_NULL_HANDLE) {
+        Write(descriptor_set, info.binding_number, descriptor_type, info.array_element, 1, &info.buffer_info);
+    }
+    else {
+        Write(descriptor_set, info.binding_number, descriptor_type, info.array_element, 1, &info.image_info);
+    }
+
+    return vkex::Result::Success;
+}
+
+void DescriptorWriter::Flush()
+{
+    if (m_vk_writes.empty()) {
+        return;
+    }
+
+    // Resolve info pointers now that the info vectors are stable
+    for (size_t i = 0; i < m_vk_writes.size(); ++i) {
+        VkWriteDescriptorSet& vk_write = m_vk_writes[i];
+        const PendingInfo&    pending  = m_pending_infos[i];
+        switch (pending.info_type) {
+            case kBufferInfo: vk_write.pBufferInfo = &m_buffer_infos[pending.first_index]; break;
+            case kImageInfo: vk_write.pImageInfo = &m_image_infos[pending.first_index]; break;
+            case kTexelBufferView: vk_write.pTexelBufferView = &m_texel_buffer_views[pending.first_index]; break;
+        }
+    }
+
+    vkUpdateDescriptorSets(
+        *m_device,
+        CountU32(m_vk_writes),
+        DataPtr(m_vk_writes),
+        0,
+        nullptr);
+
+    Clear();
+}
+
+void DescriptorWriter::Clear()
+{
+    m_device = nullptr;
+    m_vk_writes.clear();
+    m_pending_infos.clear();
+    m_buffer_infos.clear();
+    m_image_infos.clear();
+    m_texel_buffer_views.clear();
+}
+
+// =================================================================================================
+// DescriptorSetCache
+// =================================================================================================
+DescriptorSetBindings::DescriptorSetBindings()
+{
+}
+
+DescriptorSetBindings::~DescriptorSetBindings()
+{
+}
+
+void DescriptorSetBindings::Bind(const vkex::BoundDescriptor& descriptor)
+{
+    // Keep sorted so the hash doesn't depend on bind order
+    auto it = std::lower_bound(
+        std::begin(m_descriptors),
+        std::end(m_descriptors),
+        descriptor,
+        [](const vkex::BoundDescriptor& a, const vkex::BoundDescriptor& b) -> bool {
+            return (a.binding_number != b.binding_number) ? (a.binding_number < b.binding_number) : (a.array_element < b.array_element);
+        });
+
+    bool is_same_slot = (it != std::end(m_descriptors)) &&
+                        (it->binding_number == descriptor.binding_number) &&
+                        (it->array_element == descriptor.array_element);
+    if (is_same_slot) {
+        *it = descriptor;
+    }
+    else {
+        m_descriptors.insert(it, descriptor);
+    }
+}
+
+void DescriptorSetBindings::Bind(uint32_t binding_number, const vkex::Buffer buffer, uint32_t array_element)
+{
+    Bind(binding_number, buffer, 0, buffer->GetSize(), array_element);
+}
+
+void DescriptorSetBindings::Bind(uint32_t binding_number, const vkex::Buffer buffer, VkDeviceSize offset, VkDeviceSize range, uint32_t array_element)
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding_number;
+    descriptor.array_element         = array_element;
+    descriptor.buffer_info.buffer    = *buffer;
+    descriptor.buffer_info.offset    = offset;
+    descriptor.buffer_info.range     = range;
+    Bind(descriptor);
+}
+
+void DescriptorSetBindings::Bind(uint32_t binding_number, const vkex::Texture texture, uint32_t array_element)
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding_number;
+    descriptor.array_element         = array_element;
+    descriptor.image_info.imageView  = *(texture->GetImageView());
+    Bind(descriptor);
+}
+
+void DescriptorSetBindings::Bind(uint32_t binding_number, const vkex::Texture texture, VkImageLayout image_layout, uint32_t array_element)
+{
+    vkex::BoundDescriptor descriptor  = {};
+    descriptor.binding_number         = binding_number;
+    descriptor.array_element          = array_element;
+    descriptor.image_info.imageView   = *(texture->GetImageView());
+    descriptor.image_info.imageLayout = image_layout;
+    Bind(descriptor);
+}
+
+void DescriptorSetBindings::Bind(uint32_t binding_number, const vkex::Texture texture, const vkex::Sampler sampler, uint32_t array_element)
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding_number;
+    descriptor.array_element         = array_element;
+    descriptor.image_info.sampler    = *sampler;
+    descriptor.image_info.imageView  = *(texture->GetImageView());
+    Bind(descriptor);
+}
+
+void DescriptorSetBindings::Bind(uint32_t binding_number, const vkex::Sampler sampler, uint32_t array_element)
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding_number;
+    descriptor.array_element         = array_element;
+    descriptor.image_info.sampler    = *sampler;
+    Bind(descriptor);
+}
+
+void DescriptorSetBindings::Bind(uint32_t binding_number, VkBufferView texel_buffer_view, uint32_t array_element)
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding_number;
+    descriptor.array_element         = array_element;
+    descriptor.texel_buffer_view     = texel_buffer_view;
+    Bind(descriptor);
+}
+
+void DescriptorSetBindings::Clear()
+{
+    m_descriptors.clear();
+}
+
+uint64_t DescriptorSetBindings::GetHash() const
+{
+    uint64_t hash = HashValue(CountU32(m_descriptors));
+    for (const auto& descriptor : m_descriptors) {
+        hash = HashValue(descriptor.binding_number, hash);
+        hash = HashValue(descriptor.array_element, hash);
+        hash = HashValue(descriptor.buffer_info, hash);
+        hash = HashValue(descriptor.image_info.sampler, hash);
+        hash = HashValue(descriptor.image_info.imageView, hash);
+        hash = HashValue(descriptor.image_info.imageLayout, hash);
+        hash = HashValue(descriptor.texel_buffer_view, hash);
+    }
+    return hash;
+}
+
+DescriptorSetCache::DescriptorSetCache()
+{
+}
+
+DescriptorSetCache::DescriptorSetCache(vkex::DescriptorPool pool, uint32_t max_idle_frames)
+{
+    SetPool(pool, max_idle_frames);
+}
+
+DescriptorSetCache::~DescriptorSetCache()
+{
+    if (m_pool != nullptr) {
+        m_pool->GetDevice()->RemoveDestroyListener(this);
+    }
+}
+
+void DescriptorSetCache::SetPool(vkex::DescriptorPool pool, uint32_t max_idle_frames)
+{
+    Clear();
+
+    if (m_pool != nullptr) {
+        m_pool->GetDevice()->RemoveDestroyListener(this);
+    }
+
+    if (pool != nullptr) {
+        VKEX_ASSERT_MSG(pool->GetCreateFlags().bits.free_descriptor_set, "DescriptorSetCache requires a pool created with free_descriptor_set");
+        pool->GetDevice()->AddDestroyListener(this);
+    }
+
+    m_pool            = pool;
+    m_max_idle_frames = max_idle_frames;
+}
+
+void DescriptorSetCache::OnDestroyBuffer(VkBuffer vk_buffer)
+{
+    EvictIf([vk_buffer](const Entry& entry) -> bool {
+        return ContainsIf(entry.descriptors, [vk_buffer](const vkex::BoundDescriptor& elem) -> bool { return elem.buffer_info.buffer == vk_buffer; });
+    });
+}
+
+void DescriptorSetCache::OnDestroyImageView(VkImageView vk_image_view)
+{
+    EvictIf([vk_image_view](const Entry& entry) -> bool {
+        return ContainsIf(entry.descriptors, [vk_image_view](const vkex::BoundDescriptor& elem) -> bool { return elem.image_info.imageView == vk_image_view; });
+    });
+}
+
+void DescriptorSetCache::OnDestroySampler(VkSampler vk_sampler)
+{
+    EvictIf([vk_sampler](const Entry& entry) -> bool {
+        return ContainsIf(entry.descriptors, [vk_sampler](const vkex::BoundDescriptor& elem) -> bool { return elem.image_info.sampler == vk_sampler; });
+    });
+}
+
+void DescriptorSetCache::OnDestroyDescriptorSetLayout(VkDescriptorSetLayout vk_descriptor_set_layout)
+{
+    EvictIf([vk_descriptor_set_layout](const Entry& entry) -> bool { return *(entry.layout) == vk_descriptor_set_layout; });
+}
+
+void DescriptorSetCache::Evict(EntryList::iterator it)
+{
+    auto range = m_lookup.equal_range(it->hash);
+    for (auto lookup_it = range.first; lookup_it != range.second; ++lookup_it) {
+        if (lookup_it->second == it) {
+            m_lookup.erase(lookup_it);
+            break;
+        }
+    }
+
+    m_pool->FreeDescriptorSet(it->descriptor_set);
+    m_entries.erase(it);
+}
+
+void DescriptorSetCache::NewFrame()
+{
+    ++m_frame_number;
+
+    // Entries are kept most recently used first, so aged out
+    // entries are always at the back of the list.
+    while (!m_entries.empty()) {
+        auto     it         = std::prev(std::end(m_entries));
+        uint64_t idle_count = m_frame_number - it->last_used_frame;
+        if (idle_count <= m_max_idle_frames) {
+            break;
+        }
+        Evict(it);
+    }
+}
+
+void DescriptorSetCache::Clear()
+{
+    if (m_pool != nullptr) {
+        for (auto& entry : m_entries) {
+            m_pool->FreeDescriptorSet(entry.descriptor_set);
+        }
+    }
+    m_entries.clear();
+    m_lookup.clear();
+}
+
+vkex::Result DescriptorSetCache::WriteDescriptors(
+    const std::vector<vkex::BoundDescriptor>& descriptors,
+    vkex::DescriptorSet                       descriptor_set)
+{
+    // Validated against the set's layout by the same path as
+    // CDescriptorSet::UpdateDescriptor
+    vkex::DescriptorWriter writer;
+    for (const auto& descriptor : descriptors) {
+        vkex::Result vkex_result = writer.Write(descriptor_set, descriptor);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    // Single update call for the whole set
+    writer.Flush();
+
+    return vkex::Result::Success;
+}
+
+vkex::Result DescriptorSetCache::GetDescriptorSet(
+    const vkex::DescriptorSetLayout    layout,
+    const vkex::DescriptorSetBindings& bindings,
+    vkex::DescriptorSet*               p_descriptor_set)
+{
+    if ((m_pool == nullptr) || (layout == nullptr) || (p_descriptor_set == nullptr)) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    const std::vector<vkex::BoundDescriptor>& descriptors = bindings.GetDescriptors();
+
+    VkDescriptorSetLayout vk_layout = *layout;
+    uint64_t              hash      = HashValue(vk_layout, bindings.GetHash());
+
+    // Lookup - compare contents to guard against hash collisions
+    auto range = m_lookup.equal_range(hash);
+    for (auto lookup_it = range.first; lookup_it != range.second; ++lookup_it) {
+        EntryList::iterator it = lookup_it->second;
+        if ((it->layout != layout) || (it->descriptors != descriptors)) {
+            continue;
+        }
+        // Move to front
+        it->last_used_frame = m_frame_number;
+        m_entries.splice(std::begin(m_entries), m_entries, it);
+        *p_descriptor_set = it->descriptor_set;
+        ++m_hit_count;
+        return vkex::Result::Success;
+    }
+
+    // Allocate and write a new set
+    vkex::DescriptorSetAllocateInfo allocate_info = {};
+    allocate_info.layouts.push_back(layout);
+    vkex::DescriptorSet descriptor_set = nullptr;
+    vkex::Result        vkex_result    = m_pool->AllocateDescriptorSet(allocate_info, &descriptor_set);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    vkex_result = WriteDescriptors(descriptors, descriptor_set);
+    if (!vkex_result) {
+        m_pool->FreeDescriptorSet(descriptor_set);
+        return vkex_result;
+    }
+
+    Entry entry           = {};
+    entry.hash            = hash;
+    entry.layout          = layout;
+    entry.descriptors     = descriptors;
+    entry.descriptor_set  = descriptor_set;
+    entry.last_used_frame = m_frame_number;
+    m_entries.push_front(std::move(entry));
+    m_lookup.insert(std::make_pair(hash, std::begin(m_entries)));
+
+    *p_descriptor_set = descriptor_set;
+    ++m_miss_count;
+
+    return vkex::Result::Success;
+}
+
 } // namespace vkex
\ No newline at end of file
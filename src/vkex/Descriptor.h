@@ -21,6 +21,9 @@
 #include "vkex/Traits.h"
 #include "vkex/VulkanUtil.h"
 
+#include <list>
+#include <unordered_map>
+
 namespace vkex {
 
 // =================================================================================================
@@ -29,11 +32,14 @@ namespace vkex {
 
 /** @struct DescriptorSetLayoutCreateInfo
  *
+ * binding_flags is optional. If it isn't empty it must have one entry
+ * per element in bindings.
  */
 struct DescriptorSetLayoutCreateInfo
 {
     vkex::DescriptorLayoutCreateFlags         flags;
     std::vector<VkDescriptorSetLayoutBinding> bindings;
+    std::vector<VkDescriptorBindingFlags>     binding_flags;
 };
 
 /** @class IDescriptorSetLayout
@@ -69,6 +75,14 @@ public:
         return m_create_info.bindings;
     }
 
+    /** @fn GetCreateFlags
+     *
+     */
+    vkex::DescriptorLayoutCreateFlags GetCreateFlags() const
+    {
+        return m_create_info.flags;
+    }
+
 private:
     friend class CDevice;
     friend class IObjectStorageFunctions;
@@ -86,9 +100,101 @@ private:
     vkex::Result InternalDestroy(const VkAllocationCallbacks* p_allocator);
 
 private:
-    vkex::DescriptorSetLayoutCreateInfo m_create_info    = {};
-    VkDescriptorSetLayoutCreateInfo     m_vk_create_info = {};
-    VkDescriptorSetLayout               m_vk_object      = VK_NULL_HANDLE;
+    vkex::DescriptorSetLayoutCreateInfo         m_create_info                  = {};
+    VkDescriptorSetLayoutBindingFlagsCreateInfo m_vk_binding_flags_create_info = {};
+    VkDescriptorSetLayoutCreateInfo             m_vk_create_info               = {};
+    VkDescriptorSetLayout                       m_vk_object                    = VK_NULL_HANDLE;
+};
+
+// =================================================================================================
+// DescriptorUpdateTemplate
+// =================================================================================================
+
+/** @struct DescriptorUpdateTemplateCreateInfo
+ *
+ * Entries are built from the reflected set, one per binding in ascending
+ * binding order. Each binding occupies descriptor_count consecutive
+ * elements in the packed data: VkDescriptorBufferInfo for buffers,
+ * VkDescriptorImageInfo for images and samplers, and VkBufferView for
+ * texel buffers.
+ */
+struct DescriptorUpdateTemplateCreateInfo
+{
+    vkex::DescriptorSetLayout  descriptor_set_layout;
+    vkex::ShaderInterface::Set set;
+};
+
+/** @class IDescriptorUpdateTemplate
+ *
+ */
+class CDescriptorUpdateTemplate : public IDeviceObject
+{
+public:
+    CDescriptorUpdateTemplate();
+    ~CDescriptorUpdateTemplate();
+
+    /** @fn operator VkDescriptorUpdateTemplate()
+     *
+     */
+    operator VkDescriptorUpdateTemplate() const
+    {
+        return m_vk_object;
+    }
+
+    /** @fn GetVkObject
+     *
+     */
+    VkDescriptorUpdateTemplate GetVkObject() const
+    {
+        return m_vk_object;
+    }
+
+    /** @fn GetDataSize
+     *
+     * Size in bytes of the packed data passed to UpdateDescriptors.
+     */
+    size_t GetDataSize() const
+    {
+        return m_data_size;
+    }
+
+    /** @fn GetEntryOffset
+     *
+     * Returns the byte offset of array element 0 of binding_number in the
+     * packed data, or UINT32_MAX if the template has no such binding.
+     */
+    uint32_t GetEntryOffset(uint32_t binding_number) const;
+
+    /** @fn GetEntries
+     *
+     */
+    const std::vector<VkDescriptorUpdateTemplateEntry>& GetEntries() const
+    {
+        return m_vk_entries;
+    }
+
+private:
+    friend class CDevice;
+    friend class IObjectStorageFunctions;
+
+    /** @fn InternalCreate
+     *
+     */
+    vkex::Result InternalCreate(
+        const vkex::DescriptorUpdateTemplateCreateInfo& create_info,
+        const VkAllocationCallbacks*                    p_allocator);
+
+    /** @fn InternalDestroy
+     *
+     */
+    vkex::Result InternalDestroy(const VkAllocationCallbacks* p_allocator);
+
+private:
+    vkex::DescriptorUpdateTemplateCreateInfo     m_create_info = {};
+    std::vector<VkDescriptorUpdateTemplateEntry> m_vk_entries;
+    size_t                                       m_data_size      = 0;
+    VkDescriptorUpdateTemplateCreateInfo         m_vk_create_info = {};
+    VkDescriptorUpdateTemplate                   m_vk_object      = VK_NULL_HANDLE;
 };
 
 // =================================================================================================
@@ -154,9 +260,17 @@ public:
      */
     vkex::Result UpdateDescriptor(uint32_t binding, const vkex::Sampler sampler, uint32_t array_element = 0);
 
+    /** @fn UpdateDescriptors
+     *
+     * Updates every binding in the template with a single call. p_data
+     * must be laid out as described by the template's entries.
+     */
+    void UpdateDescriptors(const vkex::DescriptorUpdateTemplate update_template, const void* p_data);
+
 private:
     friend class CDescriptorPool;
     friend class IObjectStorageFunctions;
+    friend class DescriptorWriter;
 
     /** @fn InternalCreate
      *
@@ -180,9 +294,35 @@ private:
      */
     const VkDescriptorSetLayoutBinding* FindDescriptorBinding(uint32_t binding) const;
 
+    /** @fn GetDescriptorInfo
+     *
+     * Checks that descriptor holds exactly the resources the binding's
+     * descriptor type is written from and that its array element is in
+     * range. p_info receives a copy with the image layout filled in if
+     * the caller left it undefined. All other overloads go through this
+     * one.
+     */
+    vkex::Result GetDescriptorInfo(const vkex::BoundDescriptor& descriptor, VkDescriptorType* p_descriptor_type, vkex::BoundDescriptor* p_info) const;
+
+    /** @fn GetDescriptorInfo
+     *
+     */
+    vkex::Result GetDescriptorInfo(uint32_t binding, uint32_t array_element, const vkex::Buffer buffer, VkDescriptorType* p_descriptor_type, VkDescriptorBufferInfo* p_info) const;
+
+    /** @fn GetDescriptorInfo
+     *
+     */
+    vkex::Result GetDescriptorInfo(uint32_t binding, uint32_t array_element, const vkex::Texture texture, VkDescriptorType* p_descriptor_type, VkDescriptorImageInfo* p_info) const;
+
+    /** @fn GetDescriptorInfo
+     *
+     */
+    vkex::Result GetDescriptorInfo(uint32_t binding, uint32_t array_element, const vkex::Sampler sampler, VkDescriptorType* p_descriptor_type, VkDescriptorImageInfo* p_info) const;
+
 private:
     vkex::DescriptorPool          m_pool        = nullptr;
     vkex::DescriptorSetCreateInfo m_create_info = {};
+    std::vector<uint32_t>         m_binding_indices; // Index into m_create_info.bindings by binding number
 };
 
 // =================================================================================================
@@ -235,6 +375,14 @@ public:
         return m_vk_object;
     }
 
+    /** @fn GetCreateFlags
+     *
+     */
+    vkex::DescriptorPoolCreateFlags GetCreateFlags() const
+    {
+        return m_create_info.flags;
+    }
+
     /** @fn AllocateDescriptorSets
      *
      */
@@ -273,6 +421,22 @@ public:
      */
     void FreeDescriptorSet(const vkex::DescriptorSet descriptor_set);
 
+    /** @fn Reset
+     *
+     * Returns all descriptor sets allocated from the pool with a single
+     * vkResetDescriptorPool call. Does not require the free_descriptor_set
+     * flag.
+     */
+    vkex::Result Reset();
+
+    /** @fn GetStoredSetCount
+     *
+     */
+    uint32_t GetStoredSetCount() const
+    {
+        return m_stored_descriptor_sets.GetCount();
+    }
+
 private:
     friend class CDevice;
     friend class IObjectStorageFunctions;
@@ -290,11 +454,450 @@ private:
     vkex::Result InternalDestroy(const VkAllocationCallbacks* p_allocator);
 
 private:
-    vkex::DescriptorPoolCreateInfo               m_create_info    = {};
-    VkDescriptorPoolCreateInfo                   m_vk_create_info = {};
-    std::vector<VkDescriptorPoolSize>            m_vk_descriptor_pool_sizes;
-    VkDescriptorPool                             m_vk_object = VK_NULL_HANDLE;
-    std::vector<std::unique_ptr<CDescriptorSet>> m_stored_descriptor_sets;
+    vkex::DescriptorPoolCreateInfo    m_create_info    = {};
+    VkDescriptorPoolCreateInfo        m_vk_create_info = {};
+    std::vector<VkDescriptorPoolSize> m_vk_descriptor_pool_sizes;
+    VkDescriptorPool                  m_vk_object = VK_NULL_HANDLE;
+    vkex::ObjectPool<CDescriptorSet>  m_stored_descriptor_sets;
+};
+
+// =================================================================================================
+// DescriptorPoolChain
+// =================================================================================================
+
+/** @struct DescriptorPoolChainCreateInfo
+ *
+ * Each shader interface defines a size class: the descriptors from
+ * ShaderInterface::GetDescriptorPoolSizes() and the sets needed to bind
+ * the shader once. Pools of a size class hold instances_per_pool of
+ * these. Sets are allocated from the smallest size class whose per-shader
+ * descriptor counts cover the set's layout.
+ */
+struct DescriptorPoolChainCreateInfo
+{
+    uint32_t                           frame_count;
+    std::vector<vkex::ShaderInterface> shader_interfaces;
+    uint32_t                           instances_per_pool = 64;
+};
+
+/** @class IDescriptorPoolChain
+ *
+ * Per-frame descriptor set allocator made of a growing list of descriptor
+ * pools. Allocations go to the current pool of the frame and a new pool
+ * is added when none of the frame's pools have room left. Sets are never
+ * freed individually: NewFrame() resets every pool the frame used, so it
+ * must only be called once the frame's fence has signaled. Sets returned
+ * from the chain are only valid until then.
+ */
+class CDescriptorPoolChain : public IDeviceObject
+{
+public:
+    CDescriptorPoolChain();
+    ~CDescriptorPoolChain();
+
+    /** @fn NewFrame
+     *
+     */
+    vkex::Result NewFrame(uint32_t frame_index);
+
+    /** @fn AllocateDescriptorSet
+     *
+     */
+    vkex::Result AllocateDescriptorSet(
+        const vkex::DescriptorSetLayout layout,
+        vkex::DescriptorSet*            p_descriptor_set);
+
+    /** @fn AllocateDescriptorSets
+     *
+     */
+    vkex::Result AllocateDescriptorSets(
+        const std::vector<vkex::DescriptorSetLayout>& layouts,
+        std::vector<vkex::DescriptorSet>*             p_descriptor_sets);
+
+    /** @fn GetPoolCount
+     *
+     * Total number of pools across all frames.
+     */
+    uint32_t GetPoolCount() const;
+
+private:
+    friend class CDevice;
+    friend class IObjectStorageFunctions;
+
+    struct PoolState
+    {
+        vkex::DescriptorPool      pool           = nullptr;
+        vkex::DescriptorPoolSizes remaining      = {};
+        uint32_t                  remaining_sets = 0;
+    };
+
+    struct SizeClass
+    {
+        vkex::DescriptorPoolSizes instance_sizes = {};
+        vkex::DescriptorPoolSizes pool_sizes     = {};
+        uint32_t                  max_sets       = 0;
+    };
+
+    struct PoolList
+    {
+        std::vector<PoolState> pools;
+        uint32_t               current_pool = 0;
+    };
+
+    struct FrameData
+    {
+        std::vector<PoolList> size_classes; // Indexed by size class
+    };
+
+    /** @fn InternalCreate
+     *
+     */
+    vkex::Result InternalCreate(
+        const vkex::DescriptorPoolChainCreateInfo& create_info,
+        const VkAllocationCallbacks*               p_allocator);
+
+    /** @fn InternalDestroy
+     *
+     */
+    vkex::Result InternalDestroy(const VkAllocationCallbacks* p_allocator);
+
+    /** @fn AddPool
+     *
+     */
+    vkex::Result AddPool(uint32_t size_class, PoolList* p_list);
+
+    /** @fn FindSizeClass
+     *
+     * Returns UINT32_MAX if no size class covers required.
+     */
+    uint32_t FindSizeClass(const vkex::DescriptorPoolSizes& required) const;
+
+    /** @fn HasRoom
+     *
+     */
+    static bool HasRoom(const PoolState& state, const vkex::DescriptorPoolSizes& required);
+
+    /** @fn Covers
+     *
+     */
+    static bool Covers(const vkex::DescriptorPoolSizes& sizes, const vkex::DescriptorPoolSizes& required);
+
+private:
+    vkex::DescriptorPoolChainCreateInfo m_create_info = {};
+    std::vector<SizeClass>              m_size_classes;
+    const VkAllocationCallbacks*        m_p_allocator = nullptr;
+    uint32_t                            m_frame_index = 0;
+    std::vector<FrameData>              m_frames;
+};
+
+// =================================================================================================
+// DescriptorWriter
+// =================================================================================================
+
+/** @class DescriptorWriter
+ *
+ * Collects descriptor writes across any number of descriptor sets and
+ * submits them with a single vkUpdateDescriptorSets call in Flush(). All
+ * sets written between flushes must belong to the same device. Resources
+ * are validated against the set's layout when the write is recorded.
+ */
+class DescriptorWriter
+{
+public:
+    DescriptorWriter();
+    ~DescriptorWriter();
+
+    /** @fn Write
+     *
+     */
+    vkex::Result Write(vkex::DescriptorSet descriptor_set, uint32_t binding, const vkex::Buffer buffer, uint32_t array_element = 0);
+
+    /** @fn Write
+     *
+     */
+    vkex::Result Write(vkex::DescriptorSet descriptor_set, uint32_t binding, const vkex::Texture texture, uint32_t array_element = 0);
+
+    /** @fn Write
+     *
+     */
+    vkex::Result Write(vkex::DescriptorSet descriptor_set, uint32_t binding, const vkex::Sampler sampler, uint32_t array_element = 0);
+
+    /** @fn Write
+     *
+     */
+    void Write(vkex::DescriptorSet descriptor_set, uint32_t binding, VkDescriptorType descriptor_type, uint32_t array_element, uint32_t count, const VkDescriptorBufferInfo* p_infos);
+
+    /** @fn Write
+     *
+     */
+    void Write(vkex::DescriptorSet descriptor_set, uint32_t binding, VkDescriptorType descriptor_type, uint32_t array_element, uint32_t count, const VkDescriptorImageInfo* p_infos);
+
+    /** @fn Write
+     *
+     */
+    void Write(vkex::DescriptorSet descriptor_set, uint32_t binding, VkDescriptorType descriptor_type, uint32_t array_element, uint32_t count, const VkBufferView* p_texel_buffer_views);
+
+    /** @fn Write
+     *
+     * Writes a descriptor recorded by DescriptorSetBindings.
+     */
+    vkex::Result Write(vkex::DescriptorSet descriptor_set, const vkex::BoundDescriptor& descriptor);
+
+    /** @fn GetWriteCount
+     *
+     */
+    uint32_t GetWriteCount() const
+    {
+        return CountU32(m_vk_writes);
+    }
+
+    /** @fn Flush
+     *
+     * Submits all pending writes and clears the writer.
+     */
+    void Flush();
+
+    /** @fn Clear
+     *
+     * Discards all pending writes.
+     */
+    void Clear();
+
+private:
+    // Info pointers are resolved in Flush() since the info
+    // vectors may reallocate while writes are being recorded.
+    enum InfoType
+    {
+        kBufferInfo,
+        kImageInfo,
+        kTexelBufferView,
+    };
+
+    struct PendingInfo
+    {
+        InfoType info_type;
+        size_t   first_index;
+    };
+
+    void SetDevice(vkex::DescriptorSet descriptor_set);
+
+private:
+    vkex::Device                        m_device = nullptr;
+    std::vector<VkWriteDescriptorSet>   m_vk_writes;
+    std::vector<PendingInfo>            m_pending_infos;
+    std::vector<VkDescriptorBufferInfo> m_buffer_infos;
+    std::vector<VkDescriptorImageInfo>  m_image_infos;
+    std::vector<VkBufferView>           m_texel_buffer_views;
+};
+
+// =================================================================================================
+// DescriptorSetCache
+// =================================================================================================
+
+/** @class DescriptorSetBindings
+ *
+ * List of resources bound to a descriptor set, kept sorted by binding
+ * number and array element so the same combination always produces the
+ * same hash regardless of the order it was built in.
+ */
+class DescriptorSetBindings
+{
+public:
+    DescriptorSetBindings();
+    ~DescriptorSetBindings();
+
+    /** @fn Bind
+     *
+     */
+    void Bind(uint32_t binding_number, const vkex::Buffer buffer, uint32_t array_element = 0);
+
+    /** @fn Bind
+     *
+     */
+    void Bind(uint32_t binding_number, const vkex::Buffer buffer, VkDeviceSize offset, VkDeviceSize range, uint32_t array_element = 0);
+
+    /** @fn Bind
+     *
+     * The image layout defaults to the one the binding's descriptor type
+     * is normally used in.
+     */
+    void Bind(uint32_t binding_number, const vkex::Texture texture, uint32_t array_element = 0);
+
+    /** @fn Bind
+     *
+     */
+    void Bind(uint32_t binding_number, const vkex::Texture texture, VkImageLayout image_layout, uint32_t array_element = 0);
+
+    /** @fn Bind
+     *
+     * For combined image sampler bindings.
+     */
+    void Bind(uint32_t binding_number, const vkex::Texture texture, const vkex::Sampler sampler, uint32_t array_element = 0);
+
+    /** @fn Bind
+     *
+     */
+    void Bind(uint32_t binding_number, const vkex::Sampler sampler, uint32_t array_element = 0);
+
+    /** @fn Bind
+     *
+     * For uniform and storage texel buffer bindings.
+     */
+    void Bind(uint32_t binding_number, VkBufferView texel_buffer_view, uint32_t array_element = 0);
+
+    /** @fn Clear
+     *
+     */
+    void Clear();
+
+    /** @fn GetDescriptors
+     *
+     */
+    const std::vector<vkex::BoundDescriptor>& GetDescriptors() const
+    {
+        return m_descriptors;
+    }
+
+    /** @fn GetHash
+     *
+     */
+    uint64_t GetHash() const;
+
+private:
+    void Bind(const vkex::BoundDescriptor& descriptor);
+
+private:
+    std::vector<vkex::BoundDescriptor> m_descriptors;
+};
+
+/** @class DescriptorSetCache
+ *
+ * Reuses descriptor sets allocated from a descriptor pool by keying them
+ * on (layout, bound resources). A lookup that hits returns the existing
+ * set without touching any descriptors. A miss allocates a set from the
+ * pool and writes all of its descriptors in a single update call.
+ *
+ * Sets that have not been returned by a lookup for more than
+ * max_idle_frames calls to NewFrame() are freed back to the pool. This
+ * value must be larger than the number of frames in flight, since a set
+ * may still be referenced by a command buffer that is executing.
+ *
+ * The pool must be created with the free_descriptor_set flag. Cached
+ * sets are not freed on destruction since the pool may already be gone;
+ * call Clear() first if the pool outlives the cache.
+ *
+ * Entries are keyed by Vulkan handles, which the driver may reuse once
+ * an object is destroyed. The cache listens to the pool's device and
+ * evicts every set that references a buffer, image view, sampler or
+ * layout as it is destroyed, so those objects must be destroyed on the
+ * thread that uses the cache.
+ */
+class DescriptorSetCache : private vkex::ObjectDestroyListener
+{
+public:
+    static const uint32_t kDefaultMaxIdleFrames = 4;
+
+    DescriptorSetCache();
+    DescriptorSetCache(vkex::DescriptorPool pool, uint32_t max_idle_frames = kDefaultMaxIdleFrames);
+    ~DescriptorSetCache();
+
+    DescriptorSetCache(const DescriptorSetCache&)            = delete;
+    DescriptorSetCache& operator=(const DescriptorSetCache&) = delete;
+
+    /** @fn SetPool
+     *
+     * Frees all cached sets to the current pool before switching.
+     */
+    void SetPool(vkex::DescriptorPool pool, uint32_t max_idle_frames = kDefaultMaxIdleFrames);
+
+    /** @fn NewFrame
+     *
+     * Advances the frame counter and frees sets that have aged out.
+     */
+    void NewFrame();
+
+    /** @fn GetDescriptorSet
+     *
+     */
+    vkex::Result GetDescriptorSet(
+        const vkex::DescriptorSetLayout    layout,
+        const vkex::DescriptorSetBindings& bindings,
+        vkex::DescriptorSet*               p_descriptor_set);
+
+    /** @fn Clear
+     *
+     * Frees all cached sets back to the pool. The caller must make sure
+     * none of them are still in use by the GPU.
+     */
+    void Clear();
+
+    /** @fn GetSetCount
+     *
+     */
+    uint32_t GetSetCount() const
+    {
+        return static_cast<uint32_t>(m_entries.size());
+    }
+
+    /** @fn GetHitCount
+     *
+     */
+    uint64_t GetHitCount() const
+    {
+        return m_hit_count;
+    }
+
+    /** @fn GetMissCount
+     *
+     */
+    uint64_t GetMissCount() const
+    {
+        return m_miss_count;
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t                           hash            = 0;
+        vkex::DescriptorSetLayout          layout          = nullptr;
+        std::vector<vkex::BoundDescriptor> descriptors;
+        vkex::DescriptorSet                descriptor_set  = nullptr;
+        uint64_t                           last_used_frame = 0;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    vkex::Result WriteDescriptors(
+        const std::vector<vkex::BoundDescriptor>& descriptors,
+        vkex::DescriptorSet                       descriptor_set);
+
+    void Evict(EntryList::iterator it);
+
+    template <typename PredT>
+    void EvictIf(PredT pred)
+    {
+        for (auto it = std::begin(m_entries); it != std::end(m_entries);) {
+            auto next = std::next(it);
+            if (pred(*it)) {
+                Evict(it);
+            }
+            it = next;
+        }
+    }
+
+    virtual void OnDestroyBuffer(VkBuffer vk_buffer) override;
+    virtual void OnDestroyImageView(VkImageView vk_image_view) override;
+    virtual void OnDestroySampler(VkSampler vk_sampler) override;
+    virtual void OnDestroyDescriptorSetLayout(VkDescriptorSetLayout vk_descriptor_set_layout) override;
+
+private:
+    vkex::DescriptorPool                                   m_pool            = nullptr;
+    uint32_t                                               m_max_idle_frames = kDefaultMaxIdleFrames;
+    uint64_t                                               m_frame_number    = 0;
+    uint64_t                                               m_hit_count       = 0;
+    uint64_t                                               m_miss_count      = 0;
+    EntryList                                              m_entries;
+    std::unordered_multimap<uint64_t, EntryList::iterator> m_lookup;
 };
 
 } // namespace vkex
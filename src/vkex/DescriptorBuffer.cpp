@@ -0,0 +1,375 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#include "vkex/DescriptorBuffer.h"
+#include "vkex/Device.h"
+#include "vkex/ToString.h"
+
+namespace vkex {
+
+// =================================================================================================
+// DescriptorBufferHeap
+// =================================================================================================
+CDescriptorBufferHeap::CDescriptorBufferHeap()
+{
+}
+
+CDescriptorBufferHeap::~CDescriptorBufferHeap()
+{
+}
+
+vkex::Result CDescriptorBufferHeap::CreateRegionBuffer(
+    VkDeviceSize                 frame_size,
+    bool                         is_sampler,
+    const VkAllocationCallbacks* p_allocator,
+    Region*                      p_region)
+{
+    // Resource buffers also get the sampler usage so that layouts
+    // that mix samplers and resources can be placed in them.
+    vkex::BufferCreateInfo create_info                      = {};
+    create_info.size                                        = frame_size * m_create_info.frame_count;
+    create_info.usage_flags.bits.shader_device_address      = true;
+    create_info.usage_flags.bits.resource_descriptor_buffer = !is_sampler;
+    create_info.usage_flags.bits.sampler_descriptor_buffer  = true;
+    create_info.committed                                   = true;
+    create_info.memory_usage                                = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    vkex::Result vkex_result                                = GetDevice()->CreateBuffer(create_info, &p_region->buffer, p_allocator);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    VkResult vk_result = InvalidValue<VkResult>::Value;
+    VKEX_VULKAN_RESULT_CALL(
+        vk_result,
+        p_region->buffer->MapMemory(reinterpret_cast<void**>(&p_region->p_mapped)));
+    if (vk_result != VK_SUCCESS) {
+        return vkex::Result(vk_result);
+    }
+
+    p_region->frame_size   = frame_size;
+    p_region->frame_offset = 0;
+    p_region->frame_cursor = 0;
+
+    VkDescriptorBufferBindingInfoEXT vk_binding_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT};
+    vk_binding_info.address                          = p_region->buffer->GetDeviceAddress();
+    vk_binding_info.usage                            = p_region->buffer->GetUsageFlags().flags;
+    m_vk_binding_infos.push_back(vk_binding_info);
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorBufferHeap::InternalCreate(
+    const vkex::DescriptorBufferHeapCreateInfo& create_info,
+    const VkAllocationCallbacks*                p_allocator)
+{
+    // Copy create info
+    m_create_info = create_info;
+
+    if ((m_create_info.frame_count == 0) || (m_create_info.resource_size == 0)) {
+        return vkex::Result::ErrorBufferSizeMustBeGreaterThanZero;
+    }
+
+    m_alignment = GetDevice()->GetDescriptorBufferProperties().descriptorBufferOffsetAlignment;
+
+    // Resource buffer - always buffer index 0
+    {
+        VkDeviceSize frame_size  = RoundUp<VkDeviceSize>(m_create_info.resource_size, m_alignment);
+        vkex::Result vkex_result = CreateRegionBuffer(frame_size, false, p_allocator, &m_resource_region);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    // Sampler buffer - buffer index 1 if present
+    if (m_create_info.sampler_size > 0) {
+        VkDeviceSize frame_size  = RoundUp<VkDeviceSize>(m_create_info.sampler_size, m_alignment);
+        vkex::Result vkex_result = CreateRegionBuffer(frame_size, true, p_allocator, &m_sampler_region);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    GetDevice()->AddDestroyListener(this);
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorBufferHeap::InternalDestroy(const VkAllocationCallbacks* p_allocator)
+{
+    GetDevice()->RemoveDestroyListener(this);
+
+    if (m_sampler_region.buffer != nullptr) {
+        vkex::Result vkex_result = GetDevice()->DestroyBuffer(m_sampler_region.buffer, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        m_sampler_region = {};
+    }
+
+    if (m_resource_region.buffer != nullptr) {
+        vkex::Result vkex_result = GetDevice()->DestroyBuffer(m_resource_region.buffer, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        m_resource_region = {};
+    }
+
+    m_vk_binding_infos.clear();
+    m_layout_infos.clear();
+
+    return vkex::Result::Success;
+}
+
+void CDescriptorBufferHeap::NewFrame(uint32_t frame_index)
+{
+    VKEX_ASSERT_MSG((frame_index < m_create_info.frame_count), "Frame index exceeds descriptor buffer heap frame count");
+
+    m_resource_region.frame_offset = m_resource_region.frame_size * frame_index;
+    m_resource_region.frame_cursor = 0;
+    m_sampler_region.frame_offset  = m_sampler_region.frame_size * frame_index;
+    m_sampler_region.frame_cursor  = 0;
+}
+
+size_t CDescriptorBufferHeap::GetDescriptorSize(VkDescriptorType descriptor_type) const
+{
+    const VkPhysicalDeviceDescriptorBufferPropertiesEXT& properties = GetDevice()->GetDescriptorBufferProperties();
+
+    size_t size = 0;
+    switch (descriptor_type) {
+        default: break;
+        case VK_DESCRIPTOR_TYPE_SAMPLER: size = properties.samplerDescriptorSize; break;
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: size = properties.combinedImageSamplerDescriptorSize; break;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE: size = properties.sampledImageDescriptorSize; break;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: size = properties.storageImageDescriptorSize; break;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER: size = properties.uniformTexelBufferDescriptorSize; break;
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER: size = properties.storageTexelBufferDescriptorSize; break;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER: size = properties.uniformBufferDescriptorSize; break;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: size = properties.storageBufferDescriptorSize; break;
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT: size = properties.inputAttachmentDescriptorSize; break;
+        case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR: size = properties.accelerationStructureDescriptorSize; break;
+    }
+    return size;
+}
+
+void CDescriptorBufferHeap::OnDestroyDescriptorSetLayout(VkDescriptorSetLayout vk_descriptor_set_layout)
+{
+    m_layout_infos.erase(vk_descriptor_set_layout);
+}
+
+const CDescriptorBufferHeap::LayoutInfo& CDescriptorBufferHeap::GetLayoutInfo(const vkex::DescriptorSetLayout layout)
+{
+    VkDescriptorSetLayout vk_layout = *layout;
+
+    auto it = m_layout_infos.find(vk_layout);
+    if (it != m_layout_infos.end()) {
+        return it->second;
+    }
+
+    // Query size and binding offsets once per layout
+    LayoutInfo info = {};
+    vkex::GetDescriptorSetLayoutSizeEXT(*m_device, vk_layout, &info.size);
+
+    const std::vector<VkDescriptorSetLayoutBinding>& bindings = layout->GetBindings();
+
+    uint32_t max_binding = 0;
+    for (auto& binding : bindings) {
+        max_binding = std::max(max_binding, binding.binding);
+    }
+    info.descriptor_types.assign(bindings.empty() ? 0 : (max_binding + 1), InvalidValue<VkDescriptorType>::Value);
+    info.descriptor_counts.assign(bindings.empty() ? 0 : (max_binding + 1), 0);
+    info.binding_offsets.assign(bindings.empty() ? 0 : (max_binding + 1), 0);
+
+    info.sampler_only = !bindings.empty();
+    for (auto& binding : bindings) {
+        info.descriptor_types[binding.binding]  = binding.descriptorType;
+        info.descriptor_counts[binding.binding] = binding.descriptorCount;
+        vkex::GetDescriptorSetLayoutBindingOffsetEXT(*m_device, vk_layout, binding.binding, &info.binding_offsets[binding.binding]);
+        info.sampler_only = info.sampler_only && (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER);
+    }
+
+    auto result = m_layout_infos.insert(std::make_pair(vk_layout, std::move(info)));
+    return result.first->second;
+}
+
+vkex::Result CDescriptorBufferHeap::AllocateSet(
+    const vkex::DescriptorSetLayout   layout,
+    vkex::DescriptorBufferAllocation* p_allocation)
+{
+    if ((layout == nullptr) || (p_allocation == nullptr)) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    const LayoutInfo& info = GetLayoutInfo(layout);
+
+    bool     use_sampler  = info.sampler_only && (m_sampler_region.buffer != nullptr);
+    Region&  region       = use_sampler ? m_sampler_region : m_resource_region;
+    uint32_t buffer_index = use_sampler ? kSamplerBufferIndex : kResourceBufferIndex;
+
+    VkDeviceSize offset = RoundUp<VkDeviceSize>(region.frame_cursor, m_alignment);
+    if ((offset + info.size) > region.frame_size) {
+        return vkex::Result::ErrorOutOfRange;
+    }
+    region.frame_cursor = offset + info.size;
+
+    p_allocation->layout       = layout;
+    p_allocation->buffer_index = buffer_index;
+    p_allocation->offset       = region.frame_offset + offset;
+    p_allocation->p_mapped     = region.p_mapped + p_allocation->offset;
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorBufferHeap::AllocateSet(
+    const vkex::DescriptorSetLayout    layout,
+    const vkex::DescriptorSetBindings& bindings,
+    vkex::DescriptorBufferAllocation*  p_allocation)
+{
+    vkex::Result vkex_result = AllocateSet(layout, p_allocation);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    vkex_result = WriteDescriptors(*p_allocation, bindings);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorBufferHeap::WriteBoundDescriptor(
+    const vkex::DescriptorBufferAllocation& allocation,
+    const vkex::BoundDescriptor&            descriptor)
+{
+    const LayoutInfo& info = GetLayoutInfo(allocation.layout);
+
+    uint32_t binding = descriptor.binding_number;
+    if ((binding >= CountU32(info.descriptor_types)) || (info.descriptor_types[binding] == InvalidValue<VkDescriptorType>::Value)) {
+        return vkex::Result::ErrorInvalidDescriptorBinding;
+    }
+    // Descriptors are written straight into mapped memory, an element
+    // past the binding would land in the next binding or allocation
+    if (descriptor.array_element >= info.descriptor_counts[binding]) {
+        return vkex::Result::ErrorInvalidDescriptorBinding;
+    }
+
+    VkDescriptorType           descriptor_type = info.descriptor_types[binding];
+    VkDescriptorGetInfoEXT     vk_get_info     = {VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT};
+    VkDescriptorAddressInfoEXT vk_address_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT};
+    VkDescriptorImageInfo      vk_image_info   = descriptor.image_info;
+    VkSampler                  vk_sampler      = descriptor.image_info.sampler;
+    vk_get_info.type                           = descriptor_type;
+
+    switch (descriptor_type) {
+        default: {
+            return vkex::Result::ErrorInvalidDescriptorType;
+        } break;
+
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: {
+            if (descriptor.buffer_info.buffer == VK_NULL_HANDLE) {
+                return vkex::Result::ErrorInvalidDescriptorType;
+            }
+
+            VkBufferDeviceAddressInfo vk_buffer_address_info = {VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO};
+            vk_buffer_address_info.buffer                    = descriptor.buffer_info.buffer;
+
+            vk_address_info.address = vkGetBufferDeviceAddress(*m_device, &vk_buffer_address_info) + descriptor.buffer_info.offset;
+            vk_address_info.range   = descriptor.buffer_info.range;
+            vk_address_info.format  = VK_FORMAT_UNDEFINED;
+
+            if (descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+                vk_get_info.data.pUniformBuffer = &vk_address_info;
+            }
+            else {
+                vk_get_info.data.pStorageBuffer = &vk_address_info;
+            }
+        } break;
+
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: {
+            if (descriptor.image_info.imageView == VK_NULL_HANDLE) {
+                return vkex::Result::ErrorInvalidDescriptorType;
+            }
+
+            if (descriptor_type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE) {
+                vk_image_info.imageLayout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                vk_get_info.data.pSampledImage = &vk_image_info;
+            }
+            else {
+                vk_image_info.imageLayout      = VK_IMAGE_LAYOUT_GENERAL;
+                vk_get_info.data.pStorageImage = &vk_image_info;
+            }
+        } break;
+
+        case VK_DESCRIPTOR_TYPE_SAMPLER: {
+            if (vk_sampler == VK_NULL_HANDLE) {
+                return vkex::Result::ErrorInvalidDescriptorType;
+            }
+            vk_get_info.data.pSampler = &vk_sampler;
+        } break;
+    }
+
+    size_t   descriptor_size = GetDescriptorSize(descriptor_type);
+    uint8_t* p_dst           = allocation.p_mapped + info.binding_offsets[binding] + (descriptor.array_element * descriptor_size);
+    vkex::GetDescriptorEXT(*m_device, &vk_get_info, descriptor_size, p_dst);
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorBufferHeap::WriteDescriptors(
+    const vkex::DescriptorBufferAllocation& allocation,
+    const vkex::DescriptorSetBindings&      bindings)
+{
+    for (auto& descriptor : bindings.GetDescriptors()) {
+        vkex::Result vkex_result = WriteBoundDescriptor(allocation, descriptor);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+    return vkex::Result::Success;
+}
+
+vkex::Result CDescriptorBufferHeap::WriteDescriptor(const vkex::DescriptorBufferAllocation& allocation, uint32_t binding, const vkex::Buffer buffer, uint32_t array_element)
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding;
+    descriptor.array_element         = array_element;
+    descriptor.buffer_info.buffer    = *buffer;
+    descriptor.buffer_info.offset    = 0;
+    descriptor.buffer_info.range     = buffer->GetSize();
+    return WriteBoundDescriptor(allocation, descriptor);
+}
+
+vkex::Result CDescriptorBufferHeap::WriteDescriptor(const vkex::DescriptorBufferAllocation& allocation, uint32_t binding, const vkex::Texture texture, uint32_t array_element)
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding;
+    descriptor.array_element         = array_element;
+    descriptor.image_info.imageView  = *(texture->GetImageView());
+    return WriteBoundDescriptor(allocation, descriptor);
+}
+
+vkex::Result CDescriptorBufferHeap::WriteDescriptor(const vkex::DescriptorBufferAllocation& allocation, uint32_t binding, const vkex::Sampler sampler, uint32_t array_element)
+{
+    vkex::BoundDescriptor descriptor = {};
+    descriptor.binding_number        = binding;
+    descriptor.array_element         = array_element;
+    descriptor.image_info.sampler    = *sampler;
+    return WriteBoundDescriptor(allocation, descriptor);
+}
+
+} // namespace vkex
\ No newline at end of file
@@ -0,0 +1,226 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#ifndef __VKEX_DESCRIPTOR_BUFFER_H__
+#define __VKEX_DESCRIPTOR_BUFFER_H__
+
+#include "vkex/Config.h"
+#include "vkex/Descriptor.h"
+#include "vkex/Traits.h"
+#include "vkex/VulkanUtil.h"
+
+#include <unordered_map>
+
+namespace vkex {
+
+// =================================================================================================
+// DescriptorBufferHeap
+// =================================================================================================
+
+/** @struct DescriptorBufferHeapCreateInfo
+ *
+ * Sizes are per frame. The heap creates one resource descriptor buffer
+ * and, if sampler_size is non-zero, one sampler descriptor buffer, each
+ * holding frame_count regions.
+ */
+struct DescriptorBufferHeapCreateInfo
+{
+    uint32_t     frame_count;
+    VkDeviceSize resource_size;
+    VkDeviceSize sampler_size;
+};
+
+/** @struct DescriptorBufferAllocation
+ *
+ * Location of one descriptor set's worth of descriptors. buffer_index is
+ * the index of the buffer as bound by CmdBindDescriptorBuffers and offset
+ * is relative to the start of that buffer.
+ */
+struct DescriptorBufferAllocation
+{
+    vkex::DescriptorSetLayout layout       = nullptr;
+    uint32_t                  buffer_index = 0;
+    VkDeviceSize              offset       = 0;
+    uint8_t*                  p_mapped     = nullptr;
+};
+
+/** @class IDescriptorBufferHeap
+ *
+ * Per-frame linear allocator over descriptor buffers. Call NewFrame()
+ * once the frame's previous use has completed on the GPU to reset that
+ * frame's region, then allocate and write descriptor sets for the frame.
+ * Sets whose layouts only contain samplers are placed in the sampler
+ * buffer when there is one, everything else goes into the resource
+ * buffer.
+ *
+ * Layout sizes and offsets are cached by VkDescriptorSetLayout and
+ * dropped when the device destroys the layout, since the driver may
+ * reuse the handle.
+ */
+class CDescriptorBufferHeap : public IDeviceObject, private vkex::ObjectDestroyListener
+{
+public:
+    enum
+    {
+        kResourceBufferIndex = 0,
+        kSamplerBufferIndex  = 1,
+    };
+
+    CDescriptorBufferHeap();
+    ~CDescriptorBufferHeap();
+
+    /** @fn GetResourceBuffer
+     *
+     */
+    vkex::Buffer GetResourceBuffer() const
+    {
+        return m_resource_region.buffer;
+    }
+
+    /** @fn GetSamplerBuffer
+     *
+     */
+    vkex::Buffer GetSamplerBuffer() const
+    {
+        return m_sampler_region.buffer;
+    }
+
+    /** @fn GetBindingInfos
+     *
+     * Binding infos in buffer index order, for CmdBindDescriptorBuffersEXT.
+     */
+    const std::vector<VkDescriptorBufferBindingInfoEXT>& GetBindingInfos() const
+    {
+        return m_vk_binding_infos;
+    }
+
+    /** @fn NewFrame
+     *
+     */
+    void NewFrame(uint32_t frame_index);
+
+    /** @fn AllocateSet
+     *
+     */
+    vkex::Result AllocateSet(
+        const vkex::DescriptorSetLayout   layout,
+        vkex::DescriptorBufferAllocation* p_allocation);
+
+    /** @fn AllocateSet
+     *
+     * Allocates and writes all descriptors in bindings.
+     */
+    vkex::Result AllocateSet(
+        const vkex::DescriptorSetLayout    layout,
+        const vkex::DescriptorSetBindings& bindings,
+        vkex::DescriptorBufferAllocation*  p_allocation);
+
+    /** @fn WriteDescriptors
+     *
+     */
+    vkex::Result WriteDescriptors(
+        const vkex::DescriptorBufferAllocation& allocation,
+        const vkex::DescriptorSetBindings&      bindings);
+
+    /** @fn WriteDescriptor
+     *
+     */
+    vkex::Result WriteDescriptor(const vkex::DescriptorBufferAllocation& allocation, uint32_t binding, const vkex::Buffer buffer, uint32_t array_element = 0);
+
+    /** @fn WriteDescriptor
+     *
+     */
+    vkex::Result WriteDescriptor(const vkex::DescriptorBufferAllocation& allocation, uint32_t binding, const vkex::Texture texture, uint32_t array_element = 0);
+
+    /** @fn WriteDescriptor
+     *
+     */
+    vkex::Result WriteDescriptor(const vkex::DescriptorBufferAllocation& allocation, uint32_t binding, const vkex::Sampler sampler, uint32_t array_element = 0);
+
+private:
+    friend class CDevice;
+    friend class IObjectStorageFunctions;
+
+    struct LayoutInfo
+    {
+        VkDeviceSize                  size         = 0;
+        bool                          sampler_only = false;
+        std::vector<VkDescriptorType> descriptor_types;  // Indexed by binding number
+        std::vector<uint32_t>         descriptor_counts; // Indexed by binding number
+        std::vector<VkDeviceSize>     binding_offsets;   // Indexed by binding number
+    };
+
+    struct Region
+    {
+        vkex::Buffer buffer       = nullptr;
+        uint8_t*     p_mapped     = nullptr;
+        VkDeviceSize frame_size   = 0;
+        VkDeviceSize frame_offset = 0;
+        VkDeviceSize frame_cursor = 0;
+    };
+
+    /** @fn InternalCreate
+     *
+     */
+    vkex::Result InternalCreate(
+        const vkex::DescriptorBufferHeapCreateInfo& create_info,
+        const VkAllocationCallbacks*                p_allocator);
+
+    /** @fn InternalDestroy
+     *
+     */
+    vkex::Result InternalDestroy(const VkAllocationCallbacks* p_allocator);
+
+    /** @fn CreateRegionBuffer
+     *
+     */
+    vkex::Result CreateRegionBuffer(
+        VkDeviceSize                 frame_size,
+        bool                         is_sampler,
+        const VkAllocationCallbacks* p_allocator,
+        Region*                      p_region);
+
+    /** @fn GetLayoutInfo
+     *
+     */
+    const LayoutInfo& GetLayoutInfo(const vkex::DescriptorSetLayout layout);
+
+    /** @fn GetDescriptorSize
+     *
+     */
+    size_t GetDescriptorSize(VkDescriptorType descriptor_type) const;
+
+    /** @fn WriteBoundDescriptor
+     *
+     */
+    vkex::Result WriteBoundDescriptor(
+        const vkex::DescriptorBufferAllocation& allocation,
+        const vkex::BoundDescriptor&            descriptor);
+
+    virtual void OnDestroyDescriptorSetLayout(VkDescriptorSetLayout vk_descriptor_set_layout) override;
+
+private:
+    vkex::DescriptorBufferHeapCreateInfo                  m_create_info     = {};
+    VkDeviceSize                                          m_alignment       = 0;
+    Region                                                m_resource_region = {};
+    Region                                                m_sampler_region  = {};
+    std::vector<VkDescriptorBufferBindingInfoEXT>         m_vk_binding_infos;
+    std::unordered_map<VkDescriptorSetLayout, LayoutInfo> m_layout_infos;
+};
+
+} // namespace vkex
+
+#endif // __VKEX_DESCRIPTOR_BUFFER_H__
\ No newline at end of file
@@ -15,6 +15,7 @@
 */
 
 #include "vkex/Device.h"
+#include "vkex/CpuProfiler.h"
 #include "vkex/Instance.h"
 #include "vkex/Log.h"
 
@@ -24,6 +25,7 @@
 #include "vk_mem_alloc.h"
 
 #include <map>
+#include <tuple>
 
 namespace vkex {
 
@@ -41,21 +43,29 @@ PFN_vkGetImageViewOpaqueCaptureDescriptorDataEXT             GetImageViewOpaqueC
 PFN_vkGetSamplerOpaqueCaptureDescriptorDataEXT               GetSamplerOpaqueCaptureDescriptorDataEXT               = nullptr;
 PFN_vkGetAccelerationStructureOpaqueCaptureDescriptorDataEXT GetAccelerationStructureOpaqueCaptureDescriptorDataEXT = nullptr;
 
+PFN_vkCmdSetColorBlendEnableEXT   CmdSetColorBlendEnableEXT   = nullptr;
+PFN_vkCmdSetColorBlendEquationEXT CmdSetColorBlendEquationEXT = nullptr;
+PFN_vkCmdSetColorWriteMaskEXT     CmdSetColorWriteMaskEXT     = nullptr;
+
+PFN_vkResetQueryPoolEXT ResetQueryPoolEXT = nullptr;
+
 static void WireUpPNexts(vkex::PhysicalDeviceFeatures& features)
 {
-    features.bufferDeviceAddress.pNext       = nullptr;
-    features.descriptorIndexing.pNext        = &features.bufferDeviceAddress;
-    features.ext.depthClampZeroOne.pNext     = &features.descriptorIndexing;
-    features.ext.depthClipControl.pNext      = &features.ext.depthClampZeroOne;
-    features.ext.depthClipEnable.pNext       = &features.ext.depthClipControl;
-    features.ext.descriptorBuffer.pNext      = &features.ext.depthClipEnable;
-    features.ext.extendedDynamicState3.pNext = &features.ext.descriptorBuffer;
-    features.khr.dynamicRendering.pNext      = &features.ext.extendedDynamicState3;
-    features.khr.synchronization2.pNext      = &features.khr.dynamicRendering;
-    features.khr.timelineSemaphore.pNext     = &features.khr.synchronization2;
-    features.khr.rayTracingPipeline.pNext    = &features.khr.timelineSemaphore;
-    features.khr.accelerationStructure.pNext = &features.khr.rayTracingPipeline;
-    features.pFirst                          = &features.khr.accelerationStructure;
+    features.hostQueryReset.pNext              = nullptr;
+    features.bufferDeviceAddress.pNext         = &features.hostQueryReset;
+    features.descriptorIndexing.pNext          = &features.bufferDeviceAddress;
+    features.ext.depthClampZeroOne.pNext       = &features.descriptorIndexing;
+    features.ext.depthClipControl.pNext        = &features.ext.depthClampZeroOne;
+    features.ext.depthClipEnable.pNext         = &features.ext.depthClipControl;
+    features.ext.descriptorBuffer.pNext        = &features.ext.depthClipEnable;
+    features.ext.extendedDynamicState3.pNext   = &features.ext.descriptorBuffer;
+    features.ext.graphicsPipelineLibrary.pNext = &features.ext.extendedDynamicState3;
+    features.khr.dynamicRendering.pNext        = &features.ext.graphicsPipelineLibrary;
+    features.khr.synchronization2.pNext        = &features.khr.dynamicRendering;
+    features.khr.timelineSemaphore.pNext       = &features.khr.synchronization2;
+    features.khr.rayTracingPipeline.pNext      = &features.khr.timelineSemaphore;
+    features.khr.accelerationStructure.pNext   = &features.khr.rayTracingPipeline;
+    features.pFirst                            = &features.khr.accelerationStructure;
 }
 
 static void WireUpPNexts(vkex::PhysicalDeviceProperties& properties)
@@ -68,19 +78,21 @@ static void WireUpPNexts(vkex::PhysicalDeviceProperties& properties)
 
 static void ClearPNext(vkex::PhysicalDeviceFeatures& features)
 {
-    features.bufferDeviceAddress.pNext       = nullptr;
-    features.descriptorIndexing.pNext        = nullptr;
-    features.ext.depthClampZeroOne.pNext     = nullptr;
-    features.ext.depthClipControl.pNext      = nullptr;
-    features.ext.depthClipEnable.pNext       = nullptr;
-    features.ext.descriptorBuffer.pNext      = nullptr;
-    features.ext.extendedDynamicState3.pNext = nullptr;
-    features.khr.dynamicRendering.pNext      = nullptr;
-    features.khr.synchronization2.pNext      = nullptr;
-    features.khr.timelineSemaphore.pNext     = nullptr;
-    features.khr.rayTracingPipeline.pNext    = nullptr;
-    features.khr.accelerationStructure.pNext = nullptr;
-    features.pFirst                          = nullptr;
+    features.bufferDeviceAddress.pNext         = nullptr;
+    features.descriptorIndexing.pNext          = nullptr;
+    features.hostQueryReset.pNext              = nullptr;
+    features.ext.depthClampZeroOne.pNext       = nullptr;
+    features.ext.depthClipControl.pNext        = nullptr;
+    features.ext.depthClipEnable.pNext         = nullptr;
+    features.ext.descriptorBuffer.pNext        = nullptr;
+    features.ext.extendedDynamicState3.pNext   = nullptr;
+    features.ext.graphicsPipelineLibrary.pNext = nullptr;
+    features.khr.dynamicRendering.pNext        = nullptr;
+    features.khr.synchronization2.pNext        = nullptr;
+    features.khr.timelineSemaphore.pNext       = nullptr;
+    features.khr.rayTracingPipeline.pNext      = nullptr;
+    features.khr.accelerationStructure.pNext   = nullptr;
+    features.pFirst                            = nullptr;
 }
 
 static void ClearPNext(vkex::PhysicalDeviceProperties& properties)
@@ -92,18 +104,20 @@ static void ClearPNext(vkex::PhysicalDeviceProperties& properties)
 
 static void SetStructureTypes(vkex::PhysicalDeviceFeatures& features)
 {
-    features.bufferDeviceAddress.sType       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-    features.descriptorIndexing.sType        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
-    features.ext.depthClampZeroOne.sType     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLAMP_ZERO_ONE_FEATURES_EXT;
-    features.ext.depthClipControl.sType      = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_CONTROL_FEATURES_EXT;
-    features.ext.depthClipEnable.sType       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_ENABLE_FEATURES_EXT;
-    features.ext.descriptorBuffer.sType      = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
-    features.ext.extendedDynamicState3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
-    features.khr.dynamicRendering.sType      = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
-    features.khr.synchronization2.sType      = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
-    features.khr.timelineSemaphore.sType     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
-    features.khr.rayTracingPipeline.sType    = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
-    features.khr.accelerationStructure.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
+    features.bufferDeviceAddress.sType         = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+    features.descriptorIndexing.sType          = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    features.hostQueryReset.sType              = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES;
+    features.ext.depthClampZeroOne.sType       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLAMP_ZERO_ONE_FEATURES_EXT;
+    features.ext.depthClipControl.sType        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_CONTROL_FEATURES_EXT;
+    features.ext.depthClipEnable.sType         = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_ENABLE_FEATURES_EXT;
+    features.ext.descriptorBuffer.sType        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+    features.ext.extendedDynamicState3.sType   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+    features.ext.graphicsPipelineLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    features.khr.dynamicRendering.sType        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+    features.khr.synchronization2.sType        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+    features.khr.timelineSemaphore.sType       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    features.khr.rayTracingPipeline.sType      = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
+    features.khr.accelerationStructure.sType   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
 }
 
 static void SetStructureTypes(vkex::PhysicalDeviceProperties& properties)
@@ -113,6 +127,119 @@ static void SetStructureTypes(vkex::PhysicalDeviceProperties& properties)
     properties.khr.pushDescriptor.sType   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR;
 }
 
+// Prepended to the Vulkan pipeline cache data written by SavePipelineCache.
+// The Vulkan data carries its own header, but not every driver validates it
+// thoroughly, so the blob is only handed to the driver if everything here
+// matches the current device and the data hash checks out.
+struct PipelineCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint32_t driver_version;
+    uint8_t  pipeline_cache_uuid[VK_UUID_SIZE];
+    uint64_t data_size;
+    uint64_t data_hash;
+};
+
+const uint32_t kPipelineCacheFileMagic   = 0x43505856; // 'VXPC'
+const uint32_t kPipelineCacheFileVersion = 1;
+
+static PipelineCacheFileHeader GetPipelineCacheFileHeader(const VkPhysicalDeviceProperties& properties)
+{
+    PipelineCacheFileHeader header = {};
+    header.magic                   = kPipelineCacheFileMagic;
+    header.version                 = kPipelineCacheFileVersion;
+    header.vendor_id               = properties.vendorID;
+    header.device_id               = properties.deviceID;
+    header.driver_version          = properties.driverVersion;
+    std::memcpy(header.pipeline_cache_uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    return header;
+}
+
+// Canonical key for descriptor set layout interning. Bindings are sorted
+// by binding number so that declaration order does not matter.
+static std::vector<uint64_t> GetLayoutKey(const vkex::DescriptorSetLayoutCreateInfo& create_info)
+{
+    std::vector<uint32_t> order(create_info.bindings.size());
+    for (uint32_t i = 0; i < CountU32(order); ++i) {
+        order[i] = i;
+    }
+    std::sort(
+        std::begin(order),
+        std::end(order),
+        [&create_info](uint32_t a, uint32_t b) -> bool { return create_info.bindings[a].binding < create_info.bindings[b].binding; });
+
+    std::vector<uint64_t> key;
+    key.push_back(static_cast<uint64_t>(create_info.flags.flags));
+    key.push_back(static_cast<uint64_t>(create_info.bindings.size()));
+    for (uint32_t i : order) {
+        const VkDescriptorSetLayoutBinding& binding = create_info.bindings[i];
+        key.push_back(static_cast<uint64_t>(binding.binding));
+        key.push_back(static_cast<uint64_t>(binding.descriptorType));
+        key.push_back(static_cast<uint64_t>(binding.descriptorCount));
+        key.push_back(static_cast<uint64_t>(binding.stageFlags));
+        // Entries missing from binding_flags count as 0, a size mismatch
+        // is rejected when the layout is created
+        key.push_back((i < create_info.binding_flags.size()) ? static_cast<uint64_t>(create_info.binding_flags[i]) : 0);
+        key.push_back((binding.pImmutableSamplers != nullptr) ? 1 : 0);
+        if (binding.pImmutableSamplers != nullptr) {
+            for (uint32_t j = 0; j < binding.descriptorCount; ++j) {
+                key.push_back(reinterpret_cast<uint64_t>(binding.pImmutableSamplers[j]));
+            }
+        }
+    }
+    return key;
+}
+
+// Canonical key for pipeline layout interning. Push constant ranges are
+// sorted, set layouts keep their order since it defines the set numbers.
+static std::vector<uint64_t> GetLayoutKey(const vkex::PipelineLayoutCreateInfo& create_info)
+{
+    std::vector<VkPushConstantRange> ranges = create_info.push_constant_ranges;
+    std::sort(
+        std::begin(ranges),
+        std::end(ranges),
+        [](const VkPushConstantRange& a, const VkPushConstantRange& b) -> bool {
+            return std::tie(a.offset, a.size, a.stageFlags) < std::tie(b.offset, b.size, b.stageFlags);
+        });
+
+    std::vector<uint64_t> key;
+    key.push_back(static_cast<uint64_t>(create_info.descriptor_set_layouts.size()));
+    for (auto& vk_layout : create_info.descriptor_set_layouts) {
+        key.push_back(reinterpret_cast<uint64_t>(vk_layout));
+    }
+    key.push_back(static_cast<uint64_t>(ranges.size()));
+    for (auto& range : ranges) {
+        key.push_back(static_cast<uint64_t>(range.stageFlags));
+        key.push_back(static_cast<uint64_t>(range.offset));
+        key.push_back(static_cast<uint64_t>(range.size));
+    }
+    return key;
+}
+
+// Runs the body of a Create*PipelineAsync task. The promise is always
+// set, an exception escaping create_fn would otherwise leave Wait()
+// blocked forever.
+template <typename ValueT, typename CreateFnT>
+static void RunPipelineTask(std::promise<ValueT>* p_promise, CreateFnT create_fn)
+{
+    ValueT value = {};
+    try {
+        value.result = create_fn(&value.pipeline);
+    }
+    catch (const std::exception& e) {
+        VKEX_LOG_ERROR("Pipeline creation task failed: " << e.what());
+        value.result = vkex::Result::ErrorFailed;
+    }
+    catch (...) {
+        VKEX_LOG_ERROR("Pipeline creation task failed with an unknown exception");
+        value.result = vkex::Result::ErrorFailed;
+    }
+    p_promise->set_value(value);
+}
+
 static VkResult EnumerateDeviceExtensionNames(VkPhysicalDevice vk_physical_device, std::vector<std::string>& found_extensions)
 {
     uint32_t count     = 0;
@@ -414,6 +541,26 @@ vkex::Result CDevice::InitializeExtensions()
             if (m_create_info.enabled_features.ext.loadStoreOpNone) {
                 enabled_extensions.push_back(VK_EXT_LOAD_STORE_OP_NONE_EXTENSION_NAME);
             }
+            if (m_create_info.enabled_features.ext.extendedDynamicState3.extendedDynamicState3ColorBlendEnable ||
+                m_create_info.enabled_features.ext.extendedDynamicState3.extendedDynamicState3ColorBlendEquation ||
+                m_create_info.enabled_features.ext.extendedDynamicState3.extendedDynamicState3ColorWriteMask) {
+                enabled_extensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+            }
+            if (m_create_info.enabled_features.ext.graphicsPipelineLibrary.graphicsPipelineLibrary) {
+                enabled_extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+                enabled_extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+            }
+            // Host query reset is core in Vulkan 1.2, older devices need the
+            // extension or go without
+            if (m_create_info.enabled_features.hostQueryReset.hostQueryReset &&
+                (m_create_info.physical_device->GetApiVersion() < VK_MAKE_VERSION(1, 2, 0))) {
+                if (Contains(m_found_extensions, VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME)) {
+                    enabled_extensions.push_back(VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME);
+                }
+                else {
+                    m_create_info.enabled_features.hostQueryReset.hostQueryReset = VK_FALSE;
+                }
+            }
         }
 
         // KHR
@@ -609,6 +756,9 @@ vkex::Result CDevice::InternalCreate(
         m_create_info.enabled_features.khr.synchronization2.synchronization2   = VK_TRUE;
         m_create_info.enabled_features.khr.timelineSemaphore.timelineSemaphore = VK_TRUE;
 
+        // Host query reset is used by CQueryPool::ResetQueries if available
+        m_create_info.enabled_features.hostQueryReset.hostQueryReset = m_create_info.physical_device->GetPhysicalDeviceFeatures().hostQueryReset.hostQueryReset;
+
         // Enable all of these if one is enabled
         if (m_create_info.enabled_features.khr.rayTracingPipeline.rayTracingPipeline ||
             m_create_info.enabled_features.khr.accelerationStructure.accelerationStructure) {
@@ -691,6 +841,14 @@ vkex::Result CDevice::InternalCreate(
         GetImageViewOpaqueCaptureDescriptorDataEXT             = (PFN_vkGetImageViewOpaqueCaptureDescriptorDataEXT)vkGetDeviceProcAddr(m_vk_object, "vkGetImageViewOpaqueCaptureDescriptorDataEXT");
         GetSamplerOpaqueCaptureDescriptorDataEXT               = (PFN_vkGetSamplerOpaqueCaptureDescriptorDataEXT)vkGetDeviceProcAddr(m_vk_object, "vkGetSamplerOpaqueCaptureDescriptorDataEXT");
         GetAccelerationStructureOpaqueCaptureDescriptorDataEXT = (PFN_vkGetAccelerationStructureOpaqueCaptureDescriptorDataEXT)vkGetDeviceProcAddr(m_vk_object, "vkGetAccelerationStructureOpaqueCaptureDescriptorDataEXT");
+
+        CmdSetColorBlendEnableEXT   = (PFN_vkCmdSetColorBlendEnableEXT)vkGetDeviceProcAddr(m_vk_object, "vkCmdSetColorBlendEnableEXT");
+        CmdSetColorBlendEquationEXT = (PFN_vkCmdSetColorBlendEquationEXT)vkGetDeviceProcAddr(m_vk_object, "vkCmdSetColorBlendEquationEXT");
+        CmdSetColorWriteMaskEXT     = (PFN_vkCmdSetColorWriteMaskEXT)vkGetDeviceProcAddr(m_vk_object, "vkCmdSetColorWriteMaskEXT");
+
+        // Core name in Vulkan 1.2, VK_EXT_host_query_reset before that
+        const bool is_host_query_reset_core = (m_create_info.physical_device->GetApiVersion() >= VK_MAKE_VERSION(1, 2, 0));
+        ResetQueryPoolEXT                   = (PFN_vkResetQueryPoolEXT)vkGetDeviceProcAddr(m_vk_object, is_host_query_reset_core ? "vkResetQueryPool" : "vkResetQueryPoolEXT");
     }
 
     // Log device creation
@@ -766,6 +924,7 @@ vkex::Result CDevice::InternalCreate(
         vma_allocator_create_info.physicalDevice         = *m_create_info.physical_device;
         vma_allocator_create_info.device                 = m_vk_object;
         vma_allocator_create_info.instance               = GetInstance()->GetVkObject();
+        vma_allocator_create_info.pAllocationCallbacks   = ResolveAllocator(nullptr, VK_OBJECT_TYPE_DEVICE_MEMORY);
 
         if (m_create_info.enabled_features.bufferDeviceAddress.bufferDeviceAddress) {
             vma_allocator_create_info.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
@@ -790,10 +949,23 @@ vkex::Result CDevice::InternalCreate(
     return vkex::Result::Success;
 }
 
-#define VKEX_DESTROY_ALL_OBJECTS(OBJ_TYPE, ALLOCATOR, STORAGE)  \
+const VkAllocationCallbacks* CDevice::ResolveAllocator(
+    const VkAllocationCallbacks* p_allocator,
+    VkObjectType                 object_type) const
+{
+    vkex::HostAllocator* p_host_allocator = m_create_info.host_allocator;
+    if ((p_host_allocator == nullptr) ||
+        ((p_allocator != nullptr) && !p_host_allocator->OwnsCallbacks(p_allocator))) {
+        return p_allocator;
+    }
+
+    return p_host_allocator->GetCallbacks(object_type);
+}
+
+#define VKEX_DESTROY_ALL_OBJECTS(OBJ_TYPE, STORAGE, ALLOCATOR)  \
     {                                                           \
         vkex::Result vkex_result = DestroyAllObjects<OBJ_TYPE>( \
-            ALLOCATOR, STORAGE);                                \
+            STORAGE, ALLOCATOR);                                \
         if (!vkex_result) {                                     \
             return vkex_result;                                 \
         }                                                       \
@@ -802,27 +974,32 @@ vkex::Result CDevice::InternalCreate(
 vkex::Result CDevice::DestroyAllStoredObjects(const VkAllocationCallbacks* p_allocator)
 {
     // Destroy VKEX objects
-    VKEX_DESTROY_ALL_OBJECTS(vkex::ShaderProgram, m_stored_shader_programs, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::Texture, m_stored_textures, p_allocator);
+    VKEX_DESTROY_ALL_OBJECTS(CBindlessTable, m_stored_bindless_tables, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
+    VKEX_DESTROY_ALL_OBJECTS(CDescriptorBufferHeap, m_stored_descriptor_buffer_heaps, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
+    VKEX_DESTROY_ALL_OBJECTS(CDescriptorPoolChain, m_stored_descriptor_pool_chains, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
+    VKEX_DESTROY_ALL_OBJECTS(CGpuProfiler, m_stored_gpu_profilers, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
+    VKEX_DESTROY_ALL_OBJECTS(CShaderProgram, m_stored_shader_programs, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
+    VKEX_DESTROY_ALL_OBJECTS(CTexture, m_stored_textures, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
 
     // Destroy Vulkan objects
-    VKEX_DESTROY_ALL_OBJECTS(vkex::Buffer, m_stored_buffers, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::CommandPool, m_stored_command_pools, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::ComputePipeline, m_stored_compute_pipelines, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::DescriptorPool, m_stored_descriptor_pools, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::DescriptorSetLayout, m_stored_descriptor_set_layouts, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::Fence, m_stored_fences, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::GraphicsPipeline, m_stored_graphics_pipelines, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::Image, m_stored_images, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::ImageView, m_stored_image_views, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::PipelineCache, m_stored_pipeline_caches, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::PipelineLayout, m_stored_pipeline_layouts, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::QueryPool, m_stored_query_pools, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::Queue, m_stored_queues, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::Sampler, m_stored_samplers, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::Semaphore, m_stored_semaphores, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::ShaderModule, m_stored_shader_modules, p_allocator);
-    VKEX_DESTROY_ALL_OBJECTS(vkex::Swapchain, m_stored_swapchains, p_allocator);
+    VKEX_DESTROY_ALL_OBJECTS(CBuffer, m_stored_buffers, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER));
+    VKEX_DESTROY_ALL_OBJECTS(CCommandPool, m_stored_command_pools, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_COMMAND_POOL));
+    VKEX_DESTROY_ALL_OBJECTS(CComputePipeline, m_stored_compute_pipelines, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE));
+    VKEX_DESTROY_ALL_OBJECTS(CDescriptorPool, m_stored_descriptor_pools, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+    VKEX_DESTROY_ALL_OBJECTS(CDescriptorSetLayout, m_stored_descriptor_set_layouts, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    VKEX_DESTROY_ALL_OBJECTS(CDescriptorUpdateTemplate, m_stored_descriptor_update_templates, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE));
+    VKEX_DESTROY_ALL_OBJECTS(CFence, m_stored_fences, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_FENCE));
+    VKEX_DESTROY_ALL_OBJECTS(CGraphicsPipeline, m_stored_graphics_pipelines, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE));
+    VKEX_DESTROY_ALL_OBJECTS(CImage, m_stored_images, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_IMAGE));
+    VKEX_DESTROY_ALL_OBJECTS(CImageView, m_stored_image_views, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_IMAGE_VIEW));
+    VKEX_DESTROY_ALL_OBJECTS(CPipelineCache, m_stored_pipeline_caches, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE_CACHE));
+    VKEX_DESTROY_ALL_OBJECTS(CPipelineLayout, m_stored_pipeline_layouts, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    VKEX_DESTROY_ALL_OBJECTS(CQueryPool, m_stored_query_pools, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_QUERY_POOL));
+    VKEX_DESTROY_ALL_OBJECTS(CQueue, m_stored_queues, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_QUEUE));
+    VKEX_DESTROY_ALL_OBJECTS(CSampler, m_stored_samplers, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SAMPLER));
+    VKEX_DESTROY_ALL_OBJECTS(CSemaphore, m_stored_semaphores, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SEMAPHORE));
+    VKEX_DESTROY_ALL_OBJECTS(CShaderModule, m_stored_shader_modules, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SHADER_MODULE));
+    VKEX_DESTROY_ALL_OBJECTS(CSwapchain, m_stored_swapchains, ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SWAPCHAIN_KHR));
 
     return vkex::Result::Success;
 }
@@ -831,6 +1008,12 @@ vkex::Result CDevice::DestroyAllStoredObjects(const VkAllocationCallbacks* p_all
 
 vkex::Result CDevice::InternalDestroy(const VkAllocationCallbacks* p_allocator)
 {
+    // Finish queued pipeline compiles, destroying the pool joins its threads
+    {
+        std::lock_guard<std::mutex> lock(m_pipeline_workers_mutex);
+        m_pipeline_workers.reset();
+    }
+
     // Wait for device idle
     {
         VkResult vk_result = InvalidValue<VkResult>::Value;
@@ -840,12 +1023,39 @@ vkex::Result CDevice::InternalDestroy(const VkAllocationCallbacks* p_allocator)
         }
     }
 
+    // Destroy objects that are still queued, the device is idle. A
+    // failure is returned after the rest of the teardown, so that the
+    // stored objects, the allocator and the device aren't leaked.
+    vkex::Result deferred_result = FlushDeferredDestroys();
+    if (!deferred_result) {
+        VKEX_LOG_ERROR("Deferred destroy failed during device teardown: " << deferred_result);
+    }
+
     // Destroy all stored objects
     {
         vkex::Result vkex_result = DestroyAllStoredObjects(p_allocator);
         if (!vkex_result) {
             return vkex_result;
         }
+        m_default_pipeline_cache = nullptr;
+    }
+
+    // Clear pipeline registry
+    {
+        std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+        m_registered_compute_pipelines.clear();
+        m_registered_graphics_pipelines.clear();
+        m_registered_pipeline_hashes.clear();
+        m_linked_graphics_pipelines.clear();
+        m_optimized_linked_pipelines.clear();
+    }
+
+    // Clear interned layouts
+    {
+        std::lock_guard<std::mutex> lock(m_layout_intern_mutex);
+        m_interned_descriptor_set_layouts.clear();
+        m_interned_pipeline_layouts.clear();
+        m_interned_layout_keys.clear();
     }
 
     // Destroy VMA allocator
@@ -862,6 +1072,10 @@ vkex::Result CDevice::InternalDestroy(const VkAllocationCallbacks* p_allocator)
         m_vk_object = VK_NULL_HANDLE;
     }
 
+    if (!deferred_result) {
+        return deferred_result;
+    }
+
     return vkex::Result::Success;
 }
 
@@ -875,39 +1089,46 @@ const VkPhysicalDeviceDescriptorBufferPropertiesEXT& CDevice::GetDescriptorBuffe
     return GetPhysicalDevice()->GetPhysicalDeviceProperties().ext.descriptorBuffer;
 }
 
+const VkPhysicalDeviceDescriptorIndexingProperties& CDevice::GetDescriptorIndexingProperties() const
+{
+    return GetPhysicalDevice()->GetPhysicalDeviceProperties().descriptorIndexing;
+}
+
+bool CDevice::IsDynamicBlendStateEnabled() const
+{
+    const VkPhysicalDeviceExtendedDynamicState3FeaturesEXT& features = m_create_info.enabled_features.ext.extendedDynamicState3;
+    return features.extendedDynamicState3ColorBlendEnable &&
+           features.extendedDynamicState3ColorBlendEquation &&
+           features.extendedDynamicState3ColorWriteMask;
+}
+
 vkex::Result CDevice::GetQueue(
     VkQueueFlagBits queue_type,
     uint32_t        queue_family_index,
     uint32_t        queue_index,
     vkex::Queue*    p_queue) const
 {
-    auto it = FindIf(
-        m_stored_queues,
-        [queue_type, queue_family_index, queue_index](const std::unique_ptr<CQueue>& elem) -> bool {
-            // There should never be a null IQueue object
-            VKEX_ASSERT_MSG(elem, "Null IQueue object encountered!");
-            auto&    elem_supported_queue_flags = elem->GetSupportedQueueFlags();
-            uint32_t elem_queue_family_index    = elem->GetVkQueueFamilyIndex();
-            uint32_t elem_queue_index           = elem->GetVkQueueIndex();
-            bool     has_queue_type             = (elem_supported_queue_flags.flags & queue_type);
-            bool     has_queue_family_index     = (elem_queue_family_index == queue_family_index);
-            bool     has_queue_index            = (elem_queue_index == queue_index);
-            bool     found                      = has_queue_type && has_queue_family_index && has_queue_index;
-            return found;
-        });
-
-    bool found = (it != std::end(m_stored_queues));
-    if (!found) {
-        return vkex::Result::ErrorSupportedQueueSlotNotFound;
+    std::lock_guard<std::mutex> lock(m_stored_queues.GetMutex());
+    for (auto elem : m_stored_queues) {
+        auto&    elem_supported_queue_flags = elem->GetSupportedQueueFlags();
+        uint32_t elem_queue_family_index    = elem->GetVkQueueFamilyIndex();
+        uint32_t elem_queue_index           = elem->GetVkQueueIndex();
+        bool     has_queue_type             = (elem_supported_queue_flags.flags & queue_type);
+        bool     has_queue_family_index     = (elem_queue_family_index == queue_family_index);
+        bool     has_queue_index            = (elem_queue_index == queue_index);
+        bool     found                      = has_queue_type && has_queue_family_index && has_queue_index;
+        if (found) {
+            *p_queue = elem;
+            return vkex::Result::Success;
+        }
     }
 
-    *p_queue = (*it).get();
-
-    return vkex::Result::Success;
+    return vkex::Result::ErrorSupportedQueueSlotNotFound;
 }
 
 VkResult CDevice::WaitIdle()
 {
+    VKEX_CPU_ZONE("vkDeviceWaitIdle");
     VkResult vk_result = vkDeviceWaitIdle(m_vk_object);
     if (vk_result != VK_SUCCESS) {
         return vk_result;
@@ -915,6 +1136,42 @@ VkResult CDevice::WaitIdle()
     return VK_SUCCESS;
 }
 
+vkex::Result CDevice::CreateBindlessTable(
+    const vkex::BindlessTableCreateInfo& create_info,
+    vkex::BindlessTable*                 p_object,
+    const VkAllocationCallbacks*         p_allocator)
+{
+    vkex::Result vkex_result = CreateObject<CBindlessTable>(
+        create_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN),
+        m_stored_bindless_tables,
+        &CBindlessTable::SetDevice,
+        this,
+        p_object);
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::DestroyBindlessTable(
+    vkex::BindlessTable          object,
+    const VkAllocationCallbacks* p_allocator)
+{
+    vkex::Result vkex_result = DestroyObject<CBindlessTable>(
+        m_stored_bindless_tables,
+        object,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
 vkex::Result CDevice::CreateBuffer(
     const vkex::BufferCreateInfo& create_info,
     vkex::Buffer*                 p_object,
@@ -922,7 +1179,7 @@ vkex::Result CDevice::CreateBuffer(
 {
     vkex::Result vkex_result = CreateObject<CBuffer>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER),
         m_stored_buffers,
         &CBuffer::SetDevice,
         this,
@@ -939,10 +1196,14 @@ vkex::Result CDevice::DestroyBuffer(
     vkex::Buffer                 object,
     const VkAllocationCallbacks* p_allocator)
 {
+    if (object != nullptr) {
+        NotifyDestroyListeners(object->GetVkObject(), &vkex::ObjectDestroyListener::OnDestroyBuffer);
+    }
+
     vkex::Result vkex_result = DestroyObject<CBuffer>(
         m_stored_buffers,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER));
 
     if (!vkex_result) {
         return vkex_result;
@@ -958,7 +1219,7 @@ vkex::Result CDevice::CreateCommandPool(
 {
     vkex::Result vkex_result = CreateObject<CCommandPool>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_COMMAND_POOL),
         m_stored_command_pools,
         &CCommandPool::SetDevice,
         this,
@@ -978,7 +1239,7 @@ vkex::Result CDevice::DestroyCommandPool(
     vkex::Result vkex_result = DestroyObject<CCommandPool>(
         m_stored_command_pools,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_COMMAND_POOL));
 
     if (!vkex_result) {
         return vkex_result;
@@ -992,9 +1253,15 @@ vkex::Result CDevice::CreateComputePipeline(
     vkex::ComputePipeline*                 p_object,
     const VkAllocationCallbacks*           p_allocator)
 {
+    // Use the device pipeline cache unless one was specified
+    vkex::ComputePipelineCreateInfo resolved_create_info = create_info;
+    if (resolved_create_info.pipeline_cache == nullptr) {
+        resolved_create_info.pipeline_cache = m_default_pipeline_cache;
+    }
+
     vkex::Result vkex_result = CreateObject<CComputePipeline>(
-        create_info,
-        p_allocator,
+        resolved_create_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE),
         m_stored_compute_pipelines,
         &CComputePipeline::SetDevice,
         this,
@@ -1007,14 +1274,43 @@ vkex::Result CDevice::CreateComputePipeline(
     return vkex::Result::Success;
 }
 
+vkex::Result CDevice::CreateComputePipelineAsync(
+    const vkex::ComputePipelineCreateInfo& create_info,
+    vkex::AsyncComputePipeline*            p_object,
+    const VkAllocationCallbacks*           p_allocator)
+{
+    if (p_object == nullptr) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    using Value  = vkex::AsyncComputePipeline::Value;
+    auto promise = std::make_shared<std::promise<Value>>();
+    *p_object    = vkex::AsyncComputePipeline(promise->get_future().share());
+
+    // create_info is copied into the task
+    GetPipelineWorkers()->Submit(
+        [this, create_info, p_allocator, promise]() {
+            RunPipelineTask(
+                promise.get(),
+                [&](vkex::ComputePipeline* p_pipeline) -> vkex::Result { return CreateComputePipeline(create_info, p_pipeline, p_allocator); });
+        });
+
+    return vkex::Result::Success;
+}
+
 vkex::Result CDevice::DestroyComputePipeline(
     vkex::ComputePipeline        object,
     const VkAllocationCallbacks* p_allocator)
 {
+    // Registered pipelines are shared, see ReleaseComputePipeline
+    if (IsRegisteredPipeline(object)) {
+        return vkex::Result::ErrorObjectIsShared;
+    }
+
     vkex::Result vkex_result = DestroyObject<CComputePipeline>(
         m_stored_compute_pipelines,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1034,7 +1330,7 @@ vkex::Result CDevice::CreateConstantBuffer(
 
     vkex::Result vkex_result = CreateObject<CBuffer>(
         use_create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER),
         m_stored_buffers,
         &CBuffer::SetDevice,
         this,
@@ -1054,7 +1350,7 @@ vkex::Result CDevice::DestroyConstantBuffer(
     vkex::Result vkex_result = DestroyObject<CBuffer>(
         m_stored_buffers,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1070,7 +1366,7 @@ vkex::Result CDevice::CreateDescriptorSetLayout(
 {
     vkex::Result vkex_result = CreateObject<CDescriptorSetLayout>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT),
         m_stored_descriptor_set_layouts,
         &CDescriptorSetLayout::SetDevice,
         this,
@@ -1087,10 +1383,19 @@ vkex::Result CDevice::DestroyDescriptorSetLayout(
     vkex::DescriptorSetLayout    object,
     const VkAllocationCallbacks* p_allocator)
 {
+    // Interned layouts are shared, see ReleaseDescriptorSetLayout
+    if (IsInternedLayout(object)) {
+        return vkex::Result::ErrorObjectIsShared;
+    }
+
+    if (object != nullptr) {
+        NotifyDestroyListeners(object->GetVkObject(), &vkex::ObjectDestroyListener::OnDestroyDescriptorSetLayout);
+    }
+
     vkex::Result vkex_result = DestroyObject<CDescriptorSetLayout>(
         m_stored_descriptor_set_layouts,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1151,35 +1456,56 @@ vkex::Result CDevice::DestroyDescriptorSetLayouts(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::CreateDescriptorPool(
-    const vkex::DescriptorPoolCreateInfo& create_info,
-    vkex::DescriptorPool*                 p_object,
-    const VkAllocationCallbacks*          p_allocator)
+vkex::Result CDevice::AcquireDescriptorSetLayout(
+    const vkex::DescriptorSetLayoutCreateInfo& create_info,
+    vkex::DescriptorSetLayout*                 p_object,
+    const VkAllocationCallbacks*               p_allocator)
 {
-    vkex::Result vkex_result = CreateObject<CDescriptorPool>(
-        create_info,
-        p_allocator,
-        m_stored_descriptor_pools,
-        &CDescriptorPool::SetDevice,
-        this,
-        p_object);
+    if (p_object == nullptr) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
 
-    if (!vkex_result) {
-        return vkex_result;
+    std::lock_guard<std::mutex> lock(m_layout_intern_mutex);
+
+    LayoutKey key = GetLayoutKey(create_info);
+    auto      it  = m_interned_descriptor_set_layouts.find(key);
+    if (it == m_interned_descriptor_set_layouts.end()) {
+        InternedLayout<vkex::DescriptorSetLayout> interned    = {};
+        vkex::Result                              vkex_result = CreateDescriptorSetLayout(create_info, &interned.object, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        m_interned_layout_keys[interned.object] = key;
+        it                                      = m_interned_descriptor_set_layouts.emplace(std::move(key), interned).first;
     }
 
+    ++(it->second.ref_count);
+    *p_object = it->second.object;
+
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::DestroyDescriptorPool(
-    vkex::DescriptorPool         object,
+vkex::Result CDevice::ReleaseDescriptorSetLayout(
+    vkex::DescriptorSetLayout    object,
     const VkAllocationCallbacks* p_allocator)
 {
-    vkex::Result vkex_result = DestroyObject<CDescriptorPool>(
-        m_stored_descriptor_pools,
-        object,
-        p_allocator);
+    {
+        std::lock_guard<std::mutex> lock(m_layout_intern_mutex);
+
+        auto key_it = m_interned_layout_keys.find(object);
+        if (key_it != m_interned_layout_keys.end()) {
+            auto it = m_interned_descriptor_set_layouts.find(key_it->second);
+            VKEX_ASSERT(it != m_interned_descriptor_set_layouts.end());
+            if (--(it->second.ref_count) > 0) {
+                return vkex::Result::Success;
+            }
+            m_interned_descriptor_set_layouts.erase(it);
+            m_interned_layout_keys.erase(key_it);
+        }
+    }
 
+    // Last reference, or the object was never interned
+    vkex::Result vkex_result = DestroyDescriptorSetLayout(object, p_allocator);
     if (!vkex_result) {
         return vkex_result;
     }
@@ -1187,16 +1513,16 @@ vkex::Result CDevice::DestroyDescriptorPool(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::CreateFence(
-    const vkex::FenceCreateInfo& create_info,
-    vkex::Fence*                 p_object,
-    const VkAllocationCallbacks* p_allocator)
+vkex::Result CDevice::CreateDescriptorUpdateTemplate(
+    const vkex::DescriptorUpdateTemplateCreateInfo& create_info,
+    vkex::DescriptorUpdateTemplate*                 p_object,
+    const VkAllocationCallbacks*                    p_allocator)
 {
-    vkex::Result vkex_result = CreateObject<CFence>(
+    vkex::Result vkex_result = CreateObject<CDescriptorUpdateTemplate>(
         create_info,
-        p_allocator,
-        m_stored_fences,
-        &CFence::SetDevice,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE),
+        m_stored_descriptor_update_templates,
+        &CDescriptorUpdateTemplate::SetDevice,
         this,
         p_object);
 
@@ -1207,14 +1533,14 @@ vkex::Result CDevice::CreateFence(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::DestroyFence(
-    vkex::Fence                  object,
-    const VkAllocationCallbacks* p_allocator)
+vkex::Result CDevice::DestroyDescriptorUpdateTemplate(
+    vkex::DescriptorUpdateTemplate object,
+    const VkAllocationCallbacks*   p_allocator)
 {
-    vkex::Result vkex_result = DestroyObject<CFence>(
-        m_stored_fences,
+    vkex::Result vkex_result = DestroyObject<CDescriptorUpdateTemplate>(
+        m_stored_descriptor_update_templates,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1223,16 +1549,16 @@ vkex::Result CDevice::DestroyFence(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::CreateGraphicsPipeline(
-    const vkex::GraphicsPipelineCreateInfo& create_info,
-    vkex::GraphicsPipeline*                 p_object,
-    const VkAllocationCallbacks*            p_allocator)
+vkex::Result CDevice::CreateDescriptorBufferHeap(
+    const vkex::DescriptorBufferHeapCreateInfo& create_info,
+    vkex::DescriptorBufferHeap*                 p_object,
+    const VkAllocationCallbacks*                p_allocator)
 {
-    vkex::Result vkex_result = CreateObject<CGraphicsPipeline>(
+    vkex::Result vkex_result = CreateObject<CDescriptorBufferHeap>(
         create_info,
-        p_allocator,
-        m_stored_graphics_pipelines,
-        &CGraphicsPipeline::SetDevice,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN),
+        m_stored_descriptor_buffer_heaps,
+        &CDescriptorBufferHeap::SetDevice,
         this,
         p_object);
 
@@ -1243,14 +1569,14 @@ vkex::Result CDevice::CreateGraphicsPipeline(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::DestroyGraphicsPipeline(
-    vkex::GraphicsPipeline       object,
+vkex::Result CDevice::DestroyDescriptorBufferHeap(
+    vkex::DescriptorBufferHeap   object,
     const VkAllocationCallbacks* p_allocator)
 {
-    vkex::Result vkex_result = DestroyObject<CGraphicsPipeline>(
-        m_stored_graphics_pipelines,
+    vkex::Result vkex_result = DestroyObject<CDescriptorBufferHeap>(
+        m_stored_descriptor_buffer_heaps,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1259,16 +1585,16 @@ vkex::Result CDevice::DestroyGraphicsPipeline(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::CreateImage(
-    const vkex::ImageCreateInfo& create_info,
-    vkex::Image*                 p_object,
-    const VkAllocationCallbacks* p_allocator)
+vkex::Result CDevice::CreateDescriptorPool(
+    const vkex::DescriptorPoolCreateInfo& create_info,
+    vkex::DescriptorPool*                 p_object,
+    const VkAllocationCallbacks*          p_allocator)
 {
-    vkex::Result vkex_result = CreateObject<CImage>(
+    vkex::Result vkex_result = CreateObject<CDescriptorPool>(
         create_info,
-        p_allocator,
-        m_stored_images,
-        &CImage::SetDevice,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_DESCRIPTOR_POOL),
+        m_stored_descriptor_pools,
+        &CDescriptorPool::SetDevice,
         this,
         p_object);
 
@@ -1279,14 +1605,14 @@ vkex::Result CDevice::CreateImage(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::DestroyImage(
-    vkex::Image                  object,
+vkex::Result CDevice::DestroyDescriptorPool(
+    vkex::DescriptorPool         object,
     const VkAllocationCallbacks* p_allocator)
 {
-    vkex::Result vkex_result = DestroyObject<CImage>(
-        m_stored_images,
+    vkex::Result vkex_result = DestroyObject<CDescriptorPool>(
+        m_stored_descriptor_pools,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_DESCRIPTOR_POOL));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1295,16 +1621,16 @@ vkex::Result CDevice::DestroyImage(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::CreateImageView(
-    const vkex::ImageViewCreateInfo& create_info,
-    vkex::ImageView*                 p_object,
-    const VkAllocationCallbacks*     p_allocator)
+vkex::Result CDevice::CreateDescriptorPoolChain(
+    const vkex::DescriptorPoolChainCreateInfo& create_info,
+    vkex::DescriptorPoolChain*                 p_object,
+    const VkAllocationCallbacks*               p_allocator)
 {
-    vkex::Result vkex_result = CreateObject<CImageView>(
+    vkex::Result vkex_result = CreateObject<CDescriptorPoolChain>(
         create_info,
-        p_allocator,
-        m_stored_image_views,
-        &CImageView::SetDevice,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN),
+        m_stored_descriptor_pool_chains,
+        &CDescriptorPoolChain::SetDevice,
         this,
         p_object);
 
@@ -1315,14 +1641,14 @@ vkex::Result CDevice::CreateImageView(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::DestroyImageView(
-    vkex::ImageView              object,
+vkex::Result CDevice::DestroyDescriptorPoolChain(
+    vkex::DescriptorPoolChain    object,
     const VkAllocationCallbacks* p_allocator)
 {
-    vkex::Result vkex_result = DestroyObject<CImageView>(
-        m_stored_image_views,
+    vkex::Result vkex_result = DestroyObject<CDescriptorPoolChain>(
+        m_stored_descriptor_pool_chains,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1331,20 +1657,16 @@ vkex::Result CDevice::DestroyImageView(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::CreateIndexBuffer(
-    const vkex::BufferCreateInfo& create_info,
-    vkex::Buffer*                 p_object,
-    const VkAllocationCallbacks*  p_allocator)
+vkex::Result CDevice::CreateFence(
+    const vkex::FenceCreateInfo& create_info,
+    vkex::Fence*                 p_object,
+    const VkAllocationCallbacks* p_allocator)
 {
-    // Force usage
-    auto use_create_info                          = create_info;
-    use_create_info.usage_flags.bits.index_buffer = true;
-
-    vkex::Result vkex_result = CreateObject<CBuffer>(
-        use_create_info,
-        p_allocator,
-        m_stored_buffers,
-        &CBuffer::SetDevice,
+    vkex::Result vkex_result = CreateObject<CFence>(
+        create_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_FENCE),
+        m_stored_fences,
+        &CFence::SetDevice,
         this,
         p_object);
 
@@ -1355,14 +1677,14 @@ vkex::Result CDevice::CreateIndexBuffer(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::DestroyIndexBuffer(
-    vkex::Buffer                 object,
+vkex::Result CDevice::DestroyFence(
+    vkex::Fence                  object,
     const VkAllocationCallbacks* p_allocator)
 {
-    vkex::Result vkex_result = DestroyObject<CBuffer>(
-        m_stored_buffers,
+    vkex::Result vkex_result = DestroyObject<CFence>(
+        m_stored_fences,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_FENCE));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1371,20 +1693,16 @@ vkex::Result CDevice::DestroyIndexBuffer(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::CreateIndirectBuffer(
-    const vkex::BufferCreateInfo& create_info,
-    vkex::Buffer*                 p_object,
-    const VkAllocationCallbacks*  p_allocator)
+vkex::Result CDevice::CreateGpuProfiler(
+    const vkex::GpuProfilerCreateInfo& create_info,
+    vkex::GpuProfiler*                 p_object,
+    const VkAllocationCallbacks*       p_allocator)
 {
-    // Force usage
-    auto use_create_info                             = create_info;
-    use_create_info.usage_flags.bits.indirect_buffer = true;
-
-    vkex::Result vkex_result = CreateObject<CBuffer>(
-        use_create_info,
-        p_allocator,
-        m_stored_buffers,
-        &CBuffer::SetDevice,
+    vkex::Result vkex_result = CreateObject<CGpuProfiler>(
+        create_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN),
+        m_stored_gpu_profilers,
+        &CGpuProfiler::SetDevice,
         this,
         p_object);
 
@@ -1395,14 +1713,14 @@ vkex::Result CDevice::CreateIndirectBuffer(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::DestroyIndirectBuffer(
-    vkex::Buffer                 object,
+vkex::Result CDevice::DestroyGpuProfiler(
+    vkex::GpuProfiler            object,
     const VkAllocationCallbacks* p_allocator)
 {
-    vkex::Result vkex_result = DestroyObject<CBuffer>(
-        m_stored_buffers,
+    vkex::Result vkex_result = DestroyObject<CGpuProfiler>(
+        m_stored_gpu_profilers,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1411,14 +1729,753 @@ vkex::Result CDevice::DestroyIndirectBuffer(
     return vkex::Result::Success;
 }
 
-vkex::Result CDevice::CreatePipelineCache(
-    const vkex::PipelineCacheCreateInfo& create_info,
-    vkex::PipelineCache*                 p_object,
-    const VkAllocationCallbacks*         p_allocator)
-{
-    vkex::Result vkex_result = CreateObject<CPipelineCache>(
-        create_info,
+vkex::Result CDevice::CreateGraphicsPipeline(
+    const vkex::GraphicsPipelineCreateInfo& create_info,
+    vkex::GraphicsPipeline*                 p_object,
+    const VkAllocationCallbacks*            p_allocator)
+{
+    // Use the device pipeline cache unless one was specified
+    vkex::GraphicsPipelineCreateInfo resolved_create_info = create_info;
+    if (resolved_create_info.pipeline_cache == nullptr) {
+        resolved_create_info.pipeline_cache = m_default_pipeline_cache;
+    }
+
+    vkex::Result vkex_result = CreateObject<CGraphicsPipeline>(
+        resolved_create_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE),
+        m_stored_graphics_pipelines,
+        &CGraphicsPipeline::SetDevice,
+        this,
+        p_object);
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::CreateGraphicsPipelineAsync(
+    const vkex::GraphicsPipelineCreateInfo& create_info,
+    vkex::AsyncGraphicsPipeline*            p_object,
+    const VkAllocationCallbacks*            p_allocator)
+{
+    if (p_object == nullptr) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    using Value  = vkex::AsyncGraphicsPipeline::Value;
+    auto promise = std::make_shared<std::promise<Value>>();
+    *p_object    = vkex::AsyncGraphicsPipeline(promise->get_future().share());
+
+    // create_info is copied into the task
+    GetPipelineWorkers()->Submit(
+        [this, create_info, p_allocator, promise]() {
+            RunPipelineTask(
+                promise.get(),
+                [&](vkex::GraphicsPipeline* p_pipeline) -> vkex::Result { return CreateGraphicsPipeline(create_info, p_pipeline, p_allocator); });
+        });
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::DestroyGraphicsPipeline(
+    vkex::GraphicsPipeline       object,
+    const VkAllocationCallbacks* p_allocator)
+{
+    // Registered pipelines are shared, see ReleaseGraphicsPipeline
+    if (IsRegisteredPipeline(object)) {
+        return vkex::Result::ErrorObjectIsShared;
+    }
+
+    vkex::Result vkex_result = DestroyObject<CGraphicsPipeline>(
+        m_stored_graphics_pipelines,
+        object,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE));
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+// Registered entry with the given key, equal hashes alone don't mean the
+// state is the same.
+template <typename MapT>
+static typename MapT::iterator FindRegisteredPipeline(
+    MapT&                    registered_pipelines,
+    uint64_t                 hash,
+    const vkex::PipelineKey& key)
+{
+    auto range = registered_pipelines.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (!it->second.retired && (it->second.key == key)) {
+            return it;
+        }
+    }
+    return registered_pipelines.end();
+}
+
+static VkPipelineLayout GetVkPipelineLayout(const vkex::PipelineLayout pipeline_layout)
+{
+    return (pipeline_layout != nullptr) ? static_cast<VkPipelineLayout>(*pipeline_layout) : VK_NULL_HANDLE;
+}
+
+template <typename CreateInfoT, typename HandleT, typename CreateFnT>
+vkex::Result CDevice::GetOrCreatePipeline(
+    const CreateInfoT&              create_info,
+    const VkAllocationCallbacks*    p_allocator,
+    CreateFnT                       create_fn,
+    RegisteredPipelineMap<HandleT>& registered_pipelines,
+    HandleT*                        p_object)
+{
+    if (p_object == nullptr) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    vkex::PipelineKey key  = GetPipelineKey(create_info);
+    const uint64_t    hash = HashPipelineKey(key);
+
+    // Lookup
+    {
+        std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+        auto                        it = FindRegisteredPipeline(registered_pipelines, hash, key);
+        if (it != registered_pipelines.end()) {
+            ++m_pipeline_registry_hit_count;
+            ++(it->second.ref_count);
+            *p_object = it->second.object;
+            return vkex::Result::Success;
+        }
+        ++m_pipeline_registry_miss_count;
+    }
+
+    // Create without holding the lock so misses on other threads can
+    // compile in parallel.
+    HandleT      pipeline    = nullptr;
+    vkex::Result vkex_result = (this->*create_fn)(create_info, &pipeline, p_allocator);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    // Register, unless another thread registered the same state first
+    HandleT existing = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+        auto                        it = FindRegisteredPipeline(registered_pipelines, hash, key);
+        if (it != registered_pipelines.end()) {
+            existing = it->second.object;
+            ++(it->second.ref_count);
+        }
+        else {
+            RegisteredPipeline<HandleT> registered = {};
+            registered.key                         = std::move(key);
+            registered.vk_layout                   = GetVkPipelineLayout(create_info.pipeline_layout);
+            registered.object                      = pipeline;
+            registered.ref_count                   = 1;
+            registered_pipelines.emplace(hash, std::move(registered));
+            m_registered_pipeline_hashes[pipeline] = hash;
+        }
+    }
+
+    if (existing != nullptr) {
+        if constexpr (std::is_same<HandleT, vkex::ComputePipeline>::value) {
+            vkex_result = DestroyComputePipeline(pipeline, p_allocator);
+        }
+        else {
+            vkex_result = DestroyGraphicsPipeline(pipeline, p_allocator);
+        }
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        pipeline = existing;
+    }
+
+    *p_object = pipeline;
+
+    return vkex::Result::Success;
+}
+
+template <typename HandleT>
+vkex::Result CDevice::ReleasePipeline(
+    HandleT                         object,
+    const VkAllocationCallbacks*    p_allocator,
+    RegisteredPipelineMap<HandleT>& registered_pipelines)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+
+        auto hash_it = m_registered_pipeline_hashes.find(object);
+        if (hash_it != m_registered_pipeline_hashes.end()) {
+            auto range = registered_pipelines.equal_range(hash_it->second);
+            auto it    = std::find_if(range.first, range.second, [object](const auto& elem) -> bool { return elem.second.object == object; });
+            if (it == range.second) {
+                return vkex::Result::ErrorObjectIsShared;
+            }
+            if (--(it->second.ref_count) > 0) {
+                return vkex::Result::Success;
+            }
+            registered_pipelines.erase(it);
+            m_registered_pipeline_hashes.erase(hash_it);
+        }
+    }
+
+    // Last reference, or the object was never registered
+    vkex::Result vkex_result = vkex::Result::Success;
+    if constexpr (std::is_same<HandleT, vkex::ComputePipeline>::value) {
+        vkex_result = DestroyComputePipeline(object, p_allocator);
+    }
+    else {
+        vkex_result = DestroyGraphicsPipeline(object, p_allocator);
+    }
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::GetOrCreateComputePipeline(
+    const vkex::ComputePipelineCreateInfo& create_info,
+    vkex::ComputePipeline*                 p_object,
+    const VkAllocationCallbacks*           p_allocator)
+{
+    vkex::Result vkex_result = GetOrCreatePipeline(
+        create_info,
+        p_allocator,
+        &CDevice::CreateComputePipeline,
+        m_registered_compute_pipelines,
+        p_object);
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::ReleaseComputePipeline(
+    vkex::ComputePipeline        object,
+    const VkAllocationCallbacks* p_allocator)
+{
+    vkex::Result vkex_result = ReleasePipeline(object, p_allocator, m_registered_compute_pipelines);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::GetOrCreateGraphicsPipeline(
+    const vkex::GraphicsPipelineCreateInfo& create_info,
+    vkex::GraphicsPipeline*                 p_object,
+    const VkAllocationCallbacks*            p_allocator)
+{
+    vkex::Result vkex_result = GetOrCreatePipeline(
+        create_info,
         p_allocator,
+        &CDevice::CreateGraphicsPipeline,
+        m_registered_graphics_pipelines,
+        p_object);
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::ReleaseGraphicsPipeline(
+    vkex::GraphicsPipeline       object,
+    const VkAllocationCallbacks* p_allocator)
+{
+    vkex::Result vkex_result = ReleasePipeline(object, p_allocator, m_registered_graphics_pipelines);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::LinkGraphicsPipeline(
+    const vkex::GraphicsPipelineLinkInfo& link_info,
+    vkex::GraphicsPipeline*               p_object,
+    const VkAllocationCallbacks*          p_allocator)
+{
+    // Use the device pipeline cache unless one was specified
+    vkex::GraphicsPipelineLinkInfo resolved_link_info = link_info;
+    if (resolved_link_info.pipeline_cache == nullptr) {
+        resolved_link_info.pipeline_cache = m_default_pipeline_cache;
+    }
+
+    vkex::Result vkex_result = CreateObject<CGraphicsPipeline>(
+        resolved_link_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE),
+        m_stored_graphics_pipelines,
+        &CGraphicsPipeline::SetDevice,
+        this,
+        p_object);
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::LinkGraphicsPipelineAsync(
+    const vkex::GraphicsPipelineLinkInfo& link_info,
+    vkex::AsyncGraphicsPipeline*          p_object,
+    const VkAllocationCallbacks*          p_allocator)
+{
+    if (p_object == nullptr) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    using Value  = vkex::AsyncGraphicsPipeline::Value;
+    auto promise = std::make_shared<std::promise<Value>>();
+    *p_object    = vkex::AsyncGraphicsPipeline(promise->get_future().share());
+
+    // link_info is copied into the task
+    GetPipelineWorkers()->Submit(
+        [this, link_info, p_allocator, promise]() {
+            RunPipelineTask(
+                promise.get(),
+                [&](vkex::GraphicsPipeline* p_pipeline) -> vkex::Result { return LinkGraphicsPipeline(link_info, p_pipeline, p_allocator); });
+        });
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::GetOrLinkGraphicsPipeline(
+    const vkex::GraphicsPipelineCreateInfo& create_info,
+    bool                                    optimize,
+    vkex::LinkedGraphicsPipeline*           p_object,
+    const VkAllocationCallbacks*            p_allocator)
+{
+    if (p_object == nullptr) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    if (!m_create_info.enabled_features.ext.graphicsPipelineLibrary.graphicsPipelineLibrary) {
+        return vkex::Result::ErrorRequiredFeatureNotEnabled;
+    }
+
+    vkex::GraphicsPipelineCreateInfo pipeline_create_info = create_info;
+    pipeline_create_info.library_flags                    = 0;
+
+    vkex::PipelineKey key  = GetPipelineKey(pipeline_create_info);
+    const uint64_t    hash = HashPipelineKey(key);
+
+    // Lookup
+    {
+        std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+        auto                        it = FindRegisteredPipeline(m_linked_graphics_pipelines, hash, key);
+        if (it != m_linked_graphics_pipelines.end()) {
+            ++m_pipeline_registry_hit_count;
+            ++(it->second.ref_count);
+            *p_object = it->second.object;
+            return vkex::Result::Success;
+        }
+        ++m_pipeline_registry_miss_count;
+    }
+
+    // Libraries, shared with every pipeline that has the same part. The
+    // linked entry holds a reference on each until it is released.
+    const VkGraphicsPipelineLibraryFlagsEXT k_library_parts[] = {
+        VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+    };
+
+    RegisteredLinkedPipeline registered = {};
+
+    vkex::GraphicsPipelineLinkInfo link_info = {};
+    link_info.pipeline_cache                 = create_info.pipeline_cache;
+    for (auto library_part : k_library_parts) {
+        vkex::GraphicsPipelineCreateInfo library_create_info = create_info;
+        library_create_info.library_flags                    = library_part;
+
+        vkex::GraphicsPipeline library     = nullptr;
+        vkex::Result           vkex_result = GetOrCreateGraphicsPipeline(library_create_info, &library, p_allocator);
+        if (!vkex_result) {
+            DestroyLinkedPipeline(registered, p_allocator);
+            return vkex_result;
+        }
+        registered.libraries.push_back(library);
+    }
+    link_info.libraries = registered.libraries;
+
+    // Fast link
+    vkex::GraphicsPipeline fast_linked = nullptr;
+    vkex::Result           vkex_result = LinkGraphicsPipeline(link_info, &fast_linked, p_allocator);
+    if (!vkex_result) {
+        DestroyLinkedPipeline(registered, p_allocator);
+        return vkex_result;
+    }
+
+    // Optimized link, like LinkGraphicsPipelineAsync. The pipeline is
+    // marked as registered before the future is ready, so callers can't
+    // destroy it directly.
+    vkex::AsyncGraphicsPipeline optimized;
+    if (optimize) {
+        link_info.link_time_optimization = true;
+
+        using Value  = vkex::AsyncGraphicsPipeline::Value;
+        auto promise = std::make_shared<std::promise<Value>>();
+        optimized    = vkex::AsyncGraphicsPipeline(promise->get_future().share());
+
+        GetPipelineWorkers()->Submit(
+            [this, link_info, p_allocator, promise]() {
+                RunPipelineTask(
+                    promise.get(),
+                    [&](vkex::GraphicsPipeline* p_pipeline) -> vkex::Result {
+                        vkex::Result vkex_result = LinkGraphicsPipeline(link_info, p_pipeline, p_allocator);
+                        if (!vkex_result) {
+                            return vkex_result;
+                        }
+                        std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+                        m_optimized_linked_pipelines.insert(*p_pipeline);
+                        return vkex::Result::Success;
+                    });
+            });
+    }
+
+    // Register, unless another thread linked the same state first
+    registered.object    = vkex::LinkedGraphicsPipeline(fast_linked, optimized);
+    registered.ref_count = 1;
+    vkex::LinkedGraphicsPipeline existing;
+    {
+        std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+        auto                        it = FindRegisteredPipeline(m_linked_graphics_pipelines, hash, key);
+        if (it != m_linked_graphics_pipelines.end()) {
+            ++(it->second.ref_count);
+            existing = it->second.object;
+        }
+        else {
+            registered.key       = std::move(key);
+            registered.vk_layout = GetVkPipelineLayout(create_info.pipeline_layout);
+            m_linked_graphics_pipelines.emplace(hash, registered);
+            m_registered_pipeline_hashes[fast_linked] = hash;
+        }
+    }
+
+    if (existing.IsValid()) {
+        vkex_result = DestroyLinkedPipeline(registered, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        registered.object = existing;
+    }
+
+    *p_object = registered.object;
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::ReleaseLinkedGraphicsPipeline(
+    const vkex::LinkedGraphicsPipeline& object,
+    const VkAllocationCallbacks*        p_allocator)
+{
+    if (!object.IsValid()) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    RegisteredLinkedPipeline registered = {};
+    {
+        std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+
+        // Like DestroyObject, releasing a pipeline that isn't registered,
+        // e.g. one that was already released, does nothing.
+        auto hash_it = m_registered_pipeline_hashes.find(object.GetFastLinked());
+        if (hash_it == m_registered_pipeline_hashes.end()) {
+            return vkex::Result::Success;
+        }
+        auto range = m_linked_graphics_pipelines.equal_range(hash_it->second);
+        auto it    = std::find_if(range.first, range.second, [&object](const auto& elem) -> bool { return elem.second.object.GetFastLinked() == object.GetFastLinked(); });
+        if (it == range.second) {
+            return vkex::Result::Success;
+        }
+        if (--(it->second.ref_count) > 0) {
+            return vkex::Result::Success;
+        }
+        registered = std::move(it->second);
+        m_linked_graphics_pipelines.erase(it);
+        m_registered_pipeline_hashes.erase(hash_it);
+    }
+
+    // Last reference
+    vkex::Result vkex_result = DestroyLinkedPipeline(registered, p_allocator);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::DestroyLinkedPipeline(
+    const RegisteredLinkedPipeline& registered,
+    const VkAllocationCallbacks*    p_allocator)
+{
+    // The optimized link may still be running
+    const vkex::AsyncGraphicsPipeline& optimized = registered.object.GetOptimized();
+    if (optimized.IsValid() && optimized.Wait()) {
+        {
+            std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+            m_optimized_linked_pipelines.erase(optimized.Get());
+        }
+        vkex::Result vkex_result = DestroyGraphicsPipeline(optimized.Get(), p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    if (registered.object.IsValid()) {
+        vkex::Result vkex_result = DestroyGraphicsPipeline(registered.object.GetFastLinked(), p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    for (auto& library : registered.libraries) {
+        vkex::Result vkex_result = ReleaseGraphicsPipeline(library, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::PipelineRegistryStats CDevice::GetPipelineRegistryStats() const
+{
+    std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+
+    vkex::PipelineRegistryStats stats = {};
+    stats.hit_count                   = m_pipeline_registry_hit_count;
+    stats.miss_count                  = m_pipeline_registry_miss_count;
+    stats.pipeline_count              = static_cast<uint32_t>(m_registered_pipeline_hashes.size());
+    return stats;
+}
+
+bool CDevice::IsRegisteredPipeline(const void* p_pipeline) const
+{
+    std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+
+    return (m_registered_pipeline_hashes.find(p_pipeline) != m_registered_pipeline_hashes.end()) ||
+           (m_optimized_linked_pipelines.find(p_pipeline) != m_optimized_linked_pipelines.end());
+}
+
+void CDevice::RetireRegisteredPipelines(VkPipelineLayout vk_layout)
+{
+    std::lock_guard<std::mutex> lock(m_pipeline_registry_mutex);
+
+    for (auto& it : m_registered_compute_pipelines) {
+        it.second.retired |= (it.second.vk_layout == vk_layout);
+    }
+    for (auto& it : m_registered_graphics_pipelines) {
+        it.second.retired |= (it.second.vk_layout == vk_layout);
+    }
+    for (auto& it : m_linked_graphics_pipelines) {
+        it.second.retired |= (it.second.vk_layout == vk_layout);
+    }
+}
+
+bool CDevice::IsInternedLayout(const void* p_layout) const
+{
+    std::lock_guard<std::mutex> lock(m_layout_intern_mutex);
+
+    return m_interned_layout_keys.find(p_layout) != m_interned_layout_keys.end();
+}
+
+void CDevice::WaitPipelineCompiles()
+{
+    vkex::WorkerPool* p_workers = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_pipeline_workers_mutex);
+        p_workers = m_pipeline_workers.get();
+    }
+
+    // Pool lives until the device is destroyed
+    if (p_workers != nullptr) {
+        p_workers->WaitIdle();
+    }
+}
+
+vkex::WorkerPool* CDevice::GetPipelineWorkers()
+{
+    std::lock_guard<std::mutex> lock(m_pipeline_workers_mutex);
+    if (!m_pipeline_workers) {
+        m_pipeline_workers = std::make_unique<vkex::WorkerPool>(m_create_info.pipeline_compile_thread_count, "Pipeline Compile");
+    }
+    return m_pipeline_workers.get();
+}
+
+vkex::Result CDevice::CreateImage(
+    const vkex::ImageCreateInfo& create_info,
+    vkex::Image*                 p_object,
+    const VkAllocationCallbacks* p_allocator)
+{
+    vkex::Result vkex_result = CreateObject<CImage>(
+        create_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_IMAGE),
+        m_stored_images,
+        &CImage::SetDevice,
+        this,
+        p_object);
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::DestroyImage(
+    vkex::Image                  object,
+    const VkAllocationCallbacks* p_allocator)
+{
+    vkex::Result vkex_result = DestroyObject<CImage>(
+        m_stored_images,
+        object,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_IMAGE));
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::CreateImageView(
+    const vkex::ImageViewCreateInfo& create_info,
+    vkex::ImageView*                 p_object,
+    const VkAllocationCallbacks*     p_allocator)
+{
+    vkex::Result vkex_result = CreateObject<CImageView>(
+        create_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_IMAGE_VIEW),
+        m_stored_image_views,
+        &CImageView::SetDevice,
+        this,
+        p_object);
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::DestroyImageView(
+    vkex::ImageView              object,
+    const VkAllocationCallbacks* p_allocator)
+{
+    if (object != nullptr) {
+        NotifyDestroyListeners(object->GetVkObject(), &vkex::ObjectDestroyListener::OnDestroyImageView);
+    }
+
+    vkex::Result vkex_result = DestroyObject<CImageView>(
+        m_stored_image_views,
+        object,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_IMAGE_VIEW));
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::CreateIndexBuffer(
+    const vkex::BufferCreateInfo& create_info,
+    vkex::Buffer*                 p_object,
+    const VkAllocationCallbacks*  p_allocator)
+{
+    // Force usage
+    auto use_create_info                          = create_info;
+    use_create_info.usage_flags.bits.index_buffer = true;
+
+    vkex::Result vkex_result = CreateObject<CBuffer>(
+        use_create_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER),
+        m_stored_buffers,
+        &CBuffer::SetDevice,
+        this,
+        p_object);
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::DestroyIndexBuffer(
+    vkex::Buffer                 object,
+    const VkAllocationCallbacks* p_allocator)
+{
+    vkex::Result vkex_result = DestroyObject<CBuffer>(
+        m_stored_buffers,
+        object,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER));
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::CreateIndirectBuffer(
+    const vkex::BufferCreateInfo& create_info,
+    vkex::Buffer*                 p_object,
+    const VkAllocationCallbacks*  p_allocator)
+{
+    // Force usage
+    auto use_create_info                             = create_info;
+    use_create_info.usage_flags.bits.indirect_buffer = true;
+
+    vkex::Result vkex_result = CreateObject<CBuffer>(
+        use_create_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER),
+        m_stored_buffers,
+        &CBuffer::SetDevice,
+        this,
+        p_object);
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::DestroyIndirectBuffer(
+    vkex::Buffer                 object,
+    const VkAllocationCallbacks* p_allocator)
+{
+    vkex::Result vkex_result = DestroyObject<CBuffer>(
+        m_stored_buffers,
+        object,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER));
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::CreatePipelineCache(
+    const vkex::PipelineCacheCreateInfo& create_info,
+    vkex::PipelineCache*                 p_object,
+    const VkAllocationCallbacks*         p_allocator)
+{
+    vkex::Result vkex_result = CreateObject<CPipelineCache>(
+        create_info,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE_CACHE),
         m_stored_pipeline_caches,
         &CPipelineCache::SetDevice,
         this,
@@ -1438,12 +2495,88 @@ vkex::Result CDevice::DestroyPipelineCache(
     vkex::Result vkex_result = DestroyObject<CPipelineCache>(
         m_stored_pipeline_caches,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE_CACHE));
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::LoadPipelineCache(const fs::path& path)
+{
+    if (m_default_pipeline_cache != nullptr) {
+        return vkex::Result::ErrorFailed;
+    }
+
+    const PipelineCacheFileHeader expected = GetPipelineCacheFileHeader(GetPhysicalDevice()->GetPhysicalDeviceProperties().core);
+
+    // Validate file contents
+    std::vector<uint8_t> file_data = fs::load_file(path);
+    const uint8_t*       p_data    = nullptr;
+    size_t               data_size = 0;
+    if (file_data.size() >= sizeof(PipelineCacheFileHeader)) {
+        PipelineCacheFileHeader header = {};
+        std::memcpy(&header, file_data.data(), sizeof(header));
+
+        const uint8_t* p_file_data    = file_data.data() + sizeof(header);
+        const size_t   file_data_size = file_data.size() - sizeof(header);
+
+        bool valid = (header.magic == expected.magic) &&
+                     (header.version == expected.version) &&
+                     (header.vendor_id == expected.vendor_id) &&
+                     (header.device_id == expected.device_id) &&
+                     (header.driver_version == expected.driver_version) &&
+                     (std::memcmp(header.pipeline_cache_uuid, expected.pipeline_cache_uuid, VK_UUID_SIZE) == 0) &&
+                     (header.data_size == file_data_size) &&
+                     (header.data_hash == HashBytes(p_file_data, file_data_size));
+        if (valid) {
+            p_data    = p_file_data;
+            data_size = file_data_size;
+        }
+        else {
+            VKEX_LOG_WARN("Ignoring stale or corrupt pipeline cache: " << path);
+        }
+    }
+
+    // Create cache
+    vkex::PipelineCacheCreateInfo create_info = {};
+    create_info.initial_data_size             = data_size;
+    create_info.initial_data                  = p_data;
+    vkex::Result vkex_result                  = CreatePipelineCache(create_info, &m_default_pipeline_cache);
+    if (!vkex_result) {
+        return vkex_result;
+    }
 
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::SavePipelineCache(const fs::path& path) const
+{
+    if (m_default_pipeline_cache == nullptr) {
+        return vkex::Result::ErrorResourceIsNull;
+    }
+
+    std::vector<uint8_t> data;
+    vkex::Result         vkex_result = m_default_pipeline_cache->GetData(&data);
     if (!vkex_result) {
         return vkex_result;
     }
 
+    PipelineCacheFileHeader header = GetPipelineCacheFileHeader(GetPhysicalDevice()->GetPhysicalDeviceProperties().core);
+    header.data_size               = static_cast<uint64_t>(data.size());
+    header.data_hash               = HashBytes(data.data(), data.size());
+
+    std::vector<uint8_t> file_data(sizeof(header) + data.size());
+    std::memcpy(file_data.data(), &header, sizeof(header));
+    if (!data.empty()) {
+        std::memcpy(file_data.data() + sizeof(header), data.data(), data.size());
+    }
+    if (!fs::save_file_atomic(path, file_data.data(), file_data.size())) {
+        return vkex::Result::ErrorFailed;
+    }
+
     return vkex::Result::Success;
 }
 
@@ -1454,7 +2587,7 @@ vkex::Result CDevice::CreatePipelineLayout(
 {
     vkex::Result vkex_result = CreateObject<CPipelineLayout>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE_LAYOUT),
         m_stored_pipeline_layouts,
         &CPipelineLayout::SetDevice,
         this,
@@ -1471,11 +2604,83 @@ vkex::Result CDevice::DestroyPipelineLayout(
     vkex::PipelineLayout         object,
     const VkAllocationCallbacks* p_allocator)
 {
+    // Interned layouts are shared, see ReleasePipelineLayout
+    if (IsInternedLayout(object)) {
+        return vkex::Result::ErrorObjectIsShared;
+    }
+
+    // The handle may be reused by a new layout
+    bool is_live = false;
+    {
+        std::lock_guard<std::mutex> lock(m_stored_pipeline_layouts.GetMutex());
+        is_live = m_stored_pipeline_layouts.IsLive(object);
+    }
+    if (is_live) {
+        RetireRegisteredPipelines(*object);
+    }
+
     vkex::Result vkex_result = DestroyObject<CPipelineLayout>(
         m_stored_pipeline_layouts,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    return vkex::Result::Success;
+}
 
+vkex::Result CDevice::AcquirePipelineLayout(
+    const vkex::PipelineLayoutCreateInfo& create_info,
+    vkex::PipelineLayout*                 p_object,
+    const VkAllocationCallbacks*          p_allocator)
+{
+    if (p_object == nullptr) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    std::lock_guard<std::mutex> lock(m_layout_intern_mutex);
+
+    LayoutKey key = GetLayoutKey(create_info);
+    auto      it  = m_interned_pipeline_layouts.find(key);
+    if (it == m_interned_pipeline_layouts.end()) {
+        InternedLayout<vkex::PipelineLayout> interned    = {};
+        vkex::Result                         vkex_result = CreatePipelineLayout(create_info, &interned.object, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        m_interned_layout_keys[interned.object] = key;
+        it                                      = m_interned_pipeline_layouts.emplace(std::move(key), interned).first;
+    }
+
+    ++(it->second.ref_count);
+    *p_object = it->second.object;
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CDevice::ReleasePipelineLayout(
+    vkex::PipelineLayout         object,
+    const VkAllocationCallbacks* p_allocator)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_layout_intern_mutex);
+
+        auto key_it = m_interned_layout_keys.find(object);
+        if (key_it != m_interned_layout_keys.end()) {
+            auto it = m_interned_pipeline_layouts.find(key_it->second);
+            VKEX_ASSERT(it != m_interned_pipeline_layouts.end());
+            if (--(it->second.ref_count) > 0) {
+                return vkex::Result::Success;
+            }
+            m_interned_pipeline_layouts.erase(it);
+            m_interned_layout_keys.erase(key_it);
+        }
+    }
+
+    // Last reference, or the object was never interned
+    vkex::Result vkex_result = DestroyPipelineLayout(object, p_allocator);
     if (!vkex_result) {
         return vkex_result;
     }
@@ -1490,7 +2695,7 @@ vkex::Result CDevice::CreateQueryPool(
 {
     vkex::Result vkex_result = CreateObject<CQueryPool>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_QUERY_POOL),
         m_stored_query_pools,
         &CQueryPool::SetDevice,
         this,
@@ -1510,7 +2715,7 @@ vkex::Result CDevice::DestroyQueryPool(
     vkex::Result vkex_result = DestroyObject<CQueryPool>(
         m_stored_query_pools,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_QUERY_POOL));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1526,7 +2731,7 @@ vkex::Result CDevice::CreateSampler(
 {
     vkex::Result vkex_result = CreateObject<CSampler>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SAMPLER),
         m_stored_samplers,
         &CSampler::SetDevice,
         this,
@@ -1543,10 +2748,14 @@ vkex::Result CDevice::DestroySampler(
     vkex::Sampler                object,
     const VkAllocationCallbacks* p_allocator)
 {
+    if (object != nullptr) {
+        NotifyDestroyListeners(object->GetVkObject(), &vkex::ObjectDestroyListener::OnDestroySampler);
+    }
+
     vkex::Result vkex_result = DestroyObject<CSampler>(
         m_stored_samplers,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SAMPLER));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1562,7 +2771,7 @@ vkex::Result CDevice::CreateSemaphore(
 {
     vkex::Result vkex_result = CreateObject<CSemaphore>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SEMAPHORE),
         m_stored_semaphores,
         &CSemaphore::SetDevice,
         this,
@@ -1582,7 +2791,7 @@ vkex::Result CDevice::DestroySemaphore(
     vkex::Result vkex_result = DestroyObject<CSemaphore>(
         m_stored_semaphores,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SEMAPHORE));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1598,7 +2807,7 @@ vkex::Result CDevice::CreateShaderModule(
 {
     vkex::Result vkex_result = CreateObject<CShaderModule>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SHADER_MODULE),
         m_stored_shader_modules,
         &CShaderModule::SetDevice,
         this,
@@ -1618,7 +2827,7 @@ vkex::Result CDevice::DestroyShaderModule(
     vkex::Result vkex_result = DestroyObject<CShaderModule>(
         m_stored_shader_modules,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SHADER_MODULE));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1634,7 +2843,7 @@ vkex::Result CDevice::CreateShaderProgram(
 {
     vkex::Result vkex_result = CreateObject<CShaderProgram>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN),
         m_stored_shader_programs,
         &CShaderProgram::SetDevice,
         this,
@@ -1654,7 +2863,7 @@ vkex::Result CDevice::DestroyShaderProgram(
     vkex::Result vkex_result = DestroyObject<CShaderProgram>(
         m_stored_shader_programs,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1674,7 +2883,7 @@ vkex::Result CDevice::CreateStorageBuffer(
 
     vkex::Result vkex_result = CreateObject<CBuffer>(
         use_create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER),
         m_stored_buffers,
         &CBuffer::SetDevice,
         this,
@@ -1694,7 +2903,7 @@ vkex::Result CDevice::DestroyStorageBuffer(
     vkex::Result vkex_result = DestroyObject<CBuffer>(
         m_stored_buffers,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1710,7 +2919,7 @@ vkex::Result CDevice::CreateSwapchain(
 {
     vkex::Result vkex_result = CreateObject<CSwapchain>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SWAPCHAIN_KHR),
         m_stored_swapchains,
         &CSwapchain::SetDevice,
         this,
@@ -1730,7 +2939,7 @@ vkex::Result CDevice::DestroySwapchain(
     vkex::Result vkex_result = DestroyObject<CSwapchain>(
         m_stored_swapchains,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_SWAPCHAIN_KHR));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1746,7 +2955,7 @@ vkex::Result CDevice::CreateTexture(
 {
     vkex::Result vkex_result = CreateObject<CTexture>(
         create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN),
         m_stored_textures,
         &CTexture::SetDevice,
         this,
@@ -1766,7 +2975,7 @@ vkex::Result CDevice::DestroyTexture(
     vkex::Result vkex_result = DestroyObject<CTexture>(
         m_stored_textures,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_UNKNOWN));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1786,7 +2995,7 @@ vkex::Result CDevice::CreateVertexBuffer(
 
     vkex::Result vkex_result = CreateObject<CBuffer>(
         use_create_info,
-        p_allocator,
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER),
         m_stored_buffers,
         &CBuffer::SetDevice,
         this,
@@ -1806,7 +3015,7 @@ vkex::Result CDevice::DestroyVertexBuffer(
     vkex::Result vkex_result = DestroyObject<CBuffer>(
         m_stored_buffers,
         object,
-        p_allocator);
+        ResolveAllocator(p_allocator, VK_OBJECT_TYPE_BUFFER));
 
     if (!vkex_result) {
         return vkex_result;
@@ -1815,4 +3024,68 @@ vkex::Result CDevice::DestroyVertexBuffer(
     return vkex::Result::Success;
 }
 
+void CDevice::QueueDeferredDestroy(DeferredDestroy&& deferred_destroy)
+{
+    std::lock_guard<std::mutex> lock(m_deferred_destroy_mutex);
+    deferred_destroy.frame = m_deferred_destroy_frame;
+    m_deferred_destroys.push_back(std::move(deferred_destroy));
+}
+
+void CDevice::BeginDeferredDestroyFrame(uint64_t frame)
+{
+    std::lock_guard<std::mutex> lock(m_deferred_destroy_mutex);
+    VKEX_ASSERT_MSG((frame >= m_deferred_destroy_frame), "Deferred destroy frame numbers must not decrease");
+    m_deferred_destroy_frame = frame;
+}
+
+vkex::Result CDevice::CollectDeferredDestroys(uint64_t completed_frame_count)
+{
+    // Take the ready entries, destroy without holding the lock so destroy
+    // functions can queue more deferred destroys.
+    std::vector<DeferredDestroy> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_deferred_destroy_mutex);
+        while (!m_deferred_destroys.empty() && (m_deferred_destroys.front().frame < completed_frame_count)) {
+            ready.push_back(std::move(m_deferred_destroys.front()));
+            m_deferred_destroys.pop_front();
+        }
+    }
+
+    vkex::Result result = vkex::Result::Success;
+    for (auto& deferred_destroy : ready) {
+        vkex::Result vkex_result = deferred_destroy.destroy_fn();
+        if (!vkex_result && result) {
+            result = vkex_result;
+        }
+    }
+
+    return result;
+}
+
+vkex::Result CDevice::FlushDeferredDestroys()
+{
+    return CollectDeferredDestroys(UINT64_MAX);
+}
+
+uint32_t CDevice::GetDeferredDestroyCount() const
+{
+    std::lock_guard<std::mutex> lock(m_deferred_destroy_mutex);
+    return static_cast<uint32_t>(m_deferred_destroys.size());
+}
+
+void CDevice::AddDestroyListener(vkex::ObjectDestroyListener* p_listener)
+{
+    std::lock_guard<std::mutex> lock(m_destroy_listeners_mutex);
+    m_destroy_listeners.push_back(p_listener);
+}
+
+void CDevice::RemoveDestroyListener(vkex::ObjectDestroyListener* p_listener)
+{
+    std::lock_guard<std::mutex> lock(m_destroy_listeners_mutex);
+    auto                        it = std::find(std::begin(m_destroy_listeners), std::end(m_destroy_listeners), p_listener);
+    if (it != std::end(m_destroy_listeners)) {
+        m_destroy_listeners.erase(it);
+    }
+}
+
 } // namespace vkex
\ No newline at end of file
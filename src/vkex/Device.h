@@ -17,9 +17,13 @@
 #ifndef __VKEX_DEVICE_H__
 #define __VKEX_DEVICE_H__
 
+#include "vkex/Bindless.h"
 #include "vkex/Buffer.h"
 #include "vkex/Command.h"
 #include "vkex/Descriptor.h"
+#include "vkex/DescriptorBuffer.h"
+#include "vkex/GpuProfiler.h"
+#include "vkex/HostAllocator.h"
 #include "vkex/Image.h"
 #include "vkex/Pipeline.h"
 #include "vkex/QueryPool.h"
@@ -30,6 +34,12 @@
 #include "vkex/Sync.h"
 #include "vkex/Texture.h"
 #include "vkex/Traits.h"
+#include "vkex/WorkerPool.h"
+
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace vkex {
 
@@ -39,15 +49,17 @@ struct PhysicalDeviceFeatures
 
     VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddress = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES};
     VkPhysicalDeviceDescriptorIndexingFeatures  descriptorIndexing  = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES};
+    VkPhysicalDeviceHostQueryResetFeatures      hostQueryReset      = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES};
 
     struct
     {
-        VkPhysicalDeviceDepthClampZeroOneFeaturesEXT     depthClampZeroOne     = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLAMP_ZERO_ONE_FEATURES_EXT};
-        VkPhysicalDeviceDepthClipControlFeaturesEXT      depthClipControl      = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_CONTROL_FEATURES_EXT};
-        VkPhysicalDeviceDepthClipEnableFeaturesEXT       depthClipEnable       = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_ENABLE_FEATURES_EXT};
-        VkPhysicalDeviceDescriptorBufferFeaturesEXT      descriptorBuffer      = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT};
-        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extendedDynamicState3 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT};
-        VkBool32                                         loadStoreOpNone;
+        VkPhysicalDeviceDepthClampZeroOneFeaturesEXT       depthClampZeroOne       = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLAMP_ZERO_ONE_FEATURES_EXT};
+        VkPhysicalDeviceDepthClipControlFeaturesEXT        depthClipControl        = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_CONTROL_FEATURES_EXT};
+        VkPhysicalDeviceDepthClipEnableFeaturesEXT         depthClipEnable         = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_ENABLE_FEATURES_EXT};
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT        descriptorBuffer        = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT};
+        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT   extendedDynamicState3   = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT};
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibrary = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT};
+        VkBool32                                           loadStoreOpNone;
     } ext;
 
     struct
@@ -322,10 +334,26 @@ struct DeviceCreateInfo
     std::vector<std::string>           extensions;
     vkex::PhysicalDeviceFeatures       enabled_features;
     bool                               safe_values;
+    uint32_t                           pipeline_compile_thread_count; // 0 uses WorkerPool's default
+    vkex::HostAllocator*               host_allocator;                // Optional, must outlive the device
+};
+
+/** @struct PipelineRegistryStats
+ *
+ */
+struct PipelineRegistryStats
+{
+    uint64_t hit_count;
+    uint64_t miss_count;
+    uint32_t pipeline_count;
 };
 
 /** @class IDevice
  *
+ * The Create* and Destroy* functions can be called from multiple threads.
+ * Each object type has its own storage lock, held only while the object
+ * is added or removed. Using the same object from several threads still
+ * follows the Vulkan external synchronization rules.
  */
 class CDevice
     : // public DeviceFunctionSet,
@@ -385,6 +413,11 @@ public:
      */
     const VkPhysicalDeviceDescriptorBufferPropertiesEXT& GetDescriptorBufferProperties() const;
 
+    /** @fn GetDescriptorIndexingProperties
+     *
+     */
+    const VkPhysicalDeviceDescriptorIndexingProperties& GetDescriptorIndexingProperties() const;
+
     /** @fn GetEnabledFeatures
      *
      */
@@ -393,6 +426,13 @@ public:
         return m_create_info.enabled_features;
     }
 
+    /** @fn IsDynamicBlendStateEnabled
+     *
+     * True if the extendedDynamicState3 color blend enable, blend equation
+     * and color write mask features are all enabled.
+     */
+    bool IsDynamicBlendStateEnabled() const;
+
     /** @n GetDeviceName()
      *
      */
@@ -431,6 +471,21 @@ public:
      */
     VkResult WaitIdle();
 
+    /** @fn CreateBindlessTable
+     *
+     */
+    vkex::Result CreateBindlessTable(
+        const vkex::BindlessTableCreateInfo& create_info,
+        vkex::BindlessTable*                 p_object,
+        const VkAllocationCallbacks*         p_allocator = nullptr);
+
+    /** @fn DestroyBindlessTable
+     *
+     */
+    vkex::Result DestroyBindlessTable(
+        vkex::BindlessTable          object,
+        const VkAllocationCallbacks* p_allocator = nullptr);
+
     /** @fn CreateBuffer
      *
      */
@@ -469,6 +524,19 @@ public:
         vkex::ComputePipeline*                 p_object,
         const VkAllocationCallbacks*           p_allocator = nullptr);
 
+    /** @fn CreateComputePipelineAsync
+     *
+     * Queues creation of the pipeline on the device's pipeline compile
+     * threads and returns immediately. Objects referenced by create_info
+     * must stay alive until the pipeline is ready. The pipeline is owned
+     * by the device like any other and is destroyed with
+     * DestroyComputePipeline.
+     */
+    vkex::Result CreateComputePipelineAsync(
+        const vkex::ComputePipelineCreateInfo& create_info,
+        vkex::AsyncComputePipeline*            p_object,
+        const VkAllocationCallbacks*           p_allocator = nullptr);
+
     /** @fn DestroyComputePipeline
      *
      */
@@ -491,6 +559,21 @@ public:
         vkex::Buffer                 object,
         const VkAllocationCallbacks* p_allocator = nullptr);
 
+    /** @fn CreateDescriptorBufferHeap
+     *
+     */
+    vkex::Result CreateDescriptorBufferHeap(
+        const vkex::DescriptorBufferHeapCreateInfo& create_info,
+        vkex::DescriptorBufferHeap*                 p_object,
+        const VkAllocationCallbacks*                p_allocator = nullptr);
+
+    /** @fn DestroyDescriptorBufferHeap
+     *
+     */
+    vkex::Result DestroyDescriptorBufferHeap(
+        vkex::DescriptorBufferHeap   object,
+        const VkAllocationCallbacks* p_allocator = nullptr);
+
     /** @fn CreateDescriptorPool
      *
      */
@@ -506,6 +589,21 @@ public:
         vkex::DescriptorPool         object,
         const VkAllocationCallbacks* p_allocator = nullptr);
 
+    /** @fn CreateDescriptorPoolChain
+     *
+     */
+    vkex::Result CreateDescriptorPoolChain(
+        const vkex::DescriptorPoolChainCreateInfo& create_info,
+        vkex::DescriptorPoolChain*                 p_object,
+        const VkAllocationCallbacks*               p_allocator = nullptr);
+
+    /** @fn DestroyDescriptorPoolChain
+     *
+     */
+    vkex::Result DestroyDescriptorPoolChain(
+        vkex::DescriptorPoolChain    object,
+        const VkAllocationCallbacks* p_allocator = nullptr);
+
     /** @fn CreateDescriptorSetLayout
      *
      */
@@ -536,6 +634,42 @@ public:
         const std::vector<vkex::DescriptorSetLayout>& objects,
         const VkAllocationCallbacks*                  p_allocator = nullptr);
 
+    /** @fn AcquireDescriptorSetLayout
+     *
+     * Returns the interned layout for create_info, creating it on first
+     * use. Create infos that differ only in binding order share a layout.
+     * Every acquire must be matched by a ReleaseDescriptorSetLayout; the
+     * layout is destroyed when the last reference is released.
+     * DestroyDescriptorSetLayout returns vkex::Result::ErrorObjectIsShared
+     * for interned layouts.
+     */
+    vkex::Result AcquireDescriptorSetLayout(
+        const vkex::DescriptorSetLayoutCreateInfo& create_info,
+        vkex::DescriptorSetLayout*                 p_object,
+        const VkAllocationCallbacks*               p_allocator = nullptr);
+
+    /** @fn ReleaseDescriptorSetLayout
+     *
+     */
+    vkex::Result ReleaseDescriptorSetLayout(
+        vkex::DescriptorSetLayout    object,
+        const VkAllocationCallbacks* p_allocator = nullptr);
+
+    /** @fn CreateDescriptorUpdateTemplate
+     *
+     */
+    vkex::Result CreateDescriptorUpdateTemplate(
+        const vkex::DescriptorUpdateTemplateCreateInfo& create_info,
+        vkex::DescriptorUpdateTemplate*                 p_object,
+        const VkAllocationCallbacks*                    p_allocator = nullptr);
+
+    /** @fn DestroyDescriptorUpdateTemplate
+     *
+     */
+    vkex::Result DestroyDescriptorUpdateTemplate(
+        vkex::DescriptorUpdateTemplate object,
+        const VkAllocationCallbacks*   p_allocator = nullptr);
+
     /** @fn CreateFence
      *
      */
@@ -551,6 +685,21 @@ public:
         vkex::Fence                  object,
         const VkAllocationCallbacks* p_allocator = nullptr);
 
+    /** @fn CreateGpuProfiler
+     *
+     */
+    vkex::Result CreateGpuProfiler(
+        const vkex::GpuProfilerCreateInfo& create_info,
+        vkex::GpuProfiler*                 p_object,
+        const VkAllocationCallbacks*       p_allocator = nullptr);
+
+    /** @fn DestroyGpuProfiler
+     *
+     */
+    vkex::Result DestroyGpuProfiler(
+        vkex::GpuProfiler            object,
+        const VkAllocationCallbacks* p_allocator = nullptr);
+
     /** @fn CreateIndexBuffer
      *
      */
@@ -589,6 +738,19 @@ public:
         vkex::GraphicsPipeline*                 p_object,
         const VkAllocationCallbacks*            p_allocator = nullptr);
 
+    /** @fn CreateGraphicsPipelineAsync
+     *
+     * Queues creation of the pipeline on the device's pipeline compile
+     * threads and returns immediately. Objects referenced by create_info
+     * must stay alive until the pipeline is ready. The pipeline is owned
+     * by the device like any other and is destroyed with
+     * DestroyGraphicsPipeline.
+     */
+    vkex::Result CreateGraphicsPipelineAsync(
+        const vkex::GraphicsPipelineCreateInfo& create_info,
+        vkex::AsyncGraphicsPipeline*            p_object,
+        const VkAllocationCallbacks*            p_allocator = nullptr);
+
     /** @fn DestroyGraphicsPipeline
      *
      */
@@ -596,6 +758,106 @@ public:
         vkex::GraphicsPipeline       object,
         const VkAllocationCallbacks* p_allocator = nullptr);
 
+    /** @fn GetOrCreateComputePipeline
+     *
+     * Returns the registered pipeline whose GetPipelineKey() matches
+     * create_info, creating and registering one on a miss. Registered
+     * pipelines are shared by every caller with the same state, so every
+     * call must be matched by a ReleaseComputePipeline; the pipeline is
+     * destroyed when the last reference is released. DestroyComputePipeline
+     * returns vkex::Result::ErrorObjectIsShared for registered pipelines.
+     * Destroying the pipeline layout stops later calls from matching
+     * pipelines created with it.
+     */
+    vkex::Result GetOrCreateComputePipeline(
+        const vkex::ComputePipelineCreateInfo& create_info,
+        vkex::ComputePipeline*                 p_object,
+        const VkAllocationCallbacks*           p_allocator = nullptr);
+
+    /** @fn ReleaseComputePipeline
+     *
+     */
+    vkex::Result ReleaseComputePipeline(
+        vkex::ComputePipeline        object,
+        const VkAllocationCallbacks* p_allocator = nullptr);
+
+    /** @fn GetOrCreateGraphicsPipeline
+     *
+     * See GetOrCreateComputePipeline.
+     */
+    vkex::Result GetOrCreateGraphicsPipeline(
+        const vkex::GraphicsPipelineCreateInfo& create_info,
+        vkex::GraphicsPipeline*                 p_object,
+        const VkAllocationCallbacks*            p_allocator = nullptr);
+
+    /** @fn ReleaseGraphicsPipeline
+     *
+     */
+    vkex::Result ReleaseGraphicsPipeline(
+        vkex::GraphicsPipeline       object,
+        const VkAllocationCallbacks* p_allocator = nullptr);
+
+    /** @fn LinkGraphicsPipeline
+     *
+     * Links pipeline libraries into a graphics pipeline, which is
+     * destroyed with DestroyGraphicsPipeline. The libraries can be
+     * destroyed once the pipeline has been linked.
+     */
+    vkex::Result LinkGraphicsPipeline(
+        const vkex::GraphicsPipelineLinkInfo& link_info,
+        vkex::GraphicsPipeline*               p_object,
+        const VkAllocationCallbacks*          p_allocator = nullptr);
+
+    /** @fn LinkGraphicsPipelineAsync
+     *
+     * See CreateGraphicsPipelineAsync.
+     */
+    vkex::Result LinkGraphicsPipelineAsync(
+        const vkex::GraphicsPipelineLinkInfo& link_info,
+        vkex::AsyncGraphicsPipeline*          p_object,
+        const VkAllocationCallbacks*          p_allocator = nullptr);
+
+    /** @fn GetOrLinkGraphicsPipeline
+     *
+     * Builds the pipeline for create_info out of vertex input,
+     * pre-rasterization, fragment shader and fragment output libraries.
+     * Each library is fetched from the pipeline registry, so a new
+     * combination only compiles the parts that haven't been seen before,
+     * and the libraries are then fast-linked. If optimize is set a link
+     * time optimized pipeline is also linked on the pipeline compile
+     * threads and the returned LinkedGraphicsPipeline switches to it once
+     * it's ready. Linked pipelines are registered like the libraries:
+     * every call must be matched by a ReleaseLinkedGraphicsPipeline, and
+     * neither the linked pipelines nor the libraries may be destroyed
+     * directly. Requires the graphicsPipelineLibrary feature.
+     */
+    vkex::Result GetOrLinkGraphicsPipeline(
+        const vkex::GraphicsPipelineCreateInfo& create_info,
+        bool                                    optimize,
+        vkex::LinkedGraphicsPipeline*           p_object,
+        const VkAllocationCallbacks*            p_allocator = nullptr);
+
+    /** @fn ReleaseLinkedGraphicsPipeline
+     *
+     * When the last reference is released, waits for the optimized link
+     * if it is still running, destroys both pipelines and releases the
+     * libraries.
+     */
+    vkex::Result ReleaseLinkedGraphicsPipeline(
+        const vkex::LinkedGraphicsPipeline& object,
+        const VkAllocationCallbacks*        p_allocator = nullptr);
+
+    /** @fn GetPipelineRegistryStats
+     *
+     */
+    vkex::PipelineRegistryStats GetPipelineRegistryStats() const;
+
+    /** @fn WaitPipelineCompiles
+     *
+     * Blocks until all pipelines queued by Create*PipelineAsync are ready.
+     */
+    void WaitPipelineCompiles();
+
     /** @fn CreateImage
      *
      */
@@ -641,6 +903,50 @@ public:
         vkex::PipelineCache          object,
         const VkAllocationCallbacks* p_allocator = nullptr);
 
+    /** @fn LoadPipelineCache
+     *
+     * Creates the device's default pipeline cache, seeded with the contents
+     * of the file at path if the file was written by SavePipelineCache for
+     * the same vendor, device, driver version and pipelineCacheUUID. A
+     * missing, stale or corrupt file results in an empty cache rather than
+     * an error. Once created, the default cache is used by
+     * CreateComputePipeline and CreateGraphicsPipeline whenever the create
+     * info does not specify a cache.
+     */
+    vkex::Result LoadPipelineCache(const fs::path& path);
+
+    /** @fn SavePipelineCache
+     *
+     * Writes the default pipeline cache to a temporary file next to path
+     * and renames it over path, so an interrupted write never leaves a
+     * truncated cache behind.
+     */
+    vkex::Result SavePipelineCache(const fs::path& path) const;
+
+    /** @fn GetDefaultPipelineCache
+     *
+     */
+    vkex::PipelineCache GetDefaultPipelineCache() const
+    {
+        return m_default_pipeline_cache;
+    }
+
+    /** @fn GetShaderReflectionCache
+     *
+     */
+    vkex::ShaderReflectionCache& GetShaderReflectionCache()
+    {
+        return m_shader_reflection_cache;
+    }
+
+    /** @fn GetHostAllocator
+     *
+     */
+    vkex::HostAllocator* GetHostAllocator() const
+    {
+        return m_create_info.host_allocator;
+    }
+
     /** @fn CreatePipelineLayout
      *
      */
@@ -656,6 +962,27 @@ public:
         vkex::PipelineLayout         object,
         const VkAllocationCallbacks* p_allocator = nullptr);
 
+    /** @fn AcquirePipelineLayout
+     *
+     * Returns the interned pipeline layout for create_info, keyed by the
+     * set layout handles and the push constant ranges. Combined with
+     * AcquireDescriptorSetLayout, shaders with identical interfaces end up
+     * with the same, compatible pipeline layout. Every acquire must be
+     * matched by a ReleasePipelineLayout, DestroyPipelineLayout rejects
+     * interned layouts.
+     */
+    vkex::Result AcquirePipelineLayout(
+        const vkex::PipelineLayoutCreateInfo& create_info,
+        vkex::PipelineLayout*                 p_object,
+        const VkAllocationCallbacks*          p_allocator = nullptr);
+
+    /** @fn ReleasePipelineLayout
+     *
+     */
+    vkex::Result ReleasePipelineLayout(
+        vkex::PipelineLayout         object,
+        const VkAllocationCallbacks* p_allocator = nullptr);
+
     /** @fn CreateQueryPool
      *
      */
@@ -791,6 +1118,73 @@ public:
         vkex::Buffer                 object,
         const VkAllocationCallbacks* p_allocator = nullptr);
 
+    /** @fn DestroyDeferred
+     *
+     * Opt-in deferred version of any Destroy* function, e.g.
+     *
+     *   device->DestroyDeferred(&vkex::CDevice::DestroyBuffer, buffer);
+     *
+     * The object is destroyed by CollectDeferredDestroys once every frame
+     * that was in flight when this was called has completed on the GPU,
+     * so it is safe to call while command buffers that use the object are
+     * still executing. Objects still queued are destroyed with the device.
+     */
+    template <typename HandleT>
+    void DestroyDeferred(
+        vkex::Result (CDevice::*p_destroy_fn)(HandleT, const VkAllocationCallbacks*),
+        std::type_identity_t<HandleT> object,
+        const VkAllocationCallbacks*  p_allocator = nullptr)
+    {
+        using ObjectT = typename std::decay<HandleT>::type;
+
+        DeferredDestroy deferred_destroy = {};
+        deferred_destroy.destroy_fn      = [this, p_destroy_fn, object = ObjectT(object), p_allocator]() -> vkex::Result {
+            return (this->*p_destroy_fn)(object, p_allocator);
+        };
+        QueueDeferredDestroy(std::move(deferred_destroy));
+    }
+
+    /** @fn BeginDeferredDestroyFrame
+     *
+     * Objects passed to DestroyDeferred from now on belong to frame.
+     * Frame numbers must not decrease. Called by vkex::Application at the
+     * start of every frame.
+     */
+    void BeginDeferredDestroyFrame(uint64_t frame);
+
+    /** @fn CollectDeferredDestroys
+     *
+     * Destroys the queued objects that belong to frames before
+     * completed_frame_count, i.e. to frames whose RenderData and
+     * PresentData fences have signaled. Called by vkex::Application once
+     * the fences of the frame slot being reused have been waited on.
+     */
+    vkex::Result CollectDeferredDestroys(uint64_t completed_frame_count);
+
+    /** @fn FlushDeferredDestroys
+     *
+     * Destroys all queued objects. The caller must make sure the GPU is
+     * no longer using them, e.g. with WaitIdle.
+     */
+    vkex::Result FlushDeferredDestroys();
+
+    /** @fn GetDeferredDestroyCount
+     *
+     */
+    uint32_t GetDeferredDestroyCount() const;
+
+    /** @fn AddDestroyListener
+     *
+     * p_listener is called on the thread that destroys the object and
+     * must stay valid until it is removed.
+     */
+    void AddDestroyListener(vkex::ObjectDestroyListener* p_listener);
+
+    /** @fn RemoveDestroyListener
+     *
+     */
+    void RemoveDestroyListener(vkex::ObjectDestroyListener* p_listener);
+
 private:
     friend class CInstance;
     friend class IObjectStorageFunctions;
@@ -817,6 +1211,16 @@ private:
         const vkex::DeviceCreateInfo& create_info,
         const VkAllocationCallbacks*  p_allocator);
 
+    /** @fn ResolveAllocator
+     *
+     * Substitutes the host allocator's callbacks for object_type when
+     * p_allocator is null or belongs to the host allocator. Callbacks
+     * supplied by the caller are returned unchanged.
+     */
+    const VkAllocationCallbacks* ResolveAllocator(
+        const VkAllocationCallbacks* p_allocator,
+        VkObjectType                 object_type) const;
+
     /** @fn DestroyAllObjects
      *
      */
@@ -835,35 +1239,187 @@ private:
         m_instance = instance;
     }
 
+    /** @fn GetPipelineWorkers
+     *
+     */
+    vkex::WorkerPool* GetPipelineWorkers();
+
+    /** @fn GetOrCreatePipeline
+     *
+     */
+    template <typename HandleT>
+    struct RegisteredPipeline
+    {
+        vkex::PipelineKey key;
+        VkPipelineLayout  vk_layout = VK_NULL_HANDLE;
+        bool              retired   = false;
+        HandleT           object    = nullptr;
+        uint32_t          ref_count = 0;
+    };
+
+    template <typename HandleT>
+    using RegisteredPipelineMap = std::unordered_multimap<uint64_t, RegisteredPipeline<HandleT>>;
+
+    template <typename CreateInfoT, typename HandleT, typename CreateFnT>
+    vkex::Result GetOrCreatePipeline(
+        const CreateInfoT&              create_info,
+        const VkAllocationCallbacks*    p_allocator,
+        CreateFnT                       create_fn,
+        RegisteredPipelineMap<HandleT>& registered_pipelines,
+        HandleT*                        p_object);
+
+    /** @fn ReleasePipeline
+     *
+     */
+    template <typename HandleT>
+    vkex::Result ReleasePipeline(
+        HandleT                         object,
+        const VkAllocationCallbacks*    p_allocator,
+        RegisteredPipelineMap<HandleT>& registered_pipelines);
+
+    struct RegisteredLinkedPipeline
+    {
+        vkex::PipelineKey                   key;
+        VkPipelineLayout                    vk_layout = VK_NULL_HANDLE;
+        bool                                retired   = false;
+        vkex::LinkedGraphicsPipeline        object;
+        std::vector<vkex::GraphicsPipeline> libraries;
+        uint32_t                            ref_count = 0;
+    };
+
+    /** @fn DestroyLinkedPipeline
+     *
+     */
+    vkex::Result DestroyLinkedPipeline(
+        const RegisteredLinkedPipeline& registered,
+        const VkAllocationCallbacks*    p_allocator);
+
+    /** @fn IsRegisteredPipeline
+     *
+     */
+    bool IsRegisteredPipeline(const void* p_pipeline) const;
+
+    /** @fn RetireRegisteredPipelines
+     *
+     * Stops lookups from matching registered pipelines created with
+     * vk_layout, whose handle may be reused once it's destroyed. Retired
+     * pipelines stay registered until their last release.
+     */
+    void RetireRegisteredPipelines(VkPipelineLayout vk_layout);
+
+    struct DeferredDestroy
+    {
+        uint64_t                      frame = 0;
+        std::function<vkex::Result()> destroy_fn;
+    };
+
+    /** @fn QueueDeferredDestroy
+     *
+     */
+    void QueueDeferredDestroy(DeferredDestroy&& deferred_destroy);
+
+    /** @fn NotifyDestroyListeners
+     *
+     */
+    template <typename HandleT>
+    void NotifyDestroyListeners(HandleT vk_handle, void (vkex::ObjectDestroyListener::*p_fn)(HandleT))
+    {
+        if (vk_handle == VK_NULL_HANDLE) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_destroy_listeners_mutex);
+        for (auto p_listener : m_destroy_listeners) {
+            (p_listener->*p_fn)(vk_handle);
+        }
+    }
+
+    using LayoutKey = std::vector<uint64_t>;
+
+    struct LayoutKeyHasher
+    {
+        size_t operator()(const LayoutKey& key) const
+        {
+            return static_cast<size_t>(HashBytes(DataPtr(key), key.size() * sizeof(uint64_t)));
+        }
+    };
+
+    template <typename HandleT>
+    struct InternedLayout
+    {
+        HandleT  object    = nullptr;
+        uint32_t ref_count = 0;
+    };
+
+    /** @fn IsInternedLayout
+     *
+     */
+    bool IsInternedLayout(const void* p_layout) const;
+
 private:
     vkex::Instance                       m_instance    = nullptr;
     DeviceCreateInfo                     m_create_info = {};
     std::vector<std::string>             m_found_extensions;
     std::vector<const char*>             m_c_str_extensions;
     std::vector<VkDeviceQueueCreateInfo> m_vk_queue_create_infos;
-    VkDeviceCreateInfo                   m_vk_create_info = {};
-    VkDevice                             m_vk_object      = VK_NULL_HANDLE;
-    VmaAllocator                         m_vma_allocator  = VK_NULL_HANDLE;
-
-    std::vector<std::unique_ptr<CBuffer>>              m_stored_buffers;
-    std::vector<std::unique_ptr<CCommandPool>>         m_stored_command_pools;
-    std::vector<std::unique_ptr<CComputePipeline>>     m_stored_compute_pipelines;
-    std::vector<std::unique_ptr<CDescriptorPool>>      m_stored_descriptor_pools;
-    std::vector<std::unique_ptr<CDescriptorSetLayout>> m_stored_descriptor_set_layouts;
-    std::vector<std::unique_ptr<CFence>>               m_stored_fences;
-    std::vector<std::unique_ptr<CGraphicsPipeline>>    m_stored_graphics_pipelines;
-    std::vector<std::unique_ptr<CImage>>               m_stored_images;
-    std::vector<std::unique_ptr<CImageView>>           m_stored_image_views;
-    std::vector<std::unique_ptr<CPipelineCache>>       m_stored_pipeline_caches;
-    std::vector<std::unique_ptr<CPipelineLayout>>      m_stored_pipeline_layouts;
-    std::vector<std::unique_ptr<CQueryPool>>           m_stored_query_pools;
-    std::vector<std::unique_ptr<CQueue>>               m_stored_queues;
-    std::vector<std::unique_ptr<CSampler>>             m_stored_samplers;
-    std::vector<std::unique_ptr<CSemaphore>>           m_stored_semaphores;
-    std::vector<std::unique_ptr<CShaderModule>>        m_stored_shader_modules;
-    std::vector<std::unique_ptr<CShaderProgram>>       m_stored_shader_programs;
-    std::vector<std::unique_ptr<CSwapchain>>           m_stored_swapchains;
-    std::vector<std::unique_ptr<CTexture>>             m_stored_textures;
+    VkDeviceCreateInfo                   m_vk_create_info         = {};
+    VkDevice                             m_vk_object              = VK_NULL_HANDLE;
+    VmaAllocator                         m_vma_allocator          = VK_NULL_HANDLE;
+    vkex::PipelineCache                  m_default_pipeline_cache = nullptr;
+    vkex::ShaderReflectionCache          m_shader_reflection_cache;
+    std::unique_ptr<vkex::WorkerPool>    m_pipeline_workers;
+    std::mutex                           m_pipeline_workers_mutex;
+
+    // Pipeline registry
+    mutable std::mutex                                          m_pipeline_registry_mutex;
+    RegisteredPipelineMap<vkex::ComputePipeline>                m_registered_compute_pipelines;
+    RegisteredPipelineMap<vkex::GraphicsPipeline>               m_registered_graphics_pipelines;
+    std::unordered_map<const void*, uint64_t>                   m_registered_pipeline_hashes;
+    std::unordered_multimap<uint64_t, RegisteredLinkedPipeline> m_linked_graphics_pipelines;
+    std::unordered_set<const void*>                             m_optimized_linked_pipelines;
+    uint64_t                                                    m_pipeline_registry_hit_count  = 0;
+    uint64_t                                                    m_pipeline_registry_miss_count = 0;
+
+    // Interned layouts
+    mutable std::mutex                                                                        m_layout_intern_mutex;
+    std::unordered_map<LayoutKey, InternedLayout<vkex::DescriptorSetLayout>, LayoutKeyHasher> m_interned_descriptor_set_layouts;
+    std::unordered_map<LayoutKey, InternedLayout<vkex::PipelineLayout>, LayoutKeyHasher>      m_interned_pipeline_layouts;
+    std::unordered_map<const void*, LayoutKey>                                                m_interned_layout_keys;
+
+    // Deferred destruction, entries are in frame order
+    mutable std::mutex          m_deferred_destroy_mutex;
+    std::deque<DeferredDestroy> m_deferred_destroys;
+    uint64_t                    m_deferred_destroy_frame = 0;
+
+    // Caches keyed by Vulkan handles
+    std::mutex                                m_destroy_listeners_mutex;
+    std::vector<vkex::ObjectDestroyListener*> m_destroy_listeners;
+
+    // Object storage, one lock per type
+    vkex::LockedObjectPool<CBindlessTable>            m_stored_bindless_tables;
+    vkex::LockedObjectPool<CBuffer>                   m_stored_buffers;
+    vkex::LockedObjectPool<CCommandPool>              m_stored_command_pools;
+    vkex::LockedObjectPool<CComputePipeline>          m_stored_compute_pipelines;
+    vkex::LockedObjectPool<CDescriptorBufferHeap>     m_stored_descriptor_buffer_heaps;
+    vkex::LockedObjectPool<CDescriptorPool>           m_stored_descriptor_pools;
+    vkex::LockedObjectPool<CDescriptorPoolChain>      m_stored_descriptor_pool_chains;
+    vkex::LockedObjectPool<CDescriptorSetLayout>      m_stored_descriptor_set_layouts;
+    vkex::LockedObjectPool<CDescriptorUpdateTemplate> m_stored_descriptor_update_templates;
+    vkex::LockedObjectPool<CFence>                    m_stored_fences;
+    vkex::LockedObjectPool<CGpuProfiler>              m_stored_gpu_profilers;
+    vkex::LockedObjectPool<CGraphicsPipeline>         m_stored_graphics_pipelines;
+    vkex::LockedObjectPool<CImage>                    m_stored_images;
+    vkex::LockedObjectPool<CImageView>                m_stored_image_views;
+    vkex::LockedObjectPool<CPipelineCache>            m_stored_pipeline_caches;
+    vkex::LockedObjectPool<CPipelineLayout>           m_stored_pipeline_layouts;
+    vkex::LockedObjectPool<CQueryPool>                m_stored_query_pools;
+    vkex::LockedObjectPool<CQueue>                    m_stored_queues;
+    vkex::LockedObjectPool<CSampler>                  m_stored_samplers;
+    vkex::LockedObjectPool<CSemaphore>                m_stored_semaphores;
+    vkex::LockedObjectPool<CShaderModule>             m_stored_shader_modules;
+    vkex::LockedObjectPool<CShaderProgram>            m_stored_shader_programs;
+    vkex::LockedObjectPool<CSwapchain>                m_stored_swapchains;
+    vkex::LockedObjectPool<CTexture>                  m_stored_textures;
 };
 
 extern PFN_vkCmdPushDescriptorSetKHR CmdPushDescriptorSetKHR;
@@ -880,6 +1436,12 @@ extern PFN_vkGetImageViewOpaqueCaptureDescriptorDataEXT             GetImageView
 extern PFN_vkGetSamplerOpaqueCaptureDescriptorDataEXT               GetSamplerOpaqueCaptureDescriptorDataEXT;
 extern PFN_vkGetAccelerationStructureOpaqueCaptureDescriptorDataEXT GetAccelerationStructureOpaqueCaptureDescriptorDataEXT;
 
+extern PFN_vkCmdSetColorBlendEnableEXT   CmdSetColorBlendEnableEXT;
+extern PFN_vkCmdSetColorBlendEquationEXT CmdSetColorBlendEquationEXT;
+extern PFN_vkCmdSetColorWriteMaskEXT     CmdSetColorWriteMaskEXT;
+
+extern PFN_vkResetQueryPoolEXT ResetQueryPoolEXT;
+
 } // namespace vkex
 
 #endif // __VKEX_DEVICE_H__
\ No newline at end of file
@@ -49,6 +49,41 @@ inline std::vector<uint8_t> load_file(const fs::path& p)
     return data;
 }
 
+/*! @fn save_file_atomic
+
+   Writes 'size' bytes from 'p_data' to a temporary file next to 'p' and
+   renames it over 'p', so readers never see a partially written file.
+
+   @return Returns true if the file was written.
+
+ */
+inline bool save_file_atomic(const fs::path& p, const void* p_data, size_t size)
+{
+    fs::path tmp_path = p;
+    tmp_path += ".tmp";
+    {
+        std::ofstream os(tmp_path.c_str(), std::ios::binary | std::ios::trunc);
+        if (!os.is_open()) {
+            return false;
+        }
+        os.write(static_cast<const char*>(p_data), size);
+        os.close();
+        if (os.fail()) {
+            std::error_code ec;
+            fs::remove(tmp_path, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmp_path, p, ec);
+    if (ec) {
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
 } // namespace vkex::fs
 
 #endif // __VKEX_FILE_SYSTEM_H__
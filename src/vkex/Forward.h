@@ -28,17 +28,22 @@ namespace vkex {
 /** Forward declares
  *
  */
+class CBindlessTable;
 class CBuffer;
 class CCommandBuffer;
 class CCommandPool;
 class CComputePipeline;
 class CDepthStencilView;
+class CDescriptorBufferHeap;
 class CDescriptorPool;
+class CDescriptorPoolChain;
 class CDescriptorSetLayout;
 class CDescriptorSet;
+class CDescriptorUpdateTemplate;
 class CDevice;
 class CDeviceMemory;
 class CFence;
+class CGpuProfiler;
 class CGpuBufferResource;
 class CGpuTextureResource;
 class CGraphicsPipeline;
@@ -60,6 +65,7 @@ class CSurface;
 class CSwapchain;
 class CTexture;
 
+struct DescriptorBufferAllocation;
 struct DescriptorSetLayoutCreateInfo;
 
 /** Handles
@@ -97,6 +103,12 @@ using Surface             = typename std::add_pointer<CSurface>::type;
 using Swapchain           = typename std::add_pointer<CSwapchain>::type;
 using Texture             = typename std::add_pointer<CTexture>::type;
 
+using BindlessTable            = typename std::add_pointer<CBindlessTable>::type;
+using DescriptorBufferHeap     = typename std::add_pointer<CDescriptorBufferHeap>::type;
+using DescriptorPoolChain      = typename std::add_pointer<CDescriptorPoolChain>::type;
+using DescriptorUpdateTemplate = typename std::add_pointer<CDescriptorUpdateTemplate>::type;
+using GpuProfiler              = typename std::add_pointer<CGpuProfiler>::type;
+
 } // namespace vkex
 
 #endif // __VKEX_FORWARD_H__
\ No newline at end of file
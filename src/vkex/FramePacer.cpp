@@ -0,0 +1,163 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#include "vkex/FramePacer.h"
+#include "vkex/Timer.h"
+
+#include <thread>
+
+namespace vkex {
+
+// Spin bounds, the spin covers the measured sleep overshoot plus a margin
+static const double kMinSpinNanos    = 200000.0;
+static const double kMaxSpinNanos    = 4000000.0;
+static const double kSpinMarginNanos = 100000.0;
+// Yield instead of spinning hard while more than this is left
+static const double kYieldThresholdNanos = 50000.0;
+
+FramePacer::FramePacer()
+{
+    // Start conservatively until the first sleeps have been measured
+    m_sleep_overshoot_nanos = kMaxSpinNanos / 2.0;
+    m_spin_nanos            = kMaxSpinNanos;
+    m_error_histogram.resize(kHistogramBucketCount, 0);
+}
+
+FramePacer::~FramePacer()
+{
+}
+
+double FramePacer::Now()
+{
+    return vkex::Timer::TimestampToNanos(vkex::Timer::Timestamp());
+}
+
+void FramePacer::SetFrameRate(uint32_t frame_rate)
+{
+    if (frame_rate == m_frame_rate) {
+        return;
+    }
+
+    m_frame_rate   = frame_rate;
+    m_period_nanos = (frame_rate > 0) ? (1.0e9 / static_cast<double>(frame_rate)) : 0;
+    Restart();
+}
+
+void FramePacer::Restart()
+{
+    m_started      = false;
+    m_frame_number = 0;
+}
+
+void FramePacer::WaitForNextFrame()
+{
+    if (m_period_nanos <= 0) {
+        return;
+    }
+
+    double now = Now();
+
+    // First frame anchors the schedule
+    if (!m_started) {
+        m_frame_0_nanos = now;
+        m_frame_number  = 0;
+        m_started       = true;
+        return;
+    }
+
+    ++m_frame_number;
+    double deadline  = m_frame_0_nanos + (static_cast<double>(m_frame_number) * m_period_nanos);
+    double remaining = deadline - now;
+
+    // The frame itself ran past the deadline
+    if (remaining <= 0) {
+        ++m_missed_frame_count;
+        if (-remaining > m_period_nanos) {
+            m_frame_0_nanos = now;
+            m_frame_number  = 0;
+            ++m_resync_count;
+        }
+        return;
+    }
+
+    // Coarse sleep, leaving the spin phase to absorb the overshoot
+    double sleep_nanos = remaining - m_spin_nanos;
+    if (sleep_nanos > 0) {
+        double sleep_start = now;
+        vkex::Timer::SleepNanos(sleep_nanos);
+        now = Now();
+        UpdateSleepOvershoot((now - sleep_start) - sleep_nanos);
+    }
+
+    // Spin for the remainder
+    while (true) {
+        remaining = deadline - now;
+        if (remaining <= 0) {
+            break;
+        }
+        if (remaining > kYieldThresholdNanos) {
+            std::this_thread::yield();
+        }
+        now = Now();
+    }
+
+    RecordError(now - deadline);
+}
+
+void FramePacer::UpdateSleepOvershoot(double overshoot_nanos)
+{
+    overshoot_nanos = std::max(overshoot_nanos, 0.0);
+
+    // Rise immediately on a long oversleep, decay slowly otherwise
+    m_sleep_overshoot_nanos = std::max(overshoot_nanos, (0.95 * m_sleep_overshoot_nanos) + (0.05 * overshoot_nanos));
+    m_spin_nanos            = std::clamp(m_sleep_overshoot_nanos + kSpinMarginNanos, kMinSpinNanos, kMaxSpinNanos);
+}
+
+void FramePacer::RecordError(double error_nanos)
+{
+    ++m_paced_frame_count;
+    m_total_error_nanos += error_nanos;
+    m_max_error_nanos = std::max(m_max_error_nanos, error_nanos);
+
+    uint64_t bucket = static_cast<uint64_t>(error_nanos / (1000.0 * static_cast<double>(kHistogramBucketMicros)));
+    bucket          = std::min<uint64_t>(bucket, kHistogramBucketCount - 1);
+    m_error_histogram[bucket] += 1;
+}
+
+FramePacerStats FramePacer::GetStats() const
+{
+    FramePacerStats stats        = {};
+    stats.paced_frame_count      = m_paced_frame_count;
+    stats.missed_frame_count     = m_missed_frame_count;
+    stats.resync_count           = m_resync_count;
+    stats.mean_error_micros      = (m_paced_frame_count > 0) ? ((m_total_error_nanos / 1000.0) / static_cast<double>(m_paced_frame_count)) : 0;
+    stats.max_error_micros       = m_max_error_nanos / 1000.0;
+    stats.sleep_overshoot_micros = m_sleep_overshoot_nanos / 1000.0;
+    stats.error_histogram        = m_error_histogram;
+    return stats;
+}
+
+void FramePacer::ResetStats()
+{
+    m_paced_frame_count  = 0;
+    m_missed_frame_count = 0;
+    m_resync_count       = 0;
+    m_total_error_nanos  = 0;
+    m_max_error_nanos    = 0;
+    std::fill(std::begin(m_error_histogram), std::end(m_error_histogram), 0);
+}
+
+} // namespace vkex
\ No newline at end of file
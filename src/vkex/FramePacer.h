@@ -0,0 +1,126 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#ifndef __VKEX_FRAME_PACER_H__
+#define __VKEX_FRAME_PACER_H__
+
+#include "vkex/Config.h"
+
+namespace vkex {
+
+/** @struct FramePacerStats
+ *
+ * Pacing error is how late the pacer returned relative to the frame's
+ * deadline. error_histogram has kHistogramBucketMicros wide buckets and
+ * the last bucket also holds everything beyond it. Frames that reached
+ * the pacer after their deadline are counted as missed and are not part
+ * of the error statistics.
+ */
+struct FramePacerStats
+{
+    uint64_t              paced_frame_count      = 0;
+    uint64_t              missed_frame_count     = 0;
+    uint64_t              resync_count           = 0;
+    double                mean_error_micros      = 0;
+    double                max_error_micros       = 0;
+    double                sleep_overshoot_micros = 0;
+    std::vector<uint64_t> error_histogram;
+};
+
+/** @class FramePacer
+ *
+ * Holds frames to a fixed rate. Deadlines are computed from the time of
+ * the first paced frame, so rounding never accumulates into drift. The
+ * wait is split into a coarse OS sleep and a spin for the last stretch.
+ * The spin covers the sleep's overshoot, which is measured on every
+ * sleep. If a frame falls more than a full period behind, the schedule
+ * is re-anchored rather than rushing the following frames to catch up.
+ */
+class FramePacer
+{
+public:
+    enum
+    {
+        kHistogramBucketMicros = 10,
+        kHistogramBucketCount  = 100,
+    };
+
+    FramePacer();
+    ~FramePacer();
+
+    /** @fn SetFrameRate
+     *
+     * A frame_rate of 0 disables pacing. Changing the rate restarts the
+     * schedule at the next frame.
+     */
+    void SetFrameRate(uint32_t frame_rate);
+
+    /** @fn GetFrameRate
+     *
+     */
+    uint32_t GetFrameRate() const
+    {
+        return m_frame_rate;
+    }
+
+    /** @fn Restart
+     *
+     * The next call to WaitForNextFrame() starts a new schedule.
+     */
+    void Restart();
+
+    /** @fn WaitForNextFrame
+     *
+     * Call once per frame. Returns once the current frame's deadline has
+     * passed.
+     */
+    void WaitForNextFrame();
+
+    /** @fn GetStats
+     *
+     */
+    FramePacerStats GetStats() const;
+
+    /** @fn ResetStats
+     *
+     */
+    void ResetStats();
+
+private:
+    static double Now();
+
+    void UpdateSleepOvershoot(double overshoot_nanos);
+    void RecordError(double error_nanos);
+
+private:
+    uint32_t              m_frame_rate             = 0;
+    double                m_period_nanos           = 0;
+    bool                  m_started                = false;
+    double                m_frame_0_nanos          = 0;
+    uint64_t              m_frame_number           = 0;
+    double                m_sleep_overshoot_nanos  = 0;
+    double                m_spin_nanos             = 0;
+    uint64_t              m_paced_frame_count      = 0;
+    uint64_t              m_missed_frame_count     = 0;
+    uint64_t              m_resync_count           = 0;
+    double                m_total_error_nanos      = 0;
+    double                m_max_error_nanos        = 0;
+    std::vector<uint64_t> m_error_histogram;
+};
+
+} // namespace vkex
+
+#endif // __VKEX_FRAME_PACER_H__
\ No newline at end of file
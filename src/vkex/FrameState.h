@@ -0,0 +1,94 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#ifndef __VKEX_FRAME_STATE_H__
+#define __VKEX_FRAME_STATE_H__
+
+#include "vkex/Config.h"
+
+namespace vkex {
+
+/** @class IFrameState
+ *
+ */
+class IFrameState
+{
+public:
+    IFrameState() {}
+    virtual ~IFrameState() {}
+
+    /** @fn Publish
+     *
+     * Called by Application between Update and Render, while neither is
+     * running.
+     */
+    virtual void Publish() = 0;
+};
+
+/** @class FrameStateT
+ *
+ * Double-buffered hand-off of per-frame state from Update to Render.
+ * Update writes GetUpdateState(), Render reads GetRenderState(), and
+ * Publish() copies the former into the latter. With pipelined updates
+ * Update for frame N+1 runs while Render records frame N, so Render must
+ * only read state through GetRenderState() and Update must only write
+ * through GetUpdateState(). The update state is not reset by Publish(),
+ * so Update keeps building on its own results. T should be a compact
+ * snapshot, it is copied once per frame.
+ *
+ * Register instances with Application::RegisterFrameState().
+ */
+template <typename T>
+class FrameStateT : public IFrameState
+{
+public:
+    FrameStateT() {}
+    FrameStateT(const T& initial_state)
+        : m_update_state(initial_state), m_render_state(initial_state) {}
+    virtual ~FrameStateT() {}
+
+    /** @fn GetUpdateState
+     *
+     */
+    T& GetUpdateState()
+    {
+        return m_update_state;
+    }
+
+    /** @fn GetRenderState
+     *
+     */
+    const T& GetRenderState() const
+    {
+        return m_render_state;
+    }
+
+    /** @fn Publish
+     *
+     */
+    virtual void Publish() override
+    {
+        m_render_state = m_update_state;
+    }
+
+private:
+    T m_update_state = {};
+    T m_render_state = {};
+};
+
+} // namespace vkex
+
+#endif // __VKEX_FRAME_STATE_H__
\ No newline at end of file
@@ -0,0 +1,294 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#include "vkex/GpuProfiler.h"
+#include "vkex/Device.h"
+#include "vkex/ToString.h"
+
+#include <algorithm>
+
+namespace vkex {
+
+// =================================================================================================
+// GpuProfiler
+// =================================================================================================
+CGpuProfiler::CGpuProfiler()
+{
+}
+
+CGpuProfiler::~CGpuProfiler()
+{
+}
+
+vkex::Result CGpuProfiler::InternalCreate(
+    const vkex::GpuProfilerCreateInfo& create_info,
+    const VkAllocationCallbacks*       p_allocator)
+{
+    // Copy create info
+    m_create_info = create_info;
+
+    if ((m_create_info.frame_count == 0) || (m_create_info.max_zones_per_frame == 0) || (m_create_info.stats_window_size == 0)) {
+        return vkex::Result::ErrorOutOfRange;
+    }
+
+    // Timestamp support
+    {
+        VkQueueFamilyProperties2 vk_queue_family_properties = {VK_STRUCTURE_TYPE_QUEUE_FAMILY_PROPERTIES_2};
+        bool                     found                      = GetDevice()->GetPhysicalDevice()->GetQueueFamilyProperties(
+            m_create_info.queue_family_index,
+            &vk_queue_family_properties);
+        if (!found) {
+            return vkex::Result::ErrorInvalidQueueFamilyIndex;
+        }
+
+        uint32_t valid_bits = vk_queue_family_properties.queueFamilyProperties.timestampValidBits;
+        if (valid_bits == 0) {
+            return vkex::Result::ErrorTimestampsNotSupported;
+        }
+
+        m_timestamp_mask   = (valid_bits >= 64) ? UINT64_MAX : ((static_cast<uint64_t>(1) << valid_bits) - 1);
+        m_timestamp_period = GetDevice()->GetPhysicalDevice()->GetPhysicalDeviceProperties().core.limits.timestampPeriod;
+    }
+
+    // Query pools, two timestamps per zone
+    m_frames.resize(m_create_info.frame_count);
+    for (auto& frame : m_frames) {
+        vkex::QueryPoolCreateInfo create_info = {};
+        create_info.query_type                = VK_QUERY_TYPE_TIMESTAMP;
+        create_info.query_count               = 2 * m_create_info.max_zones_per_frame;
+        vkex::Result vkex_result              = GetDevice()->CreateQueryPool(create_info, &frame.query_pool, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        frame.zones.reserve(m_create_info.max_zones_per_frame);
+    }
+
+    m_zone_stack.reserve(m_create_info.max_zones_per_frame);
+    m_query_data.reserve(4 * m_create_info.max_zones_per_frame);
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CGpuProfiler::InternalDestroy(const VkAllocationCallbacks* p_allocator)
+{
+    for (auto& frame : m_frames) {
+        if (frame.query_pool == nullptr) {
+            continue;
+        }
+
+        vkex::Result vkex_result = GetDevice()->DestroyQueryPool(frame.query_pool, p_allocator);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        frame.query_pool = nullptr;
+    }
+    m_frames.clear();
+    m_current_frame = nullptr;
+
+    return vkex::Result::Success;
+}
+
+bool CGpuProfiler::ResolveFrame(Frame* p_frame)
+{
+    if (p_frame->zones.empty()) {
+        return true;
+    }
+
+    // Value and availability for both timestamps of every zone
+    uint32_t query_count = 2 * CountU32(p_frame->zones);
+    m_query_data.resize(2 * query_count);
+
+    VkResult vk_result = vkGetQueryPoolResults(
+        *m_device,
+        *(p_frame->query_pool),
+        0,
+        query_count,
+        m_query_data.size() * sizeof(uint64_t),
+        m_query_data.data(),
+        2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (vk_result != VK_SUCCESS) {
+        return false;
+    }
+
+    for (uint32_t query = 0; query < query_count; ++query) {
+        if (m_query_data[2 * query + 1] == 0) {
+            return false;
+        }
+    }
+
+    // Parents always begin before their children, so their paths are
+    // already built.
+    const double seconds_per_tick = static_cast<double>(m_timestamp_period) * 1.0e-9;
+    m_zone_results.resize(p_frame->zones.size());
+    for (size_t i = 0; i < p_frame->zones.size(); ++i) {
+        const Zone& zone  = p_frame->zones[i];
+        uint64_t    begin = m_query_data[4 * i + 0];
+        uint64_t    end   = m_query_data[4 * i + 2];
+        uint64_t    ticks = (end - begin) & m_timestamp_mask;
+
+        vkex::GpuZoneResult& result = m_zone_results[i];
+        result.name                 = zone.name;
+        result.depth                = zone.depth;
+        result.time                 = static_cast<double>(ticks) * seconds_per_tick;
+        if (zone.parent == kInvalidZone) {
+            result.path = zone.name;
+        }
+        else {
+            result.path = m_zone_results[zone.parent].path + "/" + zone.name;
+        }
+
+        auto it = m_zone_stats.find(result.path);
+        if (it == m_zone_stats.end()) {
+            // Zones can be far shorter than the microsecond RunningStats
+            // floor, so track from 10 ns.
+            it = m_zone_stats.try_emplace(result.path, m_create_info.stats_window_size, 1.0e-8, 10.0).first;
+        }
+        it->second.Push(result.time);
+    }
+
+    // Bounded in case nobody takes them
+    if (m_resolved_frame_times.size() >= m_create_info.stats_window_size) {
+        m_resolved_frame_times.erase(m_resolved_frame_times.begin());
+    }
+
+    vkex::GpuFrameTime frame_time = {};
+    frame_time.frame_number       = p_frame->frame_number;
+    frame_time.time               = m_zone_results[0].time;
+    m_resolved_frame_times.push_back(frame_time);
+
+    return true;
+}
+
+void CGpuProfiler::NewFrame(uint32_t frame_index, uint64_t frame_number)
+{
+    VKEX_ASSERT_MSG((frame_index < m_create_info.frame_count), "Frame index exceeds GPU profiler frame count");
+
+    Frame& frame = m_frames[frame_index];
+    if (frame.pending) {
+        if (!ResolveFrame(&frame)) {
+            ++m_dropped_frame_count;
+        }
+        frame.pending = false;
+    }
+
+    frame.zones.clear();
+    frame.frame_number = frame_number;
+    m_current_frame    = &frame;
+    m_zone_stack.clear();
+}
+
+void CGpuProfiler::CmdBeginFrame(vkex::CommandBuffer cmd, const char* name)
+{
+    if (m_current_frame == nullptr) {
+        return;
+    }
+
+    cmd->CmdResetQueryPool(m_current_frame->query_pool, 0, m_current_frame->query_pool->GetQueryCount());
+    CmdBeginZone(cmd, name);
+}
+
+void CGpuProfiler::CmdEndFrame(vkex::CommandBuffer cmd)
+{
+    if (m_current_frame == nullptr) {
+        return;
+    }
+
+    while (!m_zone_stack.empty()) {
+        CmdEndZone(cmd);
+    }
+
+    m_current_frame->pending = !m_current_frame->zones.empty();
+    m_current_frame          = nullptr;
+}
+
+void CGpuProfiler::CmdBeginZone(vkex::CommandBuffer cmd, const char* name, VkPipelineStageFlagBits stage)
+{
+    if (m_current_frame == nullptr) {
+        return;
+    }
+
+    std::vector<Zone>& zones = m_current_frame->zones;
+    if (zones.size() >= m_create_info.max_zones_per_frame) {
+        ++m_overflow_zone_count;
+        m_zone_stack.push_back(kInvalidZone);
+        return;
+    }
+
+    Zone zone   = {};
+    zone.name   = name;
+    zone.parent = m_zone_stack.empty() ? kInvalidZone : m_zone_stack.back();
+    zone.depth  = CountU32(m_zone_stack);
+
+    uint32_t index = CountU32(zones);
+    zones.push_back(zone);
+    m_zone_stack.push_back(index);
+
+    cmd->CmdWriteTimestamp(stage, m_current_frame->query_pool, 2 * index);
+}
+
+void CGpuProfiler::CmdEndZone(vkex::CommandBuffer cmd, VkPipelineStageFlagBits stage)
+{
+    if ((m_current_frame == nullptr) || m_zone_stack.empty()) {
+        return;
+    }
+
+    uint32_t index = m_zone_stack.back();
+    m_zone_stack.pop_back();
+    if (index == kInvalidZone) {
+        return;
+    }
+
+    cmd->CmdWriteTimestamp(stage, m_current_frame->query_pool, 2 * index + 1);
+}
+
+void CGpuProfiler::ResolvePendingFrames()
+{
+    std::vector<Frame*> pending_frames;
+    for (auto& frame : m_frames) {
+        if (frame.pending) {
+            pending_frames.push_back(&frame);
+        }
+    }
+
+    std::sort(
+        std::begin(pending_frames),
+        std::end(pending_frames),
+        [](const Frame* a, const Frame* b) -> bool { return a->frame_number < b->frame_number; });
+
+    for (auto p_frame : pending_frames) {
+        if (ResolveFrame(p_frame)) {
+            p_frame->pending = false;
+        }
+    }
+}
+
+const vkex::RunningStats* CGpuProfiler::GetZoneStats(const std::string& path) const
+{
+    auto it = m_zone_stats.find(path);
+    if (it == m_zone_stats.end()) {
+        return nullptr;
+    }
+    return &(it->second);
+}
+
+void CGpuProfiler::TakeResolvedFrameTimes(std::vector<vkex::GpuFrameTime>* p_frame_times)
+{
+    p_frame_times->insert(std::end(*p_frame_times), std::begin(m_resolved_frame_times), std::end(m_resolved_frame_times));
+    m_resolved_frame_times.clear();
+}
+
+} // namespace vkex
\ No newline at end of file
@@ -0,0 +1,284 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#ifndef __VKEX_GPU_PROFILER_H__
+#define __VKEX_GPU_PROFILER_H__
+
+#include "vkex/Config.h"
+#include "vkex/QueryPool.h"
+#include "vkex/RunningStats.h"
+#include "vkex/Traits.h"
+#include "vkex/VulkanUtil.h"
+
+#include <unordered_map>
+
+#define VKEX_GPU_ZONE_CONCAT_INNER(a, b) a##b
+#define VKEX_GPU_ZONE_CONCAT(a, b)       VKEX_GPU_ZONE_CONCAT_INNER(a, b)
+
+// Use as follows: VKEX_GPU_ZONE(profiler, cmd, "Shadows"). The zone ends
+// at the end of the enclosing scope. name must be a string literal.
+#define VKEX_GPU_ZONE(profiler, cmd, name) \
+    vkex::GpuZoneScope VKEX_GPU_ZONE_CONCAT(vkex_gpu_zone_, __LINE__)(profiler, cmd, name)
+
+namespace vkex {
+
+// =================================================================================================
+// GpuProfiler
+// =================================================================================================
+
+/** @struct GpuProfilerCreateInfo
+ *
+ * frame_count is the number of frames in flight. Command buffers using
+ * the profiler must be submitted to queues of queue_family_index.
+ * stats_window_size is the number of frames each zone's rolling stats
+ * cover.
+ */
+struct GpuProfilerCreateInfo
+{
+    uint32_t frame_count;
+    uint32_t queue_family_index;
+    uint32_t max_zones_per_frame = 256;
+    size_t   stats_window_size   = 1000;
+};
+
+/** @struct GpuZoneResult
+ *
+ * path is the zone's name prefixed with the names of its parents,
+ * separated by '/'. time is in seconds.
+ */
+struct GpuZoneResult
+{
+    const char* name  = nullptr;
+    std::string path;
+    uint32_t    depth = 0;
+    double      time  = 0;
+};
+
+/** @struct GpuFrameTime
+ *
+ */
+struct GpuFrameTime
+{
+    uint64_t frame_number = 0;
+    double   time         = 0;
+};
+
+/** @class IGpuProfiler
+ *
+ * GPU timestamp profiler with one timestamp query pool per frame in
+ * flight. Every frame is bracketed by CmdBeginFrame() and CmdEndFrame(),
+ * which record the root zone, and may contain nested zones recorded with
+ * CmdBeginZone()/CmdEndZone(), CCommandBuffer::CmdBeginGpuZone()/
+ * CmdEndGpuZone() or VKEX_GPU_ZONE. All zones of a frame
+ * must be recorded on one thread, in submission order.
+ *
+ * Results are read with vkGetQueryPoolResults without waiting: NewFrame()
+ * resolves the previous use of the frame's query pool, which has retired
+ * once the frame's fence has been waited on. A frame whose results are
+ * not available by then is dropped. Resolved zones feed per-zone rolling
+ * stats keyed by zone path.
+ */
+class CGpuProfiler : public IDeviceObject
+{
+public:
+    CGpuProfiler();
+    ~CGpuProfiler();
+
+    /** @fn GetTimestampPeriod
+     *
+     * Nanoseconds per timestamp tick.
+     */
+    float GetTimestampPeriod() const
+    {
+        return m_timestamp_period;
+    }
+
+    /** @fn NewFrame
+     *
+     * Resolves the previous use of frame_index and starts recording
+     * frame_number into it. Call once the frame's previous submission
+     * has completed, before CmdBeginFrame().
+     */
+    void NewFrame(uint32_t frame_index, uint64_t frame_number);
+
+    /** @fn CmdBeginFrame
+     *
+     * Resets the frame's queries and begins the root zone. Must be
+     * recorded outside of a render pass.
+     */
+    void CmdBeginFrame(vkex::CommandBuffer cmd, const char* name = "Frame");
+
+    /** @fn CmdEndFrame
+     *
+     * Ends the root zone. Zones still open are ended first.
+     */
+    void CmdEndFrame(vkex::CommandBuffer cmd);
+
+    /** @fn CmdBeginZone
+     *
+     * name must stay valid until the frame has been resolved.
+     */
+    void CmdBeginZone(vkex::CommandBuffer cmd, const char* name, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+    /** @fn CmdEndZone
+     *
+     */
+    void CmdEndZone(vkex::CommandBuffer cmd, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    /** @fn ResolvePendingFrames
+     *
+     * Resolves every frame whose results are available, without
+     * waiting. Useful after the device has gone idle.
+     */
+    void ResolvePendingFrames();
+
+    /** @fn GetZoneResults
+     *
+     * Zones of the most recently resolved frame, in the order they
+     * began. The root zone comes first.
+     */
+    const std::vector<vkex::GpuZoneResult>& GetZoneResults() const
+    {
+        return m_zone_results;
+    }
+
+    /** @fn GetZoneStats
+     *
+     * Returns nullptr if no zone with path has been resolved.
+     */
+    const vkex::RunningStats* GetZoneStats(const std::string& path) const;
+
+    /** @fn TakeResolvedFrameTimes
+     *
+     * Appends the root zone times of the frames resolved since the last
+     * call to p_frame_times, in resolution order. At most
+     * stats_window_size frames are kept between calls.
+     */
+    void TakeResolvedFrameTimes(std::vector<vkex::GpuFrameTime>* p_frame_times);
+
+    /** @fn GetDroppedFrameCount
+     *
+     * Number of frames whose results were not available when their
+     * query pool was reused.
+     */
+    uint64_t GetDroppedFrameCount() const
+    {
+        return m_dropped_frame_count;
+    }
+
+    /** @fn GetOverflowZoneCount
+     *
+     * Number of zones not recorded because a frame ran out of queries.
+     */
+    uint64_t GetOverflowZoneCount() const
+    {
+        return m_overflow_zone_count;
+    }
+
+private:
+    friend class CDevice;
+    friend class IObjectStorageFunctions;
+
+    enum
+    {
+        kInvalidZone = UINT32_MAX,
+    };
+
+    struct Zone
+    {
+        const char* name   = nullptr;
+        uint32_t    parent = kInvalidZone;
+        uint32_t    depth  = 0;
+    };
+
+    struct Frame
+    {
+        vkex::QueryPool   query_pool   = nullptr;
+        uint64_t          frame_number = 0;
+        bool              pending      = false;
+        std::vector<Zone> zones;
+    };
+
+    /** @fn InternalCreate
+     *
+     */
+    vkex::Result InternalCreate(
+        const vkex::GpuProfilerCreateInfo& create_info,
+        const VkAllocationCallbacks*       p_allocator);
+
+    /** @fn InternalDestroy
+     *
+     */
+    vkex::Result InternalDestroy(const VkAllocationCallbacks* p_allocator);
+
+    /** @fn ResolveFrame
+     *
+     * Returns false if the frame's results are not available yet.
+     */
+    bool ResolveFrame(Frame* p_frame);
+
+private:
+    vkex::GpuProfilerCreateInfo                         m_create_info         = {};
+    float                                               m_timestamp_period    = 0;
+    uint64_t                                            m_timestamp_mask      = 0;
+    std::vector<Frame>                                  m_frames;
+    Frame*                                              m_current_frame       = nullptr;
+    std::vector<uint32_t>                               m_zone_stack;
+    std::vector<uint64_t>                               m_query_data;
+    std::vector<vkex::GpuZoneResult>                    m_zone_results;
+    std::unordered_map<std::string, vkex::RunningStats> m_zone_stats;
+    std::vector<vkex::GpuFrameTime>                     m_resolved_frame_times;
+    uint64_t                                            m_dropped_frame_count = 0;
+    uint64_t                                            m_overflow_zone_count = 0;
+};
+
+// =================================================================================================
+// GpuZoneScope
+// =================================================================================================
+
+/** @class GpuZoneScope
+ *
+ * Use VKEX_GPU_ZONE.
+ */
+class GpuZoneScope
+{
+public:
+    GpuZoneScope(vkex::GpuProfiler profiler, vkex::CommandBuffer cmd, const char* name)
+        : m_profiler(profiler), m_cmd(cmd)
+    {
+        if (m_profiler != nullptr) {
+            m_profiler->CmdBeginZone(m_cmd, name);
+        }
+    }
+
+    ~GpuZoneScope()
+    {
+        if (m_profiler != nullptr) {
+            m_profiler->CmdEndZone(m_cmd);
+        }
+    }
+
+    GpuZoneScope(const GpuZoneScope&)            = delete;
+    GpuZoneScope& operator=(const GpuZoneScope&) = delete;
+
+private:
+    vkex::GpuProfiler   m_profiler = nullptr;
+    vkex::CommandBuffer m_cmd      = nullptr;
+};
+
+} // namespace vkex
+
+#endif // __VKEX_GPU_PROFILER_H__
\ No newline at end of file
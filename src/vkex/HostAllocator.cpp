@@ -0,0 +1,426 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#include "vkex/HostAllocator.h"
+#include "vkex/ToString.h"
+
+#include <bit>
+#include <new>
+
+namespace vkex {
+
+// =================================================================================================
+// HostAllocator::AtomicCounters
+// =================================================================================================
+void HostAllocator::AtomicCounters::AddBytes(uint64_t size)
+{
+    bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+
+    uint64_t in_use = bytes_in_use.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak   = peak_bytes_in_use.load(std::memory_order_relaxed);
+    while ((in_use > peak) && !peak_bytes_in_use.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+    }
+}
+
+void HostAllocator::AtomicCounters::RemoveBytes(uint64_t size)
+{
+    bytes_in_use.fetch_sub(size, std::memory_order_relaxed);
+}
+
+HostAllocationCounters HostAllocator::AtomicCounters::Load() const
+{
+    HostAllocationCounters counters = {};
+    counters.allocation_count       = allocation_count.load(std::memory_order_relaxed);
+    counters.reallocation_count     = reallocation_count.load(std::memory_order_relaxed);
+    counters.free_count             = free_count.load(std::memory_order_relaxed);
+    counters.bytes_allocated        = bytes_allocated.load(std::memory_order_relaxed);
+    counters.bytes_in_use           = bytes_in_use.load(std::memory_order_relaxed);
+    counters.peak_bytes_in_use      = peak_bytes_in_use.load(std::memory_order_relaxed);
+    counters.internal_bytes_in_use  = internal_bytes_in_use.load(std::memory_order_relaxed);
+    return counters;
+}
+
+// =================================================================================================
+// HostAllocator
+// =================================================================================================
+HostAllocator::HostAllocator()
+{
+}
+
+HostAllocator::~HostAllocator()
+{
+    uint64_t bytes_in_use = m_total.bytes_in_use.load();
+    if (bytes_in_use > 0) {
+        VKEX_LOG_WARN("HostAllocator destroyed with " << bytes_in_use << " bytes still allocated");
+    }
+
+    for (auto& size_class : m_size_classes) {
+        for (void* p_slab : size_class.slabs) {
+            ::operator delete(p_slab, std::align_val_t(kPoolAlignment));
+        }
+        size_class.slabs.clear();
+        size_class.p_free_list = nullptr;
+    }
+}
+
+const VkAllocationCallbacks* HostAllocator::GetCallbacks(VkObjectType object_type)
+{
+    std::lock_guard<std::mutex> lock(m_records_mutex);
+
+    std::unique_ptr<ObjectTypeRecord>& record = m_records[object_type];
+    if (!record) {
+        record                                  = std::make_unique<ObjectTypeRecord>();
+        record->p_allocator                     = this;
+        record->object_type                     = object_type;
+        record->callbacks.pUserData             = record.get();
+        record->callbacks.pfnAllocation         = &HostAllocator::AllocationFunction;
+        record->callbacks.pfnReallocation       = &HostAllocator::ReallocationFunction;
+        record->callbacks.pfnFree               = &HostAllocator::FreeFunction;
+        record->callbacks.pfnInternalAllocation = &HostAllocator::InternalAllocationNotification;
+        record->callbacks.pfnInternalFree       = &HostAllocator::InternalFreeNotification;
+    }
+
+    return &record->callbacks;
+}
+
+bool HostAllocator::OwnsCallbacks(const VkAllocationCallbacks* p_callbacks) const
+{
+    if ((p_callbacks == nullptr) || (p_callbacks->pfnAllocation != &HostAllocator::AllocationFunction)) {
+        return false;
+    }
+
+    const ObjectTypeRecord* p_record = static_cast<const ObjectTypeRecord*>(p_callbacks->pUserData);
+    return (p_record->p_allocator == this);
+}
+
+void HostAllocator::NewFrame()
+{
+    uint64_t allocation_count = m_total.allocation_count.load(std::memory_order_relaxed) +
+                                m_total.reallocation_count.load(std::memory_order_relaxed);
+    uint64_t bytes_allocated  = m_total.bytes_allocated.load(std::memory_order_relaxed);
+
+    m_frame_allocation_count = allocation_count - m_frame_start_allocation_count.exchange(allocation_count);
+    m_frame_bytes_allocated  = bytes_allocated - m_frame_start_bytes_allocated.exchange(bytes_allocated);
+}
+
+HostAllocatorStats HostAllocator::GetStats() const
+{
+    HostAllocatorStats stats = {};
+    stats.total              = m_total.Load();
+    for (uint32_t scope = 0; scope < kScopeCount; ++scope) {
+        stats.scopes[scope] = m_scopes[scope].Load();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_records_mutex);
+        for (auto& it : m_records) {
+            stats.object_types.push_back(std::make_pair(it.first, it.second->counters.Load()));
+        }
+    }
+    std::sort(
+        std::begin(stats.object_types),
+        std::end(stats.object_types),
+        [](const auto& a, const auto& b) -> bool { return a.first < b.first; });
+
+    stats.pooled_allocation_count = m_pooled_allocation_count.load();
+    stats.heap_allocation_count   = m_heap_allocation_count.load();
+    stats.pool_bytes_reserved     = m_pool_bytes_reserved.load();
+    stats.frame_allocation_count  = m_frame_allocation_count.load();
+    stats.frame_bytes_allocated   = m_frame_bytes_allocated.load();
+
+    return stats;
+}
+
+void HostAllocator::LogStats() const
+{
+    HostAllocatorStats stats = GetStats();
+
+    auto log_counters = [](const std::string& name, const HostAllocationCounters& counters) {
+        VKEX_LOG_INFO("   " << name);
+        VKEX_LOG_INFO("      "
+                      << "allocations=" << counters.allocation_count
+                      << ", reallocations=" << counters.reallocation_count
+                      << ", frees=" << counters.free_count);
+        VKEX_LOG_INFO("      "
+                      << "bytes allocated=" << counters.bytes_allocated
+                      << ", in use=" << counters.bytes_in_use
+                      << ", peak=" << counters.peak_bytes_in_use
+                      << ", internal=" << counters.internal_bytes_in_use);
+    };
+
+    VKEX_LOG_INFO("Host allocator stats:");
+    VKEX_LOG_INFO("   "
+                  << "Pooled allocations : " << stats.pooled_allocation_count);
+    VKEX_LOG_INFO("   "
+                  << "Heap allocations   : " << stats.heap_allocation_count);
+    VKEX_LOG_INFO("   "
+                  << "Pool bytes reserved: " << stats.pool_bytes_reserved);
+    log_counters("Total", stats.total);
+    for (uint32_t scope = 0; scope < kScopeCount; ++scope) {
+        log_counters(ToString(static_cast<VkSystemAllocationScope>(scope)), stats.scopes[scope]);
+    }
+    for (auto& it : stats.object_types) {
+        log_counters(ToString(it.first), it.second);
+    }
+}
+
+void* VKAPI_PTR HostAllocator::AllocationFunction(
+    void*                   p_user_data,
+    size_t                  size,
+    size_t                  alignment,
+    VkSystemAllocationScope scope)
+{
+    ObjectTypeRecord* p_record = static_cast<ObjectTypeRecord*>(p_user_data);
+    return p_record->p_allocator->Allocate(p_record, size, alignment, scope);
+}
+
+void* VKAPI_PTR HostAllocator::ReallocationFunction(
+    void*                   p_user_data,
+    void*                   p_original,
+    size_t                  size,
+    size_t                  alignment,
+    VkSystemAllocationScope scope)
+{
+    ObjectTypeRecord* p_record = static_cast<ObjectTypeRecord*>(p_user_data);
+    return p_record->p_allocator->Reallocate(p_record, p_original, size, alignment, scope);
+}
+
+void VKAPI_PTR HostAllocator::FreeFunction(void* p_user_data, void* p_memory)
+{
+    ObjectTypeRecord* p_record = static_cast<ObjectTypeRecord*>(p_user_data);
+    p_record->p_allocator->Free(p_record, p_memory);
+}
+
+void VKAPI_PTR HostAllocator::InternalAllocationNotification(
+    void*                    p_user_data,
+    size_t                   size,
+    VkInternalAllocationType type,
+    VkSystemAllocationScope  scope)
+{
+    ObjectTypeRecord* p_record    = static_cast<ObjectTypeRecord*>(p_user_data);
+    HostAllocator*    p_this      = p_record->p_allocator;
+    const uint32_t    scope_index = std::min<uint32_t>(scope, kScopeCount - 1);
+    p_record->counters.internal_bytes_in_use.fetch_add(size, std::memory_order_relaxed);
+    p_this->m_scopes[scope_index].internal_bytes_in_use.fetch_add(size, std::memory_order_relaxed);
+    p_this->m_total.internal_bytes_in_use.fetch_add(size, std::memory_order_relaxed);
+}
+
+void VKAPI_PTR HostAllocator::InternalFreeNotification(
+    void*                    p_user_data,
+    size_t                   size,
+    VkInternalAllocationType type,
+    VkSystemAllocationScope  scope)
+{
+    ObjectTypeRecord* p_record    = static_cast<ObjectTypeRecord*>(p_user_data);
+    HostAllocator*    p_this      = p_record->p_allocator;
+    const uint32_t    scope_index = std::min<uint32_t>(scope, kScopeCount - 1);
+    p_record->counters.internal_bytes_in_use.fetch_sub(size, std::memory_order_relaxed);
+    p_this->m_scopes[scope_index].internal_bytes_in_use.fetch_sub(size, std::memory_order_relaxed);
+    p_this->m_total.internal_bytes_in_use.fetch_sub(size, std::memory_order_relaxed);
+}
+
+HostAllocator::AllocationHeader* HostAllocator::GetHeader(void* p_memory)
+{
+    return reinterpret_cast<AllocationHeader*>(static_cast<uint8_t*>(p_memory) - sizeof(AllocationHeader));
+}
+
+void* HostAllocator::Allocate(
+    ObjectTypeRecord*       p_record,
+    size_t                  size,
+    size_t                  alignment,
+    VkSystemAllocationScope scope)
+{
+    if (size == 0) {
+        return nullptr;
+    }
+
+    void* p_memory = AllocateBlock(size, alignment, scope);
+    if (p_memory != nullptr) {
+        TrackAllocate(p_record, scope, size, false);
+    }
+    return p_memory;
+}
+
+void* HostAllocator::Reallocate(
+    ObjectTypeRecord*       p_record,
+    void*                   p_original,
+    size_t                  size,
+    size_t                  alignment,
+    VkSystemAllocationScope scope)
+{
+    if (p_original == nullptr) {
+        return Allocate(p_record, size, alignment, scope);
+    }
+
+    if (size == 0) {
+        Free(p_record, p_original);
+        return nullptr;
+    }
+
+    AllocationHeader*             p_header       = GetHeader(p_original);
+    const uint64_t                original_size  = p_header->size;
+    const VkSystemAllocationScope original_scope = static_cast<VkSystemAllocationScope>(p_header->scope);
+
+    // Grow or shrink in place if the size class still fits
+    if (p_header->size_class != kHeapSizeClass) {
+        const size_t capacity = size_t(1) << (p_header->size_class + kMinSizeClassLog2);
+        if ((size <= capacity) && (alignment <= kPoolAlignment)) {
+            p_header->size  = size;
+            p_header->scope = static_cast<uint8_t>(scope);
+            TrackFree(p_record, original_scope, original_size, true);
+            TrackAllocate(p_record, scope, size, true);
+            return p_original;
+        }
+    }
+
+    // The original allocation must be left untouched on failure
+    void* p_memory = AllocateBlock(size, alignment, scope);
+    if (p_memory == nullptr) {
+        return nullptr;
+    }
+    std::memcpy(p_memory, p_original, static_cast<size_t>(std::min<uint64_t>(original_size, size)));
+    FreeBlock(p_original);
+
+    TrackFree(p_record, original_scope, original_size, true);
+    TrackAllocate(p_record, scope, size, true);
+
+    return p_memory;
+}
+
+void HostAllocator::Free(ObjectTypeRecord* p_record, void* p_memory)
+{
+    if (p_memory == nullptr) {
+        return;
+    }
+
+    AllocationHeader* p_header = GetHeader(p_memory);
+    TrackFree(p_record, static_cast<VkSystemAllocationScope>(p_header->scope), p_header->size, false);
+    FreeBlock(p_memory);
+}
+
+void* HostAllocator::AllocateBlock(size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    alignment = std::max<size_t>(alignment, kPoolAlignment);
+
+    // Size class pools
+    if ((size <= (size_t(1) << kMaxSizeClassLog2)) && (alignment == kPoolAlignment)) {
+        const uint32_t size_class = (size <= (size_t(1) << kMinSizeClassLog2))
+                                        ? 0
+                                        : GetHighestBitIndex(static_cast<uint32_t>(size - 1)) - kMinSizeClassLog2;
+        const size_t   slot_size  = sizeof(AllocationHeader) + (size_t(1) << (size_class + kMinSizeClassLog2));
+
+        SizeClass& pool   = m_size_classes[size_class];
+        uint8_t*   p_slot = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if (pool.p_free_list == nullptr) {
+                void* p_slab = ::operator new(kSlabSize, std::align_val_t(kPoolAlignment), std::nothrow);
+                if (p_slab == nullptr) {
+                    return nullptr;
+                }
+                pool.slabs.push_back(p_slab);
+                m_pool_bytes_reserved.fetch_add(kSlabSize, std::memory_order_relaxed);
+
+                // Thread the slab's slots onto the free list, lowest address first
+                const size_t slot_count = kSlabSize / slot_size;
+                for (size_t i = slot_count; i > 0; --i) {
+                    void* p_free                 = static_cast<uint8_t*>(p_slab) + ((i - 1) * slot_size);
+                    *static_cast<void**>(p_free) = pool.p_free_list;
+                    pool.p_free_list             = p_free;
+                }
+            }
+            p_slot           = static_cast<uint8_t*>(pool.p_free_list);
+            pool.p_free_list = *reinterpret_cast<void**>(p_slot);
+        }
+
+        AllocationHeader* p_header = reinterpret_cast<AllocationHeader*>(p_slot);
+        p_header->size             = size;
+        p_header->offset           = 0;
+        p_header->size_class       = static_cast<uint8_t>(size_class);
+        p_header->scope            = static_cast<uint8_t>(scope);
+        p_header->alignment_log2   = static_cast<uint8_t>(std::countr_zero(alignment));
+        p_header->reserved         = 0;
+
+        m_pooled_allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+        return p_slot + sizeof(AllocationHeader);
+    }
+
+    // Heap, the header goes in front of the aligned pointer
+    const size_t offset  = std::max<size_t>(alignment, sizeof(AllocationHeader));
+    void*        p_block = ::operator new(offset + size, std::align_val_t(alignment), std::nothrow);
+    if (p_block == nullptr) {
+        return nullptr;
+    }
+
+    void*             p_memory = static_cast<uint8_t*>(p_block) + offset;
+    AllocationHeader* p_header = GetHeader(p_memory);
+    p_header->size             = size;
+    p_header->offset           = static_cast<uint32_t>(offset);
+    p_header->size_class       = kHeapSizeClass;
+    p_header->scope            = static_cast<uint8_t>(scope);
+    p_header->alignment_log2   = static_cast<uint8_t>(std::countr_zero(alignment));
+    p_header->reserved         = 0;
+
+    m_heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    return p_memory;
+}
+
+void HostAllocator::FreeBlock(void* p_memory)
+{
+    AllocationHeader* p_header = GetHeader(p_memory);
+    if (p_header->size_class != kHeapSizeClass) {
+        SizeClass& pool   = m_size_classes[p_header->size_class];
+        void*      p_slot = p_header;
+
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        *static_cast<void**>(p_slot) = pool.p_free_list;
+        pool.p_free_list             = p_slot;
+    }
+    else {
+        void*  p_block   = static_cast<uint8_t*>(p_memory) - p_header->offset;
+        size_t alignment = size_t(1) << p_header->alignment_log2;
+        ::operator delete(p_block, std::align_val_t(alignment));
+    }
+}
+
+void HostAllocator::TrackAllocate(ObjectTypeRecord* p_record, VkSystemAllocationScope scope, uint64_t size, bool is_reallocation)
+{
+    AtomicCounters* counters[3] = {&p_record->counters, &m_scopes[std::min<uint32_t>(scope, kScopeCount - 1)], &m_total};
+    for (AtomicCounters* p_counters : counters) {
+        if (is_reallocation) {
+            p_counters->reallocation_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            p_counters->allocation_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        p_counters->AddBytes(size);
+    }
+}
+
+void HostAllocator::TrackFree(ObjectTypeRecord* p_record, VkSystemAllocationScope scope, uint64_t size, bool is_reallocation)
+{
+    AtomicCounters* counters[3] = {&p_record->counters, &m_scopes[std::min<uint32_t>(scope, kScopeCount - 1)], &m_total};
+    for (AtomicCounters* p_counters : counters) {
+        if (!is_reallocation) {
+            p_counters->free_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        p_counters->RemoveBytes(size);
+    }
+}
+
+} // namespace vkex
\ No newline at end of file
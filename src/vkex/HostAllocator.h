@@ -0,0 +1,212 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#ifndef __VKEX_HOST_ALLOCATOR_H__
+#define __VKEX_HOST_ALLOCATOR_H__
+
+#include "vkex/Config.h"
+
+#include <atomic>
+#include <unordered_map>
+
+namespace vkex {
+
+/** @struct HostAllocationCounters
+ *
+ */
+struct HostAllocationCounters
+{
+    uint64_t allocation_count      = 0;
+    uint64_t reallocation_count    = 0;
+    uint64_t free_count            = 0;
+    uint64_t bytes_allocated       = 0; // Running total, never decreases
+    uint64_t bytes_in_use          = 0;
+    uint64_t peak_bytes_in_use     = 0;
+    uint64_t internal_bytes_in_use = 0; // Reported by pfnInternalAllocation
+};
+
+/** @struct HostAllocatorStats
+ *
+ * scopes is indexed by VkSystemAllocationScope. The frame counters cover
+ * the frame that ended at the most recent call to NewFrame().
+ */
+struct HostAllocatorStats
+{
+    HostAllocationCounters                                       total;
+    HostAllocationCounters                                       scopes[VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1];
+    std::vector<std::pair<VkObjectType, HostAllocationCounters>> object_types;
+    uint64_t                                                     pooled_allocation_count = 0;
+    uint64_t                                                     heap_allocation_count   = 0;
+    uint64_t                                                     pool_bytes_reserved     = 0;
+    uint64_t                                                     frame_allocation_count  = 0;
+    uint64_t                                                     frame_bytes_allocated   = 0;
+};
+
+/** @class HostAllocator
+ *
+ * VkAllocationCallbacks implementation for driver host allocations. Small
+ * allocations are served from power of two size classes carved out of
+ * 64 KiB slabs, which are kept until the allocator is destroyed, so
+ * allocation churn stops reaching the general heap once the pools are
+ * warm. Larger or over-aligned allocations go to the heap.
+ *
+ * Every allocation is counted against its VkSystemAllocationScope and
+ * against the object type of the callbacks it was made through. Use
+ * GetCallbacks() with the type of the object being created; callbacks
+ * for different types are interchangeable, so an object may be destroyed
+ * with the callbacks of any type. The allocator must outlive every
+ * object created with its callbacks.
+ */
+class HostAllocator
+{
+public:
+    HostAllocator();
+    ~HostAllocator();
+
+    /** @fn GetCallbacks
+     *
+     * Callbacks stay valid for the lifetime of the allocator.
+     */
+    const VkAllocationCallbacks* GetCallbacks(VkObjectType object_type = VK_OBJECT_TYPE_UNKNOWN);
+
+    /** @fn OwnsCallbacks
+     *
+     * Returns true if p_callbacks was returned by this allocator's
+     * GetCallbacks().
+     */
+    bool OwnsCallbacks(const VkAllocationCallbacks* p_callbacks) const;
+
+    /** @fn NewFrame
+     *
+     * Closes the current frame's allocation counters.
+     */
+    void NewFrame();
+
+    /** @fn GetFrameAllocationCount
+     *
+     * Allocations and reallocations in the frame that ended at the most
+     * recent call to NewFrame().
+     */
+    uint64_t GetFrameAllocationCount() const
+    {
+        return m_frame_allocation_count.load(std::memory_order_relaxed);
+    }
+
+    /** @fn GetFrameBytesAllocated
+     *
+     */
+    uint64_t GetFrameBytesAllocated() const
+    {
+        return m_frame_bytes_allocated.load(std::memory_order_relaxed);
+    }
+
+    /** @fn GetStats
+     *
+     */
+    HostAllocatorStats GetStats() const;
+
+    /** @fn LogStats
+     *
+     */
+    void LogStats() const;
+
+private:
+    enum
+    {
+        kMinSizeClassLog2 = 4,
+        kMaxSizeClassLog2 = 12,
+        kSizeClassCount   = kMaxSizeClassLog2 - kMinSizeClassLog2 + 1,
+        kHeapSizeClass    = 0xFF,
+        kPoolAlignment    = 16,
+        kSlabSize         = 64 * 1024,
+        kScopeCount       = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1,
+    };
+
+    // Placed immediately before every pointer handed to the driver
+    struct AllocationHeader
+    {
+        uint64_t size;
+        uint32_t offset; // From the start of the heap block to the pointer
+        uint8_t  size_class;
+        uint8_t  scope;
+        uint8_t  alignment_log2;
+        uint8_t  reserved;
+    };
+
+    struct AtomicCounters
+    {
+        std::atomic<uint64_t> allocation_count{0};
+        std::atomic<uint64_t> reallocation_count{0};
+        std::atomic<uint64_t> free_count{0};
+        std::atomic<uint64_t> bytes_allocated{0};
+        std::atomic<uint64_t> bytes_in_use{0};
+        std::atomic<uint64_t> peak_bytes_in_use{0};
+        std::atomic<uint64_t> internal_bytes_in_use{0};
+
+        void                   AddBytes(uint64_t size);
+        void                   RemoveBytes(uint64_t size);
+        HostAllocationCounters Load() const;
+    };
+
+    struct ObjectTypeRecord
+    {
+        HostAllocator*        p_allocator = nullptr;
+        VkObjectType          object_type = VK_OBJECT_TYPE_UNKNOWN;
+        VkAllocationCallbacks callbacks   = {};
+        AtomicCounters        counters;
+    };
+
+    struct SizeClass
+    {
+        std::mutex         mutex;
+        void*              p_free_list = nullptr;
+        std::vector<void*> slabs;
+    };
+
+    static void* VKAPI_PTR AllocationFunction(void* p_user_data, size_t size, size_t alignment, VkSystemAllocationScope scope);
+    static void* VKAPI_PTR ReallocationFunction(void* p_user_data, void* p_original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+    static void VKAPI_PTR  FreeFunction(void* p_user_data, void* p_memory);
+    static void VKAPI_PTR  InternalAllocationNotification(void* p_user_data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+    static void VKAPI_PTR  InternalFreeNotification(void* p_user_data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+
+    static AllocationHeader* GetHeader(void* p_memory);
+
+    void* Allocate(ObjectTypeRecord* p_record, size_t size, size_t alignment, VkSystemAllocationScope scope);
+    void* Reallocate(ObjectTypeRecord* p_record, void* p_original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+    void  Free(ObjectTypeRecord* p_record, void* p_memory);
+    void* AllocateBlock(size_t size, size_t alignment, VkSystemAllocationScope scope);
+    void  FreeBlock(void* p_memory);
+    void  TrackAllocate(ObjectTypeRecord* p_record, VkSystemAllocationScope scope, uint64_t size, bool is_reallocation);
+    void  TrackFree(ObjectTypeRecord* p_record, VkSystemAllocationScope scope, uint64_t size, bool is_reallocation);
+
+private:
+    mutable std::mutex                                                  m_records_mutex;
+    std::unordered_map<VkObjectType, std::unique_ptr<ObjectTypeRecord>> m_records;
+    SizeClass                                                           m_size_classes[kSizeClassCount];
+    AtomicCounters                                                      m_total;
+    AtomicCounters                                                      m_scopes[kScopeCount];
+    std::atomic<uint64_t>                                               m_pooled_allocation_count{0};
+    std::atomic<uint64_t>                                               m_heap_allocation_count{0};
+    std::atomic<uint64_t>                                               m_pool_bytes_reserved{0};
+    std::atomic<uint64_t>                                               m_frame_start_allocation_count{0};
+    std::atomic<uint64_t>                                               m_frame_start_bytes_allocated{0};
+    std::atomic<uint64_t>                                               m_frame_allocation_count{0};
+    std::atomic<uint64_t>                                               m_frame_bytes_allocated{0};
+};
+
+} // namespace vkex
+
+#endif // __VKEX_HOST_ALLOCATOR_H__
\ No newline at end of file
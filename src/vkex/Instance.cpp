@@ -768,7 +768,7 @@ vkex::Result CInstance::InternalCreate(
 vkex::Result CInstance::InternalDestroy(const VkAllocationCallbacks* p_allocator)
 {
     // Destroy all devices
-    for (auto& device : m_stored_devices) {
+    for (auto device : m_stored_devices) {
         vkex::Result vkex_result = device->InternalDestroy(p_allocator);
         if (!vkex_result) {
             return vkex_result;
@@ -799,10 +799,16 @@ vkex::Result CInstance::InternalDestroy(const VkAllocationCallbacks* p_allocator
 
 vkex::PhysicalDevice CInstance::GetPhysicalDevice(uint32_t index) const
 {
+    // Physical devices are never destroyed individually, so slot order is
+    // enumeration order.
     vkex::PhysicalDevice physical_device = nullptr;
-    uint32_t             count           = GetPhysicalDeviceCount();
-    if (index < count) {
-        physical_device = m_stored_physical_devices[index].get();
+    uint32_t             i               = 0;
+    for (auto device : m_stored_physical_devices) {
+        if (i == index) {
+            physical_device = device;
+            break;
+        }
+        ++i;
     }
     return physical_device;
 }
@@ -816,19 +822,15 @@ vkex::PhysicalDevice CInstance::FindPhysicalDevice(const PhysicalDeviceCriteria&
         bool is_intel  = criteria.vendor_id == VKEX_IHV_VENDOR_ID_INTEL;
         bool is_nvidia = criteria.vendor_id == VKEX_IHV_VENDOR_ID_NVIDIA;
         if (is_amd || is_intel || is_nvidia) {
-            uint32_t count = GetPhysicalDeviceCount();
-            for (uint32_t i = 0; i < count; ++i) {
-                vkex::PhysicalDevice device    = m_stored_physical_devices[i].get();
-                uint32_t             vendor_id = device->GetVendorId();
+            for (auto device : m_stored_physical_devices) {
+                uint32_t vendor_id = device->GetVendorId();
                 if (vendor_id == criteria.vendor_id) {
                     found_devices_0.push_back(device);
                 }
             }
         }
         else {
-            uint32_t count = GetPhysicalDeviceCount();
-            for (uint32_t i = 0; i < count; ++i) {
-                vkex::PhysicalDevice device = m_stored_physical_devices[i].get();
+            for (auto device : m_stored_physical_devices) {
                 found_devices_0.push_back(device);
             }
         }
@@ -156,7 +156,7 @@ public:
      */
     uint32_t GetPhysicalDeviceCount() const
     {
-        uint32_t count = CountU32(m_stored_physical_devices);
+        uint32_t count = m_stored_physical_devices.GetCount();
         return count;
     }
 
@@ -293,9 +293,9 @@ private:
     VkDebugUtilsMessengerEXT           m_vk_messenger                         = VK_NULL_HANDLE;
     bool                               m_validation_layers_loaded             = false;
 
-    std::vector<std::unique_ptr<CPhysicalDevice>> m_stored_physical_devices;
-    std::vector<std::unique_ptr<CDevice>>         m_stored_devices;
-    std::vector<std::unique_ptr<CSurface>>        m_stored_surfaces;
+    vkex::ObjectPool<CPhysicalDevice> m_stored_physical_devices;
+    vkex::ObjectPool<CDevice>         m_stored_devices;
+    vkex::ObjectPool<CSurface>        m_stored_surfaces;
 };
 
 // =================================================================================================
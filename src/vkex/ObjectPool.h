@@ -0,0 +1,398 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+
+#ifndef __VKEX_OBJECT_POOL_H__
+#define __VKEX_OBJECT_POOL_H__
+
+#include "vkex/Config.h"
+
+#include <cstddef>
+#include <functional>
+#include <new>
+
+namespace vkex {
+
+/** @class ObjectPool
+ *
+ * Slab storage for the objects of one type. Objects are constructed in
+ * fixed size chunks that never move, so pointers stay valid until the
+ * object is freed, and freed slots are reused through a free list, which
+ * makes Allocate and Free O(1).
+ *
+ * Every slot has a generation that is bumped when its object is
+ * recycled. A Handle taken from a live object stops resolving once the
+ * object is gone, even if the slot has been reused; debug builds assert
+ * when a stale handle is resolved. Retire and Free reject pointers to
+ * slots that aren't live or that belong to another pool of the same
+ * type; debug builds also check that the pointer points into one of the
+ * pool's chunks. A raw pointer to a freed object is only rejected until
+ * its slot is reused, so code that may outlive an object should hold a
+ * Handle. The free list is FIFO, and debug builds hold back the last
+ * kQuarantineSize freed slots to make reuse late.
+ *
+ * Not thread safe, callers serialize access.
+ */
+template <typename T>
+class ObjectPool
+{
+public:
+    enum
+    {
+        kChunkSize = 64,
+#if defined(NDEBUG)
+        kQuarantineSize = 0,
+#else
+        kQuarantineSize = kChunkSize,
+#endif
+    };
+
+    /** @struct Handle
+     *
+     */
+    struct Handle
+    {
+        uint32_t index      = UINT32_MAX;
+        uint32_t generation = 0;
+    };
+
+    /** @class Iterator
+     *
+     * Visits live objects in slot order.
+     */
+    class Iterator
+    {
+    public:
+        Iterator(const ObjectPool* p_pool, uint32_t index)
+            : m_p_pool(p_pool), m_index(index)
+        {
+            SkipFree();
+        }
+
+        T* operator*() const
+        {
+            return m_p_pool->GetSlot(m_index)->GetObject();
+        }
+
+        Iterator& operator++()
+        {
+            ++m_index;
+            SkipFree();
+            return *this;
+        }
+
+        bool operator!=(const Iterator& rhs) const
+        {
+            return m_index != rhs.m_index;
+        }
+
+    private:
+        void SkipFree()
+        {
+            while ((m_index < m_p_pool->m_slot_count) && (m_p_pool->GetSlot(m_index)->state != kSlotLive)) {
+                ++m_index;
+            }
+        }
+
+    private:
+        const ObjectPool* m_p_pool = nullptr;
+        uint32_t          m_index  = 0;
+    };
+
+    ObjectPool() {}
+
+    ~ObjectPool()
+    {
+        Clear();
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    /** @fn Allocate
+     *
+     * Default constructs a new object.
+     */
+    T* Allocate()
+    {
+        Slot* p_slot = nullptr;
+        if (m_free_count > kQuarantineSize) {
+            p_slot      = GetSlot(m_free_head);
+            m_free_head = p_slot->next_free;
+            if (m_free_head == UINT32_MAX) {
+                m_free_tail = UINT32_MAX;
+            }
+            --m_free_count;
+        }
+        else {
+            if ((m_slot_count % kChunkSize) == 0) {
+                m_chunks.push_back(std::make_unique<Slot[]>(kChunkSize));
+            }
+            p_slot          = GetSlot(m_slot_count);
+            p_slot->index   = m_slot_count;
+            p_slot->p_owner = this;
+            ++m_slot_count;
+        }
+
+        new (p_slot->storage) T();
+        p_slot->state     = kSlotLive;
+        p_slot->next_free = UINT32_MAX;
+        ++m_live_count;
+
+        return p_slot->GetObject();
+    }
+
+    /** @fn Free
+     *
+     * Destroys p_object and returns its slot to the free list. Returns
+     * false if p_object isn't a live object of this pool.
+     */
+    bool Free(T* p_object)
+    {
+        if (!Retire(p_object)) {
+            return false;
+        }
+        Recycle(p_object);
+        return true;
+    }
+
+    /** @fn Retire
+     *
+     * First half of Free: p_object stops being live, so a second Retire
+     * fails, but it isn't destroyed until Recycle is called. Lets callers
+     * tear the object down without holding their lock.
+     */
+    bool Retire(T* p_object)
+    {
+        if (!IsLive(p_object)) {
+            return false;
+        }
+
+        Slot* p_slot  = Slot::FromObject(p_object);
+        p_slot->state = kSlotRetired;
+        --m_live_count;
+
+        return true;
+    }
+
+    /** @fn Recycle
+     *
+     * Destroys a retired object and appends its slot to the free list.
+     */
+    void Recycle(T* p_object)
+    {
+        Slot* p_slot = Slot::FromObject(p_object);
+        VKEX_ASSERT_MSG((p_slot->state == kSlotRetired), "Recycling an object that was not retired");
+
+        p_object->~T();
+        p_slot->state     = kSlotFree;
+        p_slot->next_free = UINT32_MAX;
+        ++p_slot->generation;
+        if (m_free_tail != UINT32_MAX) {
+            GetSlot(m_free_tail)->next_free = p_slot->index;
+        }
+        else {
+            m_free_head = p_slot->index;
+        }
+        m_free_tail = p_slot->index;
+        ++m_free_count;
+    }
+
+    /** @fn Clear
+     *
+     * Destroys all objects and releases the chunks.
+     */
+    void Clear()
+    {
+        for (uint32_t i = 0; i < m_slot_count; ++i) {
+            Slot* p_slot = GetSlot(i);
+            if (p_slot->state != kSlotFree) {
+                p_slot->GetObject()->~T();
+            }
+        }
+        m_chunks.clear();
+        m_slot_count = 0;
+        m_live_count = 0;
+        m_free_count = 0;
+        m_free_head  = UINT32_MAX;
+        m_free_tail  = UINT32_MAX;
+    }
+
+    /** @fn IsLive
+     *
+     */
+    bool IsLive(const T* p_object) const
+    {
+        if (p_object == nullptr) {
+            return false;
+        }
+#if !defined(NDEBUG)
+        if (!Owns(p_object)) {
+            return false;
+        }
+#endif
+        // Objects from another pool of the same type share the slot
+        // layout, so the owner check is cheap enough to always do
+        const Slot* p_slot = Slot::FromObject(p_object);
+        return (p_slot->p_owner == this) && (p_slot->state == kSlotLive);
+    }
+
+    /** @fn GetHandle
+     *
+     * Returns a handle that doesn't resolve if p_object isn't live.
+     */
+    Handle GetHandle(const T* p_object) const
+    {
+        Handle handle = {};
+        if (IsLive(p_object)) {
+            const Slot* p_slot = Slot::FromObject(p_object);
+            handle.index       = p_slot->index;
+            handle.generation  = p_slot->generation;
+        }
+        return handle;
+    }
+
+    /** @fn Resolve
+     *
+     * Returns nullptr if the handle's object has been freed, or is
+     * retired and about to be.
+     */
+    T* Resolve(const Handle& handle) const
+    {
+        if (handle.index >= m_slot_count) {
+            return nullptr;
+        }
+        Slot* p_slot = GetSlot(handle.index);
+        VKEX_ASSERT_MSG((p_slot->generation == handle.generation), "Resolving a handle to an object that was freed");
+        if ((p_slot->state != kSlotLive) || (p_slot->generation != handle.generation)) {
+            return nullptr;
+        }
+        return p_slot->GetObject();
+    }
+
+    /** @fn GetCount
+     *
+     */
+    uint32_t GetCount() const
+    {
+        return m_live_count;
+    }
+
+    /** @fn IsEmpty
+     *
+     */
+    bool IsEmpty() const
+    {
+        return m_live_count == 0;
+    }
+
+    Iterator begin() const
+    {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() const
+    {
+        return Iterator(this, m_slot_count);
+    }
+
+private:
+    enum SlotState : uint32_t
+    {
+        kSlotFree    = 0,
+        kSlotLive    = 1,
+        kSlotRetired = 2,
+    };
+
+    struct Slot
+    {
+        alignas(T) uint8_t storage[sizeof(T)];
+        const ObjectPool* p_owner    = nullptr;
+        uint32_t          index      = 0;
+        uint32_t          generation = 0;
+        uint32_t          next_free  = UINT32_MAX;
+        SlotState         state      = kSlotFree;
+
+        T* GetObject()
+        {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+
+        // storage is the first member, so the object and slot addresses
+        // are the same.
+        static Slot* FromObject(const T* p_object)
+        {
+            static_assert(offsetof(Slot, storage) == 0, "Slot storage must be the first member");
+            return reinterpret_cast<Slot*>(const_cast<T*>(p_object));
+        }
+    };
+
+    Slot* GetSlot(uint32_t index) const
+    {
+        return &m_chunks[index / kChunkSize][index % kChunkSize];
+    }
+
+    bool Owns(const T* p_object) const
+    {
+        const Slot* p_slot = reinterpret_cast<const Slot*>(p_object);
+        for (auto& chunk : m_chunks) {
+            const Slot* p_first = chunk.get();
+            if (!std::less<const Slot*>()(p_slot, p_first) && std::less<const Slot*>()(p_slot, p_first + kChunkSize)) {
+                return (reinterpret_cast<uintptr_t>(p_slot) - reinterpret_cast<uintptr_t>(p_first)) % sizeof(Slot) == 0;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::vector<std::unique_ptr<Slot[]>> m_chunks;
+    uint32_t                             m_slot_count = 0;
+    uint32_t                             m_live_count = 0;
+    uint32_t                             m_free_count = 0;
+    uint32_t                             m_free_head  = UINT32_MAX;
+    uint32_t                             m_free_tail  = UINT32_MAX;
+};
+
+/** @class LockedObjectPool
+ *
+ * ObjectPool with its own mutex, for storage that is modified from
+ * several threads. IObjectStorageFunctions holds the mutex only while
+ * the pool itself is modified, never during InternalCreate or
+ * InternalDestroy, so objects of one type can be created concurrently
+ * and different types never contend.
+ */
+template <typename T>
+class LockedObjectPool : public ObjectPool<T>
+{
+public:
+    LockedObjectPool() {}
+    ~LockedObjectPool() {}
+
+    /** @fn GetMutex
+     *
+     */
+    std::mutex& GetMutex() const
+    {
+        return m_mutex;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+};
+
+} // namespace vkex
+
+#endif // __VKEX_OBJECT_POOL_H__
\ No newline at end of file
@@ -15,6 +15,7 @@
 */
 
 #include "vkex/Pipeline.h"
+#include "vkex/CpuProfiler.h"
 #include "vkex/Device.h"
 #include "vkex/Shader.h"
 #include "vkex/ToString.h"
@@ -128,6 +129,43 @@ vkex::Result CPipelineCache::InternalDestroy(const VkAllocationCallbacks* p_allo
     return vkex::Result::Success;
 }
 
+vkex::Result CPipelineCache::GetData(std::vector<uint8_t>* p_data) const
+{
+    // Query size
+    size_t   data_size = 0;
+    VkResult vk_result = InvalidValue<VkResult>::Value;
+    VKEX_VULKAN_RESULT_CALL(
+        vk_result,
+        vkGetPipelineCacheData(
+            *m_device,
+            m_vk_object,
+            &data_size,
+            nullptr));
+    if (vk_result != VK_SUCCESS) {
+        return vkex::Result(vk_result);
+    }
+
+    // Get data
+    p_data->resize(data_size);
+    if (data_size > 0) {
+        VKEX_VULKAN_RESULT_CALL(
+            vk_result,
+            vkGetPipelineCacheData(
+                *m_device,
+                m_vk_object,
+                &data_size,
+                p_data->data()));
+        if (vk_result != VK_SUCCESS) {
+            p_data->clear();
+            return vkex::Result(vk_result);
+        }
+        // Cache may have shrunk between the two calls
+        p_data->resize(data_size);
+    }
+
+    return vkex::Result::Success;
+}
+
 // =================================================================================================
 // ComputePipeline
 // =================================================================================================
@@ -156,8 +194,14 @@ vkex::Result CComputePipeline::InternalCreate(
 
         m_cs_entry_point = module->GetEntryPoint();
 
+        vkex::Result vkex_result = m_create_info.specialization.Validate(m_create_info.shader_program);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+        m_create_info.specialization.Apply(module, &m_specialization_data);
+
         vk_shader_stage.flags               = 0;
-        vk_shader_stage.pSpecializationInfo = nullptr;
+        vk_shader_stage.pSpecializationInfo = (m_specialization_data.vk_info.mapEntryCount > 0) ? &m_specialization_data.vk_info : nullptr;
         vk_shader_stage.pName               = m_cs_entry_point.c_str();
         vk_shader_stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
         vk_shader_stage.module              = *(module);
@@ -178,15 +222,18 @@ vkex::Result CComputePipeline::InternalCreate(
     m_vk_create_info.basePipelineIndex  = 0;
     // Call create
     VkResult vk_result = InvalidValue<VkResult>::Value;
-    VKEX_VULKAN_RESULT_CALL(
-        vk_result,
-        vkCreateComputePipelines(
-            *m_device,
-            vk_pipeline_cache,
-            1,
-            &m_vk_create_info,
-            p_allocator,
-            &m_vk_object));
+    {
+        VKEX_CPU_ZONE("vkCreateComputePipelines");
+        VKEX_VULKAN_RESULT_CALL(
+            vk_result,
+            vkCreateComputePipelines(
+                *m_device,
+                vk_pipeline_cache,
+                1,
+                &m_vk_create_info,
+                p_allocator,
+                &m_vk_object));
+    }
 
     if (vk_result != VK_SUCCESS) {
         return vkex::Result(vk_result);
@@ -471,6 +518,23 @@ vkex::Result CGraphicsPipeline::InitializeDynamicState()
     m_vk_dynamic_states.push_back(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK);
     m_vk_dynamic_states.push_back(VK_DYNAMIC_STATE_STENCIL_REFERENCE);
 
+    // Core in Vulkan 1.3
+    if (m_create_info.use_extended_dynamic_state) {
+        m_vk_dynamic_states.push_back(VK_DYNAMIC_STATE_CULL_MODE);
+        m_vk_dynamic_states.push_back(VK_DYNAMIC_STATE_FRONT_FACE);
+        m_vk_dynamic_states.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY);
+        m_vk_dynamic_states.push_back(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE);
+        m_vk_dynamic_states.push_back(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE);
+    }
+
+    // VK_EXT_extended_dynamic_state3
+    m_dynamic_blend_state = m_create_info.use_extended_dynamic_state && m_device->IsDynamicBlendStateEnabled();
+    if (m_dynamic_blend_state) {
+        m_vk_dynamic_states.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+        m_vk_dynamic_states.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT);
+        m_vk_dynamic_states.push_back(VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT);
+    }
+
     m_vk_pipeline_dynamic_state.flags             = 0;
     m_vk_pipeline_dynamic_state.dynamicStateCount = CountU32(m_vk_dynamic_states);
     m_vk_pipeline_dynamic_state.pDynamicStates    = DataPtr(m_vk_dynamic_states);
@@ -478,6 +542,82 @@ vkex::Result CGraphicsPipeline::InitializeDynamicState()
     return vkex::Result::Success;
 }
 
+vkex::Result CGraphicsPipeline::InitializeLibrary()
+{
+    const VkGraphicsPipelineLibraryFlagsEXT library_flags = m_create_info.library_flags;
+    if (library_flags == 0) {
+        return vkex::Result::Success;
+    }
+
+    if (!m_device->GetEnabledFeatures().ext.graphicsPipelineLibrary.graphicsPipelineLibrary) {
+        return vkex::Result::ErrorRequiredFeatureNotEnabled;
+    }
+
+    // Keep only the shader stages that belong to the library's parts
+    VkShaderStageFlags stage_mask = 0;
+    if (library_flags & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT) {
+        stage_mask |= VK_SHADER_STAGE_VERTEX_BIT |
+                      VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT |
+                      VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT |
+                      VK_SHADER_STAGE_GEOMETRY_BIT;
+    }
+    if (library_flags & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT) {
+        stage_mask |= VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+    m_vk_shader_stages.erase(
+        std::remove_if(
+            std::begin(m_vk_shader_stages),
+            std::end(m_vk_shader_stages),
+            [stage_mask](const VkPipelineShaderStageCreateInfo& stage) -> bool {
+                return (stage.stage & stage_mask) == 0;
+            }),
+        std::end(m_vk_shader_stages));
+
+    m_vk_library.pNext = nullptr;
+    m_vk_library.flags = library_flags;
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CGraphicsPipeline::InitializeSpecialization()
+{
+    const vkex::SpecializationConstants& specialization = m_create_info.specialization;
+    if (specialization.IsEmpty()) {
+        return vkex::Result::Success;
+    }
+
+    // Libraries check against the whole program, so a value for a stage
+    // in another library isn't an error.
+    vkex::ShaderProgram program     = m_create_info.shader_program;
+    vkex::Result        vkex_result = specialization.Validate(program);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    // Sized once, the stages point into the elements
+    m_specialization_data.resize(m_vk_shader_stages.size());
+    for (size_t i = 0; i < m_vk_shader_stages.size(); ++i) {
+        VkPipelineShaderStageCreateInfo& vk_shader_stage = m_vk_shader_stages[i];
+        vkex::ShaderModule               module          = nullptr;
+        switch (vk_shader_stage.stage) {
+            default: break;
+            case VK_SHADER_STAGE_VERTEX_BIT: module = program->GetVS(); break;
+            case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT: module = program->GetHS(); break;
+            case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT: module = program->GetDS(); break;
+            case VK_SHADER_STAGE_GEOMETRY_BIT: module = program->GetGS(); break;
+            case VK_SHADER_STAGE_FRAGMENT_BIT: module = program->GetPS(); break;
+        }
+
+        vkex::SpecializationData& data = m_specialization_data[i];
+        specialization.Apply(module, &data);
+        if (data.vk_info.mapEntryCount > 0) {
+            vk_shader_stage.pSpecializationInfo = &data.vk_info;
+        }
+    }
+
+    return vkex::Result::Success;
+}
+
 vkex::Result CGraphicsPipeline::InternalCreate(
     const vkex::GraphicsPipelineCreateInfo& create_info,
     const VkAllocationCallbacks*            p_allocator)
@@ -535,6 +675,16 @@ vkex::Result CGraphicsPipeline::InternalCreate(
         return htk_result;
     }
 
+    htk_result = InitializeLibrary();
+    if (!htk_result) {
+        return htk_result;
+    }
+
+    htk_result = InitializeSpecialization();
+    if (!htk_result) {
+        return htk_result;
+    }
+
     // Pipeline cache
     VkPipelineCache vk_pipeline_cache = VK_NULL_HANDLE;
     if (m_create_info.pipeline_cache != nullptr) {
@@ -570,17 +720,127 @@ vkex::Result CGraphicsPipeline::InternalCreate(
     m_vk_create_info.subpass             = 0;
     m_vk_create_info.basePipelineHandle  = VK_NULL_HANDLE;
     m_vk_create_info.basePipelineIndex   = -1;
+
+    // Pipeline library, drop the state of parts it doesn't contain
+    const VkGraphicsPipelineLibraryFlagsEXT library_flags = m_create_info.library_flags;
+    if (library_flags != 0) {
+        const bool vertex_input    = (library_flags & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT) != 0;
+        const bool pre_raster      = (library_flags & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT) != 0;
+        const bool fragment_shader = (library_flags & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT) != 0;
+        const bool fragment_output = (library_flags & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT) != 0;
+
+        m_vk_library.pNext                   = &m_vk_pipeline_rendering;
+        m_vk_create_info.pNext               = &m_vk_library;
+        m_vk_create_info.flags              |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+        m_vk_create_info.stageCount          = CountU32(m_vk_shader_stages);
+        m_vk_create_info.pStages             = DataPtr(m_vk_shader_stages);
+        m_vk_create_info.pVertexInputState   = vertex_input ? &m_vk_pipeline_vertex_input : nullptr;
+        m_vk_create_info.pInputAssemblyState = vertex_input ? &m_vk_pipeline_input_assembly : nullptr;
+        m_vk_create_info.pTessellationState  = pre_raster ? &m_vk_pipeline_tessellation : nullptr;
+        m_vk_create_info.pViewportState      = pre_raster ? &m_vk_pipeline_viewport : nullptr;
+        m_vk_create_info.pRasterizationState = pre_raster ? &m_vk_pipeline_rasterization : nullptr;
+        m_vk_create_info.pMultisampleState   = (fragment_shader || fragment_output) ? &m_vk_pipeline_multisample : nullptr;
+        m_vk_create_info.pDepthStencilState  = fragment_shader ? &m_vk_pipeline_depth_stencil : nullptr;
+        m_vk_create_info.pColorBlendState    = fragment_output ? &m_vk_pipeline_color_blend : nullptr;
+        m_vk_create_info.layout              = (pre_raster || fragment_shader) ? *(m_create_info.pipeline_layout) : VK_NULL_HANDLE;
+    }
+
     // Call create
     VkResult vk_result = InvalidValue<VkResult>::Value;
-    VKEX_VULKAN_RESULT_CALL(
-        vk_result,
-        vkCreateGraphicsPipelines(
-            *m_device,
-            vk_pipeline_cache,
-            1,
-            &m_vk_create_info,
-            p_allocator,
-            &m_vk_object));
+    {
+        VKEX_CPU_ZONE("vkCreateGraphicsPipelines");
+        VKEX_VULKAN_RESULT_CALL(
+            vk_result,
+            vkCreateGraphicsPipelines(
+                *m_device,
+                vk_pipeline_cache,
+                1,
+                &m_vk_create_info,
+                p_allocator,
+                &m_vk_object));
+    }
+
+    if (vk_result != VK_SUCCESS) {
+        return vkex::Result(vk_result);
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CGraphicsPipeline::InternalCreate(
+    const vkex::GraphicsPipelineLinkInfo& link_info,
+    const VkAllocationCallbacks*          p_allocator)
+{
+    const VkGraphicsPipelineLibraryFlagsEXT k_all_parts = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT |
+                                                          VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+                                                          VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT |
+                                                          VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+
+    // Check libraries
+    VkGraphicsPipelineLibraryFlagsEXT linked_parts = 0;
+    VkPipelineLayout                  vk_layout    = VK_NULL_HANDLE;
+    for (auto& library : link_info.libraries) {
+        if (library == nullptr) {
+            return vkex::Result::ErrorUnexpectedNullPointer;
+        }
+
+        const VkGraphicsPipelineLibraryFlagsEXT library_flags = library->GetLibraryFlags();
+        if ((library_flags == 0) || ((linked_parts & library_flags) != 0)) {
+            return vkex::Result::ErrorFailed;
+        }
+        linked_parts |= library_flags;
+
+        // The linked pipeline reports the dynamic state of the libraries
+        // it was linked from.
+        if (library_flags & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT) {
+            m_create_info               = library->m_create_info;
+            m_create_info.library_flags = 0;
+            vk_layout                   = *(library->m_create_info.pipeline_layout);
+        }
+        if (library_flags & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT) {
+            m_dynamic_blend_state = library->m_dynamic_blend_state;
+        }
+
+        m_vk_linked_libraries.push_back(library->GetVkObject());
+    }
+    if (linked_parts != k_all_parts) {
+        return vkex::Result::ErrorFailed;
+    }
+
+    // Pipeline cache
+    VkPipelineCache vk_pipeline_cache = VK_NULL_HANDLE;
+    if (link_info.pipeline_cache != nullptr) {
+        vk_pipeline_cache = *(link_info.pipeline_cache);
+    }
+
+    m_vk_pipeline_library.pNext        = nullptr;
+    m_vk_pipeline_library.libraryCount = CountU32(m_vk_linked_libraries);
+    m_vk_pipeline_library.pLibraries   = DataPtr(m_vk_linked_libraries);
+
+    // Vulkan create info
+    m_vk_create_info                    = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+    m_vk_create_info.pNext              = &m_vk_pipeline_library;
+    m_vk_create_info.flags              = link_info.link_time_optimization ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    m_vk_create_info.layout             = vk_layout;
+    m_vk_create_info.renderPass         = VK_NULL_HANDLE;
+    m_vk_create_info.subpass            = 0;
+    m_vk_create_info.basePipelineHandle = VK_NULL_HANDLE;
+    m_vk_create_info.basePipelineIndex  = -1;
+
+    // Call create
+    VkResult vk_result = InvalidValue<VkResult>::Value;
+    {
+        VKEX_CPU_ZONE("vkCreateGraphicsPipelines");
+        VKEX_VULKAN_RESULT_CALL(
+            vk_result,
+            vkCreateGraphicsPipelines(
+                *m_device,
+                vk_pipeline_cache,
+                1,
+                &m_vk_create_info,
+                p_allocator,
+                &m_vk_object));
+    }
 
     if (vk_result != VK_SUCCESS) {
         return vkex::Result(vk_result);
@@ -601,4 +861,205 @@ vkex::Result CGraphicsPipeline::InternalDestroy(const VkAllocationCallbacks* p_a
     return vkex::Result::Success;
 }
 
+// =================================================================================================
+// Pipeline keys
+// =================================================================================================
+template <typename T>
+static void AppendKeyValue(const T& value, vkex::PipelineKey* p_key)
+{
+    const uint8_t* p_bytes = reinterpret_cast<const uint8_t*>(&value);
+    p_key->insert(p_key->end(), p_bytes, p_bytes + sizeof(T));
+}
+
+static void AppendKeyBytes(const void* p_data, size_t size, vkex::PipelineKey* p_key)
+{
+    AppendKeyValue(static_cast<uint64_t>(size), p_key);
+    const uint8_t* p_bytes = static_cast<const uint8_t*>(p_data);
+    p_key->insert(p_key->end(), p_bytes, p_bytes + size);
+}
+
+template <typename T>
+static void AppendKeyVector(const std::vector<T>& values, vkex::PipelineKey* p_key)
+{
+    AppendKeyBytes(DataPtr(values), values.size() * sizeof(T), p_key);
+}
+
+static void AppendKeyShaderModule(const vkex::ShaderModule shader_module, vkex::PipelineKey* p_key)
+{
+    if (shader_module == nullptr) {
+        AppendKeyValue(uint64_t(0), p_key);
+        return;
+    }
+
+    const std::string& entry_point = shader_module->GetEntryPoint();
+
+    AppendKeyValue(uint64_t(1), p_key);
+    AppendKeyVector(shader_module->GetCode(), p_key);
+    AppendKeyValue(shader_module->GetStage(), p_key);
+    AppendKeyBytes(entry_point.data(), entry_point.size(), p_key);
+}
+
+static void AppendKeyPipelineLayout(const vkex::PipelineLayout pipeline_layout, vkex::PipelineKey* p_key)
+{
+    VkPipelineLayout vk_layout = VK_NULL_HANDLE;
+    if (pipeline_layout != nullptr) {
+        vk_layout = *pipeline_layout;
+    }
+    AppendKeyValue(vk_layout, p_key);
+}
+
+static VkPrimitiveTopology GetTopologyClass(VkPrimitiveTopology topology)
+{
+    switch (topology) {
+        default: break;
+        case VK_PRIMITIVE_TOPOLOGY_POINT_LIST: return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY: return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+        case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST:
+        case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
+        case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN:
+        case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST_WITH_ADJACENCY:
+        case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP_WITH_ADJACENCY: return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    }
+    return topology;
+}
+
+vkex::PipelineKey GetPipelineKey(const vkex::ComputePipelineCreateInfo& create_info)
+{
+    vkex::PipelineKey key;
+    AppendKeyValue(VK_PIPELINE_BIND_POINT_COMPUTE, &key);
+    AppendKeyShaderModule((create_info.shader_program != nullptr) ? create_info.shader_program->GetCS() : nullptr, &key);
+    AppendKeyPipelineLayout(create_info.pipeline_layout, &key);
+    create_info.specialization.AppendKey(&key);
+    return key;
+}
+
+static void AppendKeyVertexInputState(const vkex::GraphicsPipelineCreateInfo& create_info, vkex::PipelineKey* p_key)
+{
+    AppendKeyValue(static_cast<uint64_t>(create_info.vertex_binding_descriptions.size()), p_key);
+    for (auto& binding : create_info.vertex_binding_descriptions) {
+        AppendKeyValue(binding.GetDescription(), p_key);
+        AppendKeyValue(static_cast<uint64_t>(binding.GetAttributes().size()), p_key);
+        for (auto& attribute : binding.GetAttributes()) {
+            AppendKeyValue(attribute.GetDescription(), p_key);
+        }
+    }
+
+    if (create_info.use_extended_dynamic_state) {
+        AppendKeyValue(GetTopologyClass(create_info.topology), p_key);
+    }
+    else {
+        AppendKeyValue(create_info.topology, p_key);
+    }
+}
+
+static void AppendKeyPreRasterizationState(const vkex::GraphicsPipelineCreateInfo& create_info, vkex::PipelineKey* p_key)
+{
+    const vkex::ShaderProgram program = create_info.shader_program;
+    AppendKeyShaderModule((program != nullptr) ? program->GetVS() : nullptr, p_key);
+    AppendKeyShaderModule((program != nullptr) ? program->GetHS() : nullptr, p_key);
+    AppendKeyShaderModule((program != nullptr) ? program->GetDS() : nullptr, p_key);
+    AppendKeyShaderModule((program != nullptr) ? program->GetGS() : nullptr, p_key);
+    create_info.specialization.AppendKey(p_key);
+
+    AppendKeyValue(create_info.tessellation_domain_origin, p_key);
+    AppendKeyValue(create_info.patch_control_points, p_key);
+    if (!create_info.use_extended_dynamic_state) {
+        AppendKeyValue(create_info.cull_mode, p_key);
+        AppendKeyValue(create_info.front_face, p_key);
+    }
+}
+
+static void AppendKeyFragmentShaderState(const vkex::GraphicsPipelineCreateInfo& create_info, vkex::PipelineKey* p_key)
+{
+    const vkex::ShaderProgram program = create_info.shader_program;
+    AppendKeyShaderModule((program != nullptr) ? program->GetPS() : nullptr, p_key);
+    create_info.specialization.AppendKey(p_key);
+
+    AppendKeyValue(create_info.samples, p_key);
+    if (!create_info.use_extended_dynamic_state) {
+        AppendKeyValue(create_info.depth_test_enable, p_key);
+        AppendKeyValue(create_info.depth_write_enable, p_key);
+    }
+    AppendKeyValue(create_info.depth_bounds_test_enable, p_key);
+    AppendKeyValue(create_info.depth_stencil_format, p_key);
+}
+
+static void AppendKeyFragmentOutputState(const vkex::GraphicsPipelineCreateInfo& create_info, vkex::PipelineKey* p_key)
+{
+    AppendKeyValue(create_info.samples, p_key);
+
+    bool dynamic_blend_state = create_info.use_extended_dynamic_state &&
+                               (create_info.pipeline_layout != nullptr) &&
+                               create_info.pipeline_layout->GetDevice()->IsDynamicBlendStateEnabled();
+    if (dynamic_blend_state) {
+        AppendKeyValue(static_cast<uint64_t>(create_info.color_blend_attachment_states.GetStates().size()), p_key);
+    }
+    else {
+        AppendKeyVector(create_info.color_blend_attachment_states.GetStates(), p_key);
+    }
+    AppendKeyValue(create_info.color_blend_logic_op_enable, p_key);
+    AppendKeyValue(create_info.color_blend_logic_op, p_key);
+    AppendKeyValue(create_info.blend_constants, p_key);
+    AppendKeyVector(create_info.color_formats, p_key);
+    AppendKeyValue(create_info.depth_stencil_format, p_key);
+}
+
+vkex::PipelineKey GetPipelineKey(const vkex::GraphicsPipelineCreateInfo& create_info)
+{
+    // A complete pipeline keys all parts
+    VkGraphicsPipelineLibraryFlagsEXT parts = create_info.library_flags;
+    if (parts == 0) {
+        parts = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT |
+                VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+                VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT |
+                VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+    }
+
+    vkex::PipelineKey key;
+    AppendKeyValue(VK_PIPELINE_BIND_POINT_GRAPHICS, &key);
+    AppendKeyValue(create_info.flags, &key);
+    AppendKeyValue(create_info.library_flags, &key);
+    AppendKeyValue(create_info.use_extended_dynamic_state, &key);
+
+    if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT) {
+        AppendKeyVertexInputState(create_info, &key);
+    }
+    if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT) {
+        AppendKeyPreRasterizationState(create_info, &key);
+    }
+    if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT) {
+        AppendKeyFragmentShaderState(create_info, &key);
+    }
+    if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT) {
+        AppendKeyFragmentOutputState(create_info, &key);
+    }
+
+    // Layout, only the shader parts use it
+    const VkGraphicsPipelineLibraryFlagsEXT k_layout_parts = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+                                                             VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+    if (parts & k_layout_parts) {
+        AppendKeyPipelineLayout(create_info.pipeline_layout, &key);
+    }
+
+    return key;
+}
+
+uint64_t HashPipelineKey(const vkex::PipelineKey& key)
+{
+    return HashBytes(DataPtr(key), key.size());
+}
+
+uint64_t HashCreateInfo(const vkex::ComputePipelineCreateInfo& create_info)
+{
+    return HashPipelineKey(GetPipelineKey(create_info));
+}
+
+uint64_t HashCreateInfo(const vkex::GraphicsPipelineCreateInfo& create_info)
+{
+    return HashPipelineKey(GetPipelineKey(create_info));
+}
+
 } // namespace vkex
\ No newline at end of file
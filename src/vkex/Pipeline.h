@@ -19,8 +19,11 @@
 
 #include "vkex/Config.h"
 #include "vkex/Buffer.h"
+#include "vkex/Shader.h"
 #include "vkex/Traits.h"
 
+#include <future>
+
 namespace vkex {
 
 // =================================================================================================
@@ -121,6 +124,14 @@ public:
         return m_vk_object;
     }
 
+    /** @fn GetData
+     *
+     * Retrieves the current contents of the cache, including the
+     * implementation's own header, suitable for passing back in as
+     * initial_data.
+     */
+    vkex::Result GetData(std::vector<uint8_t>* p_data) const;
+
 private:
     friend class CDevice;
     friend class IObjectStorageFunctions;
@@ -149,12 +160,15 @@ private:
 
 /** @struct ComputePipelineCreateInfo
  *
+ * specialization values are checked against the constants reflected from
+ * the compute shader.
  */
 struct ComputePipelineCreateInfo
 {
-    vkex::ShaderProgram  shader_program;
-    vkex::PipelineLayout pipeline_layout;
-    vkex::PipelineCache  pipeline_cache;
+    vkex::ShaderProgram           shader_program;
+    vkex::PipelineLayout          pipeline_layout;
+    vkex::PipelineCache           pipeline_cache;
+    vkex::SpecializationConstants specialization;
 };
 
 /** @class IComputePipeline
@@ -203,6 +217,7 @@ private:
     VkComputePipelineCreateInfo     m_vk_create_info = {};
     VkPipeline                      m_vk_object      = VK_NULL_HANDLE;
     std::string                     m_cs_entry_point;
+    vkex::SpecializationData        m_specialization_data;
 };
 
 // =================================================================================================
@@ -236,6 +251,26 @@ private:
 
 /** @struct GraphicsPipelineCreateInfo
  *
+ * If use_extended_dynamic_state is set, cull_mode, front_face,
+ * depth_test_enable and depth_write_enable are ignored and topology only
+ * fixes the topology class (points, lines, triangles or patches). They
+ * are left out of GetPipelineKey, so a registered pipeline may have been
+ * created from a create info with different values. The matching
+ * CCommandBuffer setters must be called before the first draw after
+ * binding the pipeline, unless a pipeline with the same dynamic state
+ * was bound before and the values are still current. If the device also
+ * has the extendedDynamicState3 color blend enable, blend equation and
+ * color write mask features enabled, the blend part of
+ * color_blend_attachment_states is dynamic too and only the attachment
+ * count is baked into the pipeline; the blend setters are then
+ * mandatory in the same way.
+ *
+ * If library_flags is non-zero a graphics pipeline library containing
+ * only those parts of the state is created (requires the
+ * graphicsPipelineLibrary feature). See GraphicsPipelineLinkInfo.
+ *
+ * specialization values are applied to every stage that declares the
+ * constant. Libraries apply the values for the stages they contain.
  */
 struct GraphicsPipelineCreateInfo
 {
@@ -259,6 +294,24 @@ struct GraphicsPipelineCreateInfo
     vkex::PipelineCache                   pipeline_cache;
     std::vector<VkFormat>                 color_formats;
     VkFormat                              depth_stencil_format;
+    bool                                  use_extended_dynamic_state = false;
+    VkGraphicsPipelineLibraryFlagsEXT     library_flags              = 0;
+    vkex::SpecializationConstants         specialization;
+};
+
+/** @struct GraphicsPipelineLinkInfo
+ *
+ * Pipeline libraries to link into a complete graphics pipeline. Together
+ * the libraries must contain each of the vertex input, pre-rasterization,
+ * fragment shader and fragment output parts exactly once. Without
+ * link_time_optimization the link is fast but the pipeline may run slower
+ * than a monolithic one.
+ */
+struct GraphicsPipelineLinkInfo
+{
+    std::vector<vkex::GraphicsPipeline> libraries;
+    bool                                link_time_optimization = false;
+    vkex::PipelineCache                 pipeline_cache         = nullptr;
 };
 
 /** @class IGraphicsPipeline
@@ -286,6 +339,34 @@ public:
         return m_vk_object;
     }
 
+    /** @fn HasDynamicRasterState
+     *
+     * Cull mode, front face, topology and depth test/write are dynamic.
+     */
+    bool HasDynamicRasterState() const
+    {
+        return m_create_info.use_extended_dynamic_state;
+    }
+
+    /** @fn HasDynamicBlendState
+     *
+     * Color blend enable, blend equation and color write mask are dynamic.
+     */
+    bool HasDynamicBlendState() const
+    {
+        return m_dynamic_blend_state;
+    }
+
+    /** @fn GetLibraryFlags
+     *
+     * Parts of the state contained in this pipeline if it is a pipeline
+     * library, 0 otherwise.
+     */
+    VkGraphicsPipelineLibraryFlagsEXT GetLibraryFlags() const
+    {
+        return m_create_info.library_flags;
+    }
+
 private:
     friend class CDevice;
     friend class IObjectStorageFunctions;
@@ -300,6 +381,8 @@ private:
     vkex::Result InitializeDepthStencil();
     vkex::Result InitializeBlending();
     vkex::Result InitializeDynamicState();
+    vkex::Result InitializeLibrary();
+    vkex::Result InitializeSpecialization();
 
     /** @fn InternalCreate
      *
@@ -308,6 +391,13 @@ private:
         const vkex::GraphicsPipelineCreateInfo& create_info,
         const VkAllocationCallbacks*            p_allocator);
 
+    /** @fn InternalCreate
+     *
+     */
+    vkex::Result InternalCreate(
+        const vkex::GraphicsPipelineLinkInfo& link_info,
+        const VkAllocationCallbacks*          p_allocator);
+
     /** @fn InternalDestroy
      *
      */
@@ -341,9 +431,221 @@ private:
     std::vector<VkDynamicState>                           m_vk_dynamic_states;
     VkPipelineDynamicStateCreateInfo                      m_vk_pipeline_dynamic_state = { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
     VkPipelineRenderingCreateInfo                         m_vk_pipeline_rendering = {VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO};
+    bool                                                  m_dynamic_blend_state = false;
+    VkGraphicsPipelineLibraryCreateInfoEXT                m_vk_library = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT };
+    std::vector<VkPipeline>                               m_vk_linked_libraries;
+    VkPipelineLibraryCreateInfoKHR                        m_vk_pipeline_library = { VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR };
+    std::vector<vkex::SpecializationData>                 m_specialization_data;
     // clang-format on
 };
 
+// =================================================================================================
+// Pipeline keys
+// =================================================================================================
+
+/** @typedef PipelineKey
+ *
+ */
+using PipelineKey = std::vector<uint8_t>;
+
+/** @fn GetPipelineKey
+ *
+ * Canonical form of the state that affects the created pipeline, two
+ * create infos build the same pipeline if their keys are equal. Shader
+ * modules contribute their SPIR-V code and entry point, so separately
+ * loaded copies of the same shader produce equal keys. The pipeline
+ * layout contributes its handle and pipeline_cache is ignored.
+ * Specialization constant values are part of the key.
+ */
+vkex::PipelineKey GetPipelineKey(const vkex::ComputePipelineCreateInfo& create_info);
+
+/** @fn GetPipelineKey
+ *
+ * State that use_extended_dynamic_state makes dynamic is left out of the
+ * key, so create infos that only differ in those toggles share a
+ * pipeline. For pipeline libraries only the parts in library_flags are
+ * keyed.
+ */
+vkex::PipelineKey GetPipelineKey(const vkex::GraphicsPipelineCreateInfo& create_info);
+
+/** @fn HashPipelineKey
+ *
+ */
+uint64_t HashPipelineKey(const vkex::PipelineKey& key);
+
+/** @fn HashCreateInfo
+ *
+ * Hash of GetPipelineKey(create_info). Equal hashes don't guarantee
+ * equal state, compare the keys to be sure.
+ */
+uint64_t HashCreateInfo(const vkex::ComputePipelineCreateInfo& create_info);
+
+/** @fn HashCreateInfo
+ *
+ */
+uint64_t HashCreateInfo(const vkex::GraphicsPipelineCreateInfo& create_info);
+
+// =================================================================================================
+// AsyncPipeline
+// =================================================================================================
+
+/** @class AsyncPipeline
+ *
+ * Handle to a pipeline that is being created on one of the device's
+ * pipeline compile threads. Copies share the same result. Until the
+ * pipeline is ready Get() returns the fallback passed in, which lets an
+ * application keep drawing with a simpler pipeline while the final one
+ * finishes compiling.
+ */
+template <typename HandleT>
+class AsyncPipeline
+{
+public:
+    struct Value
+    {
+        vkex::Result result   = vkex::Result::Undefined;
+        HandleT      pipeline = nullptr;
+    };
+
+    AsyncPipeline() {}
+
+    AsyncPipeline(std::shared_future<Value>&& future)
+        : m_future(std::move(future))
+    {
+    }
+
+    ~AsyncPipeline() {}
+
+    /** @fn IsValid
+     *
+     */
+    bool IsValid() const
+    {
+        return m_future.valid();
+    }
+
+    /** @fn IsReady
+     *
+     * Returns true once creation has finished, successfully or not. Does
+     * not block.
+     */
+    bool IsReady() const
+    {
+        return IsValid() && (m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    }
+
+    /** @fn Wait
+     *
+     * Blocks until creation has finished and returns its result.
+     */
+    vkex::Result Wait() const
+    {
+        if (!IsValid()) {
+            return vkex::Result::ErrorUnexpectedNullPointer;
+        }
+        return m_future.get().result;
+    }
+
+    /** @fn GetResult
+     *
+     * Returns vkex::Result::Undefined if creation has not finished.
+     */
+    vkex::Result GetResult() const
+    {
+        return IsReady() ? m_future.get().result : vkex::Result::Undefined;
+    }
+
+    /** @fn Get
+     *
+     * Returns the pipeline if it was created successfully, fallback
+     * otherwise. Does not block.
+     */
+    HandleT Get(HandleT fallback = nullptr) const
+    {
+        if (!IsReady()) {
+            return fallback;
+        }
+        const Value& value = m_future.get();
+        return value.result ? value.pipeline : fallback;
+    }
+
+private:
+    std::shared_future<Value> m_future;
+};
+
+using AsyncComputePipeline  = AsyncPipeline<vkex::ComputePipeline>;
+using AsyncGraphicsPipeline = AsyncPipeline<vkex::GraphicsPipeline>;
+
+// =================================================================================================
+// LinkedGraphicsPipeline
+// =================================================================================================
+
+/** @class LinkedGraphicsPipeline
+ *
+ * Graphics pipeline linked from pipeline libraries, see
+ * CDevice::GetOrLinkGraphicsPipeline. Get() returns the fast-linked
+ * pipeline until the link-time optimized one has finished compiling in
+ * the background and the optimized one after that, so callers should
+ * call Get() every time they bind instead of holding on to the result.
+ */
+class LinkedGraphicsPipeline
+{
+public:
+    LinkedGraphicsPipeline() {}
+
+    LinkedGraphicsPipeline(vkex::GraphicsPipeline fast_linked, const vkex::AsyncGraphicsPipeline& optimized)
+        : m_fast_linked(fast_linked), m_optimized(optimized)
+    {
+    }
+
+    ~LinkedGraphicsPipeline() {}
+
+    /** @fn IsValid
+     *
+     */
+    bool IsValid() const
+    {
+        return m_fast_linked != nullptr;
+    }
+
+    /** @fn IsOptimized
+     *
+     * Returns true once the optimized pipeline is ready. Does not block.
+     */
+    bool IsOptimized() const
+    {
+        return m_optimized.Get() != nullptr;
+    }
+
+    /** @fn Get
+     *
+     */
+    vkex::GraphicsPipeline Get() const
+    {
+        return m_optimized.Get(m_fast_linked);
+    }
+
+    /** @fn GetFastLinked
+     *
+     */
+    vkex::GraphicsPipeline GetFastLinked() const
+    {
+        return m_fast_linked;
+    }
+
+    /** @fn GetOptimized
+     *
+     */
+    const vkex::AsyncGraphicsPipeline& GetOptimized() const
+    {
+        return m_optimized;
+    }
+
+private:
+    vkex::GraphicsPipeline      m_fast_linked = nullptr;
+    vkex::AsyncGraphicsPipeline m_optimized;
+};
+
 } // namespace vkex
 
 #endif // __VKEX_PIPELINE_H__
\ No newline at end of file
@@ -20,6 +20,36 @@
 
 namespace vkex {
 
+// Indexed by bit position, names match QueryPipelineStatisticFlags
+static const uint32_t k_pipeline_statistic_count = 11;
+
+static const char* k_pipeline_statistic_names[k_pipeline_statistic_count] = {
+    "input_assembly_vertices",
+    "input_assembly_primitives",
+    "vertex_shader_invocations",
+    "geometry_shader_invocations",
+    "geometry_shader_primitives",
+    "clipping_invocations",
+    "clipping_primitives",
+    "fragment_shader_invocations",
+    "tessellation_control_shader_patches",
+    "tessellation_evaluation_shader_invocations",
+    "compute_shader_invocations",
+};
+
+// =================================================================================================
+// PipelineStatisticsResult
+// =================================================================================================
+uint64_t PipelineStatisticsResult::GetValue(VkQueryPipelineStatisticFlagBits statistic) const
+{
+    for (const auto& value : values) {
+        if (value.statistic == statistic) {
+            return value.value;
+        }
+    }
+    return 0;
+}
+
 // =================================================================================================
 // QueryPool
 // =================================================================================================
@@ -38,14 +68,25 @@ vkex::Result CQueryPool::InternalCreate(
     // Copy create info
     m_create_info = create_info;
 
-    // Create Vulkan sampler
+    // Enabled statistics in result order
+    m_statistics.clear();
+    if (m_create_info.query_type == VK_QUERY_TYPE_PIPELINE_STATISTICS) {
+        for (uint32_t i = 0; i < k_pipeline_statistic_count; ++i) {
+            VkQueryPipelineStatisticFlagBits statistic = static_cast<VkQueryPipelineStatisticFlagBits>(1 << i);
+            if ((m_create_info.pipeline_statistics.flags & statistic) != 0) {
+                m_statistics.push_back(statistic);
+            }
+        }
+    }
+
+    // Create Vulkan query pool
     {
         // Create info
         m_vk_create_info                    = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
         m_vk_create_info.queryType          = m_create_info.query_type;
         m_vk_create_info.queryCount         = m_create_info.query_count;
         m_vk_create_info.pipelineStatistics = m_create_info.pipeline_statistics.flags;
-        // Create Vulkan sampler
+        // Create Vulkan query pool
         VkResult vk_result = InvalidValue<VkResult>::Value;
         VKEX_VULKAN_RESULT_CALL(
             vk_result,
@@ -75,4 +116,185 @@ vkex::Result CQueryPool::InternalDestroy(const VkAllocationCallbacks* p_allocato
     return vkex::Result::Success;
 }
 
+const char* CQueryPool::GetPipelineStatisticName(VkQueryPipelineStatisticFlagBits statistic)
+{
+    for (uint32_t i = 0; i < k_pipeline_statistic_count; ++i) {
+        if (statistic == static_cast<VkQueryPipelineStatisticFlagBits>(1 << i)) {
+            return k_pipeline_statistic_names[i];
+        }
+    }
+    return "<unknown>";
+}
+
+bool CQueryPool::ResolveQueryCount(uint32_t first_query, uint32_t* p_query_count) const
+{
+    if (first_query >= m_create_info.query_count) {
+        return false;
+    }
+
+    uint32_t remaining = m_create_info.query_count - first_query;
+    if (*p_query_count == VKEX_ALL_QUERIES) {
+        *p_query_count = remaining;
+    }
+
+    return (*p_query_count > 0) && (*p_query_count <= remaining);
+}
+
+vkex::Result CQueryPool::ResetQueries(uint32_t first_query, uint32_t query_count)
+{
+    if (!GetDevice()->GetEnabledFeatures().hostQueryReset.hostQueryReset || (ResetQueryPoolEXT == nullptr)) {
+        return vkex::Result::ErrorRequiredFeatureNotEnabled;
+    }
+
+    if (!ResolveQueryCount(first_query, &query_count)) {
+        return vkex::Result::ErrorOutOfRange;
+    }
+
+    ResetQueryPoolEXT(
+        *m_device,
+        m_vk_object,
+        first_query,
+        query_count);
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CQueryPool::FetchResults(
+    uint32_t               first_query,
+    uint32_t               query_count,
+    uint32_t               value_count,
+    bool                   wait,
+    std::vector<uint64_t>* p_data) const
+{
+    const uint32_t stride = value_count + 1;
+    p_data->assign(static_cast<size_t>(query_count) * stride, 0);
+
+    VkQueryResultFlags flags = VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT;
+    if (wait) {
+        flags |= VK_QUERY_RESULT_WAIT_BIT;
+    }
+
+    // VK_NOT_READY is expected when some queries have not completed,
+    // their availability values are left at zero.
+    VkResult vk_result = vkGetQueryPoolResults(
+        *m_device,
+        m_vk_object,
+        first_query,
+        query_count,
+        p_data->size() * sizeof(uint64_t),
+        DataPtr(*p_data),
+        stride * sizeof(uint64_t),
+        flags);
+    if ((vk_result != VK_SUCCESS) && (vk_result != VK_NOT_READY)) {
+        return vkex::Result(vk_result);
+    }
+
+    return vkex::Result::Success;
+}
+
+bool CQueryPool::IsAvailable(uint32_t first_query, uint32_t query_count) const
+{
+    if (!ResolveQueryCount(first_query, &query_count)) {
+        return false;
+    }
+
+    const uint32_t value_count = (m_create_info.query_type == VK_QUERY_TYPE_PIPELINE_STATISTICS) ? GetPipelineStatisticCount() : 1;
+
+    std::vector<uint64_t> data;
+    vkex::Result          vkex_result = FetchResults(first_query, query_count, value_count, false, &data);
+    if (!vkex_result) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < query_count; ++i) {
+        if (data[(i * (value_count + 1)) + value_count] == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+vkex::Result CQueryPool::GetResults(
+    uint32_t                        first_query,
+    uint32_t                        query_count,
+    std::vector<vkex::QueryResult>* p_results,
+    bool                            wait) const
+{
+    if (m_create_info.query_type == VK_QUERY_TYPE_PIPELINE_STATISTICS) {
+        return vkex::Result::ErrorInvalidQueryType;
+    }
+
+    if (!ResolveQueryCount(first_query, &query_count)) {
+        return vkex::Result::ErrorOutOfRange;
+    }
+
+    std::vector<uint64_t> data;
+    vkex::Result          vkex_result = FetchResults(first_query, query_count, 1, wait, &data);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    p_results->resize(query_count);
+    for (uint32_t i = 0; i < query_count; ++i) {
+        vkex::QueryResult& result = (*p_results)[i];
+        result.value              = data[(2 * i) + 0];
+        result.available          = (data[(2 * i) + 1] != 0);
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result CQueryPool::GetPipelineStatistics(
+    uint32_t                                     first_query,
+    uint32_t                                     query_count,
+    std::vector<vkex::PipelineStatisticsResult>* p_results,
+    bool                                         wait) const
+{
+    if (m_create_info.query_type != VK_QUERY_TYPE_PIPELINE_STATISTICS) {
+        return vkex::Result::ErrorInvalidQueryType;
+    }
+
+    if (!ResolveQueryCount(first_query, &query_count)) {
+        return vkex::Result::ErrorOutOfRange;
+    }
+
+    const uint32_t        value_count = GetPipelineStatisticCount();
+    std::vector<uint64_t> data;
+    vkex::Result          vkex_result = FetchResults(first_query, query_count, value_count, wait, &data);
+    if (!vkex_result) {
+        return vkex_result;
+    }
+
+    p_results->resize(query_count);
+    for (uint32_t i = 0; i < query_count; ++i) {
+        const uint64_t*                 p_values = data.data() + (i * (value_count + 1));
+        vkex::PipelineStatisticsResult& result   = (*p_results)[i];
+        result.available                         = (p_values[value_count] != 0);
+        result.values.resize(value_count);
+        for (uint32_t j = 0; j < value_count; ++j) {
+            vkex::PipelineStatisticValue& value = result.values[j];
+            value.statistic                     = m_statistics[j];
+            value.name                          = GetPipelineStatisticName(m_statistics[j]);
+            value.value                         = p_values[j];
+        }
+    }
+
+    return vkex::Result::Success;
+}
+
+// =================================================================================================
+// QueryScope
+// =================================================================================================
+QueryScope::QueryScope(vkex::CommandBuffer cmd, vkex::QueryPool query_pool, uint32_t query, VkQueryControlFlags flags)
+    : m_cmd(cmd), m_query_pool(query_pool), m_query(query)
+{
+    m_cmd->CmdBeginQuery(m_query_pool, m_query, flags);
+}
+
+QueryScope::~QueryScope()
+{
+    m_cmd->CmdEndQuery(m_query_pool, m_query);
+}
+
 } // namespace vkex
\ No newline at end of file
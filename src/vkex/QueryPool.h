@@ -21,6 +21,14 @@
 #include "vkex/Traits.h"
 #include "vkex/VulkanUtil.h"
 
+#define VKEX_QUERY_SCOPE_CONCAT_INNER(a, b) a##b
+#define VKEX_QUERY_SCOPE_CONCAT(a, b)       VKEX_QUERY_SCOPE_CONCAT_INNER(a, b)
+
+// Use as follows: VKEX_QUERY_SCOPE(cmd, query_pool, query). The query
+// ends at the end of the enclosing scope.
+#define VKEX_QUERY_SCOPE(cmd, query_pool, query) \
+    vkex::QueryScope VKEX_QUERY_SCOPE_CONCAT(vkex_query_scope_, __LINE__)(cmd, query_pool, query)
+
 namespace vkex {
 
 // =================================================================================================
@@ -37,6 +45,43 @@ struct QueryPoolCreateInfo
     QueryPipelineStatisticFlags pipeline_statistics;
 };
 
+/** @struct QueryResult
+ *
+ */
+struct QueryResult
+{
+    bool     available = false;
+    uint64_t value     = 0;
+};
+
+/** @struct PipelineStatisticValue
+ *
+ * name matches the field name in QueryPipelineStatisticFlags.
+ */
+struct PipelineStatisticValue
+{
+    VkQueryPipelineStatisticFlagBits statistic = VK_QUERY_PIPELINE_STATISTIC_FLAG_BITS_MAX_ENUM;
+    const char*                      name      = nullptr;
+    uint64_t                         value     = 0;
+};
+
+/** @struct PipelineStatisticsResult
+ *
+ * values holds one entry per statistic enabled on the pool, in the
+ * order of the VkQueryPipelineStatisticFlagBits bits.
+ */
+struct PipelineStatisticsResult
+{
+    bool                                available = false;
+    std::vector<PipelineStatisticValue> values;
+
+    /** @fn GetValue
+     *
+     * Returns 0 if statistic is not enabled on the pool.
+     */
+    uint64_t GetValue(VkQueryPipelineStatisticFlagBits statistic) const;
+};
+
 /** @class IQueryPool
  *
  */
@@ -78,6 +123,60 @@ public:
         return m_create_info.query_count;
     }
 
+    /** @fn GetPipelineStatisticCount
+     *
+     * Number of statistics enabled on a pipeline statistics pool.
+     */
+    uint32_t GetPipelineStatisticCount() const
+    {
+        return CountU32(m_statistics);
+    }
+
+    /** @fn GetPipelineStatisticName
+     *
+     */
+    static const char* GetPipelineStatisticName(VkQueryPipelineStatisticFlagBits statistic);
+
+    /** @fn ResetQueries
+     *
+     * Resets queries from the host. Requires hostQueryReset to be enabled
+     * in VkPhysicalDeviceHostQueryResetFeatures, which on devices older
+     * than Vulkan 1.2 needs VK_EXT_host_query_reset. The queries must not be
+     * in use by pending command buffers. Use
+     * CCommandBuffer::CmdResetQueryPool otherwise.
+     */
+    vkex::Result ResetQueries(uint32_t first_query = 0, uint32_t query_count = VKEX_ALL_QUERIES);
+
+    /** @fn IsAvailable
+     *
+     * Returns true if the results of every query in the range are
+     * available. Does not block.
+     */
+    bool IsAvailable(uint32_t first_query, uint32_t query_count = 1) const;
+
+    /** @fn GetResults
+     *
+     * Fetches 64 bit results for occlusion and timestamp queries. If wait
+     * is false queries that have not completed are returned with available
+     * set to false, otherwise blocks until all of them have completed.
+     */
+    vkex::Result GetResults(
+        uint32_t                        first_query,
+        uint32_t                        query_count,
+        std::vector<vkex::QueryResult>* p_results,
+        bool                            wait = false) const;
+
+    /** @fn GetPipelineStatistics
+     *
+     * Fetches and decodes the results of pipeline statistics queries.
+     * wait behaves as in GetResults.
+     */
+    vkex::Result GetPipelineStatistics(
+        uint32_t                                     first_query,
+        uint32_t                                     query_count,
+        std::vector<vkex::PipelineStatisticsResult>* p_results,
+        bool                                         wait = false) const;
+
 private:
     friend class CDevice;
     friend class IObjectStorageFunctions;
@@ -94,10 +193,55 @@ private:
      */
     vkex::Result InternalDestroy(const VkAllocationCallbacks* p_allocator);
 
+    /** @fn ResolveQueryCount
+     *
+     * Clamps VKEX_ALL_QUERIES to the end of the pool. Returns false if
+     * the range is out of bounds.
+     */
+    bool ResolveQueryCount(uint32_t first_query, uint32_t* p_query_count) const;
+
+    /** @fn FetchResults
+     *
+     * Fetches value_count values per query, each followed by its
+     * availability value.
+     */
+    vkex::Result FetchResults(
+        uint32_t               first_query,
+        uint32_t               query_count,
+        uint32_t               value_count,
+        bool                   wait,
+        std::vector<uint64_t>* p_data) const;
+
+private:
+    vkex::QueryPoolCreateInfo                     m_create_info    = {};
+    VkQueryPoolCreateInfo                         m_vk_create_info = {};
+    VkQueryPool                                   m_vk_object      = VK_NULL_HANDLE;
+    std::vector<VkQueryPipelineStatisticFlagBits> m_statistics;
+};
+
+// =================================================================================================
+// QueryScope
+// =================================================================================================
+
+/** @class QueryScope
+ *
+ * Begins a query on construction and ends it on destruction. Wrapping a
+ * range of draws with a pipeline statistics or occlusion query only
+ * takes a block. Use VKEX_QUERY_SCOPE. The query must have been reset.
+ */
+class QueryScope
+{
+public:
+    QueryScope(vkex::CommandBuffer cmd, vkex::QueryPool query_pool, uint32_t query, VkQueryControlFlags flags = 0);
+    ~QueryScope();
+
+    QueryScope(const QueryScope&)            = delete;
+    QueryScope& operator=(const QueryScope&) = delete;
+
 private:
-    vkex::QueryPoolCreateInfo m_create_info    = {};
-    VkQueryPoolCreateInfo     m_vk_create_info = {};
-    VkQueryPool               m_vk_object      = VK_NULL_HANDLE;
+    vkex::CommandBuffer m_cmd        = nullptr;
+    vkex::QueryPool     m_query_pool = nullptr;
+    uint32_t            m_query      = 0;
 };
 
 } // namespace vkex
@@ -15,6 +15,7 @@
 */
 
 #include <vkex/Queue.h>
+#include <vkex/CpuProfiler.h>
 #include <vkex/Device.h>
 
 namespace vkex {
@@ -107,6 +108,7 @@ VkBool32 CQueue::SupportsPresent(const vkex::DisplayInfo& display_info) const
 
 VkResult CQueue::WaitIdle()
 {
+    VKEX_CPU_ZONE("vkQueueWaitIdle");
     VkResult vk_result = vkQueueWaitIdle(
         m_create_info.vk_object);
     if (vk_result != VK_SUCCESS) {
@@ -117,6 +119,8 @@ VkResult CQueue::WaitIdle()
 
 vkex::Result CQueue::Submit(const vkex::SubmitInfo& submit_info)
 {
+    VKEX_CPU_ZONE("vkQueueSubmit");
+
     const std::vector<VkSemaphore>&          vk_wait_semaphores      = submit_info.GetWaitSemaphores();
     const std::vector<VkPipelineStageFlags>& vk_wait_dst_stage_masks = submit_info.GetWaitDstStageMasks();
     const std::vector<VkCommandBuffer>&      vk_command_buffers      = submit_info.GetCommandBuffers();
@@ -0,0 +1,183 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#include "vkex/RunningStats.h"
+
+#include <cmath>
+
+namespace vkex {
+
+RunningStats::RunningStats(size_t window_size, double min_value, double max_value, uint32_t bucket_count)
+{
+    VKEX_ASSERT_MSG((window_size > 0), "RunningStats window size must be non-zero");
+    VKEX_ASSERT_MSG(((min_value > 0) && (max_value > min_value)), "RunningStats range must be positive and non-empty");
+    VKEX_ASSERT_MSG((bucket_count > 0), "RunningStats bucket count must be non-zero");
+
+    m_samples.resize(window_size, 0);
+    m_histogram.resize(bucket_count, 0);
+    m_log_min   = std::log(min_value);
+    m_log_scale = static_cast<double>(bucket_count) / (std::log(max_value) - m_log_min);
+}
+
+RunningStats::~RunningStats()
+{
+}
+
+uint32_t RunningStats::GetBucket(double value) const
+{
+    if (!(value > 0)) {
+        return 0;
+    }
+
+    double bucket = (std::log(value) - m_log_min) * m_log_scale;
+    if (bucket <= 0) {
+        return 0;
+    }
+
+    const uint32_t last_bucket = CountU32(m_histogram) - 1;
+    return (bucket >= static_cast<double>(last_bucket)) ? last_bucket : static_cast<uint32_t>(bucket);
+}
+
+double RunningStats::GetBucketValue(uint32_t bucket) const
+{
+    // Geometric center of the bucket
+    return std::exp(m_log_min + ((static_cast<double>(bucket) + 0.5) / m_log_scale));
+}
+
+void RunningStats::Push(double value)
+{
+    const size_t window_size = m_samples.size();
+
+    // Evict the oldest sample once the window is full
+    if (m_count == window_size) {
+        double evicted = m_samples[m_next];
+        m_histogram[GetBucket(evicted)] -= 1;
+
+        if (m_count == 1) {
+            m_mean = 0;
+            m_m2   = 0;
+        }
+        else {
+            double n     = static_cast<double>(m_count - 1);
+            double delta = evicted - m_mean;
+            m_mean -= delta / n;
+            m_m2 -= delta * (evicted - m_mean);
+        }
+        --m_count;
+    }
+
+    m_samples[m_next] = value;
+    m_next            = (m_next + 1) % window_size;
+    m_histogram[GetBucket(value)] += 1;
+
+    ++m_count;
+    double delta = value - m_mean;
+    m_mean += delta / static_cast<double>(m_count);
+    m_m2 += delta * (value - m_mean);
+
+    // Rounding can leave a tiny negative residue after evictions
+    m_m2 = std::max(m_m2, 0.0);
+}
+
+void RunningStats::Clear()
+{
+    m_next  = 0;
+    m_count = 0;
+    m_mean  = 0;
+    m_m2    = 0;
+    std::fill(std::begin(m_histogram), std::end(m_histogram), 0);
+}
+
+double RunningStats::GetLast() const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    const size_t window_size = m_samples.size();
+    return m_samples[(m_next + window_size - 1) % window_size];
+}
+
+double RunningStats::GetVariance() const
+{
+    return (m_count > 1) ? (m_m2 / static_cast<double>(m_count - 1)) : 0;
+}
+
+double RunningStats::GetStandardDeviation() const
+{
+    return std::sqrt(GetVariance());
+}
+
+double RunningStats::GetSample(size_t n) const
+{
+    VKEX_ASSERT_MSG((n < m_count), "RunningStats sample index out of range");
+
+    const size_t window_size = m_samples.size();
+    const size_t oldest      = (m_count == window_size) ? m_next : 0;
+    return m_samples[(oldest + n) % window_size];
+}
+
+double RunningStats::GetPercentile(double percentile) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    // Rank of the sample, 1 based
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 1.0) * static_cast<double>(m_count)));
+    rank          = std::max<uint64_t>(rank, 1);
+
+    uint64_t       cumulative   = 0;
+    const uint32_t bucket_count = CountU32(m_histogram);
+    for (uint32_t bucket = 0; bucket < bucket_count; ++bucket) {
+        cumulative += m_histogram[bucket];
+        if (cumulative >= rank) {
+            return GetBucketValue(bucket);
+        }
+    }
+
+    return GetBucketValue(bucket_count - 1);
+}
+
+vkex::Percentiles RunningStats::GetPercentiles() const
+{
+    vkex::Percentiles percentiles = {};
+    if (m_count == 0) {
+        return percentiles;
+    }
+
+    const double   count        = static_cast<double>(m_count);
+    const uint64_t ranks[3]     = {
+        std::max<uint64_t>(static_cast<uint64_t>(std::ceil(0.50 * count)), 1),
+        std::max<uint64_t>(static_cast<uint64_t>(std::ceil(0.95 * count)), 1),
+        std::max<uint64_t>(static_cast<uint64_t>(std::ceil(0.99 * count)), 1),
+    };
+    double*        p_values[3]  = {&percentiles.p50, &percentiles.p95, &percentiles.p99};
+    uint32_t       next_rank    = 0;
+    uint64_t       cumulative   = 0;
+    const uint32_t bucket_count = CountU32(m_histogram);
+    for (uint32_t bucket = 0; (bucket < bucket_count) && (next_rank < 3); ++bucket) {
+        cumulative += m_histogram[bucket];
+        while ((next_rank < 3) && (cumulative >= ranks[next_rank])) {
+            *p_values[next_rank] = GetBucketValue(bucket);
+            ++next_rank;
+        }
+    }
+
+    return percentiles;
+}
+
+} // namespace vkex
\ No newline at end of file
@@ -0,0 +1,128 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#ifndef __VKEX_RUNNING_STATS_H__
+#define __VKEX_RUNNING_STATS_H__
+
+#include "vkex/Config.h"
+
+namespace vkex {
+
+/** @struct Percentiles
+ *
+ */
+struct Percentiles
+{
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+};
+
+/** @class RunningStats
+ *
+ * Statistics over the most recent window_size samples. Push() is O(1):
+ * samples live in a ring buffer, mean and variance are updated with
+ * Welford's method as samples enter and leave the window, and a
+ * histogram with logarithmically spaced buckets between min_value and
+ * max_value tracks the window's distribution for percentiles. Percentile
+ * queries walk the histogram and are accurate to about one bucket, which
+ * is roughly 1.6% of the value with the defaults. The defaults suit
+ * timings in seconds, from 1 us to 10 s.
+ */
+class RunningStats
+{
+public:
+    RunningStats(size_t window_size = 1000, double min_value = 1.0e-6, double max_value = 10.0, uint32_t bucket_count = 1024);
+    ~RunningStats();
+
+    /** @fn Push
+     *
+     */
+    void Push(double value);
+
+    /** @fn Clear
+     *
+     */
+    void Clear();
+
+    /** @fn GetCount
+     *
+     */
+    size_t GetCount() const
+    {
+        return m_count;
+    }
+
+    /** @fn GetLast
+     *
+     */
+    double GetLast() const;
+
+    /** @fn GetMean
+     *
+     */
+    double GetMean() const
+    {
+        return m_mean;
+    }
+
+    /** @fn GetVariance
+     *
+     * Sample variance of the window.
+     */
+    double GetVariance() const;
+
+    /** @fn GetStandardDeviation
+     *
+     */
+    double GetStandardDeviation() const;
+
+    /** @fn GetPercentile
+     *
+     * percentile is in [0, 1].
+     */
+    double GetPercentile(double percentile) const;
+
+    /** @fn GetPercentiles
+     *
+     * p50, p95 and p99 in a single pass over the histogram.
+     */
+    vkex::Percentiles GetPercentiles() const;
+
+    /** @fn GetSample
+     *
+     * Sample n of the window, 0 is the oldest.
+     */
+    double GetSample(size_t n) const;
+
+private:
+    uint32_t GetBucket(double value) const;
+    double   GetBucketValue(uint32_t bucket) const;
+
+private:
+    std::vector<double>   m_samples;
+    size_t                m_next      = 0;
+    size_t                m_count     = 0;
+    double                m_mean      = 0;
+    double                m_m2        = 0;
+    double                m_log_min   = 0;
+    double                m_log_scale = 0;
+    std::vector<uint32_t> m_histogram;
+};
+
+} // namespace vkex
+
+#endif // __VKEX_RUNNING_STATS_H__
\ No newline at end of file
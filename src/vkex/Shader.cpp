@@ -23,6 +23,445 @@
 
 namespace vkex {
 
+// =================================================================================================
+// ShaderReflectionCache
+// =================================================================================================
+// Not every SPIRV-Reflect version reports specialization constants, so
+// scalar ones are found with a pass over the instruction stream.
+static vkex::Result ReflectSpecializationConstants(size_t code_size, const uint8_t* code, std::vector<vkex::SpecializationConstantInfo>* p_constants)
+{
+    const uint32_t  k_header_word_count = 5;
+    const uint32_t* p_words             = reinterpret_cast<const uint32_t*>(code);
+    const size_t    word_count          = code_size / sizeof(uint32_t);
+    if ((word_count < k_header_word_count) || (p_words[0] != SpvMagicNumber)) {
+        return vkex::Result::ErrorSpirvReflectionError;
+    }
+
+    std::unordered_map<uint32_t, std::string>                      names;
+    std::unordered_map<uint32_t, uint32_t>                         constant_ids;
+    std::unordered_map<uint32_t, vkex::SpecializationConstantType> types;
+    std::vector<std::pair<uint32_t, uint32_t>>                     constants; // Result id, type id
+
+    size_t offset = k_header_word_count;
+    while (offset < word_count) {
+        const uint32_t  instruction_word_count = p_words[offset] >> 16;
+        const uint32_t  opcode                 = p_words[offset] & 0xFFFF;
+        const uint32_t* p_operands             = p_words + offset + 1;
+        if ((instruction_word_count == 0) || ((word_count - offset) < instruction_word_count)) {
+            return vkex::Result::ErrorSpirvReflectionError;
+        }
+
+        switch (opcode) {
+            default: break;
+
+            case SpvOpName: {
+                if (instruction_word_count > 2) {
+                    const char*  p_name     = reinterpret_cast<const char*>(p_operands + 1);
+                    const size_t max_length = (instruction_word_count - 2) * sizeof(uint32_t);
+                    names[p_operands[0]]    = std::string(p_name, std::find(p_name, p_name + max_length, '\0'));
+                }
+            } break;
+
+            case SpvOpDecorate: {
+                if ((instruction_word_count > 3) && (p_operands[1] == SpvDecorationSpecId)) {
+                    constant_ids[p_operands[0]] = p_operands[2];
+                }
+            } break;
+
+            case SpvOpTypeBool: {
+                types[p_operands[0]] = vkex::SpecializationConstantType::Bool;
+            } break;
+
+            case SpvOpTypeInt: {
+                const uint32_t width     = p_operands[1];
+                const bool     is_signed = (p_operands[2] != 0);
+                if (width == 32) {
+                    types[p_operands[0]] = is_signed ? vkex::SpecializationConstantType::Int32 : vkex::SpecializationConstantType::UInt32;
+                }
+                else if (width == 64) {
+                    types[p_operands[0]] = is_signed ? vkex::SpecializationConstantType::Int64 : vkex::SpecializationConstantType::UInt64;
+                }
+            } break;
+
+            case SpvOpTypeFloat: {
+                const uint32_t width = p_operands[1];
+                if (width == 32) {
+                    types[p_operands[0]] = vkex::SpecializationConstantType::Float32;
+                }
+                else if (width == 64) {
+                    types[p_operands[0]] = vkex::SpecializationConstantType::Float64;
+                }
+            } break;
+
+            case SpvOpSpecConstantTrue:
+            case SpvOpSpecConstantFalse:
+            case SpvOpSpecConstant: {
+                constants.push_back(std::make_pair(p_operands[1], p_operands[0]));
+            } break;
+        }
+
+        offset += instruction_word_count;
+    }
+
+    // Only constants with a SpecId can be specialized
+    for (auto& constant : constants) {
+        auto constant_id_it = constant_ids.find(constant.first);
+        if (constant_id_it == constant_ids.end()) {
+            continue;
+        }
+
+        vkex::SpecializationConstantInfo info = {};
+        info.constant_id                      = constant_id_it->second;
+        auto type_it                          = types.find(constant.second);
+        if (type_it != types.end()) {
+            info.type = type_it->second;
+        }
+        auto name_it = names.find(constant.first);
+        if (name_it != names.end()) {
+            info.name = name_it->second;
+        }
+        p_constants->push_back(info);
+    }
+
+    std::sort(
+        std::begin(*p_constants),
+        std::end(*p_constants),
+        [](const vkex::SpecializationConstantInfo& a, const vkex::SpecializationConstantInfo& b) -> bool {
+            return a.constant_id < b.constant_id;
+        });
+
+    return vkex::Result::Success;
+}
+
+static vkex::Result ReflectShaderModule(size_t code_size, const uint8_t* code, vkex::ShaderReflection* p_reflection)
+{
+    spv_reflect::ShaderModule reflection(code_size, code);
+    SpvReflectResult          spv_reflect_result = reflection.GetResult();
+    if (spv_reflect_result != SPV_REFLECT_RESULT_SUCCESS) {
+        return vkex::Result(spv_reflect_result);
+    }
+
+    p_reflection->stage       = static_cast<VkShaderStageFlagBits>(reflection.GetShaderStage());
+    p_reflection->entry_point = reflection.GetEntryPointName();
+    p_reflection->source_file = (reflection.GetSourceFile() != nullptr) ? reflection.GetSourceFile() : "";
+
+    if ((p_reflection->stage & VK_SHADER_STAGE_COMPUTE_BIT) != 0) {
+        // HACK: No formal getter yet?
+        auto dispatch_local_size             = reflection.GetShaderModule().entry_points[0].local_size;
+        p_reflection->threadgroup_dimensions = vkex::uint3(dispatch_local_size.x, dispatch_local_size.y, dispatch_local_size.z);
+    }
+
+    // Descriptor bindings
+    {
+        uint32_t count     = 0;
+        spv_reflect_result = reflection.EnumerateDescriptorBindings(&count, nullptr);
+        if (spv_reflect_result != SPV_REFLECT_RESULT_SUCCESS) {
+            return vkex::Result(spv_reflect_result);
+        }
+
+        std::vector<SpvReflectDescriptorBinding*> bindings(count);
+        spv_reflect_result = reflection.EnumerateDescriptorBindings(&count, bindings.data());
+        if (spv_reflect_result != SPV_REFLECT_RESULT_SUCCESS) {
+            return vkex::Result(spv_reflect_result);
+        }
+
+        for (auto& binding : bindings) {
+            vkex::ShaderInterface::Binding desc = {};
+            desc.name                           = (binding->name != nullptr ? binding->name : "");
+            desc.set_number                     = binding->set;
+            desc.binding_number                 = binding->binding;
+            desc.descriptor_type                = static_cast<VkDescriptorType>(binding->descriptor_type);
+            desc.descriptor_count               = binding->count;
+            p_reflection->bindings.push_back(desc);
+        }
+    }
+
+    // Specialization constants
+    {
+        vkex::Result vkex_result = ReflectSpecializationConstants(code_size, code, &p_reflection->specialization_constants);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+    }
+
+    return vkex::Result::Success;
+}
+
+// File layout: header, then per entry the SPIR-V code followed by the
+// serialized ShaderReflection. Strings and code are stored as a uint32_t
+// length and the contents.
+struct ShaderReflectionFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+    uint64_t data_hash;
+};
+
+const uint32_t kShaderReflectionFileMagic   = 0x52535856; // 'VXSR'
+const uint32_t kShaderReflectionFileVersion = 3;
+
+class ReflectionWriter
+{
+public:
+    template <typename T>
+    void Write(const T& value)
+    {
+        const uint8_t* p_bytes = reinterpret_cast<const uint8_t*>(&value);
+        m_data.insert(std::end(m_data), p_bytes, p_bytes + sizeof(T));
+    }
+
+    void Write(const std::string& value)
+    {
+        Write(static_cast<uint32_t>(value.size()));
+        m_data.insert(std::end(m_data), std::begin(value), std::end(value));
+    }
+
+    void Write(const std::vector<uint32_t>& words)
+    {
+        const uint8_t* p_bytes = reinterpret_cast<const uint8_t*>(DataPtr(words));
+        Write(CountU32(words));
+        m_data.insert(std::end(m_data), p_bytes, p_bytes + (words.size() * sizeof(uint32_t)));
+    }
+
+    std::vector<uint8_t>& GetData()
+    {
+        return m_data;
+    }
+
+private:
+    std::vector<uint8_t> m_data;
+};
+
+class ReflectionReader
+{
+public:
+    ReflectionReader(const uint8_t* p_data, size_t size)
+        : m_p_data(p_data), m_size(size)
+    {
+    }
+
+    template <typename T>
+    bool Read(T* p_value)
+    {
+        if ((m_size - m_offset) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(p_value, m_p_data + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    bool Read(std::string* p_value)
+    {
+        uint32_t length = 0;
+        if (!Read(&length) || ((m_size - m_offset) < length)) {
+            return false;
+        }
+        p_value->assign(reinterpret_cast<const char*>(m_p_data + m_offset), length);
+        m_offset += length;
+        return true;
+    }
+
+    bool Read(std::vector<uint32_t>* p_words)
+    {
+        uint32_t count = 0;
+        if (!Read(&count) || !CanHold(count, sizeof(uint32_t))) {
+            return false;
+        }
+        p_words->resize(count);
+        if (count > 0) {
+            std::memcpy(p_words->data(), m_p_data + m_offset, count * sizeof(uint32_t));
+        }
+        m_offset += count * sizeof(uint32_t);
+        return true;
+    }
+
+    // Checks count against the bytes left so a corrupt count can't
+    // trigger a huge allocation before the reads fail
+    bool CanHold(size_t count, size_t min_element_size) const
+    {
+        return count <= ((m_size - m_offset) / min_element_size);
+    }
+
+    bool IsAtEnd() const
+    {
+        return m_offset == m_size;
+    }
+
+private:
+    const uint8_t* m_p_data = nullptr;
+    size_t         m_size   = 0;
+    size_t         m_offset = 0;
+};
+
+bool ShaderReflectionCache::Find(const std::vector<uint32_t>& code, uint64_t code_hash, vkex::ShaderReflection* p_reflection) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Equal hashes alone don't mean the code is the same
+    auto it = m_entries.find(code_hash);
+    if ((it == m_entries.end()) || (it->second.code != code)) {
+        ++m_miss_count;
+        return false;
+    }
+
+    ++m_hit_count;
+    *p_reflection = it->second.reflection;
+    return true;
+}
+
+void ShaderReflectionCache::Insert(const std::vector<uint32_t>& code, uint64_t code_hash, const vkex::ShaderReflection& reflection)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Entry& entry     = m_entries[code_hash];
+    entry.code       = code;
+    entry.reflection = reflection;
+}
+
+void ShaderReflectionCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+vkex::Result ShaderReflectionCache::Load(const fs::path& path)
+{
+    std::vector<uint8_t> file_data = fs::load_file(path);
+    if (file_data.size() < sizeof(ShaderReflectionFileHeader)) {
+        return vkex::Result::ErrorFailed;
+    }
+
+    ShaderReflectionFileHeader header = {};
+    std::memcpy(&header, file_data.data(), sizeof(header));
+
+    const uint8_t* p_data    = file_data.data() + sizeof(header);
+    const size_t   data_size = file_data.size() - sizeof(header);
+    if ((header.magic != kShaderReflectionFileMagic) ||
+        (header.version != kShaderReflectionFileVersion) ||
+        (header.data_hash != HashBytes(p_data, data_size))) {
+        return vkex::Result::ErrorFailed;
+    }
+
+    // Smallest serialized sizes, strings are at least their length
+    using Binding                    = vkex::ShaderInterface::Binding;
+    using Constant                   = vkex::SpecializationConstantInfo;
+    const size_t k_min_string_size   = sizeof(uint32_t);
+    const size_t k_min_entry_size    = sizeof(uint32_t) + sizeof(vkex::ShaderReflection::stage) + (2 * k_min_string_size) + sizeof(vkex::ShaderReflection::threadgroup_dimensions) + (2 * sizeof(uint32_t));
+    const size_t k_min_binding_size  = k_min_string_size + sizeof(Binding::set_number) + sizeof(Binding::binding_number) + sizeof(Binding::descriptor_type) + sizeof(Binding::descriptor_count);
+    const size_t k_min_constant_size = k_min_string_size + sizeof(Constant::constant_id) + sizeof(Constant::type);
+
+    // Parse everything before touching the cache
+    ReflectionReader reader(p_data, data_size);
+    if (!reader.CanHold(header.entry_count, k_min_entry_size)) {
+        return vkex::Result::ErrorFailed;
+    }
+
+    std::vector<Entry> entries(header.entry_count);
+    for (auto& entry : entries) {
+        vkex::ShaderReflection& reflection     = entry.reflection;
+        uint32_t                binding_count  = 0;
+        uint32_t                constant_count = 0;
+        if (!reader.Read(&entry.code) ||
+            !reader.Read(&reflection.stage) ||
+            !reader.Read(&reflection.entry_point) ||
+            !reader.Read(&reflection.source_file) ||
+            !reader.Read(&reflection.threadgroup_dimensions) ||
+            !reader.Read(&binding_count) ||
+            !reader.CanHold(binding_count, k_min_binding_size)) {
+            return vkex::Result::ErrorFailed;
+        }
+
+        reflection.bindings.resize(binding_count);
+        for (auto& binding : reflection.bindings) {
+            if (!reader.Read(&binding.name) ||
+                !reader.Read(&binding.set_number) ||
+                !reader.Read(&binding.binding_number) ||
+                !reader.Read(&binding.descriptor_type) ||
+                !reader.Read(&binding.descriptor_count)) {
+                return vkex::Result::ErrorFailed;
+            }
+        }
+
+        if (!reader.Read(&constant_count) || !reader.CanHold(constant_count, k_min_constant_size)) {
+            return vkex::Result::ErrorFailed;
+        }
+
+        reflection.specialization_constants.resize(constant_count);
+        for (auto& constant : reflection.specialization_constants) {
+            if (!reader.Read(&constant.name) ||
+                !reader.Read(&constant.constant_id) ||
+                !reader.Read(&constant.type)) {
+                return vkex::Result::ErrorFailed;
+            }
+        }
+    }
+    if (!reader.IsAtEnd()) {
+        return vkex::Result::ErrorFailed;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& entry : entries) {
+        const uint64_t code_hash = HashWords(DataPtr(entry.code), entry.code.size());
+        m_entries[code_hash]     = std::move(entry);
+    }
+
+    return vkex::Result::Success;
+}
+
+vkex::Result ShaderReflectionCache::Save(const fs::path& path) const
+{
+    ReflectionWriter writer;
+    uint32_t         entry_count = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        entry_count = static_cast<uint32_t>(m_entries.size());
+        for (auto& entry : m_entries) {
+            const vkex::ShaderReflection& reflection = entry.second.reflection;
+            writer.Write(entry.second.code);
+            writer.Write(reflection.stage);
+            writer.Write(reflection.entry_point);
+            writer.Write(reflection.source_file);
+            writer.Write(reflection.threadgroup_dimensions);
+            writer.Write(CountU32(reflection.bindings));
+            for (auto& binding : reflection.bindings) {
+                writer.Write(binding.name);
+                writer.Write(binding.set_number);
+                writer.Write(binding.binding_number);
+                writer.Write(binding.descriptor_type);
+                writer.Write(binding.descriptor_count);
+            }
+            writer.Write(CountU32(reflection.specialization_constants));
+            for (auto& constant : reflection.specialization_constants) {
+                writer.Write(constant.name);
+                writer.Write(constant.constant_id);
+                writer.Write(constant.type);
+            }
+        }
+    }
+
+    const std::vector<uint8_t>& data = writer.GetData();
+
+    ShaderReflectionFileHeader header = {};
+    header.magic                      = kShaderReflectionFileMagic;
+    header.version                    = kShaderReflectionFileVersion;
+    header.entry_count                = entry_count;
+    header.data_hash                  = HashBytes(DataPtr(data), data.size());
+
+    std::vector<uint8_t> file_data(sizeof(header) + data.size());
+    std::memcpy(file_data.data(), &header, sizeof(header));
+    if (!data.empty()) {
+        std::memcpy(file_data.data() + sizeof(header), data.data(), data.size());
+    }
+    if (!fs::save_file_atomic(path, file_data.data(), file_data.size())) {
+        return vkex::Result::ErrorFailed;
+    }
+
+    return vkex::Result::Success;
+}
+
 // =================================================================================================
 // ShaderModule
 // =================================================================================================
@@ -41,11 +480,17 @@ vkex::Result CShaderModule::InternalCreate(
     // Copy create info
     m_create_info = create_info;
 
+    // Copy code, SPIR-V is a stream of 32-bit words
+    const uint32_t* p_words = reinterpret_cast<const uint32_t*>(create_info.code);
+    m_code.assign(p_words, p_words + (create_info.code_size / sizeof(uint32_t)));
+    m_create_info.code = reinterpret_cast<const uint8_t*>(DataPtr(m_code));
+    m_code_hash        = HashWords(DataPtr(m_code), m_code.size());
+
     // Vulkan create info
     m_vk_create_info          = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
     m_vk_create_info.flags    = 0;
     m_vk_create_info.codeSize = m_create_info.code_size;
-    m_vk_create_info.pCode    = reinterpret_cast<const uint32_t*>(m_create_info.code);
+    m_vk_create_info.pCode    = DataPtr(m_code);
     VkResult vk_result        = InvalidValue<VkResult>::Value;
     VKEX_VULKAN_RESULT_CALL(
         vk_result,
@@ -58,66 +503,49 @@ vkex::Result CShaderModule::InternalCreate(
         return vkex::Result(vk_result);
     }
 
-    // Reflect information
-    {
-        spv_reflect::ShaderModule reflection(m_create_info.code_size, m_create_info.code);
-        SpvReflectResult          spv_reflect_result = reflection.GetResult();
-        if (spv_reflect_result != SPV_REFLECT_RESULT_SUCCESS) {
-            return vkex::Result(spv_reflect_result);
-        }
-
-        // Grab shader stage if not specified
-        if (m_create_info.stage == 0) {
-            m_create_info.stage = static_cast<VkShaderStageFlagBits>(reflection.GetShaderStage());
+    // Reflect information, or reuse an earlier parse of the same code
+    vkex::ShaderReflection       reflection = {};
+    vkex::ShaderReflectionCache& cache      = m_device->GetShaderReflectionCache();
+    if (!cache.Find(m_code, m_code_hash, &reflection)) {
+        vkex::Result vkex_result = ReflectShaderModule(m_create_info.code_size, m_create_info.code, &reflection);
+        if (!vkex_result) {
+            return vkex_result;
         }
+        cache.Insert(m_code, m_code_hash, reflection);
+    }
 
-        // Grab entry point if not specified
-        if (m_create_info.entry_point.empty()) {
-            m_create_info.entry_point = reflection.GetEntryPointName();
-        }
+    // Grab shader stage if not specified
+    if (m_create_info.stage == 0) {
+        m_create_info.stage = reflection.stage;
+    }
 
-        // Grab file source if not specified
-        if (m_create_info.source_file.empty() && (reflection.GetSourceFile() != nullptr)) {
-            m_create_info.source_file = reflection.GetSourceFile();
-        }
+    // Grab entry point if not specified
+    if (m_create_info.entry_point.empty()) {
+        m_create_info.entry_point = reflection.entry_point;
+    }
 
-        if ((m_create_info.stage & VK_SHADER_STAGE_COMPUTE_BIT) != 0) {
-            // HACK: No formal getter yet?
-            auto dispatch_local_size = reflection.GetShaderModule().entry_points[0].local_size;
-            m_interface.AddThreadgroupDimensions(dispatch_local_size.x, dispatch_local_size.y, dispatch_local_size.z);
-        }
+    // Grab file source if not specified
+    if (m_create_info.source_file.empty()) {
+        m_create_info.source_file = reflection.source_file;
+    }
 
-        // Descriptor set create infos
-        {
-            uint32_t count     = 0;
-            spv_reflect_result = reflection.EnumerateDescriptorBindings(&count, nullptr);
-            if (spv_reflect_result != SPV_REFLECT_RESULT_SUCCESS) {
-                return vkex::Result(spv_reflect_result);
-            }
+    if ((m_create_info.stage & VK_SHADER_STAGE_COMPUTE_BIT) != 0) {
+        const vkex::uint3& dims = reflection.threadgroup_dimensions;
+        m_interface.AddThreadgroupDimensions(dims.x, dims.y, dims.z);
+    }
 
-            std::vector<SpvReflectDescriptorBinding*> bindings(count);
-            spv_reflect_result = reflection.EnumerateDescriptorBindings(&count, bindings.data());
-            if (spv_reflect_result != SPV_REFLECT_RESULT_SUCCESS) {
-                return vkex::Result(spv_reflect_result);
-            }
+    m_specialization_constants = reflection.specialization_constants;
 
-            // Build out descriptor set and binding information
-            for (auto& binding : bindings) {
-                vkex::ShaderInterface::Binding desc = {};
-                desc.name                           = (binding->name != nullptr ? binding->name : "");
-                desc.set_number                     = binding->set;
-                desc.binding_number                 = binding->binding;
-                desc.descriptor_type                = static_cast<VkDescriptorType>(binding->descriptor_type);
-                desc.descriptor_count               = binding->count;
-                desc.stage_flags                    = m_create_info.stage;
-                vkex::Result vkex_result            = vkex::Result::Undefined;
-                VKEX_RESULT_CALL(
-                    vkex_result,
-                    m_interface.AddBinding(desc));
-                if (!vkex_result) {
-                    return vkex_result;
-                }
-            }
+    // Build out descriptor set and binding information
+    for (auto& binding : reflection.bindings) {
+        vkex::ShaderInterface::Binding desc = binding;
+        desc.stage_flags                    = m_create_info.stage;
+        vkex::Result vkex_result            = vkex::Result::Undefined;
+        VKEX_RESULT_CALL(
+            vkex_result,
+            m_interface.AddBinding(desc));
+        if (!vkex_result) {
+            return vkex_result;
         }
     }
 
@@ -138,6 +566,39 @@ vkex::Result CShaderModule::InternalDestroy(const VkAllocationCallbacks* p_alloc
     return vkex::Result::Success;
 }
 
+const vkex::SpecializationConstantInfo* CShaderModule::FindSpecializationConstant(uint32_t constant_id) const
+{
+    auto it = std::lower_bound(
+        std::begin(m_specialization_constants),
+        std::end(m_specialization_constants),
+        constant_id,
+        [](const vkex::SpecializationConstantInfo& info, uint32_t id) -> bool {
+            return info.constant_id < id;
+        });
+    if ((it == std::end(m_specialization_constants)) || (it->constant_id != constant_id)) {
+        return nullptr;
+    }
+    return &(*it);
+}
+
+const vkex::SpecializationConstantInfo* CShaderModule::FindSpecializationConstant(const std::string& name) const
+{
+    if (name.empty()) {
+        return nullptr;
+    }
+
+    auto it = std::find_if(
+        std::begin(m_specialization_constants),
+        std::end(m_specialization_constants),
+        [&name](const vkex::SpecializationConstantInfo& info) -> bool {
+            return info.name == name;
+        });
+    if (it == std::end(m_specialization_constants)) {
+        return nullptr;
+    }
+    return &(*it);
+}
+
 // =================================================================================================
 // ShaderProgram
 // =================================================================================================
@@ -189,6 +650,148 @@ vkex::Result CShaderProgram::InternalDestroy(const VkAllocationCallbacks* p_allo
     return vkex::Result::Success;
 }
 
+// =================================================================================================
+// SpecializationConstants
+// =================================================================================================
+void SpecializationConstants::Store(const Entry& entry)
+{
+    auto it = std::find_if(
+        std::begin(m_entries),
+        std::end(m_entries),
+        [&entry](const Entry& elem) -> bool {
+            return (elem.constant_id == entry.constant_id) && (elem.name == entry.name);
+        });
+    if (it != std::end(m_entries)) {
+        *it = entry;
+        return;
+    }
+
+    // Sorted so the hash doesn't depend on the order values were set in
+    it = std::upper_bound(
+        std::begin(m_entries),
+        std::end(m_entries),
+        entry,
+        [](const Entry& a, const Entry& b) -> bool {
+            return (a.constant_id != b.constant_id) ? (a.constant_id < b.constant_id) : (a.name < b.name);
+        });
+    m_entries.insert(it, entry);
+}
+
+const vkex::SpecializationConstantInfo* SpecializationConstants::Find(const vkex::ShaderModule module, const Entry& entry)
+{
+    if (module == nullptr) {
+        return nullptr;
+    }
+    if (entry.name.empty()) {
+        return module->FindSpecializationConstant(entry.constant_id);
+    }
+    return module->FindSpecializationConstant(entry.name);
+}
+
+void SpecializationConstants::AppendKey(std::vector<uint8_t>* p_key) const
+{
+    // Sizes are written ahead of the variable length fields so that
+    // different entries can't produce the same bytes.
+    auto append = [p_key](const void* p_data, size_t size) {
+        const uint8_t* p_bytes = static_cast<const uint8_t*>(p_data);
+        p_key->insert(p_key->end(), p_bytes, p_bytes + size);
+    };
+
+    const uint64_t count = m_entries.size();
+    append(&count, sizeof(count));
+    for (auto& entry : m_entries) {
+        const uint64_t name_size = entry.name.size();
+        append(&entry.constant_id, sizeof(entry.constant_id));
+        append(&name_size, sizeof(name_size));
+        append(entry.name.data(), entry.name.size());
+        append(&entry.type, sizeof(entry.type));
+        append(&entry.size, sizeof(entry.size));
+        append(entry.value, entry.size);
+    }
+}
+
+vkex::Result SpecializationConstants::Validate(const vkex::ShaderProgram program) const
+{
+    if (m_entries.empty()) {
+        return vkex::Result::Success;
+    }
+
+    if (program == nullptr) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    const vkex::ShaderModule modules[] = {
+        program->GetVS(),
+        program->GetHS(),
+        program->GetDS(),
+        program->GetGS(),
+        program->GetPS(),
+        program->GetCS(),
+    };
+
+    for (auto& entry : m_entries) {
+        bool found = false;
+        for (auto& module : modules) {
+            const vkex::SpecializationConstantInfo* p_info = Find(module, entry);
+            if (p_info == nullptr) {
+                continue;
+            }
+            if (p_info->type != entry.type) {
+                VKEX_LOG_ERROR("Specialization constant " << (entry.name.empty() ? std::to_string(entry.constant_id) : entry.name) << " type does not match the shader declaration");
+                return vkex::Result::ErrorSpecializationConstantTypeMismatch;
+            }
+            found = true;
+        }
+
+        if (!found) {
+            VKEX_LOG_ERROR("Specialization constant " << (entry.name.empty() ? std::to_string(entry.constant_id) : entry.name) << " is not declared by any shader stage");
+            return vkex::Result::ErrorSpecializationConstantNotFound;
+        }
+    }
+
+    return vkex::Result::Success;
+}
+
+void SpecializationConstants::Apply(const vkex::ShaderModule module, vkex::SpecializationData* p_data) const
+{
+    p_data->map_entries.clear();
+    p_data->data.clear();
+    p_data->vk_info = {};
+
+    for (auto& entry : m_entries) {
+        const vkex::SpecializationConstantInfo* p_info = Find(module, entry);
+        if (p_info == nullptr) {
+            continue;
+        }
+
+        // A constant set both by id and by name keeps the value set by id,
+        // entries with an id sort first.
+        auto it = std::find_if(
+            std::begin(p_data->map_entries),
+            std::end(p_data->map_entries),
+            [p_info](const VkSpecializationMapEntry& elem) -> bool {
+                return elem.constantID == p_info->constant_id;
+            });
+        if (it != std::end(p_data->map_entries)) {
+            continue;
+        }
+
+        VkSpecializationMapEntry vk_map_entry = {};
+        vk_map_entry.constantID               = p_info->constant_id;
+        vk_map_entry.offset                   = static_cast<uint32_t>(p_data->data.size());
+        vk_map_entry.size                     = entry.size;
+        p_data->map_entries.push_back(vk_map_entry);
+        p_data->data.insert(std::end(p_data->data), entry.value, entry.value + entry.size);
+    }
+
+    if (!p_data->map_entries.empty()) {
+        p_data->vk_info.mapEntryCount = CountU32(p_data->map_entries);
+        p_data->vk_info.pMapEntries   = DataPtr(p_data->map_entries);
+        p_data->vk_info.dataSize      = p_data->data.size();
+        p_data->vk_info.pData         = DataPtr(p_data->data);
+    }
+}
+
 // =================================================================================================
 // Support functions
 // =================================================================================================
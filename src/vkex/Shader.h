@@ -21,8 +21,128 @@
 #include "vkex/Traits.h"
 #include "vkex/VulkanUtil.h"
 
+#include <atomic>
+#include <unordered_map>
+
 namespace vkex {
 
+// =================================================================================================
+// ShaderReflectionCache
+// =================================================================================================
+
+/** @enum SpecializationConstantType
+ *
+ */
+enum class SpecializationConstantType : uint32_t
+{
+    Undefined = 0,
+    Bool,
+    Int32,
+    UInt32,
+    Float32,
+    Int64,
+    UInt64,
+    Float64,
+};
+
+/** @struct SpecializationConstantInfo
+ *
+ * A scalar specialization constant declared with a SpecId decoration.
+ * name is empty if the SPIR-V was stripped of debug names.
+ */
+struct SpecializationConstantInfo
+{
+    std::string                      name;
+    uint32_t                         constant_id = 0;
+    vkex::SpecializationConstantType type        = vkex::SpecializationConstantType::Undefined;
+};
+
+/** @struct ShaderReflection
+ *
+ * The parts of a SPIRV-Reflect parse that CShaderModule uses. Binding
+ * stage flags are not stored, they come from the module's stage.
+ * Specialization constants are sorted by constant_id.
+ */
+struct ShaderReflection
+{
+    VkShaderStageFlagBits                         stage;
+    std::string                                   entry_point;
+    std::string                                   source_file;
+    vkex::uint3                                   threadgroup_dimensions = vkex::uint3(0);
+    std::vector<vkex::ShaderInterface::Binding>   bindings;
+    std::vector<vkex::SpecializationConstantInfo> specialization_constants;
+};
+
+/** @class ShaderReflectionCache
+ *
+ * Reflection results keyed by SPIR-V code hash, so loading the same blob
+ * again skips the SPIRV-Reflect parse. Entries keep a copy of the code
+ * and a hit requires the code to match, so a hash collision is a miss.
+ * Thread safe. The contents can be saved to and loaded from disk; the
+ * file only depends on the SPIR-V, not on the device or driver.
+ */
+class ShaderReflectionCache
+{
+public:
+    ShaderReflectionCache() {}
+    ~ShaderReflectionCache() {}
+
+    /** @fn Find
+     *
+     */
+    bool Find(const std::vector<uint32_t>& code, uint64_t code_hash, vkex::ShaderReflection* p_reflection) const;
+
+    /** @fn Insert
+     *
+     */
+    void Insert(const std::vector<uint32_t>& code, uint64_t code_hash, const vkex::ShaderReflection& reflection);
+
+    /** @fn Clear
+     *
+     */
+    void Clear();
+
+    /** @fn Load
+     *
+     * Adds the entries in the file at path. Returns an error and leaves
+     * the cache unchanged if the file is missing or malformed.
+     */
+    vkex::Result Load(const fs::path& path);
+
+    /** @fn Save
+     *
+     */
+    vkex::Result Save(const fs::path& path) const;
+
+    /** @fn GetHitCount
+     *
+     */
+    uint64_t GetHitCount() const
+    {
+        return m_hit_count;
+    }
+
+    /** @fn GetMissCount
+     *
+     */
+    uint64_t GetMissCount() const
+    {
+        return m_miss_count;
+    }
+
+private:
+    struct Entry
+    {
+        std::vector<uint32_t>  code;
+        vkex::ShaderReflection reflection;
+    };
+
+    mutable std::mutex                  m_mutex;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    mutable std::atomic<uint64_t>       m_hit_count  = 0;
+    mutable std::atomic<uint64_t>       m_miss_count = 0;
+};
+
 // =================================================================================================
 // ShaderModule
 // =================================================================================================
@@ -86,6 +206,46 @@ public:
         return m_interface;
     }
 
+    /** @fn GetCode
+     *
+     * Copy of the SPIR-V code, made at creation since the code pointer in
+     * the create info is not required to stay valid.
+     */
+    const std::vector<uint32_t>& GetCode() const
+    {
+        return m_code;
+    }
+
+    /** @fn GetCodeHash
+     *
+     * Hash of GetCode().
+     */
+    uint64_t GetCodeHash() const
+    {
+        return m_code_hash;
+    }
+
+    /** @fn GetSpecializationConstants
+     *
+     * Specialization constants declared in the module, sorted by
+     * constant_id.
+     */
+    const std::vector<vkex::SpecializationConstantInfo>& GetSpecializationConstants() const
+    {
+        return m_specialization_constants;
+    }
+
+    /** @fn FindSpecializationConstant
+     *
+     * Returns nullptr if the module doesn't declare the constant.
+     */
+    const vkex::SpecializationConstantInfo* FindSpecializationConstant(uint32_t constant_id) const;
+
+    /** @fn FindSpecializationConstant
+     *
+     */
+    const vkex::SpecializationConstantInfo* FindSpecializationConstant(const std::string& name) const;
+
 private:
     friend class CDevice;
     friend class CShaderProgram;
@@ -104,10 +264,13 @@ private:
     vkex::Result InternalDestroy(const VkAllocationCallbacks* p_allocator);
 
 private:
-    vkex::ShaderModuleCreateInfo m_create_info    = {};
-    VkShaderModuleCreateInfo     m_vk_create_info = {};
-    VkShaderModule               m_vk_object      = VK_NULL_HANDLE;
-    vkex::ShaderInterface        m_interface;
+    vkex::ShaderModuleCreateInfo                  m_create_info    = {};
+    VkShaderModuleCreateInfo                      m_vk_create_info = {};
+    VkShaderModule                                m_vk_object      = VK_NULL_HANDLE;
+    std::vector<uint32_t>                         m_code;
+    uint64_t                                      m_code_hash      = 0;
+    vkex::ShaderInterface                         m_interface;
+    std::vector<vkex::SpecializationConstantInfo> m_specialization_constants;
 };
 
 // =================================================================================================
@@ -199,6 +362,193 @@ private:
     vkex::ShaderInterface         m_interface;
 };
 
+// =================================================================================================
+// SpecializationConstants
+// =================================================================================================
+
+/** @struct SpecializationConstantTypeOf
+ *
+ */
+template <typename T>
+struct SpecializationConstantTypeOf;
+
+template <>
+struct SpecializationConstantTypeOf<bool>
+{
+    static constexpr vkex::SpecializationConstantType value = vkex::SpecializationConstantType::Bool;
+};
+
+template <>
+struct SpecializationConstantTypeOf<int32_t>
+{
+    static constexpr vkex::SpecializationConstantType value = vkex::SpecializationConstantType::Int32;
+};
+
+template <>
+struct SpecializationConstantTypeOf<uint32_t>
+{
+    static constexpr vkex::SpecializationConstantType value = vkex::SpecializationConstantType::UInt32;
+};
+
+template <>
+struct SpecializationConstantTypeOf<float>
+{
+    static constexpr vkex::SpecializationConstantType value = vkex::SpecializationConstantType::Float32;
+};
+
+template <>
+struct SpecializationConstantTypeOf<int64_t>
+{
+    static constexpr vkex::SpecializationConstantType value = vkex::SpecializationConstantType::Int64;
+};
+
+template <>
+struct SpecializationConstantTypeOf<uint64_t>
+{
+    static constexpr vkex::SpecializationConstantType value = vkex::SpecializationConstantType::UInt64;
+};
+
+template <>
+struct SpecializationConstantTypeOf<double>
+{
+    static constexpr vkex::SpecializationConstantType value = vkex::SpecializationConstantType::Float64;
+};
+
+/** @struct SpecializationData
+ *
+ * Storage for one shader stage's VkSpecializationInfo, vk_info points
+ * into map_entries and data.
+ */
+struct SpecializationData
+{
+    std::vector<VkSpecializationMapEntry> map_entries;
+    std::vector<uint8_t>                  data;
+    VkSpecializationInfo                  vk_info = {};
+};
+
+/** @class SpecializationConstants
+ *
+ * Typed specialization constant values, set by constant_id or by the
+ * name the constant has in the shader source. The value's C++ type must
+ * match the declared type exactly (bool, int32_t, uint32_t, float,
+ * int64_t, uint64_t or double), which is checked against the reflected
+ * SPIR-V when the pipeline is created. A value applies to every stage
+ * of the program that declares the constant.
+ *
+ *   vkex::SpecializationConstants constants;
+ *   constants.Set("kSampleCount", 16u).Set(1, true);
+ *   create_info.specialization = constants;
+ */
+class SpecializationConstants
+{
+public:
+    SpecializationConstants() {}
+    ~SpecializationConstants() {}
+
+    /** @fn Set
+     *
+     */
+    template <typename T>
+    SpecializationConstants& Set(uint32_t constant_id, T value)
+    {
+        Entry entry       = {};
+        entry.constant_id = constant_id;
+        SetValue(value, &entry);
+        Store(entry);
+        return *this;
+    }
+
+    /** @fn Set
+     *
+     */
+    template <typename T>
+    SpecializationConstants& Set(const std::string& name, T value)
+    {
+        Entry entry = {};
+        entry.name  = name;
+        SetValue(value, &entry);
+        Store(entry);
+        return *this;
+    }
+
+    /** @fn IsEmpty
+     *
+     */
+    bool IsEmpty() const
+    {
+        return m_entries.empty();
+    }
+
+    /** @fn Clear
+     *
+     */
+    void Clear()
+    {
+        m_entries.clear();
+    }
+
+    /** @fn AppendKey
+     *
+     * Appends the entries to p_key, see GetPipelineKey.
+     */
+    void AppendKey(std::vector<uint8_t>* p_key) const;
+
+    /** @fn Validate
+     *
+     * Checks that each value names a constant declared by at least one
+     * stage of program, and that the types agree in every stage that
+     * declares it.
+     */
+    vkex::Result Validate(const vkex::ShaderProgram program) const;
+
+    /** @fn Apply
+     *
+     * Fills p_data with the values of the constants declared by module.
+     * p_data->vk_info is left empty if there are none.
+     */
+    void Apply(const vkex::ShaderModule module, vkex::SpecializationData* p_data) const;
+
+private:
+    struct Entry
+    {
+        uint32_t                         constant_id = UINT32_MAX;
+        std::string                      name;
+        vkex::SpecializationConstantType type     = vkex::SpecializationConstantType::Undefined;
+        uint32_t                         size     = 0;
+        uint8_t                          value[8] = {};
+    };
+
+    template <typename T>
+    static void SetValue(T value, Entry* p_entry)
+    {
+        p_entry->type = vkex::SpecializationConstantTypeOf<T>::value;
+        if constexpr (std::is_same<T, bool>::value) {
+            // SPIR-V booleans are specialized with a VkBool32
+            VkBool32 vk_value = value ? VK_TRUE : VK_FALSE;
+            p_entry->size     = sizeof(vk_value);
+            std::memcpy(p_entry->value, &vk_value, sizeof(vk_value));
+        }
+        else {
+            p_entry->size = sizeof(T);
+            std::memcpy(p_entry->value, &value, sizeof(T));
+        }
+    }
+
+    /** @fn Store
+     *
+     * Replaces an earlier value for the same constant.
+     */
+    void Store(const Entry& entry);
+
+    /** @fn Find
+     *
+     */
+    static const vkex::SpecializationConstantInfo* Find(const vkex::ShaderModule module, const Entry& entry);
+
+private:
+    std::vector<Entry> m_entries;
+};
+
 // =================================================================================================
 // Support functions
 // =================================================================================================
@@ -15,6 +15,7 @@
 */
 
 #include "vkex/Swapchain.h"
+#include "vkex/CpuProfiler.h"
 #include "vkex/Instance.h"
 #include "vkex/Queue.h"
 #include "vkex/ToString.h"
@@ -479,6 +480,7 @@ vkex::Result CSwapchain::GetDepthStencilImage(uint32_t image_index, vkex::Image*
 
 VkResult CSwapchain::AcquireNextImage(uint64_t timeout, VkSemaphore semaphore, VkFence fence, uint32_t* pImageIndex)
 {
+    VKEX_CPU_ZONE("vkAcquireNextImageKHR");
     VkResult vk_result = vkAcquireNextImageKHR(
         *m_device,
         m_vk_object,
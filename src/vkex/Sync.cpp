@@ -15,6 +15,7 @@
 */
 
 #include "vkex/Sync.h"
+#include "vkex/CpuProfiler.h"
 #include "vkex/Device.h"
 #include "vkex/ToString.h"
 
@@ -175,6 +176,7 @@ VkResult CFence::GetFenceStatus()
 
 VkResult CFence::WaitForFence(uint64_t timeout)
 {
+    VKEX_CPU_ZONE("vkWaitForFences");
     VkResult vk_result = vkWaitForFences(
         *m_device,
         1,
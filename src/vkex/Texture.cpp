@@ -15,6 +15,7 @@
 */
 
 #include "vkex/Texture.h"
+#include "vkex/CpuProfiler.h"
 #include "vkex/Device.h"
 
 namespace vkex {
@@ -297,6 +298,8 @@ vkex::Result CTexture::CopyToMipLevel(
     uint32_t       src_height,
     const uint8_t* p_src_data)
 {
+    VKEX_CPU_ZONE("CTexture::CopyToMipLevel");
+
     bool is_host_visible = IsMemoryHostVisible(m_create_info.image.memory_usage);
     VKEX_ASSERT_MSG(is_host_visible, "Texture resource must be host visible for direct copy!");
     if (!is_host_visible) {
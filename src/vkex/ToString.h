@@ -53,6 +53,8 @@ std::string ToString(VkPresentModeKHR value);
 std::string ToString(VkSharingMode value);
 std::string ToString(VkSurfaceTransformFlagBitsKHR value);
 std::string ToString(VkCompositeAlphaFlagBitsKHR value);
+std::string ToString(VkObjectType value);
+std::string ToString(VkSystemAllocationScope value);
 
 std::string ToString(const VkExtent2D& value);
 std::string ToString(const VkPhysicalDeviceFeatures& value, const vkex::TextFormat& format = vkex::TextFormat());
@@ -18,89 +18,106 @@
 #define __VKEX_TRAITS_H__
 
 #include <vkex/Config.h>
+#include <vkex/ObjectPool.h>
 
 namespace vkex {
 
 /** @class IObjectStorageFunctions
  *
+ * Objects are stored in per-type ObjectPools, so creating and destroying
+ * an object is O(1) regardless of how many objects of its type exist.
  */
 class IObjectStorageFunctions
 {
 protected:
     /** @fn CreateObject
      *
+     * If p_storage_mutex is not null it is held only while storage is
+     * modified, so objects can be created concurrently.
      */
     template <
         typename IObjectT,
         typename SetParentMemberFnT,
         typename ParentT,
         typename CreateInfoT,
-        typename HandleT    = typename std::add_pointer<IObjectT>::type,
-        typename UniquePtrT = std::unique_ptr<IObjectT>>
+        typename HandleT = typename std::add_pointer<IObjectT>::type>
     vkex::Result CreateObject(
         const CreateInfoT&           create_info,
         const VkAllocationCallbacks* p_allocator,
-        std::vector<UniquePtrT>&     storage,
+        vkex::ObjectPool<IObjectT>&  storage,
         SetParentMemberFnT           p_set_parent_member_fn,
         ParentT                      parent,
-        HandleT*                     p_object)
+        HandleT*                     p_object,
+        std::mutex*                  p_storage_mutex = nullptr)
     {
+        std::unique_lock<std::mutex> lock;
+        if (p_storage_mutex != nullptr) {
+            lock = std::unique_lock<std::mutex>(*p_storage_mutex);
+        }
         // Allocate object
-        UniquePtrT obj = std::make_unique<IObjectT>();
-        if (!obj) {
-            return vkex::Result::ErrorAllocationFailed;
+        HandleT obj = storage.Allocate();
+        if (lock.owns_lock()) {
+            lock.unlock();
         }
         // Set parent
-        HandleT raw_obj = obj.get();
-        (raw_obj->*p_set_parent_member_fn)(parent);
+        (obj->*p_set_parent_member_fn)(parent);
         // Internal create
         vkex::Result vkex_result = obj->InternalCreate(create_info, p_allocator);
         if (!vkex_result) {
-            obj.reset();
+            if (p_storage_mutex != nullptr) {
+                lock.lock();
+            }
+            storage.Free(obj);
             return vkex_result;
         }
         // Grab object pointer
-        *p_object = obj.get();
-        // Store object
-        storage.push_back(std::move(obj));
+        *p_object = obj;
         // Success
         return vkex::Result::Success;
     }
 
     /** @fn DestroyObject
      *
+     * If p_storage_mutex is not null it is held only while storage is
+     * modified. Destroying an object that isn't live in storage, e.g.
+     * one that was already destroyed, does nothing.
      */
     template <
         typename IObjectT,
-        typename HandleT    = typename std::add_pointer<IObjectT>::type,
-        typename UniquePtrT = std::unique_ptr<IObjectT>>
+        typename HandleT = typename std::add_pointer<IObjectT>::type>
     vkex::Result DestroyObject(
-        std::vector<UniquePtrT>&     storage,
+        vkex::ObjectPool<IObjectT>&  storage,
         HandleT                      object,
-        const VkAllocationCallbacks* p_allocator)
+        const VkAllocationCallbacks* p_allocator,
+        std::mutex*                  p_storage_mutex = nullptr)
     {
-        auto it = std::find_if(
-            std::begin(storage),
-            std::end(storage),
-            [object](const UniquePtrT& elem) -> bool { return elem.get() == object; });
+        std::unique_lock<std::mutex> lock;
+        if (p_storage_mutex != nullptr) {
+            lock = std::unique_lock<std::mutex>(*p_storage_mutex);
+        }
 
-        // Exit if object isn't found
-        if (it == std::end(storage)) {
+        // Take ownership, exit if object isn't live
+        if (!storage.Retire(object)) {
+#if !defined(NDEBUG)
+            if (object != nullptr) {
+                VKEX_LOG_WARN("DestroyObject: object " << object << " is stale or belongs to another parent");
+            }
+#endif
             return vkex::Result::Success;
         }
 
-        // Move object to take ownership
-        UniquePtrT obj = std::move(*it);
+        if (lock.owns_lock()) {
+            lock.unlock();
+        }
 
-        // Erase/remove elements that are null
-        storage.erase(
-            std::remove_if(
-                std::begin(storage),
-                std::end(storage),
-                [](const UniquePtrT& elem) -> bool { return elem.get() == nullptr ? true : false; }),
-            std::end(storage));
+        vkex::Result vkex_result = object->InternalDestroy(p_allocator);
+
+        // The slot isn't reused until now
+        if (p_storage_mutex != nullptr) {
+            lock.lock();
+        }
+        storage.Recycle(object);
 
-        vkex::Result vkex_result = obj->InternalDestroy(p_allocator);
         if (!vkex_result) {
             return vkex_result;
         }
@@ -108,23 +125,68 @@ protected:
         return vkex::Result::Success;
     }
 
-    /** @fn DestroyAllObjects
+    /** @fn CreateObject
+     *
+     * Locks storage's own mutex while it is modified.
+     */
+    template <
+        typename IObjectT,
+        typename SetParentMemberFnT,
+        typename ParentT,
+        typename CreateInfoT,
+        typename HandleT = typename std::add_pointer<IObjectT>::type>
+    vkex::Result CreateObject(
+        const CreateInfoT&                create_info,
+        const VkAllocationCallbacks*      p_allocator,
+        vkex::LockedObjectPool<IObjectT>& storage,
+        SetParentMemberFnT                p_set_parent_member_fn,
+        ParentT                           parent,
+        HandleT*                          p_object)
+    {
+        return CreateObject<IObjectT>(
+            create_info,
+            p_allocator,
+            static_cast<vkex::ObjectPool<IObjectT>&>(storage),
+            p_set_parent_member_fn,
+            parent,
+            p_object,
+            &storage.GetMutex());
+    }
+
+    /** @fn DestroyObject
      *
+     * Locks storage's own mutex while it is modified.
      */
     template <
         typename IObjectT,
-        typename UniquePtrT = std::unique_ptr<IObjectT>>
+        typename HandleT = typename std::add_pointer<IObjectT>::type>
+    vkex::Result DestroyObject(
+        vkex::LockedObjectPool<IObjectT>& storage,
+        HandleT                           object,
+        const VkAllocationCallbacks*      p_allocator)
+    {
+        return DestroyObject<IObjectT>(
+            static_cast<vkex::ObjectPool<IObjectT>&>(storage),
+            object,
+            p_allocator,
+            &storage.GetMutex());
+    }
+
+    /** @fn DestroyAllObjects
+     *
+     */
+    template <typename IObjectT>
     vkex::Result DestroyAllObjects(
-        std::vector<UniquePtrT>&     storage,
+        vkex::ObjectPool<IObjectT>&  storage,
         const VkAllocationCallbacks* p_allocator)
     {
-        for (auto& obj : storage) {
+        for (auto obj : storage) {
             vkex::Result vkex_result = obj->InternalDestroy(p_allocator);
             if (!vkex_result) {
                 return vkex_result;
             }
         }
-        storage.clear();
+        storage.Clear();
 
         return vkex::Result::Success;
     }
@@ -17,6 +17,9 @@
 #ifndef __VKEX_UTIL_H__
 #define __VKEX_UTIL_H__
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <type_traits>
 
 namespace vkex {
@@ -52,6 +55,59 @@ inline uint32_t GetHighestBitIndex(uint32_t value)
     return index;
 }
 
+/** @fn HashBytes
+ *
+ * 64-bit FNV-1a. Pass a previous result as seed to hash incrementally.
+ */
+inline uint64_t HashBytes(const void* p_data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL)
+{
+    const uint8_t* p_bytes = static_cast<const uint8_t*>(p_data);
+    uint64_t       hash    = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint64_t>(p_bytes[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/** @fn HashWords
+ *
+ * FNV-1a over 32-bit words followed by a 64-bit finalizer, roughly four
+ * times faster than HashBytes for word aligned data such as SPIR-V.
+ */
+inline uint64_t HashWords(const uint32_t* p_words, size_t count, uint64_t seed = 0xcbf29ce484222325ULL)
+{
+    uint64_t hash = seed;
+    for (size_t i = 0; i < count; ++i) {
+        hash ^= static_cast<uint64_t>(p_words[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    // Spread the low bits, which are all a single xor touches
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/** @fn HashValue
+ *
+ */
+template <typename T>
+uint64_t HashValue(const T& value, uint64_t seed = 0xcbf29ce484222325ULL)
+{
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "T must be trivially copyable");
+
+    return HashBytes(&value, sizeof(T), seed);
+}
+
+/** @fn JsonString
+ *
+ * Quotes and escapes a string for use as a JSON string value.
+ */
+std::string JsonString(const std::string& s);
+
 } // namespace vkex
 
 #endif // __VKEX_UTIL_H__
\ No newline at end of file
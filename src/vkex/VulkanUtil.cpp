@@ -15,6 +15,7 @@
 */
 
 #include "vkex/Buffer.h"
+#include "vkex/CpuProfiler.h"
 #include "vkex/Device.h"
 #include "vkex/Image.h"
 #include "vkex/VulkanUtil.h"
@@ -254,6 +255,20 @@ VkDescriptorType ShaderInterface::GetDescriptorType(uint32_t set_number, uint32_
 // =================================================================================================
 // ShaderArguments
 // =================================================================================================
+bool operator==(const vkex::BoundDescriptor& a, const vkex::BoundDescriptor& b)
+{
+    bool is_equal = (a.binding_number == b.binding_number) &&
+                    (a.array_element == b.array_element) &&
+                    (a.buffer_info.buffer == b.buffer_info.buffer) &&
+                    (a.buffer_info.offset == b.buffer_info.offset) &&
+                    (a.buffer_info.range == b.buffer_info.range) &&
+                    (a.image_info.sampler == b.image_info.sampler) &&
+                    (a.image_info.imageView == b.image_info.imageView) &&
+                    (a.image_info.imageLayout == b.image_info.imageLayout) &&
+                    (a.texel_buffer_view == b.texel_buffer_view);
+    return is_equal;
+}
+
 ShaderArguments::ShaderArguments()
 {
 }
@@ -293,11 +308,158 @@ vkex::Result ShaderArguments::AssignSet(uint32_t set_number, vkex::DescriptorSet
 
     SortSets();
 
+    // A set number is either allocated or pushed
+    m_assigned_push_sets.erase(
+        std::remove_if(
+            std::begin(m_assigned_push_sets),
+            std::end(m_assigned_push_sets),
+            [set_number](const AssignedPushDescriptorSet& elem) -> bool { return elem.set_number == set_number; }),
+        std::end(m_assigned_push_sets));
+
     return vkex::Result::Success;
 }
 
+vkex::Result ShaderArguments::AssignPushSet(uint32_t set_number, const vkex::DescriptorSetLayout layout)
+{
+    if (layout == nullptr) {
+        return vkex::Result::ErrorUnexpectedNullPointer;
+    }
+
+    if (!layout->GetCreateFlags().bits.push_descriptor_set) {
+        return vkex::Result::ErrorDescriptorSetLayoutNotPushDescriptor;
+    }
+
+    // Pushed sets are bound with vkCmdPushDescriptorSetKHR
+    if (!layout->GetDevice()->GetEnabledFeatures().khr.pushDescriptor) {
+        return vkex::Result::ErrorRequiredFeatureNotEnabled;
+    }
+
+    AssignedPushDescriptorSet* p_push_set = FindPushSet(set_number);
+    if (p_push_set != nullptr) {
+        p_push_set->layout = layout;
+        p_push_set->descriptors.clear();
+    }
+    else {
+        AssignedPushDescriptorSet push_set = {};
+        push_set.set_number                = set_number;
+        push_set.layout                    = layout;
+        m_assigned_push_sets.push_back(push_set);
+    }
+
+    // A set number is either allocated or pushed
+    m_assigned_sets.erase(
+        std::remove_if(
+            std::begin(m_assigned_sets),
+            std::end(m_assigned_sets),
+            [set_number](const AssignedDescriptorSet& elem) -> bool { return elem.set_number == set_number; }),
+        std::end(m_assigned_sets));
+
+    return vkex::Result::Success;
+}
+
+AssignedPushDescriptorSet* ShaderArguments::FindPushSet(uint32_t set_number)
+{
+    auto it = std::find_if(
+        std::begin(m_assigned_push_sets),
+        std::end(m_assigned_push_sets),
+        [set_number](const AssignedPushDescriptorSet& elem) -> bool { return elem.set_number == set_number; });
+    if (it == std::end(m_assigned_push_sets)) {
+        return nullptr;
+    }
+    return &(*it);
+}
+
+vkex::Result ShaderArguments::GetPushDescriptorType(const AssignedPushDescriptorSet* p_push_set, uint32_t binding_number, VkDescriptorType* p_descriptor_type) const
+{
+    const std::vector<VkDescriptorSetLayoutBinding>& bindings = p_push_set->layout->GetBindings();
+
+    auto it = std::find_if(
+        std::begin(bindings),
+        std::end(bindings),
+        [binding_number](const VkDescriptorSetLayoutBinding& elem) -> bool { return elem.binding == binding_number; });
+    if (it == std::end(bindings)) {
+        return vkex::Result::ErrorInvalidDescriptorBinding;
+    }
+
+    *p_descriptor_type = it->descriptorType;
+
+    return vkex::Result::Success;
+}
+
+void ShaderArguments::AssignPushDescriptor(AssignedPushDescriptorSet* p_push_set, const vkex::BoundDescriptor& descriptor)
+{
+    auto it = std::find_if(
+        std::begin(p_push_set->descriptors),
+        std::end(p_push_set->descriptors),
+        [&descriptor](const vkex::BoundDescriptor& elem) -> bool { return (elem.binding_number == descriptor.binding_number) && (elem.array_element == descriptor.array_element); });
+
+    if (it != std::end(p_push_set->descriptors)) {
+        *it = descriptor;
+    }
+    else {
+        p_push_set->descriptors.push_back(descriptor);
+    }
+}
+
+void ShaderArguments::GetPushDescriptorWrites(uint32_t set_number, std::vector<VkWriteDescriptorSet>* p_writes) const
+{
+    auto it = std::find_if(
+        std::begin(m_assigned_push_sets),
+        std::end(m_assigned_push_sets),
+        [set_number](const AssignedPushDescriptorSet& elem) -> bool { return elem.set_number == set_number; });
+    if (it == std::end(m_assigned_push_sets)) {
+        return;
+    }
+
+    for (auto& descriptor : it->descriptors) {
+        // Types were validated when the descriptors were assigned
+        VkDescriptorType descriptor_type = InvalidValue<VkDescriptorType>::Value;
+        GetPushDescriptorType(&(*it), descriptor.binding_number, &descriptor_type);
+
+        bool is_buffer = (descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) ||
+                         (descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+        VkWriteDescriptorSet vk_write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        vk_write.dstSet               = VK_NULL_HANDLE;
+        vk_write.dstBinding           = descriptor.binding_number;
+        vk_write.dstArrayElement      = descriptor.array_element;
+        vk_write.descriptorCount      = 1;
+        vk_write.descriptorType       = descriptor_type;
+        vk_write.pImageInfo           = is_buffer ? nullptr : &descriptor.image_info;
+        vk_write.pBufferInfo          = is_buffer ? &descriptor.buffer_info : nullptr;
+        vk_write.pTexelBufferView     = nullptr;
+        p_writes->push_back(vk_write);
+    }
+}
+
 vkex::Result ShaderArguments::AssignDescriptor(uint32_t set_number, uint32_t binding_number, const vkex::Buffer constant_buffer, uint32_t array_element)
 {
+    AssignedPushDescriptorSet* p_push_set = FindPushSet(set_number);
+    if (p_push_set != nullptr) {
+        VkDescriptorType descriptor_type = InvalidValue<VkDescriptorType>::Value;
+        vkex::Result     vkex_result     = GetPushDescriptorType(p_push_set, binding_number, &descriptor_type);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+
+        // Dynamic offsets and texel buffer views aren't supported for push descriptors here
+        bool is_uniform_buffer = (descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+        bool is_storage_buffer = (descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+        if (!(is_uniform_buffer || is_storage_buffer)) {
+            return vkex::Result::ErrorInvalidDescriptorType;
+        }
+
+        vkex::BoundDescriptor descriptor = {};
+        descriptor.binding_number        = binding_number;
+        descriptor.array_element         = array_element;
+        descriptor.buffer_info.buffer    = *constant_buffer;
+        descriptor.buffer_info.offset    = 0;
+        descriptor.buffer_info.range     = constant_buffer->GetSize();
+        AssignPushDescriptor(p_push_set, descriptor);
+
+        return vkex::Result::Success;
+    }
+
     auto it = std::find_if(
         std::begin(m_assigned_sets),
         std::end(m_assigned_sets),
@@ -313,6 +475,30 @@ vkex::Result ShaderArguments::AssignDescriptor(uint32_t set_number, uint32_t bin
 
 vkex::Result ShaderArguments::AssignDescriptor(uint32_t set_number, uint32_t binding_number, const vkex::Texture texture, uint32_t array_element)
 {
+    AssignedPushDescriptorSet* p_push_set = FindPushSet(set_number);
+    if (p_push_set != nullptr) {
+        VkDescriptorType descriptor_type = InvalidValue<VkDescriptorType>::Value;
+        vkex::Result     vkex_result     = GetPushDescriptorType(p_push_set, binding_number, &descriptor_type);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+
+        bool is_sampled_image = (descriptor_type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+        bool is_storage_image = (descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+        if (!(is_sampled_image || is_storage_image)) {
+            return vkex::Result::ErrorInvalidDescriptorType;
+        }
+
+        vkex::BoundDescriptor descriptor  = {};
+        descriptor.binding_number         = binding_number;
+        descriptor.array_element          = array_element;
+        descriptor.image_info.imageView   = *(texture->GetImageView());
+        descriptor.image_info.imageLayout = is_storage_image ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        AssignPushDescriptor(p_push_set, descriptor);
+
+        return vkex::Result::Success;
+    }
+
     auto it = std::find_if(
         std::begin(m_assigned_sets),
         std::end(m_assigned_sets),
@@ -328,6 +514,27 @@ vkex::Result ShaderArguments::AssignDescriptor(uint32_t set_number, uint32_t bin
 
 vkex::Result ShaderArguments::AssignDescriptor(uint32_t set_number, uint32_t binding_number, const vkex::Sampler sampler, uint32_t array_element)
 {
+    AssignedPushDescriptorSet* p_push_set = FindPushSet(set_number);
+    if (p_push_set != nullptr) {
+        VkDescriptorType descriptor_type = InvalidValue<VkDescriptorType>::Value;
+        vkex::Result     vkex_result     = GetPushDescriptorType(p_push_set, binding_number, &descriptor_type);
+        if (!vkex_result) {
+            return vkex_result;
+        }
+
+        if (descriptor_type != VK_DESCRIPTOR_TYPE_SAMPLER) {
+            return vkex::Result::ErrorInvalidDescriptorType;
+        }
+
+        vkex::BoundDescriptor descriptor = {};
+        descriptor.binding_number        = binding_number;
+        descriptor.array_element         = array_element;
+        descriptor.image_info.sampler    = *sampler;
+        AssignPushDescriptor(p_push_set, descriptor);
+
+        return vkex::Result::Success;
+    }
+
     auto it = std::find_if(
         std::begin(m_assigned_sets),
         std::end(m_assigned_sets),
@@ -730,6 +937,8 @@ vkex::Result TransitionImageLayout(
     VkImageLayout        new_layout,
     VkPipelineStageFlags new_pipeline_stage)
 {
+    VKEX_CPU_ZONE("TransitionImageLayout");
+
     VKEX_ASSERT(queue != nullptr);
     if (queue == nullptr) {
         return vkex::Result::ErrorUnexpectedNullPointer;
@@ -835,6 +1044,8 @@ vkex::Result CopyResource(
     uint32_t            region_count,
     const VkBufferCopy* p_regions)
 {
+    VKEX_CPU_ZONE("CopyResource");
+
     // Grab device
     vkex::Device device = queue->GetDevice();
     // Create command pool
@@ -922,6 +1133,8 @@ vkex::Result CopyResource(
     const void*  p_src_data,
     vkex::Buffer dst)
 {
+    VKEX_CPU_ZONE("CopyResource");
+
     // Grab device
     vkex::Device device = queue->GetDevice();
     // Create temporary buffer
@@ -982,6 +1195,8 @@ vkex::Result CopyResource(
     uint32_t           region_count,
     const VkImageCopy* p_regions)
 {
+    VKEX_CPU_ZONE("CopyResource");
+
     // Grab device
     vkex::Device device = queue->GetDevice();
     // Create command pool
@@ -1058,6 +1273,8 @@ vkex::Result CopyResource(
     uint32_t                 region_count,
     const VkBufferImageCopy* p_regions)
 {
+    VKEX_CPU_ZONE("CopyResource");
+
     // Grab device
     vkex::Device device = queue->GetDevice();
     // Create command pool
@@ -919,12 +919,63 @@ enum
     kMaxAllSets = 0xFFFFFFFF
 };
 
+/** @struct BoundDescriptor
+ *
+ * Resource handles bound to a single descriptor. Unused fields are left
+ * as VK_NULL_HANDLE/0 so that the struct can be compared and hashed as
+ * a whole.
+ */
+struct BoundDescriptor
+{
+    uint32_t               binding_number = 0;
+    uint32_t               array_element  = 0;
+    VkDescriptorBufferInfo buffer_info       = {};
+    VkDescriptorImageInfo  image_info        = {};
+    VkBufferView           texel_buffer_view = VK_NULL_HANDLE;
+};
+
+/** @fn operator==(const BoundDescriptor&, const BoundDescriptor&)
+ *
+ */
+bool operator==(const vkex::BoundDescriptor& a, const vkex::BoundDescriptor& b);
+
+/** @class ObjectDestroyListener
+ *
+ * Receives the Vulkan handle of a buffer, image view, sampler or
+ * descriptor set layout just before the device destroys it. Caches that
+ * key on these handles register with CDevice::AddDestroyListener and
+ * drop their entries here, since the driver may hand out the same handle
+ * value again.
+ */
+class ObjectDestroyListener
+{
+public:
+    virtual ~ObjectDestroyListener() {}
+
+    virtual void OnDestroyBuffer(VkBuffer vk_buffer) {}
+    virtual void OnDestroyImageView(VkImageView vk_image_view) {}
+    virtual void OnDestroySampler(VkSampler vk_sampler) {}
+    virtual void OnDestroyDescriptorSetLayout(VkDescriptorSetLayout vk_descriptor_set_layout) {}
+};
+
 struct AssignedDescriptorSet
 {
     uint32_t            set_number;
     vkex::DescriptorSet descriptor_set;
 };
 
+/** @struct AssignedPushDescriptorSet
+ *
+ * Descriptors recorded for a set that is pushed into the command buffer
+ * with vkCmdPushDescriptorSetKHR instead of allocated from a pool.
+ */
+struct AssignedPushDescriptorSet
+{
+    uint32_t                           set_number;
+    vkex::DescriptorSetLayout          layout;
+    std::vector<vkex::BoundDescriptor> descriptors;
+};
+
 class ShaderArguments
 {
 public:
@@ -934,6 +985,16 @@ public:
 
     vkex::Result AssignSet(uint32_t set_number, vkex::DescriptorSet descriptor_set);
 
+    /** @fn AssignPushSet
+     *
+     * Descriptors assigned to set_number are recorded and pushed when the
+     * arguments are bound with CCommandBuffer::CmdBindShaderArguments, so
+     * no descriptor set needs to be allocated or updated. layout must be
+     * created with the push_descriptor_set flag, on a device with
+     * VK_KHR_push_descriptor enabled.
+     */
+    vkex::Result AssignPushSet(uint32_t set_number, const vkex::DescriptorSetLayout layout);
+
     /** @fn AssignDescriptor
      *
      */
@@ -954,11 +1015,41 @@ public:
      */
     std::vector<VkDescriptorSet> GetVkDescriptorSets(uint32_t first_set_number = 0, uint32_t set_count = kMaxAllSets) const;
 
+    /** @fn GetAssignedSets
+     *
+     */
+    const std::vector<AssignedDescriptorSet>& GetAssignedSets() const
+    {
+        return m_assigned_sets;
+    }
+
+    /** @fn GetAssignedPushSets
+     *
+     */
+    const std::vector<AssignedPushDescriptorSet>& GetAssignedPushSets() const
+    {
+        return m_assigned_push_sets;
+    }
+
+    /** @fn GetPushDescriptorWrites
+     *
+     * Info pointers in the writes point into this object and stay valid
+     * until the next descriptor is assigned.
+     */
+    void GetPushDescriptorWrites(uint32_t set_number, std::vector<VkWriteDescriptorSet>* p_writes) const;
+
 private:
     void SortSets();
 
+    AssignedPushDescriptorSet* FindPushSet(uint32_t set_number);
+
+    vkex::Result GetPushDescriptorType(const AssignedPushDescriptorSet* p_push_set, uint32_t binding_number, VkDescriptorType* p_descriptor_type) const;
+
+    void AssignPushDescriptor(AssignedPushDescriptorSet* p_push_set, const vkex::BoundDescriptor& descriptor);
+
 private:
-    std::vector<AssignedDescriptorSet> m_assigned_sets;
+    std::vector<AssignedDescriptorSet>     m_assigned_sets;
+    std::vector<AssignedPushDescriptorSet> m_assigned_push_sets;
 };
 
 // =================================================================================================
@@ -0,0 +1,104 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#include "vkex/WorkerPool.h"
+#include "vkex/CpuProfiler.h"
+
+namespace vkex {
+
+// =================================================================================================
+// WorkerPool
+// =================================================================================================
+WorkerPool::WorkerPool(uint32_t thread_count, const std::string& name)
+    : m_name(name)
+{
+    if (thread_count == 0) {
+        uint32_t hardware_thread_count = static_cast<uint32_t>(std::thread::hardware_concurrency());
+        thread_count                   = (hardware_thread_count > 1) ? (hardware_thread_count - 1) : 1;
+    }
+
+    m_threads.reserve(thread_count);
+    for (uint32_t i = 0; i < thread_count; ++i) {
+        m_threads.emplace_back(&WorkerPool::ThreadMain, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_task_available.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::Submit(Task&& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_task_available.notify_one();
+}
+
+void WorkerPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() -> bool { return m_tasks.empty() && (m_running_count == 0); });
+}
+
+void WorkerPool::ThreadMain(uint32_t thread_index)
+{
+    CpuProfiler::SetThreadName(m_name + " " + std::to_string(thread_index));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_task_available.wait(lock, [this]() -> bool { return m_stop || !m_tasks.empty(); });
+        // Queue is drained before exiting
+        if (m_tasks.empty()) {
+            break;
+        }
+
+        Task task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+        ++m_running_count;
+
+        // An exception must not take the thread down with the running
+        // count still raised, WaitIdle() would never return
+        lock.unlock();
+        try {
+            task();
+        }
+        catch (const std::exception& e) {
+            VKEX_LOG_ERROR("WorkerPool task threw an exception: " << e.what());
+        }
+        catch (...) {
+            VKEX_LOG_ERROR("WorkerPool task threw an unknown exception");
+        }
+        lock.lock();
+
+        --m_running_count;
+        if (m_tasks.empty() && (m_running_count == 0)) {
+            m_idle.notify_all();
+        }
+    }
+}
+
+} // namespace vkex
\ No newline at end of file
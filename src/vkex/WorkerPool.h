@@ -0,0 +1,86 @@
+/*
+ Copyright 2018-2023 Google Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+*/
+
+#ifndef __VKEX_WORKER_POOL_H__
+#define __VKEX_WORKER_POOL_H__
+
+#include "vkex/Config.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
+
+namespace vkex {
+
+/** @class WorkerPool
+ *
+ * Fixed set of threads that run submitted tasks in FIFO order. Tasks
+ * still queued when the pool is destroyed are run before the threads
+ * exit, so anything waiting on a task's result is always released.
+ * Exceptions thrown by a task are logged and do not stop the pool;
+ * tasks that fulfil a promise must catch them themselves.
+ */
+class WorkerPool
+{
+public:
+    using Task = std::function<void()>;
+
+    /** @fn WorkerPool
+     *
+     * A thread_count of 0 uses one less than the number of hardware
+     * threads, leaving a core for the thread that submits work. Threads
+     * are named "<name> <index>" in CPU profiler traces.
+     */
+    WorkerPool(uint32_t thread_count = 0, const std::string& name = "Worker");
+    ~WorkerPool();
+
+    /** @fn GetThreadCount
+     *
+     */
+    uint32_t GetThreadCount() const
+    {
+        return CountU32(m_threads);
+    }
+
+    /** @fn Submit
+     *
+     */
+    void Submit(Task&& task);
+
+    /** @fn WaitIdle
+     *
+     * Blocks until the queue is empty and no task is running.
+     */
+    void WaitIdle();
+
+private:
+    void ThreadMain(uint32_t thread_index);
+
+private:
+    std::string              m_name;
+    std::vector<std::thread> m_threads;
+    std::mutex               m_mutex;
+    std::condition_variable  m_task_available;
+    std::condition_variable  m_idle;
+    std::deque<Task>         m_tasks;
+    uint32_t                 m_running_count = 0;
+    bool                     m_stop          = false;
+};
+
+} // namespace vkex
+
+#endif // __VKEX_WORKER_POOL_H__
\ No newline at end of file
@@ -18,11 +18,16 @@
 #define __VKEX_VKEX_H__
 
 #include "vkex/Application.h"
+#include "vkex/Bindless.h"
 #include "vkex/Buffer.h"
 #include "vkex/Command.h"
 #include "vkex/Config.h"
+#include "vkex/CpuProfiler.h"
 #include "vkex/Descriptor.h"
+#include "vkex/DescriptorBuffer.h"
 #include "vkex/Device.h"
+#include "vkex/GpuProfiler.h"
+#include "vkex/HostAllocator.h"
 #include "vkex/Image.h"
 #include "vkex/Instance.h"
 #include "vkex/Pipeline.h"